@@ -1,10 +1,19 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QHostAddress>
+#include <QLockFile>
+#include <QMessageBox>
 #include <QScreen>
-#include <QPainter>
-#include <QPixmap>
-#include <QRadialGradient>
-#include <QPen>
+#include "BackgroundWriter.h"
+#include "HistoryExporter.h"
+#include "HistoryImporter.h"
 #include "PomodoroTimer.h"
+#include "SessionHistory.h"
+#include "StartupSequence.h"
+#include "TeamTimerClient.h"
+#include "TeamTimerServer.h"
+#include "TomatoIcon.h"
 
 namespace {
     // Application constants - use QStringLiteral for compile-time optimization
@@ -12,16 +21,6 @@ namespace {
     const QString APP_VERSION = QStringLiteral("0.1.1");
     const QString ORGANIZATION = QStringLiteral("PomodoroApp");
 
-    // Icon generation constants
-    constexpr double TOMATO_SIZE_RATIO = 0.8;
-    constexpr double STEM_SIZE_RATIO = 0.15;
-    constexpr double TOMATO_FLATTEN_RATIO = 0.9;
-    constexpr int PEN_WIDTH = 1;
-    constexpr int HIGHLIGHT_ALPHA = 100;
-
-    // Forward declaration for createTomatoIcon
-    QIcon createTomatoIcon(int size = 32);
-
     // Use thread-safe singleton pattern instead of global variable
     class IconCache {
     public:
@@ -48,66 +47,6 @@ namespace {
         }
     };
 
-    QIcon createTomatoIcon(int size)
-    {
-        QPixmap pixmap(size, size);
-        pixmap.fill(Qt::transparent);
-
-        QPainter painter(&pixmap);
-        painter.setRenderHint(QPainter::Antialiasing);
-
-        // Calculate proportions
-        const int tomatoSize = static_cast<int>(size * TOMATO_SIZE_RATIO);
-        const int stemSize = static_cast<int>(size * STEM_SIZE_RATIO);
-        const int margin = (size - tomatoSize) / 2;
-
-        // Draw tomato body with gradient
-        QRadialGradient tomatoGradient(size/2, size/2 + stemSize, tomatoSize/2);
-        tomatoGradient.setColorAt(0.0, QColor(255, 100, 100));
-        tomatoGradient.setColorAt(0.7, QColor(220, 50, 50));
-        tomatoGradient.setColorAt(1.0, QColor(180, 30, 30));
-
-        painter.setBrush(QBrush(tomatoGradient));
-        painter.setPen(QPen(QColor(150, 20, 20), PEN_WIDTH));
-
-        const QRect tomatoRect(margin, margin + stemSize, tomatoSize,
-                              static_cast<int>(tomatoSize * TOMATO_FLATTEN_RATIO));
-        painter.drawEllipse(tomatoRect);
-
-        // Draw stem and leaves
-        painter.setBrush(QBrush(QColor(34, 139, 34)));
-        painter.setPen(QPen(QColor(20, 100, 20), PEN_WIDTH));
-
-        // Main stem
-        const QRect stemRect(size/2 - stemSize/3, margin, stemSize/1.5, stemSize);
-        painter.drawRect(stemRect);
-
-        // Draw leaves using polygons - optimize polygon creation
-        QPolygon leftLeaf, rightLeaf;
-        leftLeaf.reserve(3);
-        rightLeaf.reserve(3);
-
-        leftLeaf << QPoint(size/2 - stemSize/2, margin + stemSize/3)
-                 << QPoint(size/2 - stemSize, margin)
-                 << QPoint(size/2 - stemSize/3, margin + stemSize/2);
-
-        rightLeaf << QPoint(size/2 + stemSize/2, margin + stemSize/3)
-                  << QPoint(size/2 + stemSize, margin)
-                  << QPoint(size/2 + stemSize/3, margin + stemSize/2);
-
-        painter.drawPolygon(leftLeaf);
-        painter.drawPolygon(rightLeaf);
-
-        // Add 3D highlight effect
-        painter.setBrush(QBrush(QColor(255, 150, 150, HIGHLIGHT_ALPHA)));
-        painter.setPen(Qt::NoPen);
-        const QRect highlightRect(margin + tomatoSize/4, margin + stemSize + tomatoSize/4,
-                                 tomatoSize/3, tomatoSize/4);
-        painter.drawEllipse(highlightRect);
-
-        return QIcon(pixmap);
-    }
-
     void centerWindow(QWidget* window)
     {
         if (!window) {
@@ -135,15 +74,257 @@ namespace {
         app.setWindowIcon(IconCache::instance().getApplicationIcon());
         app.setQuitOnLastWindowClosed(false);
     }
+
+    struct CommandLineOptions {
+        QCommandLineOption tag{QStringLiteral("tag"),
+            QStringLiteral("Task or project tag for the following work sessions."),
+            QStringLiteral("name")};
+        QCommandLineOption exportPath{QStringLiteral("export"),
+            QStringLiteral("Export the session history to a file and exit."),
+            QStringLiteral("file")};
+        QCommandLineOption importPath{QStringLiteral("import"),
+            QStringLiteral("Import sessions from a CSV or NDJSON file and exit."),
+            QStringLiteral("file")};
+        QCommandLineOption format{QStringLiteral("format"),
+            QStringLiteral("File format: csv or ndjson (export default csv, import detects it)."),
+            QStringLiteral("format"), QStringLiteral("csv")};
+        QCommandLineOption dataset{QStringLiteral("dataset"),
+            QStringLiteral("Data to export: sessions or daily (default sessions)."),
+            QStringLiteral("dataset"), QStringLiteral("sessions")};
+        QCommandLineOption server{QStringLiteral("server"),
+            QStringLiteral("Run headless as a shared team timer server.")};
+        QCommandLineOption join{QStringLiteral("join"),
+            QStringLiteral("Join a room on a team timer server and print its transitions."),
+            QStringLiteral("room")};
+        QCommandLineOption address{QStringLiteral("address"),
+            QStringLiteral("Team server address (default 127.0.0.1)."),
+            QStringLiteral("address"), QStringLiteral("127.0.0.1")};
+        QCommandLineOption port{QStringLiteral("port"),
+            QStringLiteral("Team server port (default %1).").arg(TeamTimerServer::DEFAULT_PORT),
+            QStringLiteral("port"), QString::number(TeamTimerServer::DEFAULT_PORT)};
+
+        QCommandLineOption audioSink{QStringLiteral("audio-sink"),
+            QStringLiteral("Output for sound cues: device, null or a .wav file to record into."),
+            QStringLiteral("sink")};
+
+        QCommandLineOption plugins{QStringLiteral("plugins"),
+            QStringLiteral("Load timer event plugins from a directory instead of the app data one."),
+            QStringLiteral("directory")};
+
+        QCommandLineOption hud{QStringLiteral("hud"),
+            QStringLiteral("Show the performance overlay (toggle with Ctrl+Shift+D).")};
+
+        void addTo(QCommandLineParser& parser) const
+        {
+            parser.addOptions({tag, exportPath, importPath, format, dataset, server, join, address, port, audioSink,
+                               plugins, hud});
+        }
+    };
+
+    QStringList argumentList(int argc, char *argv[])
+    {
+        QStringList arguments;
+        arguments.reserve(argc);
+        for (int i = 0; i < argc; ++i) {
+            arguments << QString::fromLocal8Bit(argv[i]);
+        }
+        return arguments;
+    }
+
+    void setupCoreApplicationProperties(QCoreApplication& app)
+    {
+        app.setApplicationName(APP_NAME);
+        app.setApplicationVersion(APP_VERSION);
+        app.setOrganizationName(ORGANIZATION);
+    }
+
+    // Only one process may write the session history; see SessionHistory::lockFilePath()
+    bool lockHistory(QLockFile& lock, QString& holder)
+    {
+        // Held for the whole run; a crashed holder is still detected by its PID
+        lock.setStaleLockTime(0);
+        if (lock.tryLock(0)) {
+            return true;
+        }
+        qint64 pid = 0;
+        QString hostName, appName;
+        lock.getLockInfo(&pid, &hostName, &appName);
+        holder = QStringLiteral("%1 (PID %2)").arg(appName.isEmpty() ? APP_NAME : appName).arg(pid);
+        return false;
+    }
+
+    int runExport(int argc, char *argv[], const QString& path, const QString& formatName, const QString& datasetName)
+    {
+        QCoreApplication app(argc, argv);
+        setupCoreApplicationProperties(app);
+
+        HistoryExporter::Format format;
+        HistoryExporter::Dataset dataset;
+        if (!HistoryExporter::parseFormat(formatName, format)) {
+            qCritical().noquote() << "Unknown export format:" << formatName;
+            return 1;
+        }
+        if (!HistoryExporter::parseDataset(datasetName, dataset)) {
+            qCritical().noquote() << "Unknown export dataset:" << datasetName;
+            return 1;
+        }
+
+        HistoryExporter exporter(path, format, dataset);
+        QObject::connect(&exporter, &HistoryExporter::finished, [&path](bool success, const QString& error) {
+            if (success) {
+                qInfo().noquote() << "Exported history to" << path;
+            } else {
+                qCritical().noquote() << "Export failed:" << error;
+            }
+        });
+        return exporter.run() ? 0 : 1;
+    }
+
+    int runImport(int argc, char *argv[], const QString& path, const QString& formatName)
+    {
+        QCoreApplication app(argc, argv);
+        setupCoreApplicationProperties(app);
+
+        HistoryImporter::Format format = HistoryImporter::Format::Auto;
+        if (!formatName.isEmpty() && !HistoryImporter::parseFormat(formatName, format)) {
+            qCritical().noquote() << "Unknown import format:" << formatName;
+            return 1;
+        }
+
+        QLockFile lock(SessionHistory::lockFilePath());
+        QString holder;
+        if (!lockHistory(lock, holder)) {
+            qCritical().noquote() << "Import failed: the session history is in use by" << holder
+                                  << "- close it or import from its Statistics window";
+            return 1;
+        }
+
+        HistoryImporter importer(path, format);
+        QObject::connect(&importer, &HistoryImporter::finished, [](bool success, const QString& error) {
+            if (!success) {
+                qCritical().noquote() << "Import failed:" << error;
+            }
+        });
+        QObject::connect(&importer, &HistoryImporter::written, [](bool success, const QString& error) {
+            if (!success) {
+                qCritical().noquote() << "Import failed:" << error;
+            }
+        });
+        if (!importer.run()) {
+            return 1;
+        }
+        importer.resolveTags();
+        if (!importer.write()) {
+            return 1;
+        }
+
+        const HistoryImporter::Summary summary = importer.commit();
+        BackgroundWriter::instance().flush();
+        qInfo().noquote() << QStringLiteral("Imported %1 sessions from %2 (%3 duplicates, %4 invalid rows skipped)")
+                                 .arg(summary.imported).arg(path).arg(summary.duplicates).arg(summary.invalid);
+        return 0;
+    }
+
+    int runServer(int argc, char *argv[], const QHostAddress& address, quint16 port)
+    {
+        QCoreApplication app(argc, argv);
+        setupCoreApplicationProperties(app);
+
+        TeamTimerServer server;
+        if (!server.listen(address, port)) {
+            return 1;
+        }
+        qInfo().noquote() << "Team timer server listening on"
+                          << QStringLiteral("%1:%2").arg(address.toString()).arg(server.serverPort());
+
+        return app.exec();
+    }
+
+    int runJoin(int argc, char *argv[], const QHostAddress& address, quint16 port, const QString& room)
+    {
+        QCoreApplication app(argc, argv);
+        setupCoreApplicationProperties(app);
+
+        TeamTimerClient client;
+        QObject::connect(&client, &TeamTimerClient::stateReceived, &app, [&client](const QJsonObject& state) {
+            const int remaining = client.remainingSeconds();
+            qInfo().noquote() << state.value(QStringLiteral("session")).toString()
+                              << state.value(QStringLiteral("status")).toString()
+                              << QStringLiteral("%1:%2").arg(remaining / 60, 2, 10, QChar('0'))
+                                                        .arg(remaining % 60, 2, 10, QChar('0'));
+        });
+        QObject::connect(&client, &TeamTimerClient::errorReceived, &app, [](const QString& message) {
+            qWarning().noquote() << "Team server error:" << message;
+        });
+        QObject::connect(&client, &TeamTimerClient::disconnected, &app, &QCoreApplication::quit);
+        client.connectToServer(address, port, room);
+
+        return app.exec();
+    }
 }
 
 int main(int argc, char *argv[])
 {
+    // Reference point for the time-to-first-frame metric
+    StartupSequence::markProcessStart();
+
+    QCommandLineParser parser;
+    const CommandLineOptions options;
+    options.addTo(parser);
+    parser.addHelpOption();
+    parser.addVersionOption();
+    // The application object depends on the mode, so parse before creating it
+    parser.parse(argumentList(argc, argv));
+
+    if (parser.isSet(options.exportPath)) {
+        return runExport(argc, argv, parser.value(options.exportPath),
+                         parser.value(options.format), parser.value(options.dataset));
+    }
+
+    if (parser.isSet(options.importPath)) {
+        // Only an explicit --format overrides detection; its default is meant for export
+        return runImport(argc, argv, parser.value(options.importPath),
+                         parser.isSet(options.format) ? parser.value(options.format) : QString());
+    }
+
+    if (parser.isSet(options.server) || parser.isSet(options.join)) {
+        const QHostAddress address(parser.value(options.address));
+        const quint16 port = static_cast<quint16>(parser.value(options.port).toUInt());
+        if (address.isNull() || port == 0) {
+            qCritical("Invalid team server address or port");
+            return 1;
+        }
+        return parser.isSet(options.server)
+            ? runServer(argc, argv, address, port)
+            : runJoin(argc, argv, address, port, parser.value(options.join));
+    }
+
     QApplication app(argc, argv);
 
     setupApplicationProperties(app);
+    parser.process(app);
+
+    QLockFile historyLock(SessionHistory::lockFilePath());
+    QString holder;
+    if (!lockHistory(historyLock, holder)) {
+        QMessageBox::critical(nullptr, APP_NAME,
+                              QStringLiteral("The session history is in use by %1.").arg(holder));
+        return 1;
+    }
 
     PomodoroTimer timer;
+    if (parser.isSet(options.tag)) {
+        timer.setCurrentTag(parser.value(options.tag));
+    }
+    if (parser.isSet(options.audioSink)) {
+        timer.setAudioSink(parser.value(options.audioSink));
+    }
+    if (parser.isSet(options.plugins)) {
+        timer.setPluginDirectory(parser.value(options.plugins));
+    }
+    if (parser.isSet(options.hud)) {
+        timer.setHudVisible(true);
+    }
     timer.show();
     centerWindow(&timer);
 
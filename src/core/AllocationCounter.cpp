@@ -0,0 +1,83 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<bool> s_enabled{false};
+    thread_local quint64 t_allocations = 0;
+
+#ifdef POMODORO_COUNT_ALLOCATIONS
+    void count() noexcept
+    {
+        if (s_enabled.load(std::memory_order_relaxed)) {
+            ++t_allocations;
+        }
+    }
+#endif
+}
+
+bool AllocationCounter::isAvailable()
+{
+#ifdef POMODORO_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationCounter::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationCounter::isEnabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+quint64 AllocationCounter::currentThread()
+{
+    return t_allocations;
+}
+
+#ifdef POMODORO_COUNT_ALLOCATIONS
+// The array and sized forms fall through to these in the standard library
+void* operator new(std::size_t size)
+{
+    count();
+    const std::size_t bytes = size == 0 ? 1 : size;
+
+    // As the standard one does: let the new-handler free memory and retry,
+    // and throw only once there is none
+    for (;;) {
+        if (void *p = std::malloc(bytes)) {
+            return p;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return ::operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+#endif
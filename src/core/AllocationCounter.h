@@ -0,0 +1,25 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Counts heap allocations made through operator new, per thread.
+//
+// The global operator new is replaced when POMODORO_COUNT_ALLOCATIONS is
+// defined: CMake defines it for Debug builds, or for every build when the
+// option of the same name is on. While counting is disabled an allocation
+// costs one relaxed atomic load more than usual; without the define nothing
+// is replaced and isAvailable() is false.
+class AllocationCounter
+{
+public:
+    static bool isAvailable();
+
+    static void setEnabled(bool enabled);
+    [[nodiscard]] static bool isEnabled();
+
+    // Allocations on the calling thread while counting was enabled
+    [[nodiscard]] static quint64 currentThread();
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,143 @@
+#include "AnalyticsCube.h"
+#include "SessionHistory.h"
+#include <QDataStream>
+#include <algorithm>
+
+void AnalyticsCube::clear()
+{
+    m_total.clear();
+    m_byTag.clear();
+}
+
+int AnalyticsCube::offset(int hour, int weekday, TimerState type)
+{
+    return (static_cast<int>(type) * WEEKDAYS + (weekday - 1)) * HOURS + hour;
+}
+
+void AnalyticsCube::add(const SessionRecord &record)
+{
+    if (static_cast<int>(record.type) >= TYPES) return;
+
+    const QDateTime start = QDateTime::fromSecsSinceEpoch(record.startTime);
+    const int at = offset(start.time().hour(), start.date().dayOfWeek(), record.type);
+
+    if (m_total.isEmpty()) {
+        m_total.resize(SLAB_SIZE);
+    }
+    QVector<Cell> &tagSlab = m_byTag[record.tagId];
+    if (tagSlab.isEmpty()) {
+        tagSlab.resize(SLAB_SIZE);
+    }
+
+    for (Cell *cell : {&m_total[at], &tagSlab[at]}) {
+        cell->seconds += record.duration;
+        cell->sessions++;
+    }
+}
+
+void AnalyticsCube::merge(const AnalyticsCube &other)
+{
+    combine(other, 1);
+}
+
+void AnalyticsCube::subtract(const AnalyticsCube &other)
+{
+    combine(other, -1);
+}
+
+void AnalyticsCube::combine(const AnalyticsCube &other, int sign)
+{
+    const auto addSlab = [sign](QVector<Cell> &into, const QVector<Cell> &from) {
+        if (from.isEmpty()) return;
+        if (into.isEmpty() && sign > 0) {
+            into = from;
+            return;
+        }
+        into.resize(SLAB_SIZE);
+        for (int i = 0; i < SLAB_SIZE; ++i) {
+            into[i].seconds += sign * from.at(i).seconds;
+            into[i].sessions += static_cast<quint32>(sign) * from.at(i).sessions;
+        }
+    };
+
+    addSlab(m_total, other.m_total);
+    for (auto it = other.m_byTag.cbegin(); it != other.m_byTag.cend(); ++it) {
+        addSlab(m_byTag[it.key()], it.value());
+    }
+}
+
+void AnalyticsCube::write(QDataStream &stream) const
+{
+    // The all-tags slab is the sum of the others and is rebuilt on read
+    stream << static_cast<quint32>(m_byTag.size());
+    for (auto it = m_byTag.cbegin(); it != m_byTag.cend(); ++it) {
+        const QVector<Cell> &cells = it.value();
+        const auto used = std::count_if(cells.cbegin(), cells.cend(), [](const Cell &cell) { return cell.sessions > 0; });
+        stream << it.key() << static_cast<quint16>(used);
+        for (int i = 0; i < cells.size(); ++i) {
+            if (cells.at(i).sessions == 0) continue;
+            stream << static_cast<quint16>(i) << cells.at(i).seconds << cells.at(i).sessions;
+        }
+    }
+}
+
+bool AnalyticsCube::read(QDataStream &stream, const std::function<quint16(quint16)> &mapTag)
+{
+    quint32 slabCount = 0;
+    stream >> slabCount;
+    for (quint32 i = 0; i < slabCount && stream.status() == QDataStream::Ok; ++i) {
+        quint16 tag = 0;
+        quint16 used = 0;
+        stream >> tag >> used;
+
+        QVector<Cell> &tagSlab = m_byTag[mapTag(tag)];
+        if (tagSlab.isEmpty()) {
+            tagSlab.resize(SLAB_SIZE);
+        }
+        if (m_total.isEmpty()) {
+            m_total.resize(SLAB_SIZE);
+        }
+        for (quint16 j = 0; j < used && stream.status() == QDataStream::Ok; ++j) {
+            quint16 at = 0;
+            Cell cell;
+            stream >> at >> cell.seconds >> cell.sessions;
+            if (at >= SLAB_SIZE) {
+                stream.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+            for (Cell *into : {&m_total[at], &tagSlab[at]}) {
+                into->seconds += cell.seconds;
+                into->sessions += cell.sessions;
+            }
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+const QVector<AnalyticsCube::Cell>* AnalyticsCube::slab(int tag) const
+{
+    if (tag == ALL_TAGS) {
+        return m_total.isEmpty() ? nullptr : &m_total;
+    }
+    const auto found = m_byTag.constFind(static_cast<quint16>(tag));
+    return found == m_byTag.cend() ? nullptr : &found.value();
+}
+
+AnalyticsCube::Cell AnalyticsCube::cell(int hour, int weekday, TimerState type, int tag) const
+{
+    const QVector<Cell> *cells = slab(tag);
+    if (!cells || hour < 0 || hour >= HOURS || weekday < 1 || weekday > WEEKDAYS) {
+        return {};
+    }
+    return cells->at(offset(hour, weekday, type));
+}
+
+QVector<AnalyticsCube::Cell> AnalyticsCube::heatmap(TimerState type, int tag) const
+{
+    const QVector<Cell> *cells = slab(tag);
+    if (!cells) {
+        return QVector<Cell>(HOURS * WEEKDAYS);
+    }
+    // The type's cells are contiguous: weekday rows of HOURS each
+    return cells->mid(offset(0, 1, type), HOURS * WEEKDAYS);
+}
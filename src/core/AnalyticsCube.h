@@ -0,0 +1,61 @@
+#ifndef ANALYTICSCUBE_H
+#define ANALYTICSCUBE_H
+
+#include <QHash>
+#include <QVector>
+#include <functional>
+#include "TimerState.h"
+
+class QDataStream;
+struct SessionRecord;
+
+// Session time and counts keyed by (hour of day, weekday, session type, tag).
+//
+// A session is attributed to the local hour and weekday it started in. Every
+// add() touches two cells: the tag's own and the all-tags total, so a heatmap
+// for one tag or for everything is read straight out of a 24x7 slab no matter
+// how long the history is. Sessions already folded into daily or monthly
+// rollups by the compactor have no time of day left and are not counted.
+class AnalyticsCube
+{
+public:
+    struct Cell {
+        qint64 seconds = 0;
+        quint32 sessions = 0;
+    };
+
+    static constexpr int HOURS = 24;
+    static constexpr int WEEKDAYS = 7;
+    static constexpr int TYPES = 3;         // TimerState values
+    static constexpr int SLAB_SIZE = HOURS * WEEKDAYS * TYPES;
+    static constexpr int ALL_TAGS = -1;
+
+    void clear();
+    void add(const SessionRecord &record);
+    // Adds every cell of other, e.g. a cube built for a batch on another thread
+    void merge(const AnalyticsCube &other);
+    // Takes back cells added by an earlier merge() of other
+    void subtract(const AnalyticsCube &other);
+
+    // Non-empty cells of every tag, e.g. for the HistoryArchive index
+    void write(QDataStream &stream) const;
+    // Adds the cells written by write(); mapTag translates the stored tag IDs
+    bool read(QDataStream &stream, const std::function<quint16(quint16)> &mapTag);
+
+    // weekday is Qt's 1 (Monday) .. 7 (Sunday); tag is a tag ID or ALL_TAGS
+    [[nodiscard]] Cell cell(int hour, int weekday, TimerState type, int tag = ALL_TAGS) const;
+    // HOURS * WEEKDAYS cells, row-major by weekday (Monday first)
+    [[nodiscard]] QVector<Cell> heatmap(TimerState type, int tag = ALL_TAGS) const;
+
+    [[nodiscard]] bool isEmpty() const { return m_total.isEmpty(); }
+
+private:
+    static int offset(int hour, int weekday, TimerState type);
+    void combine(const AnalyticsCube &other, int sign);
+    [[nodiscard]] const QVector<Cell>* slab(int tag) const;
+
+    QVector<Cell> m_total;                  // all tags, SLAB_SIZE cells once anything was added
+    QHash<quint16, QVector<Cell>> m_byTag;  // tag 0 (untagged) included
+};
+
+#endif // ANALYTICSCUBE_H
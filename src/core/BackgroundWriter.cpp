@@ -0,0 +1,57 @@
+#include "BackgroundWriter.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+BackgroundWriter& BackgroundWriter::instance()
+{
+    static BackgroundWriter writer;
+    return writer;
+}
+
+BackgroundWriter::~BackgroundWriter()
+{
+    if (!m_thread) return;
+
+    // quit() would drop jobs still queued behind it
+    flush();
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void BackgroundWriter::post(std::function<void()> job)
+{
+    {
+        QMutexLocker locker(&m_startMutex);
+        if (!m_thread) {
+            m_thread = std::make_unique<QThread>();
+            m_thread->setObjectName(QStringLiteral("BackgroundWriter"));
+            m_context = new QObject();
+            m_context->moveToThread(m_thread.get());
+            QObject::connect(m_thread.get(), &QThread::finished, m_context, &QObject::deleteLater);
+            m_thread->start(QThread::LowPriority);
+        }
+    }
+    QMetaObject::invokeMethod(m_context, std::move(job), Qt::QueuedConnection);
+}
+
+void BackgroundWriter::replace(const QString& path, const QByteArray& data)
+{
+    post([path, data]() {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+            qWarning() << "BackgroundWriter: cannot write" << path << file.errorString();
+        }
+    });
+}
+
+void BackgroundWriter::flush()
+{
+    {
+        QMutexLocker locker(&m_startMutex);
+        if (!m_thread) return;
+    }
+    // A job that flushes would wait for itself
+    if (QThread::currentThread() == m_thread.get()) return;
+    QMetaObject::invokeMethod(m_context, []() {}, Qt::BlockingQueuedConnection);
+}
@@ -0,0 +1,45 @@
+#ifndef BACKGROUNDWRITER_H
+#define BACKGROUNDWRITER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <functional>
+#include <memory>
+
+// Runs the small file writes of the timer path (history appends, tags,
+// metrics, the forecast and the checkpoint) on one low-priority thread, so
+// finishing or resetting a session never waits for the disk.
+//
+// Jobs run one at a time in the order they were posted. Callers snapshot
+// whatever a job writes before posting it; the job must not touch state the
+// GUI thread keeps changing.
+class BackgroundWriter
+{
+public:
+    static BackgroundWriter& instance();
+
+    // Thread-safe; starts the writer thread on first use
+    void post(std::function<void()> job);
+    // Replaces path with data through QSaveFile, after every job posted before
+    void replace(const QString& path, const QByteArray& data);
+    // Blocks until every job posted so far has run; for shutdown and tests
+    void flush();
+
+private:
+    BackgroundWriter() = default;
+    ~BackgroundWriter();
+
+    // Disable copy/move
+    BackgroundWriter(const BackgroundWriter&) = delete;
+    BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+    BackgroundWriter(BackgroundWriter&&) = delete;
+    BackgroundWriter& operator=(BackgroundWriter&&) = delete;
+
+    std::unique_ptr<QThread> m_thread;
+    QObject *m_context = nullptr;           // lives on m_thread; runs the queued jobs
+    QMutex m_startMutex;
+};
+
+#endif // BACKGROUNDWRITER_H
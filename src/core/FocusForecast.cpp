@@ -0,0 +1,148 @@
+#include "FocusForecast.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <cmath>
+
+namespace {
+    void writeOutlook(QDataStream& stream, const FocusForecast::Outlook& outlook)
+    {
+        stream << (outlook.end.isValid() ? outlook.end.toJulianDay() : qint64(0))
+               << outlook.restMinutes << outlook.variance;
+    }
+
+    void readOutlook(QDataStream& stream, FocusForecast::Outlook& outlook)
+    {
+        qint64 end = 0;
+        stream >> end >> outlook.restMinutes >> outlook.variance;
+        outlook.end = end > 0 ? QDate::fromJulianDay(end) : QDate();
+    }
+}
+
+void FocusForecast::addDay(qint64 julianDay, double workMinutes)
+{
+    if (m_daysFitted > 0 && julianDay <= m_lastDay) return;
+
+    const int at = static_cast<int>(julianDay % SEASON);
+    if (m_daysFitted == 0) {
+        m_level = workMinutes;
+        m_trend = 0;
+        m_season.fill(0);
+        m_squaredError = 0;
+    } else {
+        const double error = workMinutes - (m_level + DAMPING * m_trend + m_season[at]);
+        m_squaredError = m_daysFitted == 1
+            ? error * error
+            : (1 - ERROR_WEIGHT) * m_squaredError + ERROR_WEIGHT * error * error;
+
+        const double previousLevel = m_level;
+        const double season = m_season[at];
+        m_level = ALPHA * (workMinutes - season) + (1 - ALPHA) * (m_level + DAMPING * m_trend);
+        m_trend = BETA * (m_level - previousLevel) + (1 - BETA) * DAMPING * m_trend;
+        m_season[at] = GAMMA * (workMinutes - m_level) + (1 - GAMMA) * season;
+    }
+    m_lastDay = julianDay;
+    ++m_daysFitted;
+}
+
+double FocusForecast::predict(qint64 julianDay) const
+{
+    if (m_daysFitted == 0) return 0;
+
+    const qint64 horizon = qMax<qint64>(1, julianDay - m_lastDay);
+    const double trendWeight = DAMPING * (1 - std::pow(DAMPING, static_cast<double>(horizon))) / (1 - DAMPING);
+    return qMax(0.0, m_level + trendWeight * m_trend + m_season[julianDay % SEASON]);
+}
+
+void FocusForecast::updateOutlook(const QDate& today)
+{
+    m_asOf = today;
+    m_todayMinutes = predict(today.toJulianDay());
+    m_week = outlookUntil(today.addDays(7 - today.dayOfWeek()));
+    m_month = outlookUntil(QDate(today.year(), today.month(), today.daysInMonth()));
+}
+
+FocusForecast::Outlook FocusForecast::outlookUntil(const QDate& end) const
+{
+    Outlook outlook;
+    outlook.end = end;
+    const qint64 today = m_asOf.toJulianDay();
+    for (qint64 day = today + 1; day <= end.toJulianDay(); ++day) {
+        outlook.restMinutes += predict(day);
+    }
+
+    // One-step errors treated as independent across the remaining days
+    const double dayVariance = qMax(m_squaredError, MIN_STDDEV_MINUTES * MIN_STDDEV_MINUTES);
+    outlook.variance = dayVariance * static_cast<double>(end.toJulianDay() - today + 1);
+    return outlook;
+}
+
+FocusForecast::Estimate FocusForecast::estimate(const Outlook& outlook, double soFarMinutes,
+                                                double todayMinutes, double goalMinutes) const
+{
+    Estimate estimate;
+    estimate.expectedMinutes = soFarMinutes + qMax(0.0, m_todayMinutes - todayMinutes) + outlook.restMinutes;
+
+    if (goalMinutes <= 0 || soFarMinutes >= goalMinutes) {
+        estimate.goalProbability = 1;
+    } else {
+        const double stdDev = std::sqrt(outlook.variance);
+        estimate.goalProbability = 0.5 * std::erfc((goalMinutes - estimate.expectedMinutes) / (stdDev * std::sqrt(2.0)));
+    }
+    return estimate;
+}
+
+bool FocusForecast::save(const QString& path) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << MAGIC << VERSION << m_level << m_trend;
+    for (double season : m_season) {
+        stream << season;
+    }
+    stream << m_squaredError << m_lastDay << m_daysFitted
+           << (m_asOf.isValid() ? m_asOf.toJulianDay() : qint64(0)) << m_todayMinutes;
+    writeOutlook(stream, m_week);
+    writeOutlook(stream, m_month);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "FocusForecast: cannot write" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool FocusForecast::load(const QString& path, FocusForecast& forecast)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 asOf = 0;
+    FocusForecast loaded;
+    stream >> magic >> version >> loaded.m_level >> loaded.m_trend;
+    for (double& season : loaded.m_season) {
+        stream >> season;
+    }
+    stream >> loaded.m_squaredError >> loaded.m_lastDay >> loaded.m_daysFitted >> asOf >> loaded.m_todayMinutes;
+    readOutlook(stream, loaded.m_week);
+    readOutlook(stream, loaded.m_month);
+
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION) {
+        qWarning() << "FocusForecast: ignoring unreadable" << path;
+        return false;
+    }
+
+    loaded.m_asOf = asOf > 0 ? QDate::fromJulianDay(asOf) : QDate();
+    forecast = loaded;
+    return true;
+}
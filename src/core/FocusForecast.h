@@ -0,0 +1,80 @@
+#ifndef FOCUSFORECAST_H
+#define FOCUSFORECAST_H
+
+#include <QDate>
+#include <QString>
+#include <array>
+
+// Expected focus time for the rest of this week and month, from an additive
+// Holt-Winters model (level, trend and a weekday season) over daily work
+// minutes.
+//
+// The model only ever sees complete days, one at a time through addDay(), so
+// catching up after a day ends is O(days missed) and never a refit of the
+// whole history. Its state and the outlook derived from it are a few hundred
+// bytes kept next to the history; ForecastFitter advances them off the GUI
+// thread and readers only add today's actuals.
+class FocusForecast
+{
+public:
+    // What is still expected after today, from the model as of asOf
+    struct Outlook {
+        QDate end;                          // last day of the period
+        double restMinutes = 0;             // days after today up to end
+        double variance = 0;                // of today's remainder plus the rest
+    };
+
+    struct Estimate {
+        double expectedMinutes = 0;
+        double goalProbability = 0;         // 0..1
+    };
+
+    // Feeds the total of the next complete day; days must arrive in order and
+    // gaps are fed as zero by the caller
+    void addDay(qint64 julianDay, double workMinutes);
+    // Recomputes the week and month outlooks for today; today follows the last fed day
+    void updateOutlook(const QDate& today);
+
+    [[nodiscard]] bool isValid() const { return m_daysFitted > 0 && m_asOf.isValid(); }
+    [[nodiscard]] qint64 lastDay() const { return m_lastDay; }
+    [[nodiscard]] const QDate& asOf() const { return m_asOf; }
+    [[nodiscard]] double predict(qint64 julianDay) const;
+    [[nodiscard]] const Outlook& week() const { return m_week; }
+    [[nodiscard]] const Outlook& month() const { return m_month; }
+
+    // Period total given what was done so far; todayMinutes is part of soFarMinutes
+    [[nodiscard]] Estimate estimate(const Outlook& outlook, double soFarMinutes,
+                                    double todayMinutes, double goalMinutes) const;
+
+    bool save(const QString& path) const;
+    static bool load(const QString& path, FocusForecast& forecast);
+
+    // Smoothing weights for level, trend and season
+    static constexpr double ALPHA = 0.3;
+    static constexpr double BETA = 0.05;
+    static constexpr double GAMMA = 0.2;
+    static constexpr double DAMPING = 0.9;             // trend fades over longer horizons
+    static constexpr double ERROR_WEIGHT = 0.1;        // for the running squared error
+    static constexpr double MIN_STDDEV_MINUTES = 5.0;
+    static constexpr int SEASON = 7;
+    static constexpr int FIT_HISTORY_DAYS = 365;       // how far back a fresh model starts
+    static constexpr quint32 MAGIC = 0x50464F43;       // "COFP"
+    static constexpr quint16 VERSION = 1;
+
+private:
+    [[nodiscard]] Outlook outlookUntil(const QDate& end) const;
+
+    double m_level = 0;
+    double m_trend = 0;
+    std::array<double, SEASON> m_season{};             // indexed by Julian day % SEASON
+    double m_squaredError = 0;
+    qint64 m_lastDay = 0;                               // Julian day; 0 before the first
+    quint32 m_daysFitted = 0;
+
+    QDate m_asOf;
+    double m_todayMinutes = 0;
+    Outlook m_week;
+    Outlook m_month;
+};
+
+#endif // FOCUSFORECAST_H
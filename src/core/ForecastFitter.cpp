@@ -0,0 +1,21 @@
+#include "ForecastFitter.h"
+
+ForecastFitter::ForecastFitter(const FocusForecast &forecast, const QDate &firstDay, const QVector<double> &minutes,
+                               const QDate &today, QObject *parent)
+    : QObject(parent)
+    , m_forecast(forecast)
+    , m_firstDay(firstDay)
+    , m_minutes(minutes)
+    , m_today(today)
+{
+}
+
+void ForecastFitter::run()
+{
+    const qint64 first = m_firstDay.toJulianDay();
+    for (int i = 0; i < m_minutes.size(); ++i) {
+        m_forecast.addDay(first + i, m_minutes.at(i));
+    }
+    m_forecast.updateOutlook(m_today);
+    emit finished(m_forecast);
+}
@@ -0,0 +1,37 @@
+#ifndef FORECASTFITTER_H
+#define FORECASTFITTER_H
+
+#include <QDate>
+#include <QObject>
+#include <QVector>
+#include "FocusForecast.h"
+
+// Advances a FocusForecast by the days completed since it was last fitted.
+//
+// The daily totals are copied out of the rollups on the owning thread, so
+// run() touches nothing shared and can sit on a worker thread. A model with
+// no days yet starts from the first of the copied days.
+class ForecastFitter : public QObject
+{
+    Q_OBJECT
+
+public:
+    // minutes[i] is the work total of firstDay + i; every day up to yesterday
+    ForecastFitter(const FocusForecast &forecast, const QDate &firstDay, const QVector<double> &minutes,
+                   const QDate &today, QObject *parent = nullptr);
+    ~ForecastFitter() override = default;
+
+public slots:
+    void run();
+
+signals:
+    void finished(const FocusForecast &forecast);
+
+private:
+    FocusForecast m_forecast;
+    QDate m_firstDay;
+    QVector<double> m_minutes;
+    QDate m_today;
+};
+
+#endif // FORECASTFITTER_H
@@ -0,0 +1,625 @@
+#include "HistoryArchive.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+#include <limits>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#endif
+
+namespace {
+    constexpr int COMPRESSION_LEVEL = 9;
+    constexpr int TYPE_BITS = 2;
+    constexpr quint8 TYPE_MASK = (1 << TYPE_BITS) - 1;
+
+    void putVarint(QByteArray &out, quint64 value)
+    {
+        while (value >= 0x80) {
+            out.append(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    bool getVarint(const char *&p, const char *end, quint64 &value)
+    {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            const auto byte = static_cast<quint8>(*p++);
+            value |= static_cast<quint64>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    quint64 zigzag(qint64 value)
+    {
+        return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+    }
+
+    qint64 unzigzag(quint64 value)
+    {
+        return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+    }
+
+    // QFile::flush() only hands the data to the OS; this waits for the disk
+    bool syncToDisk(QFile &file)
+    {
+        if (!file.flush()) return false;
+#if defined(Q_OS_UNIX)
+        return ::fsync(file.handle()) == 0;
+#elif defined(Q_OS_WIN)
+        return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))) != 0;
+#else
+        return true;
+#endif
+    }
+
+    void sortByStart(QVector<SessionRecord> &records)
+    {
+        std::sort(records.begin(), records.end(), [](const SessionRecord &a, const SessionRecord &b) {
+            return a.startTime != b.startTime ? a.startTime < b.startTime : a.id < b.id;
+        });
+    }
+}
+
+void HistoryArchive::Summary::add(const SessionRecord &record, quint16 tag)
+{
+    const qint64 day = QDateTime::fromSecsSinceEpoch(record.startTime).date().toJulianDay();
+    Rollup &rollup = days[qMakePair(day, tag)];
+    rollup.julianDay = day;
+    rollup.tagId = tag;
+    if (record.type == TimerState::Work) {
+        rollup.workSeconds += record.duration;
+        rollup.sessions++;
+        if (record.flags & SessionSkipped) {
+            rollup.skippedSessions++;
+        }
+    } else {
+        rollup.breakSeconds += record.duration;
+    }
+
+    SessionRecord tagged = record;
+    tagged.tagId = tag;
+    analytics.add(tagged);
+}
+
+quint32 HistoryArchive::Dictionary::tag(const QString &name)
+{
+    const auto it = index.constFind(name);
+    if (it != index.constEnd()) return it.value();
+    names.append(name);
+    const auto tag = static_cast<quint32>(names.size());
+    index.insert(name, tag);
+    return tag;
+}
+
+void HistoryArchive::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_cutoff = 0;
+    m_tagNames.clear();
+    m_tagMap.clear();
+    m_blocks.clear();
+    m_blockReach.clear();
+    m_rollups.clear();
+    m_blockDays.clear();
+    m_analytics.clear();
+    m_recordCount = 0;
+    m_maxId = 0;
+    m_nextId = 1;
+    m_cachedBlock = -1;
+    m_cachedRecords.clear();
+}
+
+bool HistoryArchive::load(const QString &path, const TagResolver &resolveTag)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.exists()) return true;
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "HistoryArchive: cannot read" << path;
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_size >= HEADER_SIZE ? m_file.map(0, m_size) : nullptr;
+    if (!m_data) {
+        qWarning() << "HistoryArchive: cannot map" << path;
+        close();
+        return false;
+    }
+
+    const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(m_data), m_size);
+    QDataStream stream(bytes);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 reserved = 0;
+    quint64 indexOffset = 0;
+    stream >> magic >> version >> reserved >> m_cutoff >> indexOffset;
+    if (magic != FILE_MAGIC || version < 1 || version > FILE_VERSION || indexOffset < HEADER_SIZE
+        || indexOffset > static_cast<quint64>(m_size)) {
+        qWarning() << "HistoryArchive: unsupported archive" << path;
+        close();
+        return false;
+    }
+    stream.device()->seek(static_cast<qint64>(indexOffset));
+
+    quint32 tagCount = 0;
+    stream >> tagCount;
+    m_tagMap.reserve(static_cast<int>(tagCount) + 1);
+    m_tagMap.append(0);
+    for (quint32 i = 0; i < tagCount && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray name;
+        stream >> name;
+        m_tagNames.append(QString::fromUtf8(name));
+        m_tagMap.append(resolveTag ? resolveTag(m_tagNames.constLast()) : static_cast<quint16>(i + 1));
+    }
+
+    quint32 blockCount = 0;
+    stream >> blockCount;
+    m_blocks.reserve(static_cast<int>(qMin<quint32>(blockCount, m_size / HEADER_SIZE)));
+    for (quint32 i = 0; i < blockCount && stream.status() == QDataStream::Ok; ++i) {
+        BlockInfo info;
+        stream >> info.firstStart >> info.lastStart >> info.offset >> info.size >> info.count
+               >> info.minId >> info.maxId >> info.workSeconds >> info.breakSeconds >> info.sessions;
+        if (version >= 4) {
+            stream >> info.skipped;
+        }
+        stream >> info.checksum;
+        if (info.offset < HEADER_SIZE || info.offset + info.size > indexOffset) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        m_blocks.append(info);
+        m_recordCount += static_cast<int>(info.count);
+        m_maxId = qMax(m_maxId, info.maxId);
+    }
+
+    quint32 rollupCount = 0;
+    if (version >= 2) {
+        stream >> rollupCount;
+    }
+    m_rollups.reserve(static_cast<int>(qMin<quint32>(rollupCount, m_size / HEADER_SIZE)));
+    for (quint32 i = 0; i < rollupCount && stream.status() == QDataStream::Ok; ++i) {
+        Rollup rollup;
+        quint8 period = 0;
+        quint16 tag = 0;
+        stream >> rollup.julianDay >> period >> tag >> rollup.workSeconds >> rollup.breakSeconds >> rollup.sessions;
+        if (version >= 3) {
+            stream >> rollup.skippedSessions;
+        }
+        rollup.period = static_cast<RollupPeriod>(period);
+        rollup.tagId = tag < m_tagMap.size() ? m_tagMap.at(tag) : 0;
+        m_rollups.append(rollup);
+    }
+
+    quint32 nextId = 0;
+    if (version >= 3) {
+        stream >> nextId;
+    }
+    m_nextId = qMax(nextId, m_maxId + 1);
+
+    const auto mapTag = [this](quint16 tag) -> quint16 { return tag < m_tagMap.size() ? m_tagMap.at(tag) : 0; };
+    if (version >= 4) {
+        quint32 dayCount = 0;
+        stream >> dayCount;
+        m_blockDays.reserve(static_cast<int>(qMin<quint32>(dayCount, m_size / HEADER_SIZE)));
+        for (quint32 i = 0; i < dayCount && stream.status() == QDataStream::Ok; ++i) {
+            Rollup day;
+            quint16 tag = 0;
+            stream >> day.julianDay >> tag >> day.workSeconds >> day.breakSeconds >> day.sessions
+                   >> day.skippedSessions;
+            day.tagId = mapTag(tag);
+            m_blockDays.append(day);
+        }
+        m_analytics.read(stream, mapTag);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "HistoryArchive: corrupt block index in" << path;
+        close();
+        return false;
+    }
+
+    // Appended blocks come last in the index whatever their time range
+    std::stable_sort(m_blocks.begin(), m_blocks.end(), [](const BlockInfo &a, const BlockInfo &b) {
+        return a.firstStart < b.firstStart;
+    });
+    m_blockReach.reserve(m_blocks.size());
+    qint64 reach = std::numeric_limits<qint64>::min();
+    for (const BlockInfo &info : std::as_const(m_blocks)) {
+        reach = qMax(reach, info.lastStart);
+        m_blockReach.append(reach);
+    }
+
+    if (version < 4) {
+        summarizeBlocks();
+    }
+    return true;
+}
+
+void HistoryArchive::summarizeBlocks()
+{
+    // One full decode, until the compactor or the next append writes a version 4 index
+    Summary summary;
+    forEach([&summary](const SessionRecord &record) { summary.add(record, record.tagId); });
+    m_blockDays = summary.days.values();
+    m_analytics = std::move(summary.analytics);
+}
+
+QByteArray HistoryArchive::encode(QVector<SessionRecord> records, const QVector<Rollup> &rollups,
+                                  const QStringList &tagNames, qint64 cutoff, quint32 nextId)
+{
+    sortByStart(records);
+    for (const SessionRecord &record : std::as_const(records)) {
+        nextId = qMax(nextId, record.id + 1);
+    }
+
+    // Archive-local dictionary of the tags actually referenced
+    Dictionary dictionary;
+    QByteArray body;
+    QVector<BlockInfo> blocks;
+    Summary summary;
+    encodeBlocks(records, tagNames, dictionary, HEADER_SIZE, body, blocks, summary);
+
+    QVector<quint16> rollupTags;
+    rollupTags.reserve(rollups.size());
+    for (const Rollup &rollup : rollups) {
+        const bool known = rollup.tagId != 0 && rollup.tagId <= tagNames.size();
+        rollupTags.append(known ? static_cast<quint16>(dictionary.tag(tagNames.at(rollup.tagId - 1))) : 0);
+    }
+
+    QByteArray file;
+    file.reserve(HEADER_SIZE + body.size() + blocks.size() * 64 + (rollups.size() + summary.days.size()) * 32);
+    QDataStream stream(&file, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << FILE_MAGIC << FILE_VERSION << quint16(0) << cutoff << static_cast<quint64>(HEADER_SIZE + body.size());
+    stream.writeRawData(body.constData(), static_cast<int>(body.size()));
+    writeIndex(stream, dictionary, blocks, rollups, rollupTags, nextId, summary);
+    return file;
+}
+
+void HistoryArchive::encodeBlocks(const QVector<SessionRecord> &records, const QStringList &tagNames,
+                                  Dictionary &dictionary, qint64 bodyOffset,
+                                  QByteArray &body, QVector<BlockInfo> &blocks, Summary &summary)
+{
+    QHash<quint16, quint32> dictionaryIndex;
+    const auto dictionaryTag = [&](quint16 tagId) -> quint32 {
+        if (tagId == 0 || tagId > tagNames.size()) return 0;
+        const auto it = dictionaryIndex.constFind(tagId);
+        if (it != dictionaryIndex.constEnd()) return it.value();
+        const quint32 tag = dictionary.tag(tagNames.at(tagId - 1));
+        dictionaryIndex.insert(tagId, tag);
+        return tag;
+    };
+
+    blocks.reserve(blocks.size() + (records.size() + BLOCK_RECORDS - 1) / BLOCK_RECORDS);
+    QByteArray payload;
+
+    for (int first = 0; first < records.size(); first += BLOCK_RECORDS) {
+        const int last = qMin<int>(first + BLOCK_RECORDS, records.size());
+
+        BlockInfo info;
+        info.firstStart = records.at(first).startTime;
+        info.lastStart = records.at(last - 1).startTime;
+        info.count = static_cast<quint32>(last - first);
+        info.minId = std::numeric_limits<quint32>::max();
+
+        for (int i = first; i < last; ++i) {
+            info.minId = qMin(info.minId, records.at(i).id);
+            info.maxId = qMax(info.maxId, records.at(i).id);
+        }
+
+        payload.resize(0);
+        qint64 previousStart = info.firstStart;
+        qint64 previousId = info.minId;
+        qint64 previousDuration[TYPE_MASK + 1] = {};
+
+        for (int i = first; i < last; ++i) {
+            const SessionRecord &record = records.at(i);
+            const quint8 type = static_cast<quint8>(record.type) & TYPE_MASK;
+            const quint32 tag = dictionaryTag(record.tagId);
+
+            putVarint(payload, static_cast<quint64>(record.startTime - previousStart));
+            putVarint(payload, zigzag(static_cast<qint64>(record.id) - previousId));
+            putVarint(payload, zigzag(static_cast<qint64>(record.duration) - previousDuration[type]));
+            payload.append(static_cast<char>(type | (record.flags << TYPE_BITS)));
+            putVarint(payload, tag);
+
+            previousStart = record.startTime;
+            previousId = record.id;
+            previousDuration[type] = record.duration;
+            summary.add(record, static_cast<quint16>(tag));
+
+            if (record.type == TimerState::Work) {
+                info.workSeconds += record.duration;
+                info.sessions++;
+                if (record.flags & SessionSkipped) {
+                    info.skipped++;
+                }
+            } else {
+                info.breakSeconds += record.duration;
+            }
+        }
+
+        const QByteArray stored = qCompress(payload, COMPRESSION_LEVEL);
+        info.offset = static_cast<quint64>(bodyOffset + body.size());
+        info.size = static_cast<quint32>(stored.size());
+        info.checksum = qChecksum(stored);
+        body.append(stored);
+        blocks.append(info);
+    }
+}
+
+void HistoryArchive::writeIndex(QDataStream &stream, const Dictionary &dictionary, const QVector<BlockInfo> &blocks,
+                                const QVector<Rollup> &rollups, const QVector<quint16> &rollupTags, quint32 nextId,
+                                const Summary &summary)
+{
+    stream << static_cast<quint32>(dictionary.names.size());
+    for (const QString &name : dictionary.names) {
+        stream << name.toUtf8();
+    }
+    stream << static_cast<quint32>(blocks.size());
+    for (const BlockInfo &info : blocks) {
+        stream << info.firstStart << info.lastStart << info.offset << info.size << info.count
+               << info.minId << info.maxId << info.workSeconds << info.breakSeconds << info.sessions
+               << info.skipped << info.checksum;
+    }
+    stream << static_cast<quint32>(rollups.size());
+    for (int i = 0; i < rollups.size(); ++i) {
+        const Rollup &rollup = rollups.at(i);
+        stream << rollup.julianDay << static_cast<quint8>(rollup.period) << rollupTags.at(i)
+               << rollup.workSeconds << rollup.breakSeconds << rollup.sessions << rollup.skippedSessions;
+    }
+    stream << nextId;
+
+    stream << static_cast<quint32>(summary.days.size());
+    for (const Rollup &day : summary.days) {
+        stream << day.julianDay << day.tagId << day.workSeconds << day.breakSeconds << day.sessions
+               << day.skippedSessions;
+    }
+    summary.analytics.write(stream);
+}
+
+bool HistoryArchive::write(const QString &path, const QVector<SessionRecord> &records,
+                           const QVector<Rollup> &rollups, const QStringList &tagNames, qint64 cutoff,
+                           quint32 nextId)
+{
+    const QByteArray data = encode(records, rollups, tagNames, cutoff, nextId);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "HistoryArchive: cannot write" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool HistoryArchive::append(const QString &path, QVector<SessionRecord> records,
+                            const QStringList &tagNames, qint64 cutoff)
+{
+    if (!QFile::exists(path)) {
+        return write(path, records, {}, tagNames, cutoff);
+    }
+
+    // The current index, with tags left as indexes into the file's own dictionary
+    HistoryArchive current;
+    if (!current.load(path)) return false;
+
+    Dictionary dictionary;
+    for (const QString &name : std::as_const(current.m_tagNames)) {
+        dictionary.tag(name);
+    }
+    QVector<BlockInfo> blocks = current.m_blocks;
+    const QVector<Rollup> rollups = current.m_rollups;
+    QVector<quint16> rollupTags;
+    rollupTags.reserve(rollups.size());
+    for (const Rollup &rollup : rollups) {
+        rollupTags.append(rollup.tagId);
+    }
+    // The summary is extended, not recomputed: the old blocks stay encoded
+    Summary summary;
+    for (const Rollup &day : std::as_const(current.m_blockDays)) {
+        summary.days.insert(qMakePair(day.julianDay, day.tagId), day);
+    }
+    summary.analytics = current.m_analytics;
+    const qint64 end = current.m_size;
+    cutoff = qMax(cutoff, current.m_cutoff);
+    quint32 nextId = current.m_nextId;
+    current.close();
+
+    for (const SessionRecord &record : std::as_const(records)) {
+        nextId = qMax(nextId, record.id + 1);
+    }
+
+    sortByStart(records);
+    QByteArray tail;
+    encodeBlocks(records, tagNames, dictionary, end, tail, blocks, summary);
+    const auto indexOffset = static_cast<quint64>(end + tail.size());
+
+    QByteArray index;
+    QDataStream indexStream(&index, QIODevice::WriteOnly);
+    indexStream.setByteOrder(QDataStream::LittleEndian);
+    writeIndex(indexStream, dictionary, blocks, rollups, rollupTags, nextId, summary);
+    tail.append(index);
+
+    QByteArray header;
+    QDataStream headerStream(&header, QIODevice::WriteOnly);
+    headerStream.setByteOrder(QDataStream::LittleEndian);
+    headerStream << FILE_MAGIC << FILE_VERSION << quint16(0) << cutoff << indexOffset;
+
+    // Blocks and index land past the live index first; until the header is
+    // rewritten to point at them, readers and a crash both see the old archive.
+    // They must be on disk before the header is, or a crash could leave it
+    // pointing at an index that never got written
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "HistoryArchive: cannot write" << path << file.errorString();
+        return false;
+    }
+    if (!file.seek(end) || file.write(tail) != tail.size() || !syncToDisk(file)) {
+        qWarning() << "HistoryArchive: cannot append to" << path << file.errorString();
+        file.resize(end);
+        return false;
+    }
+    if (!file.seek(0) || file.write(header) != header.size() || !syncToDisk(file)) {
+        qWarning() << "HistoryArchive: cannot update header of" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+const QVector<SessionRecord>* HistoryArchive::block(int index) const
+{
+    if (index == m_cachedBlock) return &m_cachedRecords;
+
+    const BlockInfo &info = m_blocks.at(index);
+    const QByteArray stored = QByteArray::fromRawData(reinterpret_cast<const char*>(m_data) + info.offset,
+                                                      static_cast<qsizetype>(info.size));
+    if (qChecksum(stored) != info.checksum) {
+        qWarning() << "HistoryArchive: checksum mismatch in block" << index;
+        return nullptr;
+    }
+
+    const QByteArray payload = qUncompress(stored);
+    const char *p = payload.constData();
+    const char *end = p + payload.size();
+
+    m_cachedBlock = -1;
+    m_cachedRecords.resize(0);
+    m_cachedRecords.reserve(static_cast<int>(info.count));
+
+    qint64 previousStart = info.firstStart;
+    qint64 previousId = info.minId;
+    qint64 previousDuration[TYPE_MASK + 1] = {};
+
+    for (quint32 i = 0; i < info.count; ++i) {
+        quint64 startDelta, idDelta, durationDelta, tag;
+        if (!getVarint(p, end, startDelta) || !getVarint(p, end, idDelta)
+            || !getVarint(p, end, durationDelta) || p >= end) {
+            qWarning() << "HistoryArchive: truncated block" << index;
+            return nullptr;
+        }
+        const auto typeAndFlags = static_cast<quint8>(*p++);
+        if (!getVarint(p, end, tag)) {
+            qWarning() << "HistoryArchive: truncated block" << index;
+            return nullptr;
+        }
+
+        const quint8 type = typeAndFlags & TYPE_MASK;
+        SessionRecord record;
+        record.startTime = previousStart + static_cast<qint64>(startDelta);
+        record.id = static_cast<quint32>(previousId + unzigzag(idDelta));
+        record.duration = static_cast<quint32>(previousDuration[type] + unzigzag(durationDelta));
+        record.type = static_cast<TimerState>(type);
+        record.flags = typeAndFlags >> TYPE_BITS;
+        record.tagId = tag < static_cast<quint64>(m_tagMap.size()) ? m_tagMap.at(static_cast<int>(tag)) : 0;
+
+        previousStart = record.startTime;
+        previousId = record.id;
+        previousDuration[type] = record.duration;
+        m_cachedRecords.append(record);
+    }
+
+    m_cachedBlock = index;
+    return &m_cachedRecords;
+}
+
+QPair<int, int> HistoryArchive::blockRange(qint64 from, qint64 to) const
+{
+    // Blocks are in start order and their reach only grows, so both ends are
+    // binary searches even where appended blocks overlap older ones
+    const auto reach = std::lower_bound(m_blockReach.cbegin(), m_blockReach.cend(), from);
+    const int first = static_cast<int>(reach - m_blockReach.cbegin());
+    const auto last = std::lower_bound(m_blocks.cbegin() + first, m_blocks.cend(), to,
+                                       [](const BlockInfo &info, qint64 value) { return info.firstStart < value; });
+    return {first, static_cast<int>(last - m_blocks.cbegin())};
+}
+
+void HistoryArchive::forEach(qint64 from, qint64 to, const std::function<void(const SessionRecord&)> &visit) const
+{
+    const auto [first, last] = blockRange(from, to);
+    for (int i = first; i < last; ++i) {
+        const QVector<SessionRecord> *records = block(i);
+        if (!records) continue;
+        for (const SessionRecord &record : *records) {
+            if (record.startTime >= from && record.startTime < to) visit(record);
+        }
+    }
+}
+
+void HistoryArchive::forEach(const std::function<void(const SessionRecord&)> &visit) const
+{
+    forEach(std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max(), visit);
+}
+
+QVector<SessionRecord> HistoryArchive::records() const
+{
+    QVector<SessionRecord> result;
+    result.reserve(m_recordCount);
+    forEach([&result](const SessionRecord &record) { result.append(record); });
+    return result;
+}
+
+std::optional<SessionRecord> HistoryArchive::find(quint32 id) const
+{
+    for (int i = 0; i < m_blocks.size(); ++i) {
+        const BlockInfo &info = m_blocks.at(i);
+        if (id < info.minId || id > info.maxId) continue;
+
+        const QVector<SessionRecord> *records = block(i);
+        if (!records) continue;
+        for (const SessionRecord &record : *records) {
+            if (record.id == id) return record;
+        }
+    }
+    return std::nullopt;
+}
+
+DailyRollup HistoryArchive::totals(qint64 from, qint64 to) const
+{
+    DailyRollup result;
+    const auto [first, last] = blockRange(from, to);
+
+    for (int i = first; i < last; ++i) {
+        const BlockInfo &info = m_blocks.at(i);
+        if (info.firstStart >= from && info.lastStart < to) {
+            result.workSeconds += static_cast<int>(info.workSeconds);
+            result.breakSeconds += static_cast<int>(info.breakSeconds);
+            result.sessions += static_cast<int>(info.sessions);
+            result.skippedSessions += static_cast<int>(info.skipped);
+            continue;
+        }
+
+        const QVector<SessionRecord> *records = block(i);
+        if (!records) continue;
+        for (const SessionRecord &record : *records) {
+            if (record.startTime < from || record.startTime >= to) continue;
+            if (record.type == TimerState::Work) {
+                result.workSeconds += static_cast<int>(record.duration);
+                result.sessions++;
+                if (record.flags & SessionSkipped) {
+                    result.skippedSessions++;
+                }
+            } else {
+                result.breakSeconds += static_cast<int>(record.duration);
+            }
+        }
+    }
+    return result;
+}
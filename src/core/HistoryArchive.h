@@ -0,0 +1,182 @@
+#ifndef HISTORYARCHIVE_H
+#define HISTORYARCHIVE_H
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include <optional>
+#include "SessionHistory.h"
+
+// Compact read-only store for cold session history.
+//
+// Records are sorted by start time and cut into blocks of BLOCK_RECORDS. Inside
+// a block, start times and IDs are delta-encoded and durations are encoded as
+// the difference from the previous session of the same type, all as varints.
+// The type and flags share one byte and tags are indexes into the archive's own
+// dictionary. Each block is then deflated and protected by a checksum.
+//
+// A block index at the end of the file holds every block's time range, ID
+// range and totals. Range queries decode only the blocks they touch, and
+// blocks that lie entirely inside a range contribute their totals without
+// being decoded at all. The index also carries per-tag daily totals and the
+// time-of-day breakdown of all raw blocks, so the statistics indexes are
+// rebuilt from it without decoding a single block.
+//
+// The oldest history is kept only as per-tag daily or monthly rollups. They
+// live in the same file as the raw blocks, so folding sessions into rollups is
+// a single atomic file swap.
+//
+// Sessions turning cold are appended as new blocks followed by a new index,
+// and only then does the header start pointing at that index; the old index
+// is left behind as garbage until the compactor next rewrites the file.
+// Appended blocks may overlap older ones in time (after importing old
+// sessions), so readers must not assume records come in start order.
+//
+// An instance is not thread-safe, not even through its const readers, which
+// share a cache of the last decoded block. Other threads open an instance of
+// their own on the same file, as HistoryExporter and HistoryCompactor do.
+class HistoryArchive
+{
+public:
+    using TagResolver = std::function<quint16(const QString&)>;
+
+    enum class RollupPeriod : quint8 {
+        Day,
+        Month
+    };
+
+    struct Rollup {
+        qint64 julianDay = 0;               // the day, or the first day of the month
+        RollupPeriod period = RollupPeriod::Day;
+        quint16 tagId = 0;
+        quint32 workSeconds = 0;
+        quint32 breakSeconds = 0;
+        quint32 sessions = 0;
+        quint32 skippedSessions = 0;        // part of sessions
+    };
+
+    HistoryArchive() = default;
+    ~HistoryArchive() { close(); }
+
+    HistoryArchive(const HistoryArchive&) = delete;
+    HistoryArchive& operator=(const HistoryArchive&) = delete;
+
+    // Maps the file and reads the dictionary and block index; a missing file is an
+    // empty archive. Without a resolver, decoded tag IDs index tagNames() (1-based)
+    bool load(const QString& path, const TagResolver& resolveTag = TagResolver());
+    void close();
+
+    // Encodes records (any order), rollups and the tags they reference as a
+    // complete archive file. Everything that started before cutoff is declared
+    // to be in the archive. nextId carries over the ID high-water mark of the
+    // sessions already folded into rollups; it is raised past every record
+    static QByteArray encode(QVector<SessionRecord> records, const QVector<Rollup>& rollups,
+                             const QStringList& tagNames, qint64 cutoff, quint32 nextId = 1);
+    static bool write(const QString& path, const QVector<SessionRecord>& records,
+                      const QVector<Rollup>& rollups, const QStringList& tagNames, qint64 cutoff,
+                      quint32 nextId = 1);
+    // Adds records to an existing archive file (or creates it) without
+    // re-encoding what is already there; tagNames resolves their tag IDs
+    static bool append(const QString& path, QVector<SessionRecord> records,
+                       const QStringList& tagNames, qint64 cutoff);
+
+    void forEach(qint64 from, qint64 to, const std::function<void(const SessionRecord&)>& visit) const;
+    void forEach(const std::function<void(const SessionRecord&)>& visit) const;
+    [[nodiscard]] QVector<SessionRecord> records() const;
+    [[nodiscard]] std::optional<SessionRecord> find(quint32 id) const;
+    [[nodiscard]] DailyRollup totals(qint64 from, qint64 to) const;
+
+    [[nodiscard]] const QVector<Rollup>& rollups() const { return m_rollups; }
+    // Per-tag daily totals of the sessions still kept raw; Day period only
+    [[nodiscard]] const QVector<Rollup>& blockDays() const { return m_blockDays; }
+    // Time of day x weekday breakdown of the sessions still kept raw
+    [[nodiscard]] const AnalyticsCube& analytics() const { return m_analytics; }
+    [[nodiscard]] const QStringList& tagNames() const { return m_tagNames; }
+    [[nodiscard]] int recordCount() const { return m_recordCount; }
+    [[nodiscard]] int blockCount() const { return static_cast<int>(m_blocks.size()); }
+    // Highest ID among the raw blocks; sessions folded into rollups are not counted
+    [[nodiscard]] quint32 maxId() const { return m_maxId; }
+    // Lowest ID never given to an archived session, rollups included; never decreases
+    [[nodiscard]] quint32 nextId() const { return m_nextId; }
+    [[nodiscard]] qint64 cutoff() const { return m_cutoff; }
+    [[nodiscard]] qint64 fileSize() const { return m_size; }
+
+    static constexpr quint32 FILE_MAGIC = 0x41484D50;  // "PMHA"
+    // 2 adds the rollup section, 3 skipped counts and nextId, 4 the daily totals and analytics of the blocks
+    static constexpr quint16 FILE_VERSION = 4;
+    static constexpr int HEADER_SIZE = 24;
+    static constexpr int BLOCK_RECORDS = 1024;
+
+private:
+    struct BlockInfo {
+        qint64 firstStart = 0;
+        qint64 lastStart = 0;
+        quint64 offset = 0;
+        quint32 size = 0;
+        quint32 count = 0;
+        quint32 minId = 0;
+        quint32 maxId = 0;
+        qint64 workSeconds = 0;
+        qint64 breakSeconds = 0;
+        quint32 sessions = 0;
+        quint32 skipped = 0;
+        quint16 checksum = 0;
+    };
+
+    // Archive-local tag dictionary being built for an encode or append
+    struct Dictionary {
+        QStringList names;
+        QHash<QString, quint32> index;
+
+        quint32 tag(const QString& name);
+    };
+
+    // Totals of the raw blocks kept in the index; tags are dictionary indexes
+    struct Summary {
+        QMap<QPair<qint64, quint16>, Rollup> days;     // keyed by (Julian day, tag)
+        AnalyticsCube analytics;
+
+        void add(const SessionRecord& record, quint16 tag);
+    };
+
+    // Compresses records (sorted by start) into blocks laid out from bodyOffset on
+    static void encodeBlocks(const QVector<SessionRecord>& records, const QStringList& tagNames,
+                             Dictionary& dictionary, qint64 bodyOffset,
+                             QByteArray& body, QVector<BlockInfo>& blocks, Summary& summary);
+    // Dictionary, block index, rollups, next ID and the summary; rollupTags are dictionary indexes
+    static void writeIndex(QDataStream& stream, const Dictionary& dictionary, const QVector<BlockInfo>& blocks,
+                           const QVector<Rollup>& rollups, const QVector<quint16>& rollupTags, quint32 nextId,
+                           const Summary& summary);
+    // Archives written before version 4 have no summary; builds it from the blocks
+    void summarizeBlocks();
+
+    // Decoded records of one block, or nullptr if it is corrupt; keeps the last block cached
+    const QVector<SessionRecord>* block(int index) const;
+    [[nodiscard]] QPair<int, int> blockRange(qint64 from, qint64 to) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    qint64 m_cutoff = 0;
+
+    QStringList m_tagNames;
+    QVector<quint16> m_tagMap;              // archive tag index -> caller's tag ID
+    QVector<BlockInfo> m_blocks;             // sorted by firstStart
+    QVector<qint64> m_blockReach;           // latest lastStart among blocks 0..i
+    QVector<Rollup> m_rollups;
+    QVector<Rollup> m_blockDays;
+    AnalyticsCube m_analytics;
+    int m_recordCount = 0;
+    quint32 m_maxId = 0;
+    quint32 m_nextId = 1;
+
+    mutable int m_cachedBlock = -1;
+    mutable QVector<SessionRecord> m_cachedRecords;
+};
+
+#endif // HISTORYARCHIVE_H
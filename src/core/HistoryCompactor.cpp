@@ -0,0 +1,188 @@
+#include "HistoryCompactor.h"
+#include "SessionNotes.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <QThread>
+#include <limits>
+#include <memory>
+
+namespace {
+    qint64 rollupKey(const HistoryArchive::Rollup &rollup)
+    {
+        return (rollup.julianDay << 20) | (static_cast<qint64>(rollup.period) << 16) | rollup.tagId;
+    }
+
+    void mergeRollup(QMap<qint64, HistoryArchive::Rollup> &rollups, const HistoryArchive::Rollup &rollup)
+    {
+        const auto it = rollups.find(rollupKey(rollup));
+        if (it == rollups.end()) {
+            rollups.insert(rollupKey(rollup), rollup);
+            return;
+        }
+        it->workSeconds += rollup.workSeconds;
+        it->breakSeconds += rollup.breakSeconds;
+        it->sessions += rollup.sessions;
+        it->skippedSessions += rollup.skippedSessions;
+    }
+}
+
+HistoryCompactor::HistoryCompactor(const RetentionPolicy &policy, QObject *parent)
+    : QObject(parent)
+    , m_policy(policy)
+{
+    m_archivePath = SessionHistory::instance().archiveFilePath();
+    m_notedSessions = SessionNotes::instance().notedSessions();
+}
+
+bool HistoryCompactor::run()
+{
+    // A private mapping; tags stay indexes into the archive's own dictionary,
+    // which is written back as is, so every tag round-trips
+    HistoryArchive archive;
+    const bool loaded = archive.load(m_archivePath);
+    if (!loaded) {
+        const QString error = tr("Cannot read %1").arg(m_archivePath);
+        emit finished(false, error);
+        return false;
+    }
+
+    const QDate today = QDate::currentDate();
+    const qint64 dailyCutoff = m_policy.dailyAfterMonths > 0
+        ? today.addMonths(-m_policy.dailyAfterMonths).startOfDay().toSecsSinceEpoch()
+        : std::numeric_limits<qint64>::min();
+    QDate monthlyCutoff;
+    if (m_policy.monthlyAfterMonths > 0) {
+        const QDate month = today.addMonths(-m_policy.monthlyAfterMonths);
+        monthlyCutoff = QDate(month.year(), month.month(), 1);
+    }
+
+    QMap<qint64, HistoryArchive::Rollup> rollups;
+    for (const HistoryArchive::Rollup &rollup : archive.rollups()) {
+        mergeRollup(rollups, rollup);
+    }
+
+    QVector<SessionRecord> kept;
+    kept.reserve(archive.recordCount());
+    int folded = 0;
+
+    archive.forEach([&](const SessionRecord &record) {
+        if (record.startTime >= dailyCutoff || m_notedSessions.contains(record.id)) {
+            kept.append(record);
+            return;
+        }
+
+        HistoryArchive::Rollup rollup;
+        rollup.julianDay = QDateTime::fromSecsSinceEpoch(record.startTime).date().toJulianDay();
+        rollup.tagId = record.tagId;
+        if (record.type == TimerState::Work) {
+            rollup.workSeconds = record.duration;
+            rollup.sessions = 1;
+            rollup.skippedSessions = (record.flags & SessionSkipped) ? 1 : 0;
+        } else {
+            rollup.breakSeconds = record.duration;
+        }
+        mergeRollup(rollups, rollup);
+        ++folded;
+    });
+
+    if (isCancelled()) {
+        emit finished(false, tr("Compaction cancelled"));
+        return false;
+    }
+
+    // Daily rollups past the monthly horizon are folded once more
+    int promoted = 0;
+    if (monthlyCutoff.isValid()) {
+        const QMap<qint64, HistoryArchive::Rollup> current = rollups;
+        rollups.clear();
+        for (HistoryArchive::Rollup rollup : current) {
+            const QDate date = QDate::fromJulianDay(rollup.julianDay);
+            if (rollup.period == HistoryArchive::RollupPeriod::Day && date < monthlyCutoff) {
+                rollup.julianDay = QDate(date.year(), date.month(), 1).toJulianDay();
+                rollup.period = HistoryArchive::RollupPeriod::Month;
+                ++promoted;
+            }
+            mergeRollup(rollups, rollup);
+        }
+    }
+
+    if (folded == 0 && promoted == 0) {
+        emit finished(false, QString());
+        return false;
+    }
+
+    // nextId keeps the IDs of folded sessions from ever being handed out again
+    const QByteArray data = HistoryArchive::encode(kept, rollups.values(), archive.tagNames(),
+                                                   archive.cutoff(), archive.nextId());
+    archive.close();
+
+    QString error;
+    const bool written = writeThrottled(data, error);
+    emit finished(written, error);
+    return written;
+}
+
+bool HistoryCompactor::writeThrottled(const QByteArray &data, QString &error)
+{
+    QSaveFile file(m_archivePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    for (qint64 written = 0; written < data.size();) {
+        if (isCancelled()) {
+            file.cancelWriting();
+            error = tr("Compaction cancelled");
+            return false;
+        }
+
+        const qint64 chunk = qMin<qint64>(WRITE_CHUNK_BYTES, data.size() - written);
+        if (file.write(data.constData() + written, chunk) != chunk) {
+            error = file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+        written += chunk;
+
+        // Stay within the byte budget so compaction never competes with the UI for the disk
+        const qint64 due = written * 1000 / WRITE_BYTES_PER_SECOND;
+        if (due > elapsed.elapsed()) {
+            QThread::msleep(static_cast<unsigned long>(due - elapsed.elapsed()));
+        }
+    }
+
+    if (!releaseArchive()) {
+        file.cancelWriting();
+        error = tr("Compaction cancelled");
+        return false;
+    }
+    if (!file.commit()) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool HistoryCompactor::releaseArchive()
+{
+    // Not a blocking queued call: the main thread may be waiting for this one
+    // to stop, so the wait keeps checking for cancellation instead
+    const auto released = std::make_shared<QSemaphore>();
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [released]() {
+        SessionHistory::instance().releaseArchive();
+        released->release();
+    }, Qt::QueuedConnection);
+
+    while (!released->tryAcquire(1, RELEASE_POLL_MS)) {
+        if (isCancelled()) return false;
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef HISTORYCOMPACTOR_H
+#define HISTORYCOMPACTOR_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <atomic>
+#include "HistoryArchive.h"
+
+// Folds old archived sessions into per-tag daily rollups, and old daily
+// rollups into monthly ones, so the archive stops growing with raw sessions.
+// Sessions with a note stay raw so the note keeps its session.
+//
+// run() works on its own mapping of the archive and writes the result through
+// QSaveFile in throttled chunks, so the swap is atomic and the disk is never
+// saturated. It is meant for a low-priority worker thread. Right before the
+// swap it has SessionHistory::releaseArchive() run on the main thread, since
+// a mapped file cannot be replaced on Windows; whenever it then finishes with
+// a change or an error, SessionHistory::reloadArchive() maps the file again.
+class HistoryCompactor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct RetentionPolicy {
+        int dailyAfterMonths = 24;          // raw sessions older than this become daily rollups
+        int monthlyAfterMonths = 60;        // daily rollups older than this become monthly rollups
+    };
+
+    explicit HistoryCompactor(const RetentionPolicy &policy, QObject *parent = nullptr);
+    ~HistoryCompactor() override = default;
+
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    static constexpr qint64 WRITE_BYTES_PER_SECOND = 2 * 1024 * 1024;
+    static constexpr int WRITE_CHUNK_BYTES = 64 * 1024;
+    static constexpr int RELEASE_POLL_MS = 50;
+
+public slots:
+    // Returns true when the archive was rewritten
+    bool run();
+
+signals:
+    void finished(bool changed, const QString &error);
+
+private:
+    bool writeThrottled(const QByteArray &data, QString &error);
+    // Waits for the main thread to let go of the archive; false if cancelled meanwhile
+    bool releaseArchive();
+    [[nodiscard]] bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    RetentionPolicy m_policy;
+
+    // Snapshots taken on the owning thread
+    QString m_archivePath;
+    QSet<quint32> m_notedSessions;
+
+    std::atomic_bool m_cancelled{false};
+};
+
+#endif // HISTORYCOMPACTOR_H
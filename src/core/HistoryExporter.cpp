@@ -0,0 +1,294 @@
+#include "HistoryExporter.h"
+#include "HistoryArchive.h"
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+
+namespace {
+    constexpr int ESTIMATED_LINE_LENGTH = 96;
+
+    void appendCsvField(QByteArray &out, const QString &value)
+    {
+        const QByteArray utf8 = value.toUtf8();
+        if (!utf8.contains(',') && !utf8.contains('"') && !utf8.contains('\n') && !utf8.contains('\r')) {
+            out.append(utf8);
+            return;
+        }
+        out.append('"');
+        for (const char ch : utf8) {
+            if (ch == '"') out.append('"');
+            out.append(ch);
+        }
+        out.append('"');
+    }
+
+    void appendJsonString(QByteArray &out, const QString &value)
+    {
+        out.append('"');
+        for (const char ch : value.toUtf8()) {
+            switch (ch) {
+                case '"':  out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20) {
+                        out.append(QByteArray("\\u00") + QByteArray::number(static_cast<unsigned char>(ch), 16).rightJustified(2, '0'));
+                    } else {
+                        out.append(ch);
+                    }
+            }
+        }
+        out.append('"');
+    }
+
+    QByteArray isoTime(qint64 secsSinceEpoch)
+    {
+        return QDateTime::fromSecsSinceEpoch(secsSinceEpoch).toUTC().toString(Qt::ISODate).toLatin1();
+    }
+}
+
+HistoryExporter::HistoryExporter(const QString &outputPath, Format format, Dataset dataset, QObject *parent)
+    : QObject(parent)
+    , m_outputPath(outputPath)
+    , m_format(format)
+    , m_dataset(dataset)
+{
+    const SessionHistory &history = SessionHistory::instance();
+    m_historyPath = history.historyFilePath();
+    m_archivePath = history.archiveFilePath();
+    m_tagNames = history.tagNames();
+    if (dataset == Dataset::DailyRollups) {
+        m_dailyRollups = history.dailyRollups();
+        m_monthlyRollups = history.monthlyRollups();
+    }
+}
+
+bool HistoryExporter::parseFormat(const QString &name, Format &format)
+{
+    if (name.compare(QLatin1String("csv"), Qt::CaseInsensitive) == 0) {
+        format = Format::Csv;
+    } else if (name.compare(QLatin1String("ndjson"), Qt::CaseInsensitive) == 0
+               || name.compare(QLatin1String("jsonl"), Qt::CaseInsensitive) == 0) {
+        format = Format::NdJson;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool HistoryExporter::parseDataset(const QString &name, Dataset &dataset)
+{
+    if (name.compare(QLatin1String("sessions"), Qt::CaseInsensitive) == 0) {
+        dataset = Dataset::Sessions;
+    } else if (name.compare(QLatin1String("daily"), Qt::CaseInsensitive) == 0) {
+        dataset = Dataset::DailyRollups;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool HistoryExporter::run()
+{
+    QSaveFile output(m_outputPath);
+    QString error;
+
+    bool success = output.open(QIODevice::WriteOnly);
+    if (!success) {
+        error = output.errorString();
+    } else {
+        success = m_dataset == Dataset::Sessions
+            ? exportSessions(output, error)
+            : exportDailyRollups(output, error);
+
+        if (success && !output.commit()) {
+            success = false;
+            error = output.errorString();
+        } else if (!success) {
+            output.cancelWriting();
+        }
+    }
+
+    emit finished(success, error);
+    return success;
+}
+
+bool HistoryExporter::exportSessions(QIODevice &output, QString &error)
+{
+    if (m_format == Format::Csv) {
+        output.write("id,start,duration_seconds,type,tag,skipped\n");
+    }
+
+    // A separate mapping of the archive; it carries its own tag dictionary.
+    // A missing archive loads as an empty one
+    HistoryArchive archive;
+    if (!archive.load(m_archivePath)) {
+        error = tr("Cannot read %1").arg(m_archivePath);
+        return false;
+    }
+
+    QFile input(m_historyPath);
+    const bool hasLog = input.exists();
+    if (hasLog && !input.open(QIODevice::ReadOnly)) {
+        error = input.errorString();
+        return false;
+    }
+
+    // Records appended while exporting are left for the next export
+    const qint64 live = hasLog
+        ? qMax<qint64>(0, (input.size() - SessionHistory::FILE_HEADER_SIZE) / SessionRecord::ENCODED_SIZE) : 0;
+    const qint64 total = archive.recordCount() + live;
+    qint64 done = 0;
+
+    if (!exportArchive(archive, output, error, done, total)) {
+        return false;
+    }
+    if (!hasLog) {
+        emit progress(done, total);
+        return true;
+    }
+    input.seek(SessionHistory::FILE_HEADER_SIZE);
+
+    QByteArray chunk(CHUNK_RECORDS * SessionRecord::ENCODED_SIZE, Qt::Uninitialized);
+    QByteArray out;
+    out.reserve(CHUNK_RECORDS * ESTIMATED_LINE_LENGTH);
+
+    qint64 liveDone = 0;
+    while (liveDone < live) {
+        if (isCancelled()) {
+            error = tr("Export cancelled");
+            return false;
+        }
+
+        const qint64 wanted = qMin<qint64>(CHUNK_RECORDS, live - liveDone) * SessionRecord::ENCODED_SIZE;
+        const qint64 read = input.read(chunk.data(), wanted);
+        const qint64 count = read / SessionRecord::ENCODED_SIZE;
+        if (count <= 0) break;
+
+        out.resize(0);
+        for (qint64 i = 0; i < count; ++i) {
+            const SessionRecord record = SessionHistory::decodeRecord(
+                reinterpret_cast<const uchar*>(chunk.constData()) + i * SessionRecord::ENCODED_SIZE);
+            // Left over from an interrupted archive pass; already exported above
+            if (record.id < archive.nextId() && record.startTime < archive.cutoff()) continue;
+            appendSession(out, record, m_tagNames);
+        }
+
+        if (output.write(out) != out.size()) {
+            error = output.errorString();
+            return false;
+        }
+
+        liveDone += count;
+        done += count;
+        emit progress(done, total);
+    }
+
+    return true;
+}
+
+bool HistoryExporter::exportArchive(const HistoryArchive &archive, QIODevice &output, QString &error,
+                                    qint64 &done, qint64 total)
+{
+    QByteArray out;
+    out.reserve(CHUNK_RECORDS * ESTIMATED_LINE_LENGTH);
+    bool success = true;
+
+    archive.forEach([&](const SessionRecord &record) {
+        if (!success) return;
+        appendSession(out, record, archive.tagNames());
+        if (++done % CHUNK_RECORDS != 0) return;
+
+        if (isCancelled()) {
+            error = tr("Export cancelled");
+            success = false;
+        } else if (output.write(out) != out.size()) {
+            error = output.errorString();
+            success = false;
+        }
+        out.resize(0);
+        emit progress(done, total);
+    });
+
+    if (success && !out.isEmpty() && output.write(out) != out.size()) {
+        error = output.errorString();
+        success = false;
+    }
+    return success;
+}
+
+void HistoryExporter::appendSession(QByteArray &out, const SessionRecord &record, const QStringList &tagNames) const
+{
+    const QString tag = record.tagId > 0 && record.tagId <= tagNames.size()
+        ? tagNames.at(record.tagId - 1) : QString();
+    const QByteArray type = TimerStateHelper::getStateKey(record.type).toLatin1();
+    const bool skipped = record.flags & SessionSkipped;
+
+    if (m_format == Format::Csv) {
+        out.append(QByteArray::number(record.id)).append(',')
+           .append(isoTime(record.startTime)).append(',')
+           .append(QByteArray::number(record.duration)).append(',')
+           .append(type).append(',');
+        appendCsvField(out, tag);
+        out.append(skipped ? ",1\n" : ",0\n");
+    } else {
+        out.append("{\"id\":").append(QByteArray::number(record.id))
+           .append(",\"start\":\"").append(isoTime(record.startTime))
+           .append("\",\"duration\":").append(QByteArray::number(record.duration))
+           .append(",\"type\":\"").append(type)
+           .append("\",\"tag\":");
+        appendJsonString(out, tag);
+        out.append(skipped ? ",\"skipped\":true}\n" : ",\"skipped\":false}\n");
+    }
+}
+
+bool HistoryExporter::exportDailyRollups(QIODevice &output, QString &error)
+{
+    if (m_format == Format::Csv) {
+        output.write("date,work_seconds,break_seconds,sessions\n");
+    }
+
+    const qint64 total = m_monthlyRollups.size() + m_dailyRollups.size();
+    QByteArray out;
+    out.reserve(CHUNK_RECORDS * ESTIMATED_LINE_LENGTH);
+
+    qint64 done = 0;
+    const auto appendRow = [&](const QByteArray &date, const DailyRollup &rollup) {
+        if (m_format == Format::Csv) {
+            out.append(date).append(',')
+               .append(QByteArray::number(rollup.workSeconds)).append(',')
+               .append(QByteArray::number(rollup.breakSeconds)).append(',')
+               .append(QByteArray::number(rollup.sessions)).append('\n');
+        } else {
+            out.append("{\"date\":\"").append(date)
+               .append("\",\"workSeconds\":").append(QByteArray::number(rollup.workSeconds))
+               .append(",\"breakSeconds\":").append(QByteArray::number(rollup.breakSeconds))
+               .append(",\"sessions\":").append(QByteArray::number(rollup.sessions)).append("}\n");
+        }
+
+        if (++done % CHUNK_RECORDS != 0 && done != total) return true;
+        if (isCancelled()) {
+            error = tr("Export cancelled");
+            return false;
+        }
+        if (output.write(out) != out.size()) {
+            error = output.errorString();
+            return false;
+        }
+        out.resize(0);
+        emit progress(done, total);
+        return true;
+    };
+
+    // Compacted months are older than any remaining day, so they simply come first
+    for (auto it = m_monthlyRollups.cbegin(); it != m_monthlyRollups.cend(); ++it) {
+        if (!appendRow(it.key().toString(QStringLiteral("yyyy-MM")).toLatin1(), it.value())) return false;
+    }
+    for (auto it = m_dailyRollups.cbegin(); it != m_dailyRollups.cend(); ++it) {
+        if (!appendRow(it.key().toString(Qt::ISODate).toLatin1(), it.value())) return false;
+    }
+
+    return true;
+}
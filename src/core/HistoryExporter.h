@@ -0,0 +1,75 @@
+#ifndef HISTORYEXPORTER_H
+#define HISTORYEXPORTER_H
+
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include "SessionHistory.h"
+
+class HistoryArchive;
+
+// Streams the session history or its daily rollups to CSV or NDJSON.
+//
+// Sessions are read straight from the history file in fixed-size chunks and
+// formatted into a reused buffer, so memory use does not depend on history
+// size. Archived sessions are decoded block by block ahead of them. The
+// output goes through QSaveFile: a cancelled or failed export never leaves a
+// partial file behind. run() is meant to be invoked on a worker thread;
+// cancel() may be called from any thread.
+class HistoryExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Csv,
+        NdJson
+    };
+
+    enum class Dataset {
+        Sessions,
+        DailyRollups
+    };
+
+    HistoryExporter(const QString &outputPath, Format format, Dataset dataset, QObject *parent = nullptr);
+    ~HistoryExporter() override = default;
+
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    static bool parseFormat(const QString &name, Format &format);
+    static bool parseDataset(const QString &name, Dataset &dataset);
+
+    static constexpr int CHUNK_RECORDS = 4096;
+
+public slots:
+    // Returns true when the complete file was written
+    bool run();
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished(bool success, const QString &error);
+
+private:
+    bool exportSessions(QIODevice &output, QString &error);
+    bool exportArchive(const HistoryArchive &archive, QIODevice &output, QString &error, qint64 &done, qint64 total);
+    void appendSession(QByteArray &out, const SessionRecord &record, const QStringList &tagNames) const;
+    bool exportDailyRollups(QIODevice &output, QString &error);
+    [[nodiscard]] bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    QString m_outputPath;
+    Format m_format;
+    Dataset m_dataset;
+
+    // Snapshots taken on the owning thread; both are small and implicitly shared
+    QString m_historyPath;
+    QString m_archivePath;
+    QStringList m_tagNames;
+    QMap<QDate, DailyRollup> m_dailyRollups;
+    QMap<QDate, DailyRollup> m_monthlyRollups;     // exported as "yyyy-MM" rows before the days
+
+    std::atomic_bool m_cancelled{false};
+};
+
+#endif // HISTORYEXPORTER_H
@@ -0,0 +1,606 @@
+#include "HistoryImporter.h"
+#include "HistoryArchive.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace {
+    // A slice of the mapped input; only materialised into a QString on demand
+    struct FieldView {
+        const char *data = nullptr;
+        qsizetype size = 0;
+        bool escaped = false;
+
+        [[nodiscard]] bool isEmpty() const { return size == 0; }
+        [[nodiscard]] bool equals(const char *literal) const { return qstrnicmp(data, size, literal) == 0; }
+    };
+
+    qint64 sessionKey(qint64 startTime, TimerState type)
+    {
+        return startTime * 4 + static_cast<qint64>(type);
+    }
+
+    const char *skipSpaces(const char *p, const char *end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p;
+    }
+
+    bool parseNumber(const FieldView &field, qint64 &value)
+    {
+        const char *p = field.data;
+        const char *end = field.data + field.size;
+        p = skipSpaces(p, end);
+
+        const bool negative = p < end && *p == '-';
+        if (negative) ++p;
+        if (p >= end || *p < '0' || *p > '9') return false;
+
+        qint64 result = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            const int digit = *p - '0';
+            if (result > (std::numeric_limits<qint64>::max() - digit) / 10) return false;
+            result = result * 10 + digit;
+        }
+        // A fractional part is accepted and truncated
+        if (p < end && *p == '.') {
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {}
+        }
+        if (skipSpaces(p, end) != end) return false;
+
+        value = negative ? -result : result;
+        return true;
+    }
+
+    bool readDigits(const char *&p, const char *end, int count, int &value)
+    {
+        value = 0;
+        for (int i = 0; i < count; ++i, ++p) {
+            if (p >= end || *p < '0' || *p > '9') return false;
+            value = value * 10 + (*p - '0');
+        }
+        return true;
+    }
+
+    int daysInMonth(int year, int month)
+    {
+        static constexpr int DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return month == 2 && leap ? 29 : DAYS[month - 1];
+    }
+
+    qint64 daysFromCivil(int year, int month, int day)
+    {
+        year -= month <= 2;
+        const qint64 era = (year >= 0 ? year : year - 399) / 400;
+        const int yearOfEra = static_cast<int>(year - era * 400);
+        const int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    // Fast path for "YYYY-MM-DD[T ]HH:MM[:SS[.fff]](Z|±HH[:MM])"; anything else,
+    // including local times without an offset, goes through QDateTime
+    bool parseIsoUtc(const FieldView &field, qint64 &secs)
+    {
+        const char *p = field.data;
+        const char *end = field.data + field.size;
+        int year, month, day, hour, minute, second = 0;
+
+        if (!readDigits(p, end, 4, year) || p >= end || *p++ != '-') return false;
+        if (!readDigits(p, end, 2, month) || p >= end || *p++ != '-') return false;
+        if (!readDigits(p, end, 2, day) || p >= end || (*p != 'T' && *p != ' ')) return false;
+        ++p;
+        if (!readDigits(p, end, 2, hour) || p >= end || *p++ != ':') return false;
+        if (!readDigits(p, end, 2, minute)) return false;
+        if (p < end && *p == ':') {
+            ++p;
+            if (!readDigits(p, end, 2, second)) return false;
+        }
+        if (p < end && *p == '.') {
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {}
+        }
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)
+            || hour > 23 || minute > 59 || second > 60) {
+            return false;
+        }
+
+        qint64 offset = 0;
+        if (p < end && *p == 'Z') {
+            ++p;
+        } else if (p < end && (*p == '+' || *p == '-')) {
+            const int sign = *p++ == '-' ? -1 : 1;
+            int offsetHours, offsetMinutes = 0;
+            if (!readDigits(p, end, 2, offsetHours)) return false;
+            if (p < end && *p == ':') ++p;
+            if (p < end && !readDigits(p, end, 2, offsetMinutes)) return false;
+            offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+        } else {
+            return false;
+        }
+        if (p != end) return false;
+
+        secs = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+        return true;
+    }
+
+    bool parseTimestamp(const FieldView &field, qint64 &secs)
+    {
+        if (field.isEmpty()) return false;
+
+        qint64 number = 0;
+        if (parseNumber(field, number)) {
+            // Millisecond epochs are common in tracker exports
+            secs = number > 100000000000LL ? number / 1000 : number;
+            return secs > 0;
+        }
+        if (parseIsoUtc(field, secs)) return true;
+
+        const QString text = QString::fromUtf8(field.data, field.size).trimmed();
+        QDateTime dateTime = QDateTime::fromString(text, Qt::ISODate);
+        if (!dateTime.isValid()) {
+            dateTime = QDateTime::fromString(text, QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+        }
+        if (!dateTime.isValid()) return false;
+        secs = dateTime.toSecsSinceEpoch();
+        return true;
+    }
+
+    bool parseType(const FieldView &field, TimerState &type)
+    {
+        if (field.isEmpty() || field.equals("work") || field.equals("focus") || field.equals("pomodoro")) {
+            type = TimerState::Work;
+        } else if (field.equals("shortBreak") || field.equals("short_break") || field.equals("break")) {
+            type = TimerState::ShortBreak;
+        } else if (field.equals("longBreak") || field.equals("long_break")) {
+            type = TimerState::LongBreak;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool parseFlag(const FieldView &field)
+    {
+        return field.equals("1") || field.equals("true") || field.equals("yes");
+    }
+
+    QString csvString(const FieldView &field)
+    {
+        QString value = QString::fromUtf8(field.data, field.size);
+        if (field.escaped) {
+            value.replace(QStringLiteral("\"\""), QStringLiteral("\""));
+        }
+        return value.trimmed();
+    }
+
+    QString jsonString(const FieldView &field)
+    {
+        if (!field.escaped) {
+            return QString::fromUtf8(field.data, field.size);
+        }
+        // Escapes are rare; let the JSON parser decode them
+        const QByteArray wrapped = "[\"" + QByteArray(field.data, field.size) + "\"]";
+        return QJsonDocument::fromJson(wrapped).array().at(0).toString();
+    }
+
+    // Splits one CSV row, honouring quoted fields with "" escapes and embedded newlines
+    bool nextCsvRow(const char *&p, const char *end, QVarLengthArray<FieldView, 16> &fields)
+    {
+        fields.clear();
+        if (p >= end) return false;
+
+        for (;;) {
+            FieldView field;
+            if (*p == '"') {
+                field.data = ++p;
+                while (p < end) {
+                    if (*p == '"') {
+                        if (p + 1 < end && p[1] == '"') {
+                            field.escaped = true;
+                            p += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    ++p;
+                }
+                field.size = p - field.data;
+                if (p < end) ++p;
+                while (p < end && *p != ',' && *p != '\n') ++p;
+            } else {
+                field.data = p;
+                while (p < end && *p != ',' && *p != '\n') ++p;
+                field.size = p - field.data;
+                if (field.size > 0 && field.data[field.size - 1] == '\r') --field.size;
+            }
+            fields.append(field);
+
+            if (p >= end) return true;
+            if (*p++ == '\n') return true;
+            if (p >= end) {
+                fields.append(FieldView{p, 0, false});
+                return true;
+            }
+        }
+    }
+}
+
+struct HistoryImporter::RawRecord {
+    FieldView start;
+    FieldView duration;
+    FieldView end;
+    FieldView type;
+    FieldView tag;
+    FieldView skipped;
+    bool jsonStrings = false;
+};
+
+HistoryImporter::HistoryImporter(const QString &inputPath, Format format, QObject *parent)
+    : QObject(parent)
+    , m_inputPath(inputPath)
+    , m_format(format)
+{
+    // Implicitly shared, so this costs nothing here; run() builds the dedup
+    // keys from it on the worker
+    const SessionHistory &history = SessionHistory::instance();
+    m_existing = history.records();
+    m_archivePath = history.archiveFilePath();
+}
+
+bool HistoryImporter::parseFormat(const QString &name, Format &format)
+{
+    if (name.compare(QLatin1String("auto"), Qt::CaseInsensitive) == 0) {
+        format = Format::Auto;
+    } else if (name.compare(QLatin1String("csv"), Qt::CaseInsensitive) == 0) {
+        format = Format::Csv;
+    } else if (name.compare(QLatin1String("ndjson"), Qt::CaseInsensitive) == 0
+               || name.compare(QLatin1String("jsonl"), Qt::CaseInsensitive) == 0) {
+        format = Format::NdJson;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool HistoryImporter::run()
+{
+    m_records.clear();
+    m_summary = Summary();
+    m_error.clear();
+    snapshotExisting();
+
+    QFile file(m_inputPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_error = file.errorString();
+        emit finished(false, m_error);
+        return false;
+    }
+
+    const qint64 size = file.size();
+    bool success = true;
+    if (size > 0) {
+        uchar *mapped = file.map(0, size);
+        if (!mapped) {
+            m_error = tr("Cannot map %1 into memory").arg(m_inputPath);
+            emit finished(false, m_error);
+            return false;
+        }
+
+        const char *begin = reinterpret_cast<const char*>(mapped);
+        const char *end = begin + size;
+        if (size >= 3 && qstrncmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+            begin += 3;
+        }
+
+        Format format = m_format;
+        if (format == Format::Auto) {
+            const QString suffix = QFileInfo(m_inputPath).suffix().toLower();
+            const char *first = begin;
+            while (first < end && (*first == ' ' || *first == '\n' || *first == '\r' || *first == '\t')) ++first;
+            const bool json = suffix == QLatin1String("ndjson") || suffix == QLatin1String("jsonl")
+                || suffix == QLatin1String("json") || (first < end && *first == '{');
+            format = json ? Format::NdJson : Format::Csv;
+        }
+
+        success = format == Format::Csv
+            ? parseCsv(begin, end, size)
+            : parseNdJson(begin, end, size);
+        file.unmap(mapped);
+    }
+
+    if (success) {
+        emit progress(size, size);
+    }
+    emit finished(success, m_error);
+    return success;
+}
+
+void HistoryImporter::snapshotExisting()
+{
+    // The archive is decoded through a private mapping, as the exporter does
+    HistoryArchive archive;
+    archive.load(m_archivePath);
+
+    m_seen.clear();
+    m_seen.reserve(m_existing.size() + archive.recordCount());
+    for (const SessionRecord &record : std::as_const(m_existing)) {
+        m_seen.insert(sessionKey(record.startTime, record.type));
+    }
+    archive.forEach([this](const SessionRecord &record) {
+        m_seen.insert(sessionKey(record.startTime, record.type));
+    });
+
+    // Compacted sessions no longer have start times to match, only the
+    // periods they were folded into
+    m_rolledDays.clear();
+    m_rolledMonths.clear();
+    for (const HistoryArchive::Rollup &rollup : archive.rollups()) {
+        (rollup.period == HistoryArchive::RollupPeriod::Month ? m_rolledMonths : m_rolledDays)
+            .insert(rollup.julianDay);
+    }
+}
+
+bool HistoryImporter::isRolledUp(qint64 startTime) const
+{
+    if (m_rolledDays.isEmpty() && m_rolledMonths.isEmpty()) return false;
+
+    // Rollups are keyed by local day, like every other per-day figure
+    const QDate date = QDateTime::fromSecsSinceEpoch(startTime).date();
+    return m_rolledDays.contains(date.toJulianDay())
+        || m_rolledMonths.contains(QDate(date.year(), date.month(), 1).toJulianDay());
+}
+
+void HistoryImporter::resolveTags()
+{
+    SessionHistory &history = SessionHistory::instance();
+
+    QVector<quint16> tagMapping(m_tagNames.size() + 1, 0);
+    for (int i = 0; i < m_tagNames.size(); ++i) {
+        tagMapping[i + 1] = history.internTag(m_tagNames.at(i));
+    }
+    for (SessionRecord &record : m_records) {
+        record.tagId = tagMapping.at(record.tagId);
+    }
+
+    m_batch.records = std::move(m_records);
+    m_records = QVector<SessionRecord>();
+    m_existing = QVector<SessionRecord>();
+    m_seen = QSet<qint64>();
+    m_rolledDays = QSet<qint64>();
+    m_rolledMonths = QSet<qint64>();
+}
+
+bool HistoryImporter::write()
+{
+    const bool success = SessionHistory::instance().writeBatch(m_batch);
+    if (!success) {
+        m_error = tr("Cannot write %1").arg(SessionHistory::instance().historyFilePath());
+    }
+    emit written(success, m_error);
+    return success;
+}
+
+HistoryImporter::Summary HistoryImporter::commit()
+{
+    SessionHistory::instance().commitBatch(m_batch);
+    m_summary.imported = static_cast<int>(m_batch.records.size());
+    m_batch = SessionBatch();
+    return m_summary;
+}
+
+bool HistoryImporter::parseCsv(const char *begin, const char *end, qint64 total)
+{
+    enum Column { Start, Duration, End, Type, Tag, Skipped, ColumnCount };
+    int columns[ColumnCount];
+    std::fill(std::begin(columns), std::end(columns), -1);
+
+    const char *p = begin;
+    QVarLengthArray<FieldView, 16> fields;
+    if (!nextCsvRow(p, end, fields)) {
+        m_error = tr("The file is empty");
+        return false;
+    }
+
+    for (int i = 0; i < fields.size(); ++i) {
+        const FieldView &name = fields.at(i);
+        if (name.equals("start") || name.equals("start_time") || name.equals("started") || name.equals("begin")) {
+            columns[Start] = i;
+        } else if (name.equals("duration") || name.equals("duration_seconds") || name.equals("seconds")) {
+            columns[Duration] = i;
+        } else if (name.equals("end") || name.equals("end_time") || name.equals("stopped")) {
+            columns[End] = i;
+        } else if (name.equals("type") || name.equals("kind") || name.equals("session_type")) {
+            columns[Type] = i;
+        } else if (name.equals("tag") || name.equals("project") || name.equals("task")) {
+            columns[Tag] = i;
+        } else if (name.equals("skipped")) {
+            columns[Skipped] = i;
+        }
+    }
+
+    if (columns[Start] < 0 || (columns[Duration] < 0 && columns[End] < 0)) {
+        m_error = tr("Missing start and duration/end columns");
+        return false;
+    }
+
+    const auto column = [&fields, &columns](Column which) {
+        const int index = columns[which];
+        return index >= 0 && index < fields.size() ? fields.at(index) : FieldView();
+    };
+
+    qint64 lines = 0;
+    while (nextCsvRow(p, end, fields)) {
+        if (fields.size() == 1 && fields.at(0).isEmpty()) continue;
+
+        RawRecord raw;
+        raw.start = column(Start);
+        raw.duration = column(Duration);
+        raw.end = column(End);
+        raw.type = column(Type);
+        raw.tag = column(Tag);
+        raw.skipped = column(Skipped);
+        accept(raw);
+
+        if (++lines % PROGRESS_INTERVAL_LINES == 0) {
+            if (isCancelled()) {
+                m_error = tr("Import cancelled");
+                return false;
+            }
+            emit progress(p - begin, total);
+        }
+    }
+    return true;
+}
+
+bool HistoryImporter::parseNdJson(const char *begin, const char *end, qint64 total)
+{
+    qint64 lines = 0;
+    const char *p = begin;
+
+    while (p < end) {
+        const char *lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+
+        // Flat objects only: "key": "string" | number | true | false | null
+        RawRecord raw;
+        raw.jsonStrings = true;
+        bool valid = false;
+        const char *q = skipSpaces(p, lineEnd);
+
+        if (q < lineEnd && *q == '{') {
+            ++q;
+            valid = true;
+            while (valid) {
+                q = skipSpaces(q, lineEnd);
+                if (q < lineEnd && *q == '}') break;
+                if (q >= lineEnd || *q != '"') { valid = false; break; }
+
+                FieldView key{++q, 0, false};
+                while (q < lineEnd && *q != '"') ++q;
+                key.size = q - key.data;
+                q = skipSpaces(q + 1, lineEnd);
+                if (q >= lineEnd || *q != ':') { valid = false; break; }
+                q = skipSpaces(q + 1, lineEnd);
+
+                FieldView value;
+                if (q < lineEnd && *q == '"') {
+                    value.data = ++q;
+                    while (q < lineEnd && *q != '"') {
+                        if (*q == '\\') {
+                            value.escaped = true;
+                            ++q;
+                        }
+                        ++q;
+                    }
+                    value.size = q - value.data;
+                    ++q;
+                } else {
+                    value.data = q;
+                    while (q < lineEnd && *q != ',' && *q != '}' && *q != ' ' && *q != '\t' && *q != '\r') ++q;
+                    value.size = q - value.data;
+                    if (value.equals("null")) value = FieldView();
+                }
+
+                if (key.equals("start") || key.equals("start_time") || key.equals("started") || key.equals("begin")) {
+                    raw.start = value;
+                } else if (key.equals("duration") || key.equals("duration_seconds") || key.equals("seconds")) {
+                    raw.duration = value;
+                } else if (key.equals("end") || key.equals("end_time") || key.equals("stopped")) {
+                    raw.end = value;
+                } else if (key.equals("type") || key.equals("kind") || key.equals("session_type")) {
+                    raw.type = value;
+                } else if (key.equals("tag") || key.equals("project") || key.equals("task")) {
+                    raw.tag = value;
+                } else if (key.equals("skipped")) {
+                    raw.skipped = value;
+                }
+
+                q = skipSpaces(q, lineEnd);
+                if (q < lineEnd && *q == ',') {
+                    ++q;
+                } else if (q >= lineEnd || *q != '}') {
+                    valid = false;
+                }
+            }
+        }
+
+        if (valid) {
+            accept(raw);
+        } else if (skipSpaces(p, lineEnd) != lineEnd) {
+            m_summary.invalid++;
+        }
+
+        p = lineEnd + 1;
+        if (++lines % PROGRESS_INTERVAL_LINES == 0) {
+            if (isCancelled()) {
+                m_error = tr("Import cancelled");
+                return false;
+            }
+            emit progress(qMin<qint64>(p - begin, total), total);
+        }
+    }
+    return true;
+}
+
+void HistoryImporter::accept(const RawRecord &raw)
+{
+    SessionRecord record;
+    qint64 duration = 0;
+
+    if (!parseTimestamp(raw.start, record.startTime)
+        || !parseType(raw.type, record.type)) {
+        m_summary.invalid++;
+        return;
+    }
+
+    if (!raw.duration.isEmpty()) {
+        if (!parseNumber(raw.duration, duration)) duration = 0;
+    } else {
+        qint64 endTime = 0;
+        if (parseTimestamp(raw.end, endTime)) duration = endTime - record.startTime;
+    }
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (duration <= 0 || duration > MAX_SESSION_SECONDS || record.startTime > now) {
+        m_summary.invalid++;
+        return;
+    }
+
+    const qint64 key = sessionKey(record.startTime, record.type);
+    if (m_seen.contains(key) || isRolledUp(record.startTime)) {
+        m_summary.duplicates++;
+        return;
+    }
+    m_seen.insert(key);
+
+    record.duration = static_cast<quint32>(duration);
+    record.flags = (!raw.skipped.isEmpty() && parseFlag(raw.skipped)) ? SessionSkipped : 0;
+    if (!raw.tag.isEmpty() && record.type == TimerState::Work) {
+        record.tagId = localTag(raw.jsonStrings ? jsonString(raw.tag) : csvString(raw.tag));
+    }
+    m_records.append(record);
+}
+
+quint16 HistoryImporter::localTag(const QString &name)
+{
+    const QString trimmed = name.trimmed();
+    if (trimmed.isEmpty()) return 0;
+
+    if (const quint16 existing = m_tagIds.value(trimmed, 0)) {
+        return existing;
+    }
+    // Past the ID range the sessions are imported untagged
+    if (m_tagNames.size() >= std::numeric_limits<quint16>::max()) return 0;
+    m_tagNames.append(trimmed);
+    const auto id = static_cast<quint16>(m_tagNames.size());
+    m_tagIds.insert(trimmed, id);
+    return id;
+}
@@ -0,0 +1,109 @@
+#ifndef HISTORYIMPORTER_H
+#define HISTORYIMPORTER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include "SessionHistory.h"
+
+// Imports session logs exported by this app or by other trackers.
+//
+// run() memory-maps the input and tokenizes it in place: fields are views
+// into the mapping and only quoted/escaped values are ever copied. Records are
+// validated and deduplicated on the worker thread: by start time and type
+// against the existing history and within the file, and by day or month
+// against history compacted into rollups. The owning thread then
+// interns the tags (resolveTags()), the worker writes and indexes the batch
+// (write()), and commit() merges it into the history; only the first and
+// last steps, both proportional to the batch, run on the owning thread.
+//
+// Recognised columns/keys (case-insensitive):
+//   start | start_time | started | begin     ISO 8601 or seconds since epoch
+//   duration | duration_seconds | seconds    or end | end_time | stopped
+//   type | kind | session_type               work, shortBreak, longBreak (default work)
+//   tag | project | task                     optional
+//   skipped                                  optional 1/0 or true/false
+class HistoryImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Auto,
+        Csv,
+        NdJson
+    };
+
+    struct Summary {
+        int imported = 0;
+        int duplicates = 0;
+        int invalid = 0;
+    };
+
+    HistoryImporter(const QString &inputPath, Format format = Format::Auto, QObject *parent = nullptr);
+    ~HistoryImporter() override = default;
+
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    // Must be called on the thread that owns SessionHistory: resolveTags()
+    // after run() succeeded, commit() after write() succeeded
+    void resolveTags();
+    Summary commit();
+
+    [[nodiscard]] const Summary& summary() const { return m_summary; }
+
+    static bool parseFormat(const QString &name, Format &format);
+
+    static constexpr qint64 MAX_SESSION_SECONDS = 24 * 3600;
+    static constexpr int PROGRESS_INTERVAL_LINES = 65536;
+
+public slots:
+    bool run();
+    bool write();
+
+signals:
+    void progress(qint64 bytesDone, qint64 bytesTotal);
+    void finished(bool success, const QString &error);
+    void written(bool success, const QString &error);
+
+private:
+    struct RawRecord;
+
+    bool parseCsv(const char *begin, const char *end, qint64 total);
+    bool parseNdJson(const char *begin, const char *end, qint64 total);
+    // Worker thread: the dedup keys of the history as of construction
+    void snapshotExisting();
+    [[nodiscard]] bool isRolledUp(qint64 startTime) const;
+    void accept(const RawRecord &raw);
+    quint16 localTag(const QString &name);
+    [[nodiscard]] bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    QString m_inputPath;
+    Format m_format;
+
+    // The live records and archive as of construction, read by run()
+    QVector<SessionRecord> m_existing;
+    QString m_archivePath;
+
+    // Keys of sessions already in the history, and the Julian days and months
+    // (first day) the archive holds as rollups
+    QSet<qint64> m_seen;
+    QSet<qint64> m_rolledDays;
+    QSet<qint64> m_rolledMonths;
+
+    // Parsed records; tagId indexes m_tagNames until commit() interns them
+    QVector<SessionRecord> m_records;
+    QStringList m_tagNames;
+    QHash<QString, quint16> m_tagIds;
+    SessionBatch m_batch;
+
+    Summary m_summary;
+    QString m_error;
+    std::atomic_bool m_cancelled{false};
+};
+
+#endif // HISTORYIMPORTER_H
@@ -80,6 +80,46 @@ void PomodoroConfig::setBreakEndSound(const QString& soundPath)
     }
 }
 
+void PomodoroConfig::setWorkEndVolume(int percent)
+{
+    percent = qBound(0, percent, 100);
+    if (percent != m_workEndVolume) {
+        m_workEndVolume = percent;
+        saveSettings();
+    }
+}
+
+void PomodoroConfig::setBreakEndVolume(int percent)
+{
+    percent = qBound(0, percent, 100);
+    if (percent != m_breakEndVolume) {
+        m_breakEndVolume = percent;
+        saveSettings();
+    }
+}
+
+void PomodoroConfig::setWeeklyGoalMinutes(int minutes)
+{
+    minutes = qBound(0, minutes, MAX_WEEKLY_GOAL_MINUTES);
+    if (minutes != m_weeklyGoalMinutes) {
+        m_weeklyGoalMinutes = minutes;
+        saveSettings();
+    }
+}
+
+void PomodoroConfig::setHookCommand(const QString& event, const QString& command)
+{
+    const QString trimmed = command.trimmed();
+    if (trimmed != m_hookCommands.value(event)) {
+        if (trimmed.isEmpty()) {
+            m_hookCommands.remove(event);
+        } else {
+            m_hookCommands.insert(event, trimmed);
+        }
+        saveSettings();
+    }
+}
+
 void PomodoroConfig::saveSettings()
 {
     if (!m_settings) return;
@@ -98,6 +138,22 @@ void PomodoroConfig::saveSettings()
     m_settings->beginGroup("Sound");
     m_settings->setValue("workEndSound", m_workEndSound);
     m_settings->setValue("breakEndSound", m_breakEndSound);
+    m_settings->setValue("workEndVolume", m_workEndVolume);
+    m_settings->setValue("breakEndVolume", m_breakEndVolume);
+    m_settings->endGroup();
+
+    m_settings->beginGroup("Goals");
+    m_settings->setValue("weeklyGoalMinutes", m_weeklyGoalMinutes);
+    m_settings->endGroup();
+
+    // Commands are the only keys besides the two limits; removed ones must not linger
+    m_settings->remove("Hooks");
+    m_settings->beginGroup("Hooks");
+    m_settings->setValue("timeoutSeconds", m_hookTimeoutSeconds);
+    m_settings->setValue("concurrency", m_hookConcurrency);
+    for (auto it = m_hookCommands.cbegin(); it != m_hookCommands.cend(); ++it) {
+        m_settings->setValue(it.key(), it.value());
+    }
     m_settings->endGroup();
 
     m_settings->sync();
@@ -121,5 +177,27 @@ void PomodoroConfig::loadSettings()
     m_settings->beginGroup("Sound");
     m_workEndSound = m_settings->value("workEndSound", QString()).toString();
     m_breakEndSound = m_settings->value("breakEndSound", QString()).toString();
+    m_workEndVolume = qBound(0, m_settings->value("workEndVolume", DEFAULT_CUE_VOLUME).toInt(), 100);
+    m_breakEndVolume = qBound(0, m_settings->value("breakEndVolume", DEFAULT_CUE_VOLUME).toInt(), 100);
+    m_settings->endGroup();
+
+    m_settings->beginGroup("Goals");
+    m_weeklyGoalMinutes = qBound(0, m_settings->value("weeklyGoalMinutes", DEFAULT_WEEKLY_GOAL_MINUTES).toInt(),
+                                 MAX_WEEKLY_GOAL_MINUTES);
+    m_settings->endGroup();
+
+    m_settings->beginGroup("Hooks");
+    m_hookCommands.clear();
+    const QStringList keys = m_settings->childKeys();
+    for (const QString& key : keys) {
+        if (key == "timeoutSeconds" || key == "concurrency") continue;
+        const QString command = m_settings->value(key).toString().trimmed();
+        if (!command.isEmpty()) {
+            m_hookCommands.insert(key, command);
+        }
+    }
+    m_hookTimeoutSeconds = qMax(1, m_settings->value("timeoutSeconds", DEFAULT_HOOK_TIMEOUT_SECONDS).toInt());
+    m_hookConcurrency = qBound(1, m_settings->value("concurrency", DEFAULT_HOOK_CONCURRENCY).toInt(),
+                               MAX_HOOK_CONCURRENCY);
     m_settings->endGroup();
 }
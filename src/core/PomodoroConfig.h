@@ -1,6 +1,7 @@
 #ifndef POMODOROCONFIG_H
 #define POMODOROCONFIG_H
 
+#include <QHash>
 #include <QSettings>
 #include <QString>
 #include <memory>
@@ -31,12 +32,33 @@ public:
     QString breakEndSound() const { return m_breakEndSound; }
     void setWorkEndSound(const QString& soundPath);
     void setBreakEndSound(const QString& soundPath);
+    // Cue volumes in percent
+    int workEndVolume() const { return m_workEndVolume; }
+    int breakEndVolume() const { return m_breakEndVolume; }
+    void setWorkEndVolume(int percent);
+    void setBreakEndVolume(int percent);
+
+    // Focus goal the statistics forecast is measured against; months scale it by their length
+    int weeklyGoalMinutes() const { return m_weeklyGoalMinutes; }
+    void setWeeklyGoalMinutes(int minutes);
+
+    // Shell commands run on timer events, keyed by event name (workStart, workEnd, ...)
+    const QHash<QString, QString>& hookCommands() const { return m_hookCommands; }
+    void setHookCommand(const QString& event, const QString& command);
+    int hookTimeoutSeconds() const { return m_hookTimeoutSeconds; }
+    int hookConcurrency() const { return m_hookConcurrency; }
 
     // Constants
     static constexpr int DEFAULT_WORK_DURATION = 1500;      // 25 minutes
     static constexpr int DEFAULT_SHORT_BREAK = 300;         // 5 minutes
     static constexpr int DEFAULT_LONG_BREAK = 900;          // 15 minutes
     static constexpr int SESSIONS_BEFORE_LONG_BREAK = 4;
+    static constexpr int DEFAULT_CUE_VOLUME = 80;
+    static constexpr int DEFAULT_WEEKLY_GOAL_MINUTES = 600; // 10 hours
+    static constexpr int MAX_WEEKLY_GOAL_MINUTES = 7 * 24 * 60;
+    static constexpr int DEFAULT_HOOK_TIMEOUT_SECONDS = 30;
+    static constexpr int DEFAULT_HOOK_CONCURRENCY = 2;
+    static constexpr int MAX_HOOK_CONCURRENCY = 8;
 
     void saveSettings();
     void loadSettings();
@@ -65,6 +87,16 @@ private:
     // Sound settings
     QString m_workEndSound;
     QString m_breakEndSound;
+    int m_workEndVolume = DEFAULT_CUE_VOLUME;
+    int m_breakEndVolume = DEFAULT_CUE_VOLUME;
+
+    // Goals
+    int m_weeklyGoalMinutes = DEFAULT_WEEKLY_GOAL_MINUTES;
+
+    // Hooks
+    QHash<QString, QString> m_hookCommands;
+    int m_hookTimeoutSeconds = DEFAULT_HOOK_TIMEOUT_SECONDS;
+    int m_hookConcurrency = DEFAULT_HOOK_CONCURRENCY;
 };
 
 #endif // POMODOROCONFIG_H
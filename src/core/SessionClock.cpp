@@ -0,0 +1,188 @@
+#include "SessionClock.h"
+#include "SessionHistory.h"
+#include <QDateTime>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#include <time.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+SessionClock::SessionClock(GapPolicy policy)
+    : m_policy(policy)
+{
+    m_monotonic.start();
+}
+
+void SessionClock::start()
+{
+    if (m_running) {
+        return;
+    }
+    if (m_startWallMs == 0) {
+        m_startWallMs = QDateTime::currentMSecsSinceEpoch();
+    }
+    m_running = true;
+    mark();
+}
+
+void SessionClock::stop()
+{
+    if (!m_running) {
+        return;
+    }
+    poll();
+    m_running = false;
+}
+
+void SessionClock::reset()
+{
+    m_running = false;
+    m_activeMs = 0;
+    m_startWallMs = 0;
+    m_flags = 0;
+}
+
+SessionClock::Event SessionClock::restore(qint64 activeMs, qint64 startWallMs, quint8 flags, qint64 downtimeMs)
+{
+    m_running = false;
+    m_activeMs = qMax<qint64>(0, activeMs);
+    m_startWallMs = startWallMs;
+    m_flags = flags;
+
+    Event event;
+    if (downtimeMs <= GAP_THRESHOLD_MS) {
+        // A quick restart; the session simply kept going
+        m_activeMs += qMax<qint64>(0, downtimeMs);
+        return event;
+    }
+
+    event.gapMs = downtimeMs;
+    if (m_policy == GapPolicy::Count) {
+        m_activeMs += downtimeMs;
+        m_flags |= SessionGapCounted;
+    } else {
+        m_flags |= SessionGapExcluded;
+    }
+    return event;
+}
+
+SessionClock::Event SessionClock::poll()
+{
+    Event event;
+    if (!m_running) {
+        return event;
+    }
+
+    const qint64 monotonic = m_monotonic.elapsed();
+    const qint64 awake = awakeMs(m_monotonic);
+    const qint64 boot = bootMs(m_monotonic);
+    const qint64 wall = QDateTime::currentMSecsSinceEpoch();
+
+    // The boot clock also covers time spent suspended
+    const qint64 bootDelta = boot - m_lastBootMs;
+    const qint64 elapsed = qMax(monotonic - m_lastMonotonicMs, bootDelta);
+    const qint64 wallDelta = wall - m_lastWallMs;
+    const qint64 suspended = bootDelta - (awake - m_lastAwakeMs);
+
+    if (suspended > GAP_THRESHOLD_MS) {
+        event.gapMs = suspended;
+        if (m_policy == GapPolicy::Count) {
+            m_activeMs += elapsed;
+            m_flags |= SessionGapCounted;
+        } else {
+            m_activeMs += qMax<qint64>(0, elapsed - suspended);
+            m_flags |= SessionGapExcluded;
+        }
+    } else {
+        m_activeMs += elapsed;
+    }
+
+    // The wall clock moved differently from real time: shift the start with it
+    if (qAbs(wallDelta - elapsed) > WALL_STEP_THRESHOLD_MS) {
+        m_startWallMs += wallDelta - elapsed;
+        m_flags |= SessionClockStepped;
+        event.wallStepped = true;
+    }
+
+    m_lastMonotonicMs = monotonic;
+    m_lastAwakeMs = awake;
+    m_lastBootMs = boot;
+    m_lastWallMs = wall;
+
+    if (event.gapMs > 0 && m_policy == GapPolicy::Pause) {
+        m_running = false;
+    }
+    return event;
+}
+
+qint64 SessionClock::activeMs() const
+{
+    if (!m_running) {
+        return m_activeMs;
+    }
+    return m_activeMs + (m_monotonic.elapsed() - m_lastMonotonicMs);
+}
+
+bool SessionClock::parsePolicy(const QString &name, GapPolicy &policy)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == QLatin1String("pause")) {
+        policy = GapPolicy::Pause;
+    } else if (key == QLatin1String("count")) {
+        policy = GapPolicy::Count;
+    } else if (key == QLatin1String("discard")) {
+        policy = GapPolicy::Discard;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString SessionClock::policyName(GapPolicy policy)
+{
+    switch (policy) {
+    case GapPolicy::Count: return QStringLiteral("count");
+    case GapPolicy::Discard: return QStringLiteral("discard");
+    case GapPolicy::Pause: break;
+    }
+    return QStringLiteral("pause");
+}
+
+qint64 SessionClock::awakeMs(const QElapsedTimer &monotonic)
+{
+#if defined(Q_OS_WIN)
+    // The performance counter behind QElapsedTimer keeps counting through sleep
+    ULONGLONG unbiased = 0;
+    if (QueryUnbiasedInterruptTime(&unbiased)) {
+        return static_cast<qint64>(unbiased / 10000);
+    }
+#endif
+    // CLOCK_MONOTONIC on Linux and mach_absolute_time on macOS stop while suspended
+    return monotonic.elapsed();
+}
+
+qint64 SessionClock::bootMs(const QElapsedTimer &monotonic)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#if defined(Q_OS_LINUX)
+    constexpr clockid_t clock = CLOCK_BOOTTIME;
+#else
+    constexpr clockid_t clock = CLOCK_MONOTONIC;    // keeps counting through sleep on macOS
+#endif
+    timespec now{};
+    if (clock_gettime(clock, &now) == 0) {
+        return static_cast<qint64>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+    }
+#endif
+    // Windows' monotonic clock already includes sleep
+    return monotonic.elapsed();
+}
+
+void SessionClock::mark()
+{
+    m_lastMonotonicMs = m_monotonic.elapsed();
+    m_lastAwakeMs = awakeMs(m_monotonic);
+    m_lastBootMs = bootMs(m_monotonic);
+    m_lastWallMs = QDateTime::currentMSecsSinceEpoch();
+}
@@ -0,0 +1,83 @@
+#ifndef SESSIONCLOCK_H
+#define SESSIONCLOCK_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+// Measures how long a session has really been running.
+//
+// Active time comes from the monotonic clock, so wall-clock or NTP steps never
+// change it. poll() is called on every timer tick and compares the clocks
+// since the previous poll: awake time, boot time (which keeps running while
+// the machine is suspended) and wall time. Only time the boot clock saw and
+// the awake clock did not is a gap, resolved by the GapPolicy; a stalled event
+// loop was awake all along and simply counts as active time. A wall-clock
+// disagreement with real time is a clock step; the session start is shifted
+// along with it so the recorded start and duration stay consistent.
+class SessionClock
+{
+public:
+    enum class GapPolicy {
+        Pause,      // leave the gap out and stop the timer until the user resumes
+        Count,      // the gap counts as session time
+        Discard     // leave the gap out and keep running
+    };
+
+    struct Event {
+        qint64 gapMs = 0;           // time suspended since the last poll, 0 if none
+        bool wallStepped = false;
+    };
+
+    explicit SessionClock(GapPolicy policy = GapPolicy::Pause);
+
+    void setPolicy(GapPolicy policy) { m_policy = policy; }
+    [[nodiscard]] GapPolicy policy() const { return m_policy; }
+
+    // Starts a new session, or resumes one after stop()
+    void start();
+    // Pauses; active time so far is kept
+    void stop();
+    // Forgets the session
+    void reset();
+    // Continues a session saved earlier; stopped until start(). downtimeMs is
+    // how long a running session went unobserved (the app was closed or had
+    // crashed); it is a gap like a suspend and is resolved by the policy
+    Event restore(qint64 activeMs, qint64 startWallMs, quint8 flags, qint64 downtimeMs = 0);
+
+    Event poll();
+
+    [[nodiscard]] bool isRunning() const { return m_running; }
+    [[nodiscard]] qint64 activeMs() const;
+    // Wall time of the first start, corrected for clock steps since then
+    [[nodiscard]] qint64 startWallMs() const { return m_startWallMs; }
+    // SessionFlag bits describing how the session was reconciled
+    [[nodiscard]] quint8 flags() const { return m_flags; }
+
+    static bool parsePolicy(const QString &name, GapPolicy &policy);
+    static QString policyName(GapPolicy policy);
+
+    // Suspends shorter than this are treated as clock jitter
+    static constexpr qint64 GAP_THRESHOLD_MS = 5000;
+    static constexpr qint64 WALL_STEP_THRESHOLD_MS = 2000;
+
+private:
+    // Excludes time suspended; boot time includes it
+    static qint64 awakeMs(const QElapsedTimer &monotonic);
+    static qint64 bootMs(const QElapsedTimer &monotonic);
+    void mark();
+
+    GapPolicy m_policy;
+    QElapsedTimer m_monotonic;
+
+    bool m_running = false;
+    qint64 m_activeMs = 0;          // up to the last poll
+    qint64 m_startWallMs = 0;
+    quint8 m_flags = 0;
+
+    qint64 m_lastMonotonicMs = 0;
+    qint64 m_lastAwakeMs = 0;
+    qint64 m_lastBootMs = 0;
+    qint64 m_lastWallMs = 0;
+};
+
+#endif // SESSIONCLOCK_H
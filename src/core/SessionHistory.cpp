@@ -0,0 +1,598 @@
+#include "SessionHistory.h"
+#include "BackgroundWriter.h"
+#include "HistoryArchive.h"
+#include "SqliteHistoryStore.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QtEndian>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    const QString HISTORY_FILE = QStringLiteral("history.dat");
+    const QString TAGS_FILE = QStringLiteral("tags.txt");
+    const QString ARCHIVE_FILE = QStringLiteral("history.archive");
+    const QString FORECAST_FILE = QStringLiteral("forecast.dat");
+    const QString LOCK_FILE = QStringLiteral("history.lock");
+
+    void writeRecord(QDataStream& stream, const SessionRecord& record)
+    {
+        stream << record.id
+               << record.startTime
+               << record.duration
+               << static_cast<quint8>(record.type)
+               << record.flags
+               << record.tagId;
+    }
+
+    bool readRecord(QDataStream& stream, SessionRecord& record)
+    {
+        quint8 type = 0;
+        stream >> record.id
+               >> record.startTime
+               >> record.duration
+               >> type
+               >> record.flags
+               >> record.tagId;
+        record.type = static_cast<TimerState>(type);
+        return stream.status() == QDataStream::Ok;
+    }
+
+    void addToRollup(QMap<QDate, DailyRollup>& rollups, const SessionRecord& record)
+    {
+        DailyRollup& rollup = rollups[QDateTime::fromSecsSinceEpoch(record.startTime).date()];
+        if (record.type == TimerState::Work) {
+            rollup.workSeconds += static_cast<int>(record.duration);
+            rollup.sessions++;
+            if (record.flags & SessionSkipped) {
+                rollup.skippedSessions++;
+            }
+        } else {
+            rollup.breakSeconds += static_cast<int>(record.duration);
+        }
+    }
+}
+
+SessionHistory& SessionHistory::instance()
+{
+    static SessionHistory history;
+    return history;
+}
+
+SessionHistory::SessionHistory()
+    : m_archive(std::make_unique<HistoryArchive>())
+{
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(m_directory);
+    m_file.setFileName(m_directory + "/" + HISTORY_FILE);
+
+    loadTags();
+    load();
+}
+
+SessionHistory::~SessionHistory() = default;
+
+QString SessionHistory::lockFilePath()
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(directory);
+    return directory + "/" + LOCK_FILE;
+}
+
+QString SessionHistory::archiveFilePath() const
+{
+    return m_directory + "/" + ARCHIVE_FILE;
+}
+
+QString SessionHistory::normalizedTag(const QString& name)
+{
+    QString line = name;
+    line.replace('\r', ' ');
+    line.replace('\n', ' ');
+    return line.trimmed();
+}
+
+quint16 SessionHistory::internTag(const QString& name)
+{
+    const QString line = normalizedTag(name);
+    if (line.isEmpty()) return 0;
+
+    if (const quint16 existing = m_tagIds.value(line, 0)) {
+        return existing;
+    }
+    // The line number is the tag ID; past the ID range sessions stay untagged
+    if (m_tagNames.size() >= std::numeric_limits<quint16>::max()) return 0;
+
+    m_tagNames.append(line);
+    const auto id = static_cast<quint16>(m_tagNames.size());
+    m_tagIds.insert(line, id);
+    saveTags();
+    return id;
+}
+
+QString SessionHistory::tagName(quint16 id) const
+{
+    if (id == 0 || id > m_tagNames.size()) return QString();
+    return m_tagNames.at(id - 1);
+}
+
+const SessionRecord& SessionHistory::append(SessionRecord record)
+{
+    record.id = m_nextId.fetch_add(1);
+    BackgroundWriter::instance().post([this, record]() { writeRecords({record}); });
+
+    m_records.append(record);
+    index(record);
+
+    // The SQLite copy, when enabled, is written on its own thread
+    SqliteHistoryStore::instance().enqueue({record}, m_tagNames);
+    return m_records.constLast();
+}
+
+SessionRecord SessionHistory::decodeRecord(const uchar *data)
+{
+    SessionRecord record;
+    record.id = qFromLittleEndian<quint32>(data);
+    record.startTime = qFromLittleEndian<qint64>(data + 4);
+    record.duration = qFromLittleEndian<quint32>(data + 12);
+    record.type = static_cast<TimerState>(data[16]);
+    record.flags = data[17];
+    record.tagId = qFromLittleEndian<quint16>(data + 18);
+    return record;
+}
+
+std::optional<SessionRecord> SessionHistory::record(quint32 id) const
+{
+    // IDs are assigned in append order, so the log is sorted by ID
+    const auto it = std::lower_bound(m_records.cbegin(), m_records.cend(), id,
+                                     [](const SessionRecord& record, quint32 value) { return record.id < value; });
+    if (it != m_records.cend() && it->id == id) return *it;
+    return m_archive->find(id);
+}
+
+bool SessionHistory::archiveBefore(const QDateTime& cutoff)
+{
+    const qint64 cutoffSecs = cutoff.toSecsSinceEpoch();
+
+    QVector<SessionRecord> hot;
+    QVector<SessionRecord> cold;
+    hot.reserve(m_records.size());
+    for (const SessionRecord& record : std::as_const(m_records)) {
+        (record.startTime < cutoffSecs ? cold : hot).append(record);
+    }
+    if (cold.isEmpty()) return true;
+
+    // Only the sessions turning cold are encoded, as blocks appended to the
+    // archive; the compactor merges them with the rest when it next rewrites it
+    const QString archivePath = archiveFilePath();
+    releaseArchive();
+    const bool archived = HistoryArchive::append(archivePath, cold, m_tagNames, cutoffSecs);
+    m_archive->load(archivePath, [this](const QString& name) { return internTag(name); });
+    if (!archived) {
+        applyArchive(1);
+        return false;
+    }
+
+    // If this fails the archived sessions stay in the log too; load() skips them
+    const bool rewritten = rewriteLog(hot);
+
+    // Either way they are served by the archive from now on. Only the live
+    // sessions are indexed one by one, and this runs once at startup
+    m_records = hot;
+    rebuildIndexes();
+    return rewritten;
+}
+
+bool SessionHistory::writeBatch(SessionBatch& batch)
+{
+    if (batch.records.isEmpty()) return true;
+
+    // IDs are reserved up front; a failed write leaves a gap, never a duplicate
+    quint32 id = m_nextId.fetch_add(static_cast<quint32>(batch.records.size()));
+    for (SessionRecord& record : batch.records) {
+        record.id = id++;
+    }
+    if (!writeRecords(batch.records)) return false;
+
+    for (const SessionRecord& record : std::as_const(batch.records)) {
+        addToRollup(batch.dailyRollups, record);
+        batch.analytics.add(record);
+        if (record.tagId != 0) {
+            const qint64 work = record.type == TimerState::Work ? record.duration : 0;
+            batch.tagged[record.tagId].append({record.startTime, work});
+        }
+    }
+    for (auto it = batch.tagged.begin(); it != batch.tagged.end(); ++it) {
+        std::stable_sort(it->begin(), it->end(), [](const SessionBatch::TaggedSession& a,
+                                                     const SessionBatch::TaggedSession& b) {
+            return a.startTime < b.startTime;
+        });
+    }
+    return true;
+}
+
+void SessionHistory::commitBatch(const SessionBatch& batch)
+{
+    if (batch.records.isEmpty()) return;
+
+    // Sessions recorded while the batch was being written have later IDs; keep
+    // m_records sorted by ID by slotting the batch in ahead of them
+    const int oldSize = static_cast<int>(m_records.size());
+    const auto position = std::lower_bound(m_records.begin(), m_records.end(), batch.records.constFirst().id,
+                                           [](const SessionRecord& record, quint32 value) { return record.id < value; });
+    const int at = static_cast<int>(position - m_records.begin());
+    m_records.append(batch.records);
+    std::rotate(m_records.begin() + at, m_records.begin() + oldSize, m_records.end());
+
+    for (auto it = batch.dailyRollups.cbegin(); it != batch.dailyRollups.cend(); ++it) {
+        DailyRollup& day = m_dailyRollups[it.key()];
+        day.workSeconds += it->workSeconds;
+        day.breakSeconds += it->breakSeconds;
+        day.sessions += it->sessions;
+        day.skippedSessions += it->skippedSessions;
+    }
+    m_analytics.merge(batch.analytics);
+    for (auto it = batch.tagged.cbegin(); it != batch.tagged.cend(); ++it) {
+        mergeTagEntries(m_tagIndex[it.key()], it.value());
+    }
+
+    // Imported days may predate the fitted ones; the next fit starts over
+    setForecast(FocusForecast());
+
+    SqliteHistoryStore::instance().enqueue(batch.records, m_tagNames);
+}
+
+void SessionHistory::mergeTagEntries(TagIndex& entry, const QVector<SessionBatch::TaggedSession>& sessions)
+{
+    // One merge pass of two sorted runs; existing entries may be rollups of
+    // several sessions, so their counts are recovered from the running totals
+    TagIndex merged;
+    const int total = static_cast<int>(entry.startTimes.size() + sessions.size());
+    merged.startTimes.reserve(total);
+    merged.cumulativeWork.reserve(total);
+    merged.cumulativeSessions.reserve(total);
+
+    qint64 work = 0;
+    int count = 0;
+    int i = 0;
+    int j = 0;
+    while (i < entry.startTimes.size() || j < sessions.size()) {
+        const bool existing = j >= sessions.size()
+            || (i < entry.startTimes.size() && entry.startTimes.at(i) <= sessions.at(j).startTime);
+        if (existing) {
+            work += entry.cumulativeWork.at(i) - (i > 0 ? entry.cumulativeWork.at(i - 1) : 0);
+            count += entry.cumulativeSessions.at(i) - (i > 0 ? entry.cumulativeSessions.at(i - 1) : 0);
+            merged.startTimes.append(entry.startTimes.at(i));
+            ++i;
+        } else {
+            work += sessions.at(j).workSeconds;
+            ++count;
+            merged.startTimes.append(sessions.at(j).startTime);
+            ++j;
+        }
+        merged.cumulativeWork.append(work);
+        merged.cumulativeSessions.append(count);
+    }
+    entry = std::move(merged);
+}
+
+qint64 SessionHistory::tagWorkSeconds(quint16 tagId, const QDateTime& from, const QDateTime& to) const
+{
+    qint64 total = 0;
+    for (const QHash<quint16, TagIndex>* index : {&m_tagIndex, &m_archiveTagIndex}) {
+        const auto it = index->constFind(tagId);
+        if (it == index->constEnd()) continue;
+
+        const auto [first, last] = tagRange(*it, from, to);
+        if (first >= last) continue;
+        const qint64 before = first > 0 ? it->cumulativeWork.at(first - 1) : 0;
+        total += it->cumulativeWork.at(last - 1) - before;
+    }
+    return total;
+}
+
+int SessionHistory::tagSessionCount(quint16 tagId, const QDateTime& from, const QDateTime& to) const
+{
+    int total = 0;
+    for (const QHash<quint16, TagIndex>* index : {&m_tagIndex, &m_archiveTagIndex}) {
+        const auto it = index->constFind(tagId);
+        if (it == index->constEnd()) continue;
+
+        const auto [first, last] = tagRange(*it, from, to);
+        if (first >= last) continue;
+        const int before = first > 0 ? it->cumulativeSessions.at(first - 1) : 0;
+        total += it->cumulativeSessions.at(last - 1) - before;
+    }
+    return total;
+}
+
+QPair<int, int> SessionHistory::tagRange(const TagIndex& entry, const QDateTime& from, const QDateTime& to)
+{
+    const QVector<qint64>& starts = entry.startTimes;
+    const qint64 fromSecs = from.isValid() ? from.toSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    const qint64 toSecs = to.isValid() ? to.toSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+
+    const auto first = std::lower_bound(starts.cbegin(), starts.cend(), fromSecs);
+    const auto last = std::lower_bound(first, starts.cend(), toSecs);
+    return {static_cast<int>(first - starts.cbegin()), static_cast<int>(last - starts.cbegin())};
+}
+
+void SessionHistory::load()
+{
+    m_archive->load(archiveFilePath(), [this](const QString& name) { return internTag(name); });
+    loadRecords();
+
+    // The archive remembers IDs of sessions long folded into rollups, so they are never handed out again
+    const quint32 lastId = m_records.isEmpty() ? 0 : m_records.constLast().id;
+    m_nextId.store(qMax(lastId + 1, m_archive->nextId()));
+    rebuildIndexes();
+    FocusForecast::load(m_directory + "/" + FORECAST_FILE, m_forecast);
+}
+
+void SessionHistory::loadRecords()
+{
+    if (!m_file.exists()) return;
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SessionHistory: cannot read" << m_file.fileName();
+        return;
+    }
+
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != FILE_MAGIC || version != FILE_VERSION) {
+        qWarning() << "SessionHistory: unsupported history file" << m_file.fileName();
+        m_file.close();
+        return;
+    }
+
+    const qint64 available = (m_file.size() - m_file.pos()) / SessionRecord::ENCODED_SIZE;
+    m_records.reserve(static_cast<int>(available));
+
+    // Sessions left behind by an interrupted archive pass are already in the archive
+    const quint32 archivedBelow = m_archive->nextId();
+    const qint64 archivedBefore = m_archive->cutoff();
+
+    SessionRecord record;
+    while (!stream.atEnd() && readRecord(stream, record)) {
+        if (record.id < archivedBelow && record.startTime < archivedBefore) continue;
+        m_records.append(record);
+    }
+    m_file.close();
+
+    // IDs are reserved before the writes are queued, so a session finished
+    // during an import can be written after the batch that follows it
+    const auto byId = [](const SessionRecord& a, const SessionRecord& b) { return a.id < b.id; };
+    if (!std::is_sorted(m_records.cbegin(), m_records.cend(), byId)) {
+        std::sort(m_records.begin(), m_records.end(), byId);
+    }
+}
+
+void SessionHistory::loadTags()
+{
+    QFile file(m_directory + "/" + TAGS_FILE);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        const QString name = stream.readLine();
+        m_tagNames.append(name);
+        m_tagIds.insert(name, static_cast<quint16>(m_tagNames.size()));
+    }
+}
+
+void SessionHistory::saveTags()
+{
+    // The whole list every time: tags are few and rarely added, and a failed
+    // write cannot leave later IDs on the wrong line
+    QByteArray data;
+    for (const QString& name : std::as_const(m_tagNames)) {
+        data += name.toUtf8();
+        data += '\n';
+    }
+    BackgroundWriter::instance().replace(m_directory + "/" + TAGS_FILE, data);
+}
+
+void SessionHistory::index(const SessionRecord& record)
+{
+    addToRollup(m_dailyRollups, record);
+    m_analytics.add(record);
+
+    if (record.tagId != 0) {
+        TagIndex& entry = m_tagIndex[record.tagId];
+        const qint64 work = record.type == TimerState::Work ? record.duration : 0;
+
+        // Live sessions arrive in order; anything older is inserted in place
+        const auto position = std::upper_bound(entry.startTimes.begin(), entry.startTimes.end(), record.startTime);
+        const int at = static_cast<int>(position - entry.startTimes.begin());
+        entry.startTimes.insert(at, record.startTime);
+        entry.cumulativeWork.insert(at, at > 0 ? entry.cumulativeWork.at(at - 1) : 0);
+        entry.cumulativeSessions.insert(at, at > 0 ? entry.cumulativeSessions.at(at - 1) : 0);
+        for (int i = at; i < entry.cumulativeWork.size(); ++i) {
+            entry.cumulativeWork[i] += work;
+            entry.cumulativeSessions[i]++;
+        }
+    }
+}
+
+void SessionHistory::rebuildIndexes()
+{
+    m_dailyRollups.clear();
+    m_monthlyRollups.clear();
+    m_analytics.clear();
+    m_tagIndex.clear();
+    m_archiveTagIndex.clear();
+
+    QHash<quint16, QVector<TagEntry>> tagged;
+    for (const SessionRecord& record : std::as_const(m_records)) {
+        addToRollup(m_dailyRollups, record);
+        m_analytics.add(record);
+        if (record.tagId != 0) {
+            const qint64 work = record.type == TimerState::Work ? record.duration : 0;
+            tagged[record.tagId].append({record.startTime, work, 1});
+        }
+    }
+    buildTagIndex(m_tagIndex, tagged);
+
+    applyArchive(1);
+}
+
+void SessionHistory::applyArchive(int sign)
+{
+    // The archive contributes its index only, never a decoded block: one entry
+    // per tag and day for the raw blocks, and one per rollup for compacted
+    // history, each dated at the start of its period. Every statistics range
+    // is whole days, so nothing finer is needed
+    if (sign > 0) {
+        m_analytics.merge(m_archive->analytics());
+    } else {
+        m_analytics.subtract(m_archive->analytics());
+    }
+
+    QHash<quint16, QVector<TagEntry>> tagged;
+    for (const QVector<HistoryArchive::Rollup>* rollups : {&m_archive->blockDays(), &m_archive->rollups()}) {
+        for (const HistoryArchive::Rollup& rollup : *rollups) {
+            const QDate date = QDate::fromJulianDay(rollup.julianDay);
+            QMap<QDate, DailyRollup>& totals = rollup.period == HistoryArchive::RollupPeriod::Month
+                ? m_monthlyRollups : m_dailyRollups;
+            auto day = totals.find(date);
+            if (day == totals.end()) {
+                day = totals.insert(date, DailyRollup());
+            }
+            day->workSeconds += sign * static_cast<int>(rollup.workSeconds);
+            day->breakSeconds += sign * static_cast<int>(rollup.breakSeconds);
+            day->sessions += sign * static_cast<int>(rollup.sessions);
+            day->skippedSessions += sign * static_cast<int>(rollup.skippedSessions);
+            if (day->workSeconds == 0 && day->breakSeconds == 0 && day->sessions == 0) {
+                totals.erase(day);
+            }
+
+            if (sign > 0 && rollup.tagId != 0) {
+                tagged[rollup.tagId].append({date.startOfDay().toSecsSinceEpoch(), rollup.workSeconds,
+                                             static_cast<int>(rollup.sessions)});
+            }
+        }
+    }
+
+    m_archiveTagIndex.clear();
+    buildTagIndex(m_archiveTagIndex, tagged);
+}
+
+void SessionHistory::buildTagIndex(QHash<quint16, TagIndex>& index, QHash<quint16, QVector<TagEntry>>& tagged)
+{
+    for (auto it = tagged.begin(); it != tagged.end(); ++it) {
+        QVector<TagEntry>& entries = it.value();
+        std::stable_sort(entries.begin(), entries.end(), [](const TagEntry& a, const TagEntry& b) {
+            return a.startTime < b.startTime;
+        });
+
+        TagIndex& entry = index[it.key()];
+        entry.startTimes.reserve(entries.size());
+        entry.cumulativeWork.reserve(entries.size());
+        entry.cumulativeSessions.reserve(entries.size());
+        qint64 work = 0;
+        int sessions = 0;
+        for (const TagEntry& tagEntry : std::as_const(entries)) {
+            work += tagEntry.work;
+            sessions += tagEntry.sessions;
+            entry.startTimes.append(tagEntry.startTime);
+            entry.cumulativeWork.append(work);
+            entry.cumulativeSessions.append(sessions);
+        }
+    }
+}
+
+void SessionHistory::setForecast(const FocusForecast& forecast)
+{
+    m_forecast = forecast;
+    ++m_forecastGeneration;
+    const QString path = m_directory + "/" + FORECAST_FILE;
+    BackgroundWriter::instance().post([forecast, path]() { forecast.save(path); });
+}
+
+void SessionHistory::releaseArchive()
+{
+    // A closed archive has no totals left, so releasing twice takes back nothing
+    applyArchive(-1);
+    m_archive->close();
+}
+
+void SessionHistory::reloadArchive()
+{
+    releaseArchive();
+    m_archive->load(archiveFilePath(), [this](const QString& name) { return internTag(name); });
+    applyArchive(1);
+}
+
+bool SessionHistory::writeRecords(const QVector<SessionRecord>& records)
+{
+    QMutexLocker locker(&m_writeMutex);
+    if (!openForAppend()) return false;
+
+    QByteArray buffer;
+    buffer.reserve(records.size() * SessionRecord::ENCODED_SIZE);
+    QDataStream stream(&buffer, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    for (const SessionRecord& record : records) {
+        writeRecord(stream, record);
+    }
+    if (m_file.write(buffer) != buffer.size() || !m_file.flush()) {
+        qWarning() << "SessionHistory: cannot write" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SessionHistory::rewriteLog(const QVector<SessionRecord>& records)
+{
+    // Appends still queued would land in the file being replaced
+    BackgroundWriter::instance().flush();
+    QMutexLocker locker(&m_writeMutex);
+    m_file.close();
+
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "SessionHistory: cannot write" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << FILE_MAGIC << FILE_VERSION;
+    for (const SessionRecord& record : records) {
+        writeRecord(stream, record);
+    }
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "SessionHistory: cannot write" << file.fileName() << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SessionHistory::openForAppend()
+{
+    if (m_file.isOpen() && m_file.isWritable()) return true;
+    if (m_file.isOpen()) m_file.close();
+
+    const bool isNew = !m_file.exists() || m_file.size() == 0;
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "SessionHistory: cannot write" << m_file.fileName();
+        return false;
+    }
+
+    if (isNew) {
+        QDataStream stream(&m_file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << FILE_MAGIC << FILE_VERSION;
+    }
+    return true;
+}
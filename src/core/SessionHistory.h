@@ -0,0 +1,195 @@
+#ifndef SESSIONHISTORY_H
+#define SESSIONHISTORY_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include "AnalyticsCube.h"
+#include "FocusForecast.h"
+#include "TimerState.h"
+
+class HistoryArchive;
+
+enum SessionFlag : quint8 {
+    SessionSkipped = 0x01,
+    SessionGapCounted = 0x02,       // a suspend gap was counted as session time
+    SessionGapExcluded = 0x04,      // a suspend gap was left out of the duration
+    SessionClockStepped = 0x08      // the wall clock jumped; the start was corrected
+};
+
+// One finished session. Kept fixed-size so the history file can be appended
+// to and replayed without any per-record parsing overhead.
+struct SessionRecord {
+    quint32 id = 0;
+    qint64 startTime = 0;       // seconds since epoch (UTC)
+    quint32 duration = 0;       // seconds
+    TimerState type = TimerState::Work;
+    quint8 flags = 0;
+    quint16 tagId = 0;          // 0 = untagged
+
+    static constexpr int ENCODED_SIZE = 20;
+};
+
+struct DailyRollup {
+    int workSeconds = 0;
+    int breakSeconds = 0;
+    int sessions = 0;
+    int skippedSessions = 0;    // part of sessions
+};
+
+// Imported sessions on their way into the history: written and indexed by
+// SessionHistory::writeBatch() on a worker, merged in by commitBatch()
+struct SessionBatch {
+    struct TaggedSession {
+        qint64 startTime;
+        qint64 workSeconds;
+    };
+
+    QVector<SessionRecord> records;         // tag IDs interned; IDs assigned by writeBatch()
+    QMap<QDate, DailyRollup> dailyRollups;
+    AnalyticsCube analytics;
+    QHash<quint16, QVector<TaggedSession>> tagged;  // sorted by start time
+};
+
+class SessionHistory
+{
+public:
+    static SessionHistory& instance();
+
+    // Tags are interned into small integer IDs; 0 is reserved for "no tag"
+    // and also returned for new tags once all 65535 IDs are taken
+    quint16 internTag(const QString& name);
+    [[nodiscard]] quint16 tagId(const QString& name) const { return m_tagIds.value(normalizedTag(name), 0); }
+    [[nodiscard]] QString tagName(quint16 id) const;
+    [[nodiscard]] const QStringList& tagNames() const { return m_tagNames; }
+
+    // Assigns the record ID and updates every index; the record reaches the
+    // disk on the BackgroundWriter thread
+    const SessionRecord& append(SessionRecord record);
+    // Safe to call from a worker: assigns IDs, persists the records with a
+    // single write and builds the batch's own rollups and indexes
+    bool writeBatch(SessionBatch& batch);
+    // Owning thread, after writeBatch(): merges the batch into every index
+    // without rescanning the history
+    void commitBatch(const SessionBatch& batch);
+
+    // Recent sessions only; anything older than the archive cutoff lives in archive()
+    [[nodiscard]] const QVector<SessionRecord>& records() const { return m_records; }
+    [[nodiscard]] std::optional<SessionRecord> record(quint32 id) const;
+    [[nodiscard]] const QMap<QDate, DailyRollup>& dailyRollups() const { return m_dailyRollups; }
+    // History the compactor folded into whole months, keyed by the first day of the month
+    [[nodiscard]] const QMap<QDate, DailyRollup>& monthlyRollups() const { return m_monthlyRollups; }
+    // Time of day x weekday breakdown, kept current on every append
+    [[nodiscard]] const AnalyticsCube& analytics() const { return m_analytics; }
+    // Weekly and monthly focus forecast, fitted off-thread and stored next to the log
+    [[nodiscard]] const FocusForecast& forecast() const { return m_forecast; }
+    void setForecast(const FocusForecast& forecast);
+    // Changes on every setForecast(), so a fit started from an older model can tell
+    [[nodiscard]] quint64 forecastGeneration() const { return m_forecastGeneration; }
+
+    // Per-tag queries answered from the secondary index in O(log n)
+    [[nodiscard]] qint64 tagWorkSeconds(quint16 tagId, const QDateTime& from, const QDateTime& to) const;
+    [[nodiscard]] int tagSessionCount(quint16 tagId, const QDateTime& from, const QDateTime& to) const;
+
+    // Held by whichever process writes the history (the app or a CLI import):
+    // both hand out record IDs, so two writers would duplicate them. Static,
+    // so it can be taken before the history is loaded
+    static QString lockFilePath();
+
+    [[nodiscard]] const QString& storageDirectory() const { return m_directory; }
+    [[nodiscard]] QString historyFilePath() const { return m_file.fileName(); }
+    [[nodiscard]] QString archiveFilePath() const;
+    [[nodiscard]] const HistoryArchive& archive() const { return *m_archive; }
+
+    // Moves sessions that started before cutoff into the compressed archive and
+    // rewrites the live log with the rest. Costs O(sessions moved), not the
+    // size of the archive, so it can run on every startup. Startup is also the
+    // only safe time: the rewrite would drop a batch written but not yet committed
+    bool archiveBefore(const QDateTime& cutoff);
+    // Unmaps and closes the archive so the compactor can replace the file,
+    // which Windows refuses while it is mapped; its totals leave the indexes
+    void releaseArchive();
+    // Maps the archive again, e.g. once the compactor replaced it. Only the
+    // archive's share of the indexes is redone, from its index alone
+    void reloadArchive();
+
+    // Decodes one on-disk record; lets readers stream the file without the in-memory copy
+    static SessionRecord decodeRecord(const uchar *data);
+
+    static constexpr quint32 FILE_MAGIC = 0x504D4853;  // "PMHS"
+    static constexpr quint16 FILE_VERSION = 1;
+    static constexpr int FILE_HEADER_SIZE = 6;
+
+private:
+    SessionHistory();
+    ~SessionHistory();
+
+    // Disable copy/move
+    SessionHistory(const SessionHistory&) = delete;
+    SessionHistory& operator=(const SessionHistory&) = delete;
+    SessionHistory(SessionHistory&&) = delete;
+    SessionHistory& operator=(SessionHistory&&) = delete;
+
+    // Sessions of one tag in chronological order, with running work totals
+    // so any time range is answered by two binary searches
+    struct TagIndex {
+        QVector<qint64> startTimes;
+        QVector<qint64> cumulativeWork;     // work seconds up to and including entry i
+        QVector<int> cumulativeSessions;
+    };
+    // A session, or a rollup of several, on its way into a TagIndex
+    struct TagEntry {
+        qint64 startTime;
+        qint64 work;
+        int sessions;
+    };
+
+    // Tag names are stored one per line: trimmed, with line breaks as spaces
+    static QString normalizedTag(const QString& name);
+    void load();
+    void loadRecords();
+    void loadTags();
+    void saveTags();
+    void index(const SessionRecord& record);
+    void rebuildIndexes();
+    // Adds (sign 1) or takes back (sign -1) the archive's totals and tag index
+    void applyArchive(int sign);
+    static void buildTagIndex(QHash<quint16, TagIndex>& index, QHash<quint16, QVector<TagEntry>>& tagged);
+    static void mergeTagEntries(TagIndex& entry, const QVector<SessionBatch::TaggedSession>& sessions);
+    bool openForAppend();
+    bool writeRecords(const QVector<SessionRecord>& records);
+    bool rewriteLog(const QVector<SessionRecord>& records);
+    [[nodiscard]] static QPair<int, int> tagRange(const TagIndex& entry, const QDateTime& from, const QDateTime& to);
+
+    QString m_directory;
+    QFile m_file;
+    // Guards m_file between the BackgroundWriter thread and writeBatch()'s
+    // worker; the GUI thread never takes it
+    QMutex m_writeMutex;
+
+    std::unique_ptr<HistoryArchive> m_archive;
+    QVector<SessionRecord> m_records;
+    std::atomic<quint32> m_nextId{1};       // IDs are reserved without m_writeMutex
+    QMap<QDate, DailyRollup> m_dailyRollups;
+    QMap<QDate, DailyRollup> m_monthlyRollups;
+    AnalyticsCube m_analytics;
+    FocusForecast m_forecast;
+    quint64 m_forecastGeneration = 0;
+
+    QStringList m_tagNames;                 // tag ID n is at index n - 1
+    QHash<QString, quint16> m_tagIds;
+    QHash<quint16, TagIndex> m_tagIndex;           // live sessions
+    QHash<quint16, TagIndex> m_archiveTagIndex;    // archived days and rollups, swapped with the archive
+};
+
+#endif // SESSIONHISTORY_H
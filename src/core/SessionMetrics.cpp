@@ -0,0 +1,230 @@
+#include "SessionMetrics.h"
+#include "BackgroundWriter.h"
+#include "SessionHistory.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+    const QString METRICS_FILE = QStringLiteral("metrics.dat");
+
+    qint64 dayOf(const SessionRecord& record)
+    {
+        return QDateTime::fromSecsSinceEpoch(record.startTime).date().toJulianDay();
+    }
+}
+
+SessionMetrics& SessionMetrics::instance()
+{
+    static SessionMetrics metrics;
+    return metrics;
+}
+
+SessionMetrics::SessionMetrics()
+{
+    // Same directory as SessionHistory, without loading the history to find it
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(directory);
+    m_path = directory + "/" + METRICS_FILE;
+    m_needsRebuild = !load();
+}
+
+void SessionMetrics::Window::advanceTo(qint64 day)
+{
+    if (day <= lastDay) return;
+
+    if (lastDay == 0 || day - lastDay >= WINDOW_DAYS) {
+        days.fill({});
+        sums.fill({});
+        lastDay = day;
+        return;
+    }
+
+    while (lastDay < day) {
+        ++lastDay;
+        // Each window drops the day that just slid out of it; the longest one
+        // drops the slot being reused for the new day
+        for (size_t w = 0; w < ROLLING_WINDOWS.size(); ++w) {
+            const Day& leaving = days[(lastDay - ROLLING_WINDOWS[w]) % WINDOW_DAYS];
+            sums[w].workSeconds -= leaving.workSeconds;
+            sums[w].sessions -= leaving.sessions;
+        }
+        days[lastDay % WINDOW_DAYS] = {};
+    }
+}
+
+void SessionMetrics::Window::add(qint64 day, qint64 workSeconds, int sessions)
+{
+    advanceTo(day);
+    if (day <= lastDay - WINDOW_DAYS) return;
+
+    Day& slot = days[day % WINDOW_DAYS];
+    slot.workSeconds += workSeconds;
+    slot.sessions += sessions;
+    for (size_t w = 0; w < ROLLING_WINDOWS.size(); ++w) {
+        if (day > lastDay - ROLLING_WINDOWS[w]) {
+            sums[w].workSeconds += workSeconds;
+            sums[w].sessions += sessions;
+        }
+    }
+}
+
+void SessionMetrics::addWorkDay(qint64 day)
+{
+    // A late session for an earlier day cannot extend the streak that follows it
+    if (day <= m_streakEnd) return;
+
+    m_currentStreak = (m_streakEnd != 0 && day == m_streakEnd + 1) ? m_currentStreak + 1 : 1;
+    m_streakEnd = day;
+    m_bestStreak = qMax(m_bestStreak, m_currentStreak);
+}
+
+void SessionMetrics::add(const SessionRecord& record, int interruptions)
+{
+    if (record.type != TimerState::Work) return;
+
+    const qint64 day = dayOf(record);
+    if (record.flags & SessionSkipped) {
+        ++m_skipped;
+    } else {
+        ++m_finished;
+        addWorkDay(day);
+    }
+    m_window.add(day, record.duration, 1);
+    m_interruptions += static_cast<quint64>(qMax(0, interruptions));
+    ++m_trackedSessions;
+
+    save();
+}
+
+void SessionMetrics::rebuild(const SessionHistory& history)
+{
+    m_window = Window();
+    m_streakEnd = 0;
+    m_currentStreak = 0;
+    m_bestStreak = 0;
+    m_finished = 0;
+    m_skipped = 0;
+
+    // The history keeps per-day rollups, so this costs O(days) rather than O(sessions)
+    const QMap<QDate, DailyRollup>& days = history.dailyRollups();
+    for (auto it = days.cbegin(); it != days.cend(); ++it) {
+        const DailyRollup& rollup = it.value();
+        if (rollup.sessions == 0) continue;
+
+        const qint64 day = it.key().toJulianDay();
+        const int finished = rollup.sessions - rollup.skippedSessions;
+        m_finished += static_cast<quint32>(finished);
+        m_skipped += static_cast<quint32>(rollup.skippedSessions);
+        if (finished > 0) {
+            addWorkDay(day);
+        }
+        m_window.add(day, rollup.workSeconds, rollup.sessions);
+    }
+
+    // Monthly rollups count towards the totals but have no days to form a streak
+    for (const DailyRollup& rollup : history.monthlyRollups()) {
+        m_finished += static_cast<quint32>(rollup.sessions - rollup.skippedSessions);
+        m_skipped += static_cast<quint32>(rollup.skippedSessions);
+    }
+
+    m_needsRebuild = false;
+    save();
+}
+
+int SessionMetrics::currentStreak(const QDate& today) const
+{
+    // Still alive until a whole day passes without a finished session
+    const qint64 sinceLast = today.toJulianDay() - m_streakEnd;
+    return (m_streakEnd != 0 && sinceLast >= 0 && sinceLast <= 1) ? m_currentStreak : 0;
+}
+
+SessionMetrics::Average SessionMetrics::rollingAverage(int days, const QDate& today) const
+{
+    const auto found = std::find(ROLLING_WINDOWS.cbegin(), ROLLING_WINDOWS.cend(), days);
+    if (found == ROLLING_WINDOWS.cend()) {
+        qWarning() << "SessionMetrics: no rolling window of" << days << "days";
+        return {};
+    }
+    const size_t w = static_cast<size_t>(found - ROLLING_WINDOWS.cbegin());
+
+    // Idle days since the last session still have to leave the window; do that on a copy
+    Window window = m_window;
+    window.advanceTo(today.toJulianDay());
+    if (window.lastDay == 0) return {};
+
+    const Day& sum = window.sums[w];
+    return {static_cast<double>(sum.workSeconds) / 60.0 / days, static_cast<double>(sum.sessions) / days};
+}
+
+double SessionMetrics::completionRate() const
+{
+    const quint32 total = m_finished + m_skipped;
+    return total > 0 ? static_cast<double>(m_finished) / total : 0.0;
+}
+
+double SessionMetrics::averageInterruptions() const
+{
+    return m_trackedSessions > 0 ? static_cast<double>(m_interruptions) / m_trackedSessions : 0.0;
+}
+
+bool SessionMetrics::load()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != FILE_MAGIC || version != FILE_VERSION) {
+        qWarning() << "SessionMetrics: ignoring unsupported" << m_path;
+        return false;
+    }
+
+    Window window;
+    stream >> window.lastDay;
+    for (Day& day : window.days) {
+        stream >> day.workSeconds >> day.sessions;
+    }
+    for (Day& sum : window.sums) {
+        stream >> sum.workSeconds >> sum.sessions;
+    }
+    stream >> m_streakEnd >> m_currentStreak >> m_bestStreak
+           >> m_finished >> m_skipped >> m_interruptions >> m_trackedSessions;
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "SessionMetrics: ignoring unreadable" << m_path;
+        // rebuild() restores the rest; interruption counts start over
+        m_interruptions = 0;
+        m_trackedSessions = 0;
+        return false;
+    }
+    m_window = window;
+    return true;
+}
+
+void SessionMetrics::save() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << FILE_MAGIC << FILE_VERSION << m_window.lastDay;
+    for (const Day& day : m_window.days) {
+        stream << day.workSeconds << day.sessions;
+    }
+    for (const Day& sum : m_window.sums) {
+        stream << sum.workSeconds << sum.sessions;
+    }
+    stream << m_streakEnd << m_currentStreak << m_bestStreak
+           << m_finished << m_skipped << m_interruptions << m_trackedSessions;
+
+    BackgroundWriter::instance().replace(m_path, data);
+}
@@ -0,0 +1,101 @@
+#ifndef SESSIONMETRICS_H
+#define SESSIONMETRICS_H
+
+#include <QDate>
+#include <QString>
+#include <array>
+
+struct SessionRecord;
+class SessionHistory;
+
+// Streaks, rolling daily averages, completion rate and interruptions,
+// maintained incrementally as sessions are recorded.
+//
+// Rolling windows keep the last WINDOW_DAYS days in a ring indexed by Julian
+// day plus one running sum per window; recording a session touches one slot
+// and the sums it falls into, and moving to a new day retires only the days
+// that left each window. The state is a few hundred bytes written next to the
+// history after every session, off the calling thread, so the figures are
+// there at startup without reading the history. Only a missing or unreadable
+// file, or a bulk import, falls back to rebuild().
+class SessionMetrics
+{
+public:
+    static SessionMetrics& instance();
+
+    struct Average {
+        double workMinutes = 0;             // per calendar day, idle days included
+        double sessions = 0;
+    };
+
+    // Records a finished or skipped session; interruptions are the pauses and
+    // away gaps seen while it ran
+    void add(const SessionRecord& record, int interruptions = 0);
+
+    // Recomputes everything except the interruption totals, which the history
+    // does not keep
+    void rebuild(const SessionHistory& history);
+    [[nodiscard]] bool needsRebuild() const { return m_needsRebuild; }
+
+    // Consecutive days with a finished work session, ending today or yesterday
+    [[nodiscard]] int currentStreak(const QDate& today = QDate::currentDate()) const;
+    [[nodiscard]] int bestStreak() const { return m_bestStreak; }
+
+    // days is one of ROLLING_WINDOWS; the window ends with today
+    [[nodiscard]] Average rollingAverage(int days, const QDate& today = QDate::currentDate()) const;
+
+    // Finished work sessions out of finished + skipped, 0..1
+    [[nodiscard]] double completionRate() const;
+    [[nodiscard]] double averageInterruptions() const;
+    [[nodiscard]] quint32 finishedSessions() const { return m_finished; }
+    [[nodiscard]] quint32 skippedSessions() const { return m_skipped; }
+
+    static constexpr int WINDOW_DAYS = 90;
+    static constexpr std::array<int, 3> ROLLING_WINDOWS{7, 30, 90};
+    static constexpr quint32 FILE_MAGIC = 0x504D4D54;  // "PMMT"
+    static constexpr quint16 FILE_VERSION = 1;
+
+private:
+    SessionMetrics();
+    ~SessionMetrics() = default;
+
+    // Disable copy/move
+    SessionMetrics(const SessionMetrics&) = delete;
+    SessionMetrics& operator=(const SessionMetrics&) = delete;
+    SessionMetrics(SessionMetrics&&) = delete;
+    SessionMetrics& operator=(SessionMetrics&&) = delete;
+
+    struct Day {
+        qint64 workSeconds = 0;
+        qint32 sessions = 0;
+    };
+
+    // The last WINDOW_DAYS days ending at lastDay, with a sum per rolling window
+    struct Window {
+        std::array<Day, WINDOW_DAYS> days{};
+        std::array<Day, ROLLING_WINDOWS.size()> sums{};
+        qint64 lastDay = 0;                 // Julian day; 0 while empty
+
+        void advanceTo(qint64 day);
+        void add(qint64 day, qint64 workSeconds, int sessions);
+    };
+
+    void addWorkDay(qint64 day);
+    bool load();
+    // Serialises the state here and writes it on the BackgroundWriter thread
+    void save() const;
+
+    QString m_path;
+    bool m_needsRebuild{false};
+
+    Window m_window;
+    qint64 m_streakEnd{0};                  // Julian day of the last finished work session
+    qint32 m_currentStreak{0};
+    qint32 m_bestStreak{0};
+    quint32 m_finished{0};
+    quint32 m_skipped{0};
+    quint64 m_interruptions{0};
+    quint32 m_trackedSessions{0};           // work sessions recorded with an interruption count
+};
+
+#endif // SESSIONMETRICS_H
@@ -0,0 +1,522 @@
+#include "SessionNotes.h"
+#include "SessionHistory.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QSaveFile>
+#include <QThread>
+#include <QtEndian>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    const QString JOURNAL_FILE = QStringLiteral("notes.log");
+    const QString SEGMENT_FILE = QStringLiteral("notes.idx");
+
+    constexpr quint32 SEGMENT_MAGIC = 0x494E4D50;   // "PMNI"
+    constexpr quint32 SEGMENT_VERSION = 1;
+
+    // Segment layout (little endian):
+    //   header      magic, version, termCount, noteCount (u32), journalSize, reserved (u64)
+    //   term table  termCount x {termOffset, termLength, postingsOffset, postingsCount} (u32)
+    //   note table  noteCount x {sessionId, reserved (u32), journalOffset (u64)}, sorted by session
+    //   term bytes and posting lists, referenced by absolute offsets
+    constexpr qint64 HEADER_SIZE = 32;
+    constexpr qint64 TERM_ENTRY_SIZE = 16;
+    constexpr qint64 NOTE_ENTRY_SIZE = 16;
+
+    // Journal entry: sessionId (u32), length (u16), UTF-8 text
+    constexpr qint64 JOURNAL_HEADER_SIZE = 6;
+
+    quint32 readU32(const uchar *data) { return qFromLittleEndian<quint32>(data); }
+    quint64 readU64(const uchar *data) { return qFromLittleEndian<quint64>(data); }
+
+    QVector<quint32> unite(const QVector<quint32>& a, const QVector<quint32>& b)
+    {
+        QVector<quint32> result;
+        result.reserve(a.size() + b.size());
+        std::set_union(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(result));
+        return result;
+    }
+}
+
+SessionNotes& SessionNotes::instance()
+{
+    static SessionNotes notes;
+    return notes;
+}
+
+SessionNotes::SessionNotes()
+{
+    const QString directory = SessionHistory::instance().storageDirectory();
+    m_journalPath = directory + "/" + JOURNAL_FILE;
+    m_segmentPath = directory + "/" + SEGMENT_FILE;
+    m_pendingSegmentPath = m_segmentPath + ".new";
+
+    m_journal.setFileName(m_journalPath);
+    if (!m_journal.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        qWarning() << "SessionNotes: cannot open" << m_journalPath;
+    }
+
+    // Only the journal tail written after the last merge is replayed
+    replayJournal(mapSegment());
+    if (m_deltaNotes.size() >= MERGE_THRESHOLD) {
+        merge();
+    }
+}
+
+SessionNotes::~SessionNotes()
+{
+    finishMerge();
+    unmapSegment();
+}
+
+void SessionNotes::setNote(quint32 sessionId, const QString& note)
+{
+    if (sessionId == 0 || !m_journal.isOpen()) return;
+
+    const QString text = note.simplified().left(MAX_NOTE_LENGTH);
+    if (text == this->note(sessionId)) return;
+
+    const QByteArray utf8 = text.toUtf8();
+    uchar header[JOURNAL_HEADER_SIZE];
+    qToLittleEndian<quint32>(sessionId, header);
+    qToLittleEndian<quint16>(static_cast<quint16>(utf8.size()), header + 4);
+
+    m_journal.seek(m_journal.size());
+    const qint64 offset = m_journal.pos();
+    m_journal.write(reinterpret_cast<const char*>(header), JOURNAL_HEADER_SIZE);
+    m_journal.write(utf8);
+    m_journal.flush();
+
+    indexDelta(sessionId, offset, text);
+
+    if (m_deltaNotes.size() >= MERGE_THRESHOLD) {
+        merge();
+    }
+}
+
+QString SessionNotes::note(quint32 sessionId) const
+{
+    const qint64 offset = noteOffset(sessionId);
+    return offset < 0 ? QString() : readJournal(offset);
+}
+
+bool SessionNotes::hasNote(quint32 sessionId) const
+{
+    return !note(sessionId).isEmpty();
+}
+
+QSet<quint32> SessionNotes::notedSessions() const
+{
+    QSet<quint32> sessions;
+    const uchar *table = m_segment ? m_segment + HEADER_SIZE + m_termCount * TERM_ENTRY_SIZE : nullptr;
+    for (quint32 i = 0; table && i < m_noteCount; ++i) {
+        sessions.insert(readU32(table + i * NOTE_ENTRY_SIZE));
+    }
+    for (auto it = m_deltaNotes.cbegin(); it != m_deltaNotes.cend(); ++it) {
+        sessions.insert(it.key());
+    }
+    return sessions;
+}
+
+QVector<quint32> SessionNotes::search(const QString& query, int limit, bool *truncated) const
+{
+    if (truncated) *truncated = false;
+
+    const QStringList terms = tokenize(query);
+    if (terms.isEmpty()) return {};
+
+    QVector<quint32> candidates;
+    for (int i = 0; i < terms.size(); ++i) {
+        const bool last = i == terms.size() - 1;
+        const QVector<quint32> postings = postingsFor(terms.at(i).toUtf8(), last, last ? truncated : nullptr);
+        if (i == 0) {
+            candidates = postings;
+        } else {
+            QVector<quint32> intersection;
+            std::set_intersection(candidates.cbegin(), candidates.cend(),
+                                  postings.cbegin(), postings.cend(),
+                                  std::back_inserter(intersection));
+            candidates = std::move(intersection);
+        }
+        if (candidates.isEmpty()) return {};
+    }
+
+    QVector<quint32> results;
+    results.reserve(qMin(limit, static_cast<int>(candidates.size())));
+    auto it = candidates.crbegin();
+    for (; it != candidates.crend() && results.size() < limit; ++it) {
+        // Segment postings of rewritten notes may be stale; confirm against the current text
+        if (m_rewritten.contains(*it)) {
+            const QStringList current = tokenize(note(*it));
+            const bool matches = std::all_of(terms.cbegin(), terms.cend() - 1, [&current](const QString& term) {
+                return current.contains(term);
+            }) && std::any_of(current.cbegin(), current.cend(), [&terms](const QString& term) {
+                return term.startsWith(terms.constLast());
+            });
+            if (!matches) continue;
+        }
+        results.append(*it);
+    }
+    if (truncated && it != candidates.crend()) {
+        *truncated = true;
+    }
+    return results;
+}
+
+void SessionNotes::merge()
+{
+    if (m_deltaNotes.isEmpty() || m_merger) return;
+
+    MergeInput input;
+    input.postings = m_deltaPostings;
+    input.notes = m_deltaNotes;
+    input.rewritten = m_rewritten;
+    input.journalSize = static_cast<quint64>(m_journal.size());
+
+    m_merger.reset(QThread::create([this, input]() {
+        m_mergeSucceeded = writeSegment(input);
+        if (QCoreApplication *app = QCoreApplication::instance()) {
+            QMetaObject::invokeMethod(app, [this]() { finishMerge(); }, Qt::QueuedConnection);
+        }
+    }));
+    m_merger->start(QThread::LowPriority);
+}
+
+bool SessionNotes::writeSegment(const MergeInput& input) const
+{
+    // The GUI thread keeps using m_journal; texts of rewritten notes are read through a handle of our own
+    QFile journal(m_journalPath);
+    if (!input.rewritten.isEmpty() && !journal.open(QIODevice::ReadOnly)) {
+        qWarning() << "SessionNotes: cannot read" << m_journalPath;
+        return false;
+    }
+
+    // Materialise the current segment, then apply the delta on top of it
+    QMap<QByteArray, QVector<quint32>> terms;
+    for (int i = 0; i < static_cast<int>(m_termCount); ++i) {
+        const QByteArray term = segmentTerm(i);
+        terms.insert(QByteArray(term.constData(), term.size()), segmentPostings(i));
+    }
+
+    QMap<quint32, qint64> notes;
+    for (quint32 i = 0; i < m_noteCount; ++i) {
+        const uchar *entry = m_segment + HEADER_SIZE + m_termCount * TERM_ENTRY_SIZE + i * NOTE_ENTRY_SIZE;
+        notes.insert(readU32(entry), static_cast<qint64>(readU64(entry + 8)));
+    }
+
+    for (const quint32 sessionId : input.rewritten) {
+        for (const QString& term : tokenize(readJournalEntry(journal, notes.value(sessionId)))) {
+            auto it = terms.find(term.toUtf8());
+            if (it == terms.end()) continue;
+            it->removeOne(sessionId);
+            if (it->isEmpty()) terms.erase(it);
+        }
+    }
+
+    for (auto it = input.postings.cbegin(); it != input.postings.cend(); ++it) {
+        QVector<quint32>& postings = terms[it.key()];
+        postings = unite(postings, it.value());
+    }
+    for (auto it = input.notes.cbegin(); it != input.notes.cend(); ++it) {
+        notes.insert(it.key(), it.value());
+    }
+
+    // Lay out the new segment
+    const auto termCount = static_cast<quint32>(terms.size());
+    const auto noteCount = static_cast<quint32>(notes.size());
+    const qint64 poolStart = HEADER_SIZE + termCount * TERM_ENTRY_SIZE + noteCount * NOTE_ENTRY_SIZE;
+
+    qint64 stringBytes = 0;
+    for (auto it = terms.cbegin(); it != terms.cend(); ++it) {
+        stringBytes += it.key().size();
+    }
+
+    // Written next to the mapped segment; it can only be replaced once unmapped
+    QSaveFile file(m_pendingSegmentPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "SessionNotes: cannot write" << m_pendingSegmentPath;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << SEGMENT_MAGIC << SEGMENT_VERSION << termCount << noteCount
+           << input.journalSize << quint64(0);
+
+    qint64 stringOffset = poolStart;
+    qint64 postingsOffset = poolStart + stringBytes;
+    for (auto it = terms.cbegin(); it != terms.cend(); ++it) {
+        stream << static_cast<quint32>(stringOffset) << static_cast<quint32>(it.key().size())
+               << static_cast<quint32>(postingsOffset) << static_cast<quint32>(it.value().size());
+        stringOffset += it.key().size();
+        postingsOffset += it.value().size() * static_cast<qint64>(sizeof(quint32));
+    }
+    for (auto it = notes.cbegin(); it != notes.cend(); ++it) {
+        stream << it.key() << quint32(0) << static_cast<quint64>(it.value());
+    }
+    for (auto it = terms.cbegin(); it != terms.cend(); ++it) {
+        stream.writeRawData(it.key().constData(), static_cast<int>(it.key().size()));
+    }
+    for (auto it = terms.cbegin(); it != terms.cend(); ++it) {
+        for (const quint32 sessionId : it.value()) {
+            stream << sessionId;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "SessionNotes: failed to write" << m_pendingSegmentPath;
+        return false;
+    }
+    return true;
+}
+
+void SessionNotes::finishMerge()
+{
+    if (!m_merger) return;
+    m_merger->wait();
+    m_merger.reset();
+    if (!m_mergeSucceeded) return;  // the delta stays; the next merge retries
+
+    // The old segment must be unmapped before it can be replaced on every platform
+    unmapSegment();
+    QFile::remove(m_segmentPath);
+    if (!QFile::rename(m_pendingSegmentPath, m_segmentPath)) {
+        qWarning() << "SessionNotes: failed to replace" << m_segmentPath;
+    }
+
+    // Whichever segment is in place now, the journal after it is the new
+    // delta; normally just the notes written while the merge ran
+    m_deltaPostings.clear();
+    m_deltaNotes.clear();
+    m_rewritten.clear();
+    replayJournal(mapSegment());
+}
+
+QStringList SessionNotes::tokenize(const QString& text)
+{
+    QStringList terms;
+    QString current;
+
+    const auto flush = [&terms, &current]() {
+        if (current.size() >= MIN_TERM_LENGTH) {
+            current.truncate(MAX_TERM_LENGTH);
+            if (!terms.contains(current)) {
+                terms.append(current);
+            }
+        }
+        current.clear();
+    };
+
+    for (const QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            current.append(ch.toLower());
+        } else {
+            flush();
+        }
+    }
+    flush();
+    return terms;
+}
+
+qint64 SessionNotes::mapSegment()
+{
+    m_segmentFile.setFileName(m_segmentPath);
+    if (!m_segmentFile.exists() || !m_segmentFile.open(QIODevice::ReadOnly)) return 0;
+
+    m_segmentSize = m_segmentFile.size();
+    if (m_segmentSize >= HEADER_SIZE) {
+        m_segment = m_segmentFile.map(0, m_segmentSize);
+    }
+
+    if (!m_segment || readU32(m_segment) != SEGMENT_MAGIC || readU32(m_segment + 4) != SEGMENT_VERSION) {
+        qWarning() << "SessionNotes: ignoring unreadable index" << m_segmentPath;
+        unmapSegment();
+        return 0;
+    }
+
+    m_termCount = readU32(m_segment + 8);
+    m_noteCount = readU32(m_segment + 12);
+    const qint64 tablesEnd = HEADER_SIZE + m_termCount * TERM_ENTRY_SIZE + m_noteCount * NOTE_ENTRY_SIZE;
+    if (tablesEnd > m_segmentSize) {
+        qWarning() << "SessionNotes: truncated index" << m_segmentPath;
+        unmapSegment();
+        return 0;
+    }
+
+    return static_cast<qint64>(readU64(m_segment + 16));
+}
+
+void SessionNotes::unmapSegment()
+{
+    if (m_segment) {
+        m_segmentFile.unmap(const_cast<uchar*>(m_segment));
+    }
+    m_segmentFile.close();
+    m_segment = nullptr;
+    m_segmentSize = 0;
+    m_termCount = 0;
+    m_noteCount = 0;
+}
+
+void SessionNotes::replayJournal(qint64 fromOffset)
+{
+    if (!m_journal.isOpen() || fromOffset >= m_journal.size()) return;
+
+    m_journal.seek(fromOffset);
+    while (!m_journal.atEnd()) {
+        const qint64 offset = m_journal.pos();
+        uchar header[JOURNAL_HEADER_SIZE];
+        if (m_journal.read(reinterpret_cast<char*>(header), JOURNAL_HEADER_SIZE) != JOURNAL_HEADER_SIZE) break;
+
+        const quint32 sessionId = readU32(header);
+        const quint16 length = qFromLittleEndian<quint16>(header + 4);
+        const QByteArray utf8 = m_journal.read(length);
+        if (utf8.size() != length) break;
+
+        indexDelta(sessionId, offset, QString::fromUtf8(utf8));
+    }
+}
+
+void SessionNotes::indexDelta(quint32 sessionId, qint64 offset, const QString& text)
+{
+    const auto previous = m_deltaNotes.constFind(sessionId);
+    if (previous != m_deltaNotes.constEnd()) {
+        for (const QString& term : tokenize(readJournal(previous.value()))) {
+            auto it = m_deltaPostings.find(term.toUtf8());
+            if (it == m_deltaPostings.end()) continue;
+            it->removeOne(sessionId);
+            if (it->isEmpty()) m_deltaPostings.erase(it);
+        }
+    } else if (segmentNoteOffset(sessionId) >= 0) {
+        m_rewritten.insert(sessionId);
+    }
+
+    m_deltaNotes.insert(sessionId, offset);
+    for (const QString& term : tokenize(text)) {
+        QVector<quint32>& postings = m_deltaPostings[term.toUtf8()];
+        const auto position = std::lower_bound(postings.begin(), postings.end(), sessionId);
+        if (position == postings.end() || *position != sessionId) {
+            postings.insert(position, sessionId);
+        }
+    }
+}
+
+int SessionNotes::segmentTermLowerBound(const QByteArray& term) const
+{
+    int low = 0;
+    int high = static_cast<int>(m_termCount);
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        if (segmentTerm(middle) < term) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+QByteArray SessionNotes::segmentTerm(int index) const
+{
+    const uchar *entry = m_segment + HEADER_SIZE + index * TERM_ENTRY_SIZE;
+    const quint32 offset = readU32(entry);
+    const quint32 length = readU32(entry + 4);
+    if (offset + qint64(length) > m_segmentSize) return QByteArray();
+
+    // Zero-copy view into the mapped file
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(m_segment + offset), static_cast<int>(length));
+}
+
+QVector<quint32> SessionNotes::segmentPostings(int index) const
+{
+    const uchar *entry = m_segment + HEADER_SIZE + index * TERM_ENTRY_SIZE;
+    const quint32 offset = readU32(entry + 8);
+    const quint32 count = readU32(entry + 12);
+    if (offset + qint64(count) * 4 > m_segmentSize) return {};
+
+    QVector<quint32> postings(static_cast<int>(count));
+    qFromLittleEndian<quint32>(m_segment + offset, count, postings.data());
+    return postings;
+}
+
+qint64 SessionNotes::segmentNoteOffset(quint32 sessionId) const
+{
+    if (!m_segment) return -1;
+
+    const uchar *table = m_segment + HEADER_SIZE + m_termCount * TERM_ENTRY_SIZE;
+    int low = 0;
+    int high = static_cast<int>(m_noteCount);
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        const quint32 id = readU32(table + middle * NOTE_ENTRY_SIZE);
+        if (id == sessionId) {
+            return static_cast<qint64>(readU64(table + middle * NOTE_ENTRY_SIZE + 8));
+        }
+        if (id < sessionId) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return -1;
+}
+
+QVector<quint32> SessionNotes::postingsFor(const QByteArray& term, bool prefix, bool *truncated) const
+{
+    QVector<quint32> result;
+
+    if (!prefix) {
+        const int index = segmentTermLowerBound(term);
+        if (index < static_cast<int>(m_termCount) && segmentTerm(index) == term) {
+            result = segmentPostings(index);
+        }
+        const auto delta = m_deltaPostings.constFind(term);
+        if (delta != m_deltaPostings.constEnd()) {
+            result = unite(result, delta.value());
+        }
+        return result;
+    }
+
+    // Terms are sorted bytewise, so every completion of the prefix is contiguous
+    int expanded = 0;
+    for (int index = segmentTermLowerBound(term);
+         index < static_cast<int>(m_termCount) && segmentTerm(index).startsWith(term); ++index, ++expanded) {
+        if (expanded == MAX_PREFIX_EXPANSION) {
+            if (truncated) *truncated = true;
+            break;
+        }
+        result = unite(result, segmentPostings(index));
+    }
+    for (auto it = m_deltaPostings.cbegin(); it != m_deltaPostings.cend(); ++it) {
+        if (it.key().startsWith(term)) {
+            result = unite(result, it.value());
+        }
+    }
+    return result;
+}
+
+qint64 SessionNotes::noteOffset(quint32 sessionId) const
+{
+    const auto delta = m_deltaNotes.constFind(sessionId);
+    if (delta != m_deltaNotes.constEnd()) return delta.value();
+    return segmentNoteOffset(sessionId);
+}
+
+QString SessionNotes::readJournal(qint64 offset) const
+{
+    return readJournalEntry(m_journal, offset);
+}
+
+QString SessionNotes::readJournalEntry(QFile& journal, qint64 offset)
+{
+    if (!journal.isOpen() || !journal.seek(offset)) return QString();
+
+    uchar header[JOURNAL_HEADER_SIZE];
+    if (journal.read(reinterpret_cast<char*>(header), JOURNAL_HEADER_SIZE) != JOURNAL_HEADER_SIZE) {
+        return QString();
+    }
+    const quint16 length = qFromLittleEndian<quint16>(header + 4);
+    return QString::fromUtf8(journal.read(length));
+}
@@ -0,0 +1,120 @@
+#ifndef SESSIONNOTES_H
+#define SESSIONNOTES_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+class QThread;
+
+// Short notes attached to finished sessions, searchable through an inverted
+// index (term -> session IDs).
+//
+// Note texts live in an append-only journal. The index is a sorted, immutable
+// segment file that is memory-mapped on startup, so it is never parsed or
+// reloaded. Notes added since the segment was written are kept in a small
+// in-memory delta; only that journal tail is replayed at startup, and it is
+// folded into a fresh segment once it grows past MERGE_THRESHOLD. The fold
+// runs on a worker thread that only reads the mapped segment and its own
+// journal handle; the GUI thread swaps the result in and replays the notes
+// written meanwhile.
+class SessionNotes
+{
+public:
+    static SessionNotes& instance();
+
+    void setNote(quint32 sessionId, const QString& note);
+    [[nodiscard]] QString note(quint32 sessionId) const;
+    [[nodiscard]] bool hasNote(quint32 sessionId) const;
+    // Every session with a journal entry, including ones cleared since
+    [[nodiscard]] QSet<quint32> notedSessions() const;
+
+    // Sessions whose notes contain every query term, newest first. The last
+    // term also matches as a prefix so results follow the user's typing.
+    // truncated is set when more sessions match than were returned, either
+    // past limit or because the prefix has more than MAX_PREFIX_EXPANSION
+    // completions.
+    [[nodiscard]] QVector<quint32> search(const QString& query, int limit = DEFAULT_SEARCH_LIMIT,
+                                          bool *truncated = nullptr) const;
+
+    // Writes the delta into a new segment in the background; no-op while one is running
+    void merge();
+
+    static QStringList tokenize(const QString& text);
+
+    static constexpr int MAX_NOTE_LENGTH = 500;
+    static constexpr int MERGE_THRESHOLD = 256;
+    static constexpr int DEFAULT_SEARCH_LIMIT = 200;
+    static constexpr int MAX_PREFIX_EXPANSION = 64;
+    static constexpr int MIN_TERM_LENGTH = 2;
+    static constexpr int MAX_TERM_LENGTH = 64;
+
+private:
+    SessionNotes();
+    ~SessionNotes();
+
+    // Disable copy/move
+    SessionNotes(const SessionNotes&) = delete;
+    SessionNotes& operator=(const SessionNotes&) = delete;
+    SessionNotes(SessionNotes&&) = delete;
+    SessionNotes& operator=(SessionNotes&&) = delete;
+
+    // Maps the segment file; returns the journal size it covers, 0 without a segment
+    qint64 mapSegment();
+    void unmapSegment();
+    void replayJournal(qint64 fromOffset);
+    void indexDelta(quint32 sessionId, qint64 offset, const QString& text);
+
+    // Delta as of when a merge starts; the worker builds from this copy
+    struct MergeInput {
+        QHash<QByteArray, QVector<quint32>> postings;
+        QMap<quint32, qint64> notes;
+        QSet<quint32> rewritten;
+        quint64 journalSize = 0;
+    };
+    // Worker thread: segment plus input -> pending segment file
+    bool writeSegment(const MergeInput& input) const;
+    // GUI thread, after the worker: swaps the pending segment in
+    void finishMerge();
+
+    // Segment accessors; all offsets point into the mapped file
+    [[nodiscard]] int segmentTermLowerBound(const QByteArray& term) const;
+    [[nodiscard]] QByteArray segmentTerm(int index) const;
+    [[nodiscard]] QVector<quint32> segmentPostings(int index) const;
+    [[nodiscard]] qint64 segmentNoteOffset(quint32 sessionId) const;
+
+    [[nodiscard]] QVector<quint32> postingsFor(const QByteArray& term, bool prefix, bool *truncated) const;
+    [[nodiscard]] qint64 noteOffset(quint32 sessionId) const;
+    [[nodiscard]] QString readJournal(qint64 offset) const;
+    static QString readJournalEntry(QFile& journal, qint64 offset);
+
+    QString m_journalPath;
+    QString m_segmentPath;
+    QString m_pendingSegmentPath;
+    mutable QFile m_journal;
+    QFile m_segmentFile;
+
+    const uchar *m_segment = nullptr;
+    qint64 m_segmentSize = 0;
+    quint32 m_termCount = 0;
+    quint32 m_noteCount = 0;
+
+    // Delta since the last merge
+    QHash<QByteArray, QVector<quint32>> m_deltaPostings;
+    QMap<quint32, qint64> m_deltaNotes;
+    // Notes rewritten after their segment postings were built; results for
+    // these are re-checked against the current text
+    QSet<quint32> m_rewritten;
+
+    // Only the GUI thread remaps the segment, and only once m_merger has finished
+    std::unique_ptr<QThread> m_merger;
+    bool m_mergeSucceeded = false;
+};
+
+#endif // SESSIONNOTES_H
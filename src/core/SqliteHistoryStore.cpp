@@ -0,0 +1,398 @@
+#include "SqliteHistoryStore.h"
+#include "HistoryArchive.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+
+namespace {
+    const QString DRIVER = QStringLiteral("QSQLITE");
+    const QString DATABASE_FILE = QStringLiteral("history.sqlite");
+    const QString WRITER_CONNECTION = QStringLiteral("history-writer");
+
+    const char *const SCHEMA[] = {
+        "CREATE TABLE IF NOT EXISTS tags ("
+        " id INTEGER PRIMARY KEY,"
+        " name TEXT NOT NULL)",
+        "CREATE TABLE IF NOT EXISTS sessions ("
+        " id INTEGER PRIMARY KEY,"
+        " start INTEGER NOT NULL,"
+        " day INTEGER NOT NULL,"
+        " duration INTEGER NOT NULL,"
+        " type INTEGER NOT NULL,"
+        " tag_id INTEGER NOT NULL DEFAULT 0,"
+        " flags INTEGER NOT NULL DEFAULT 0)",
+        "CREATE INDEX IF NOT EXISTS sessions_day_type_tag ON sessions (day, type, tag_id, duration)",
+        "CREATE TABLE IF NOT EXISTS daily_rollups ("
+        " day INTEGER PRIMARY KEY,"
+        " work_seconds INTEGER NOT NULL,"
+        " break_seconds INTEGER NOT NULL,"
+        " sessions INTEGER NOT NULL) WITHOUT ROWID",
+        "CREATE VIEW IF NOT EXISTS session_log AS"
+        " SELECT s.id, datetime(s.start, 'unixepoch', 'localtime') AS started, date(s.day) AS day,"
+        " s.duration, CASE s.type WHEN 0 THEN 'work' WHEN 1 THEN 'shortBreak' ELSE 'longBreak' END AS type,"
+        " t.name AS tag, s.flags & 1 AS skipped"
+        " FROM sessions s LEFT JOIN tags t ON t.id = s.tag_id",
+    };
+
+    QString readerConnectionName()
+    {
+        return QStringLiteral("history-reader-%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()), 0, 16);
+    }
+
+    qint64 localDay(qint64 startTime)
+    {
+        return QDateTime::fromSecsSinceEpoch(startTime).date().toJulianDay();
+    }
+}
+
+struct SqliteHistoryStore::Statements {
+    explicit Statements(const QSqlDatabase& db)
+        : insertTag(db)
+        , insertSession(db)
+        , addRollup(db)
+    {
+    }
+
+    QSqlQuery insertTag;
+    QSqlQuery insertSession;
+    QSqlQuery addRollup;
+};
+
+SqliteHistoryStore& SqliteHistoryStore::instance()
+{
+    static SqliteHistoryStore store;
+    return store;
+}
+
+SqliteHistoryStore::~SqliteHistoryStore()
+{
+    close();
+}
+
+QString SqliteHistoryStore::databasePath() const
+{
+    return SessionHistory::instance().storageDirectory() + "/" + DATABASE_FILE;
+}
+
+bool SqliteHistoryStore::open()
+{
+    if (m_thread) return true;
+
+    if (!QSqlDatabase::isDriverAvailable(DRIVER)) {
+        qWarning() << "SqliteHistoryStore: SQLite driver is not available";
+        return false;
+    }
+
+    m_thread = std::make_unique<QThread>();
+    m_thread->setObjectName(QStringLiteral("HistoryStore"));
+    m_context = new QObject();
+    m_context->moveToThread(m_thread.get());
+    QObject::connect(m_thread.get(), &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread->start(QThread::LowPriority);
+
+    // Implicitly shared snapshots; later appends detach on the owning thread
+    const SessionHistory& history = SessionHistory::instance();
+    const QVector<SessionRecord> records = history.records();
+    const QStringList tagNames = history.tagNames();
+    const QString archivePath = history.archiveFilePath();
+
+    QMetaObject::invokeMethod(m_context, [this, records, tagNames, archivePath]() {
+        if (openWriter()) {
+            backfill(records, tagNames, archivePath);
+        }
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SqliteHistoryStore::close()
+{
+    if (!m_thread) return;
+
+    QMetaObject::invokeMethod(m_context, [this]() {
+        flush();
+        closeWriter();
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread->quit();
+    m_thread->wait();
+    m_thread.reset();
+    m_context = nullptr;
+
+    const QString reader = readerConnectionName();
+    if (QSqlDatabase::contains(reader)) {
+        QSqlDatabase::removeDatabase(reader);
+    }
+}
+
+void SqliteHistoryStore::enqueue(const QVector<SessionRecord>& records, const QStringList& tagNames)
+{
+    if (!m_thread || records.isEmpty()) return;
+
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        m_pending.append(records);
+        m_pendingTags = tagNames;
+        if (m_flushQueued) return;
+        m_flushQueued = true;
+    }
+    QMetaObject::invokeMethod(m_context, [this]() { flush(); }, Qt::QueuedConnection);
+}
+
+QMap<QDate, DailyRollup> SqliteHistoryStore::dailyRollups(const QDate& from, const QDate& to) const
+{
+    QMap<QDate, DailyRollup> rollups;
+
+    const QString name = readerConnectionName();
+    QSqlDatabase db = QSqlDatabase::contains(name)
+        ? QSqlDatabase::database(name, false)
+        : QSqlDatabase::addDatabase(DRIVER, name);
+    if (!db.isOpen()) {
+        db.setDatabaseName(databasePath());
+        db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+        if (!db.open()) {
+            qWarning() << "SqliteHistoryStore: cannot open" << databasePath() << db.lastError().text();
+            return rollups;
+        }
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("SELECT day, work_seconds, break_seconds, sessions FROM daily_rollups"
+                                 " WHERE day BETWEEN ? AND ? ORDER BY day"));
+    query.bindValue(0, from.toJulianDay());
+    query.bindValue(1, to.toJulianDay());
+    if (!query.exec()) {
+        qWarning() << "SqliteHistoryStore: rollup query failed" << query.lastError().text();
+        return rollups;
+    }
+
+    while (query.next()) {
+        DailyRollup& rollup = rollups[QDate::fromJulianDay(query.value(0).toLongLong())];
+        rollup.workSeconds = query.value(1).toInt();
+        rollup.breakSeconds = query.value(2).toInt();
+        rollup.sessions = query.value(3).toInt();
+    }
+    return rollups;
+}
+
+bool SqliteHistoryStore::openWriter()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER, WRITER_CONNECTION);
+    db.setDatabaseName(databasePath());
+    if (!db.open()) {
+        qWarning() << "SqliteHistoryStore: cannot open" << databasePath() << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.exec(QStringLiteral("PRAGMA journal_mode = WAL"));
+    query.exec(QStringLiteral("PRAGMA synchronous = NORMAL"));
+    for (const char *statement : SCHEMA) {
+        if (!query.exec(QLatin1String(statement))) {
+            qWarning() << "SqliteHistoryStore: schema setup failed" << query.lastError().text();
+            return false;
+        }
+    }
+    query.exec(QStringLiteral("PRAGMA user_version = %1").arg(SCHEMA_VERSION));
+
+    m_statements = std::make_unique<Statements>(db);
+    const bool prepared =
+        m_statements->insertTag.prepare(QStringLiteral("INSERT OR IGNORE INTO tags (id, name) VALUES (?, ?)"))
+        && m_statements->insertSession.prepare(QStringLiteral(
+            "INSERT OR IGNORE INTO sessions (id, start, day, duration, type, tag_id, flags)"
+            " VALUES (?, ?, ?, ?, ?, ?, ?)"))
+        && m_statements->addRollup.prepare(QStringLiteral(
+            "INSERT INTO daily_rollups (day, work_seconds, break_seconds, sessions) VALUES (?, ?, ?, ?)"
+            " ON CONFLICT (day) DO UPDATE SET"
+            " work_seconds = work_seconds + excluded.work_seconds,"
+            " break_seconds = break_seconds + excluded.break_seconds,"
+            " sessions = sessions + excluded.sessions"));
+    if (!prepared) {
+        qWarning() << "SqliteHistoryStore: cannot prepare statements" << db.lastError().text();
+        m_statements.reset();
+        return false;
+    }
+    return true;
+}
+
+void SqliteHistoryStore::closeWriter()
+{
+    m_ready.store(false, std::memory_order_release);
+    m_statements.reset();
+    m_writtenTags.clear();
+    {
+        QSqlDatabase db = QSqlDatabase::database(WRITER_CONNECTION, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(WRITER_CONNECTION);
+}
+
+void SqliteHistoryStore::backfill(const QVector<SessionRecord>& records, const QStringList& tagNames,
+                                  const QString& archivePath)
+{
+    QSqlQuery query(QSqlDatabase::database(WRITER_CONNECTION, false));
+    quint32 lastId = 0;
+    if (query.exec(QStringLiteral("SELECT COALESCE(MAX(id), 0) FROM sessions")) && query.next()) {
+        lastId = query.value(0).toUInt();
+    }
+
+    // Archived sessions are decoded from a private mapping, with tags resolved to history IDs
+    HistoryArchive archive;
+    archive.load(archivePath, [&tagNames](const QString& name) {
+        return static_cast<quint16>(tagNames.indexOf(name) + 1);
+    });
+    if (!writeArchivedRollups(archive)) return;
+    if (archive.maxId() > lastId) {
+        QVector<SessionRecord> archived;
+        archive.forEach([&archived, lastId](const SessionRecord& record) {
+            if (record.id > lastId) archived.append(record);
+        });
+        if (!writeChunked(archived, tagNames)) return;
+    }
+
+    // Live records are sorted by ID, so only the tail past the database's last ID is missing
+    const auto it = std::upper_bound(records.cbegin(), records.cend(), lastId,
+                                     [](quint32 value, const SessionRecord& record) { return value < record.id; });
+    if (!writeChunked(QVector<SessionRecord>(it, records.cend()), tagNames)) return;
+
+    m_ready.store(true, std::memory_order_release);
+}
+
+bool SqliteHistoryStore::writeArchivedRollups(const HistoryArchive& archive)
+{
+    if (archive.rollups().isEmpty()) return true;
+
+    // Summed over tags, keyed by the first and last day each rollup covers
+    QMap<QPair<qint64, qint64>, DailyRollup> periods;
+    for (const HistoryArchive::Rollup& rollup : archive.rollups()) {
+        const qint64 last = rollup.period == HistoryArchive::RollupPeriod::Month
+            ? QDate::fromJulianDay(rollup.julianDay).addMonths(1).toJulianDay() - 1
+            : rollup.julianDay;
+        DailyRollup& total = periods[qMakePair(rollup.julianDay, last)];
+        total.workSeconds += static_cast<int>(rollup.workSeconds);
+        total.breakSeconds += static_cast<int>(rollup.breakSeconds);
+        total.sessions += static_cast<int>(rollup.sessions);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(WRITER_CONNECTION, false);
+    if (!db.transaction()) {
+        qWarning() << "SqliteHistoryStore: cannot begin transaction" << db.lastError().text();
+        return false;
+    }
+
+    // A period with any day present was mirrored as sessions before it was
+    // compacted, or by an earlier back-fill; either way it is complete
+    QSqlQuery insertRollup(db);
+    bool success = insertRollup.prepare(QStringLiteral(
+        "INSERT INTO daily_rollups (day, work_seconds, break_seconds, sessions) SELECT ?, ?, ?, ?"
+        " WHERE NOT EXISTS (SELECT 1 FROM daily_rollups WHERE day BETWEEN ? AND ?)"));
+    for (auto it = periods.cbegin(); success && it != periods.cend(); ++it) {
+        insertRollup.bindValue(0, it.key().first);
+        insertRollup.bindValue(1, it->workSeconds);
+        insertRollup.bindValue(2, it->breakSeconds);
+        insertRollup.bindValue(3, it->sessions);
+        insertRollup.bindValue(4, it.key().first);
+        insertRollup.bindValue(5, it.key().second);
+        success = insertRollup.exec();
+    }
+
+    if (success && db.commit()) return true;
+
+    qWarning() << "SqliteHistoryStore: rollup back-fill failed" << db.lastError().text();
+    db.rollback();
+    return false;
+}
+
+bool SqliteHistoryStore::writeChunked(const QVector<SessionRecord>& records, const QStringList& tagNames)
+{
+    for (int first = 0; first < records.size(); first += BACKFILL_CHUNK) {
+        if (!writeBatch(records.mid(first, BACKFILL_CHUNK), tagNames)) return false;
+    }
+    return true;
+}
+
+void SqliteHistoryStore::flush()
+{
+    QVector<SessionRecord> batch;
+    QStringList tagNames;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        batch.swap(m_pending);
+        tagNames = m_pendingTags;
+        m_flushQueued = false;
+    }
+
+    if (!batch.isEmpty()) {
+        writeBatch(batch, tagNames);
+    }
+}
+
+bool SqliteHistoryStore::writeBatch(const QVector<SessionRecord>& records, const QStringList& tagNames)
+{
+    if (!m_statements) return false;
+
+    QSqlDatabase db = QSqlDatabase::database(WRITER_CONNECTION, false);
+    if (!db.transaction()) {
+        qWarning() << "SqliteHistoryStore: cannot begin transaction" << db.lastError().text();
+        return false;
+    }
+
+    QSet<quint16> newTags;
+    QMap<qint64, DailyRollup> rollups;
+    bool success = true;
+
+    for (const SessionRecord& record : records) {
+        if (record.tagId != 0 && record.tagId <= tagNames.size()
+            && !m_writtenTags.contains(record.tagId) && !newTags.contains(record.tagId)) {
+            QSqlQuery& insertTag = m_statements->insertTag;
+            insertTag.bindValue(0, record.tagId);
+            insertTag.bindValue(1, tagNames.at(record.tagId - 1));
+            if (!(success = insertTag.exec())) break;
+            newTags.insert(record.tagId);
+        }
+
+        const qint64 day = localDay(record.startTime);
+        QSqlQuery& insertSession = m_statements->insertSession;
+        insertSession.bindValue(0, record.id);
+        insertSession.bindValue(1, record.startTime);
+        insertSession.bindValue(2, day);
+        insertSession.bindValue(3, record.duration);
+        insertSession.bindValue(4, static_cast<int>(record.type));
+        insertSession.bindValue(5, record.tagId);
+        insertSession.bindValue(6, record.flags);
+        if (!(success = insertSession.exec())) break;
+
+        // Sessions that were already mirrored must not be counted twice
+        if (insertSession.numRowsAffected() <= 0) continue;
+
+        DailyRollup& rollup = rollups[day];
+        if (record.type == TimerState::Work) {
+            rollup.workSeconds += static_cast<int>(record.duration);
+            rollup.sessions++;
+        } else {
+            rollup.breakSeconds += static_cast<int>(record.duration);
+        }
+    }
+
+    for (auto it = rollups.cbegin(); success && it != rollups.cend(); ++it) {
+        QSqlQuery& addRollup = m_statements->addRollup;
+        addRollup.bindValue(0, it.key());
+        addRollup.bindValue(1, it->workSeconds);
+        addRollup.bindValue(2, it->breakSeconds);
+        addRollup.bindValue(3, it->sessions);
+        success = addRollup.exec();
+    }
+
+    if (success && db.commit()) {
+        m_writtenTags.unite(newTags);
+        return true;
+    }
+
+    qWarning() << "SqliteHistoryStore: batch write failed" << db.lastError().text();
+    db.rollback();
+    return false;
+}
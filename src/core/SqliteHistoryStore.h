@@ -0,0 +1,91 @@
+#ifndef SQLITEHISTORYSTORE_H
+#define SQLITEHISTORYSTORE_H
+
+#include <QDate>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "SessionHistory.h"
+
+class HistoryArchive;
+
+// Optional SQLite copy of the session history for ad-hoc queries.
+//
+// Every write runs on a dedicated thread. enqueue() only appends to a pending
+// batch under a mutex; the writer drains whatever has accumulated in one
+// transaction through prepared statements. The database uses WAL, so readers
+// on other threads scan the rollup table without waiting for the writer.
+//
+// Schema: sessions(id, start, day, duration, type, tag_id, flags) with a
+// covering index on (day, type, tag_id, duration), tags(id, name),
+// daily_rollups(day, work_seconds, break_seconds, sessions) and a
+// human-readable session_log view. Days are Julian day numbers (local time).
+// History the compactor had already folded into rollups before the back-fill
+// has no sessions rows, only its totals in daily_rollups; a monthly rollup is
+// filed under the first day of its month.
+class SqliteHistoryStore
+{
+public:
+    static SqliteHistoryStore& instance();
+
+    // Starts the writer thread and back-fills sessions missing from the database
+    bool open();
+    // Writes anything still pending and stops the writer thread
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return m_thread != nullptr; }
+    // True once the back-fill has finished and reads reflect the whole history
+    [[nodiscard]] bool isReady() const { return m_ready.load(std::memory_order_acquire); }
+
+    // Thread-safe; never touches the disk on the calling thread
+    void enqueue(const QVector<SessionRecord>& records, const QStringList& tagNames);
+
+    // Primary-key range scan on a read connection owned by the calling thread
+    [[nodiscard]] QMap<QDate, DailyRollup> dailyRollups(const QDate& from, const QDate& to) const;
+
+    [[nodiscard]] QString databasePath() const;
+
+    static constexpr int SCHEMA_VERSION = 1;
+    static constexpr int BACKFILL_CHUNK = 4096;
+
+private:
+    SqliteHistoryStore() = default;
+    ~SqliteHistoryStore();
+
+    // Disable copy/move
+    SqliteHistoryStore(const SqliteHistoryStore&) = delete;
+    SqliteHistoryStore& operator=(const SqliteHistoryStore&) = delete;
+    SqliteHistoryStore(SqliteHistoryStore&&) = delete;
+    SqliteHistoryStore& operator=(SqliteHistoryStore&&) = delete;
+
+    struct Statements;
+
+    // Writer thread only
+    bool openWriter();
+    void closeWriter();
+    void backfill(const QVector<SessionRecord>& records, const QStringList& tagNames, const QString& archivePath);
+    bool writeArchivedRollups(const HistoryArchive& archive);
+    bool writeChunked(const QVector<SessionRecord>& records, const QStringList& tagNames);
+    void flush();
+    bool writeBatch(const QVector<SessionRecord>& records, const QStringList& tagNames);
+
+    std::unique_ptr<QThread> m_thread;
+    QObject *m_context = nullptr;           // lives on m_thread; runs the queued writer jobs
+    std::atomic_bool m_ready{false};
+
+    QMutex m_pendingMutex;
+    QVector<SessionRecord> m_pending;
+    QStringList m_pendingTags;
+    bool m_flushQueued = false;
+
+    std::unique_ptr<Statements> m_statements;
+    QSet<quint16> m_writtenTags;
+};
+
+#endif // SQLITEHISTORYSTORE_H
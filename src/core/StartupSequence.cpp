@@ -0,0 +1,77 @@
+#include "StartupSequence.h"
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTimer>
+
+Q_LOGGING_CATEGORY(lcStartup, "pomodoro.startup", QtWarningMsg)
+
+namespace {
+    QElapsedTimer& processClock()
+    {
+        static QElapsedTimer clock;
+        if (!clock.isValid()) {
+            clock.start();
+        }
+        return clock;
+    }
+}
+
+StartupSequence::StartupSequence(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void StartupSequence::markProcessStart()
+{
+    processClock();
+}
+
+qint64 StartupSequence::sinceProcessStartMs()
+{
+    return processClock().elapsed();
+}
+
+void StartupSequence::addStage(const QString &name, std::function<void()> run)
+{
+    m_stages.append({name, std::move(run)});
+}
+
+void StartupSequence::start()
+{
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+    QTimer::singleShot(0, this, &StartupSequence::runNext);
+}
+
+void StartupSequence::recordFirstFrame()
+{
+    if (m_firstFrameMs >= 0) {
+        return;
+    }
+    m_firstFrameMs = sinceProcessStartMs();
+    qCInfo(lcStartup).noquote() << "first frame after" << m_firstFrameMs << "ms";
+}
+
+void StartupSequence::runNext()
+{
+    if (m_next >= m_stages.size()) {
+        qCInfo(lcStartup).noquote() << "all stages done after" << sinceProcessStartMs() << "ms";
+        emit finished();
+        return;
+    }
+
+    const Stage &stage = m_stages.at(m_next++);
+    const qint64 startedMs = sinceProcessStartMs();
+    QElapsedTimer elapsed;
+    elapsed.start();
+    stage.run();
+
+    const Timing timing{stage.name, startedMs, elapsed.nsecsElapsed() / 1000};
+    m_timings.append(timing);
+    qCInfo(lcStartup).noquote() << "stage" << timing.stage << "took" << timing.durationUs << "us";
+
+    // Yield so pending input and paint events go before the next stage
+    QTimer::singleShot(0, this, &StartupSequence::runNext);
+}
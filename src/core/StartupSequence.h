@@ -0,0 +1,61 @@
+#ifndef STARTUPSEQUENCE_H
+#define STARTUPSEQUENCE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Runs deferred initialisation stages from the event loop, one stage per pass
+// and in the order they were added, so input and painting are never held up
+// for longer than a single stage.
+//
+// Every stage is timed, as is the first frame relative to markProcessStart().
+// Timings go to the "pomodoro.startup" logging category, which is silent
+// unless enabled (QT_LOGGING_RULES="pomodoro.startup.info=true").
+class StartupSequence : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Timing {
+        QString stage;
+        qint64 startedMs;       // since process start
+        qint64 durationUs;
+    };
+
+    explicit StartupSequence(QObject *parent = nullptr);
+
+    void addStage(const QString &name, std::function<void()> run);
+    // Starts running the stages; later calls are ignored
+    void start();
+
+    void recordFirstFrame();
+
+    [[nodiscard]] bool isFinished() const { return m_started && m_next >= m_stages.size(); }
+    [[nodiscard]] qint64 firstFrameMs() const { return m_firstFrameMs; }
+    [[nodiscard]] const QVector<Timing>& timings() const { return m_timings; }
+
+    // Call first thing in main() so metrics include application startup
+    static void markProcessStart();
+    static qint64 sinceProcessStartMs();
+
+signals:
+    void finished();
+
+private:
+    struct Stage {
+        QString name;
+        std::function<void()> run;
+    };
+
+    void runNext();
+
+    QVector<Stage> m_stages;
+    QVector<Timing> m_timings;
+    int m_next = 0;
+    bool m_started = false;
+    qint64 m_firstFrameMs = -1;
+};
+
+#endif // STARTUPSEQUENCE_H
@@ -0,0 +1,81 @@
+#include "TimerCheckpoint.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+    const QString CHECKPOINT_FILE_NAME = QStringLiteral("timer.checkpoint");
+}
+
+qint64 TimerCheckpoint::downtimeMsAt(qint64 nowMs) const
+{
+    return running ? qMax<qint64>(0, nowMs - writtenAtMs) : 0;
+}
+
+bool TimerCheckpoint::save(const QString& path) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << MAGIC << VERSION
+           << static_cast<quint8>(state) << static_cast<quint8>(running) << clockFlags
+           << static_cast<qint32>(completedSessions) << static_cast<qint32>(totalDuration)
+           << activeMs << startWallMs << writtenAtMs;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "TimerCheckpoint: cannot write" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TimerCheckpoint::load(const QString& path, TimerCheckpoint& checkpoint)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint8 state = 0;
+    quint8 running = 0;
+    qint32 completedSessions = 0;
+    qint32 totalDuration = 0;
+    TimerCheckpoint loaded;
+    stream >> magic >> version >> state >> running >> loaded.clockFlags
+           >> completedSessions >> totalDuration
+           >> loaded.activeMs >> loaded.startWallMs >> loaded.writtenAtMs;
+
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION
+        || state > static_cast<quint8>(TimerState::LongBreak) || totalDuration <= 0) {
+        qWarning() << "TimerCheckpoint: ignoring unreadable" << path;
+        return false;
+    }
+
+    loaded.state = static_cast<TimerState>(state);
+    loaded.running = running != 0;
+    loaded.completedSessions = qMax(0, completedSessions);
+    loaded.totalDuration = totalDuration;
+    checkpoint = loaded;
+    return true;
+}
+
+QString TimerCheckpoint::defaultPath()
+{
+    // Same directory as SessionHistory, without loading the history to find it;
+    // worked out once, since every transition asks for it
+    static const QString path = []() {
+        const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        QDir().mkpath(directory);
+        return directory + "/" + CHECKPOINT_FILE_NAME;
+    }();
+    return path;
+}
@@ -0,0 +1,35 @@
+#ifndef TIMERCHECKPOINT_H
+#define TIMERCHECKPOINT_H
+
+#include <QString>
+#include "TimerState.h"
+
+// The live timer state, persisted so a restarted app resumes mid-session.
+//
+// It is rewritten only on transitions (start, pause, reset, session change)
+// and on shutdown, never on ticks. The time between writtenAtMs and the next
+// launch is not known to be work: SessionClock::restore() treats it as a gap
+// under the suspend policy. The file is a few dozen bytes replaced through
+// QSaveFile, so a crash leaves either the old or the new one.
+struct TimerCheckpoint {
+    TimerState state = TimerState::Work;
+    bool running = false;
+    int completedSessions = 0;          // position in the work/break cycle
+    int totalDuration = 0;              // seconds
+    qint64 activeMs = 0;                // session time elapsed when written
+    qint64 startWallMs = 0;             // 0 until the session first starts
+    quint8 clockFlags = 0;              // SessionFlag bits from SessionClock
+    qint64 writtenAtMs = 0;             // wall clock
+
+    // How long a running session has gone unobserved at nowMs; 0 when paused
+    [[nodiscard]] qint64 downtimeMsAt(qint64 nowMs) const;
+
+    bool save(const QString& path) const;
+    static bool load(const QString& path, TimerCheckpoint& checkpoint);
+    static QString defaultPath();
+
+    static constexpr quint32 MAGIC = 0x50434B54;       // "TKCP"
+    static constexpr quint16 VERSION = 1;
+};
+
+#endif // TIMERCHECKPOINT_H
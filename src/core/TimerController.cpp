@@ -19,7 +19,7 @@ void TimerController::start()
 
     m_state = TimerStatus::Running;
     m_timer->start();
-    emit stateChanged(m_state);
+    publish();
 }
 
 void TimerController::pause()
@@ -27,7 +27,7 @@ void TimerController::pause()
     if (m_state == TimerStatus::Running) {
         m_state = TimerStatus::Paused;
         m_timer->stop();
-        emit stateChanged(m_state);
+        publish();
     }
 }
 
@@ -38,10 +38,7 @@ void TimerController::reset()
     m_currentSessionType = SessionType::Work;
     updateTotalSeconds();
     m_remainingSeconds = m_totalSeconds;
-
-    emit stateChanged(m_state);
-    emit sessionChanged(m_currentSessionType);
-    emit timeChanged(m_remainingSeconds);
+    publish();
 }
 
 void TimerController::skip()
@@ -60,7 +57,7 @@ void TimerController::onTimerTick()
 {
     if (m_remainingSeconds > 0) {
         --m_remainingSeconds;
-        emit timeChanged(m_remainingSeconds);
+        publish();
     } else {
         m_timer->stop();
         emit timerFinished();
@@ -89,10 +86,29 @@ void TimerController::startNextSession()
     m_state = TimerStatus::Stopped;
     updateTotalSeconds();
     m_remainingSeconds = m_totalSeconds;
+    publish();
+}
+
+void TimerController::publish()
+{
+    const TimerSnapshot current{m_state, m_currentSessionType, m_remainingSeconds,
+                                m_totalSeconds, m_completedSessions};
+
+    ChangeMask changes;
+    if (!m_hasPublished) {
+        changes = StatusChanged | SessionChanged | RemainingChanged | TotalChanged | CompletedChanged;
+    } else {
+        changes.setFlag(StatusChanged, current.status != m_published.status);
+        changes.setFlag(SessionChanged, current.session != m_published.session);
+        changes.setFlag(RemainingChanged, current.remainingSeconds != m_published.remainingSeconds);
+        changes.setFlag(TotalChanged, current.totalSeconds != m_published.totalSeconds);
+        changes.setFlag(CompletedChanged, current.completedSessions != m_published.completedSessions);
+    }
+    if (!changes) return;
 
-    emit sessionChanged(m_currentSessionType);
-    emit stateChanged(m_state);
-    emit timeChanged(m_remainingSeconds);
+    m_published = current;
+    m_hasPublished = true;
+    emit stateUpdated(m_published, changes);
 }
 
 void TimerController::updateTotalSeconds()
@@ -18,11 +18,31 @@ enum class TimerStatus {
     Paused
 };
 
+// Everything a view of the controller needs, published as one value
+struct TimerSnapshot {
+    TimerStatus status = TimerStatus::Stopped;
+    SessionType session = SessionType::Work;
+    int remainingSeconds = 0;
+    int totalSeconds = 0;
+    int completedSessions = 0;
+};
+
 class TimerController : public QObject
 {
     Q_OBJECT
 
 public:
+    // Which TimerSnapshot fields differ from the previous stateUpdated()
+    enum Change {
+        StatusChanged = 0x01,
+        SessionChanged = 0x02,
+        RemainingChanged = 0x04,
+        TotalChanged = 0x08,
+        CompletedChanged = 0x10
+    };
+    Q_DECLARE_FLAGS(ChangeMask, Change)
+    Q_FLAG(ChangeMask)
+
     explicit TimerController(QObject *parent = nullptr);
     ~TimerController() override = default;
 
@@ -39,6 +59,7 @@ public:
     [[nodiscard]] TimerStatus state() const { return m_state; }
     [[nodiscard]] int completedSessions() const { return m_completedSessions; }
     [[nodiscard]] double progressPercentage() const;
+    [[nodiscard]] const TimerSnapshot& snapshot() const { return m_published; }
 
     // Configuration
     void setWorkDuration(int seconds) { m_workDuration = seconds; }
@@ -46,10 +67,9 @@ public:
     void setLongBreakDuration(int seconds) { m_longBreakDuration = seconds; }
 
 signals:
-    void timeChanged(int remainingSeconds);
-    void sessionChanged(SessionType type);
+    // Once per transition or tick, with only the fields that changed marked
+    void stateUpdated(const TimerSnapshot &snapshot, TimerController::ChangeMask changes);
     void timerFinished();
-    void stateChanged(TimerStatus state);
 
 private slots:
     void onTimerTick();
@@ -57,6 +77,8 @@ private slots:
 private:
     void startNextSession();
     void updateTotalSeconds();
+    // Emits stateUpdated() if anything differs from the last published snapshot
+    void publish();
 
     // Timer objects
     std::unique_ptr<QTimer> m_timer;
@@ -70,6 +92,9 @@ private:
     int m_totalSeconds = 0;
     int m_completedSessions = 0;
 
+    TimerSnapshot m_published;
+    bool m_hasPublished = false;
+
     // Configuration
     int m_workDuration = 1500;      // 25 minutes
     int m_shortBreakDuration = 300; // 5 minutes
@@ -78,4 +103,6 @@ private:
     static constexpr int SESSIONS_BEFORE_LONG_BREAK = 4;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(TimerController::ChangeMask)
+
 #endif // TIMERCONTROLLER_H
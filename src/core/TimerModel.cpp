@@ -0,0 +1,54 @@
+#include "TimerModel.h"
+
+TimerModel::TimerModel(int sessionsPerCycle, QObject *parent)
+    : QObject(parent)
+    , m_sessionsPerCycle(qMax(1, sessionsPerCycle))
+{
+    m_progress.setBinding([this]() {
+        const int total = m_totalSeconds.value();
+        return total > 0 ? ((total - m_remainingSeconds.value()) * 100) / total : 0;
+    });
+    m_cycleIndex.setBinding([this]() {
+        return (m_completedSessions.value() % m_sessionsPerCycle) + 1;
+    });
+    m_formattedTime.setBinding([this]() {
+        return formatTime(m_remainingSeconds.value());
+    });
+
+    // Reads the countdown only while running, so a stopped timer's title does
+    // not depend on it at all
+    m_windowTitle.setBinding([this]() {
+        if (!m_running.value()) {
+            return QStringLiteral("🍅 Pomodoro Timer");
+        }
+        const TimerState state = m_state.value();
+        const QString stateText = state == TimerState::Work ? QStringLiteral("Focus") : QStringLiteral("Break");
+        return QStringLiteral("%1 %2: %3").arg(TimerStateHelper::getStateEmoji(state), stateText,
+                                               m_formattedTime.value());
+    });
+
+    m_trayToolTip.setBinding([this]() {
+        const TimerState state = m_state.value();
+        const QString emoji = TimerStateHelper::getStateEmoji(state);
+        const QString stateText = TimerStateHelper::getStateText(state);
+        QString tooltip = m_running.value()
+            ? QStringLiteral("%1 %2 - %3 remaining").arg(emoji, stateText, m_formattedTime.value())
+            : QStringLiteral("%1 %2 (Paused) Ready (%3)").arg(emoji, stateText, m_formattedTime.value());
+        tooltip += QStringLiteral("\nSession %1 of %2").arg(m_cycleIndex.value()).arg(m_sessionsPerCycle);
+        return tooltip;
+    });
+
+    m_startEnabled.setBinding([this]() { return !m_running.value(); });
+    m_resetVisible.setBinding([this]() {
+        return m_running.value() || m_remainingSeconds.value() < m_totalSeconds.value();
+    });
+}
+
+QString TimerModel::formatTime(int seconds)
+{
+    const int minutes = seconds / 60;
+    const int secs = seconds % 60;
+    return QString("%1:%2")
+        .arg(minutes, 2, 10, QChar('0'))
+        .arg(secs, 2, 10, QChar('0'));
+}
@@ -0,0 +1,117 @@
+#ifndef TIMERMODEL_H
+#define TIMERMODEL_H
+
+#include <QObject>
+#include <QProperty>
+#include <QString>
+#include "TimerState.h"
+
+// The timer's observable state as bindable properties.
+//
+// The five inputs are written by the timer; everything a view shows is a
+// binding over them, re-evaluated only when one of its inputs actually
+// changes. A tick that moves the countdown re-formats the time but leaves the
+// button states and cycle index alone, and the window title only follows the
+// countdown while the timer runs. Views attach notifiers to the derived
+// properties instead of recomputing them on every update.
+class TimerModel : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int remainingSeconds READ remainingSeconds WRITE setRemainingSeconds
+               NOTIFY remainingSecondsChanged BINDABLE bindableRemainingSeconds)
+    Q_PROPERTY(int totalSeconds READ totalSeconds WRITE setTotalSeconds
+               NOTIFY totalSecondsChanged BINDABLE bindableTotalSeconds)
+    Q_PROPERTY(TimerState state READ state WRITE setState NOTIFY stateChanged BINDABLE bindableState)
+    Q_PROPERTY(bool running READ isRunning WRITE setRunning NOTIFY runningChanged BINDABLE bindableRunning)
+    Q_PROPERTY(int completedSessions READ completedSessions WRITE setCompletedSessions
+               NOTIFY completedSessionsChanged BINDABLE bindableCompletedSessions)
+
+    Q_PROPERTY(int progress READ progress BINDABLE bindableProgress)
+    Q_PROPERTY(int cycleIndex READ cycleIndex BINDABLE bindableCycleIndex)
+    Q_PROPERTY(QString formattedTime READ formattedTime BINDABLE bindableFormattedTime)
+    Q_PROPERTY(QString windowTitle READ windowTitle BINDABLE bindableWindowTitle)
+    Q_PROPERTY(QString trayToolTip READ trayToolTip BINDABLE bindableTrayToolTip)
+    Q_PROPERTY(bool startEnabled READ isStartEnabled BINDABLE bindableStartEnabled)
+    Q_PROPERTY(bool resetVisible READ isResetVisible BINDABLE bindableResetVisible)
+
+public:
+    explicit TimerModel(int sessionsPerCycle, QObject *parent = nullptr);
+
+    // Inputs
+    [[nodiscard]] int remainingSeconds() const { return m_remainingSeconds; }
+    void setRemainingSeconds(int seconds) { m_remainingSeconds = seconds; }
+    QBindable<int> bindableRemainingSeconds() { return &m_remainingSeconds; }
+
+    [[nodiscard]] int totalSeconds() const { return m_totalSeconds; }
+    void setTotalSeconds(int seconds) { m_totalSeconds = seconds; }
+    QBindable<int> bindableTotalSeconds() { return &m_totalSeconds; }
+
+    [[nodiscard]] TimerState state() const { return m_state; }
+    void setState(TimerState state) { m_state = state; }
+    QBindable<TimerState> bindableState() { return &m_state; }
+
+    [[nodiscard]] bool isRunning() const { return m_running; }
+    void setRunning(bool running) { m_running = running; }
+    QBindable<bool> bindableRunning() { return &m_running; }
+
+    [[nodiscard]] int completedSessions() const { return m_completedSessions; }
+    void setCompletedSessions(int sessions) { m_completedSessions = sessions; }
+    QBindable<int> bindableCompletedSessions() { return &m_completedSessions; }
+
+    // Derived, read-only
+    [[nodiscard]] int progress() const { return m_progress; }           // percent elapsed
+    QBindable<int> bindableProgress() { return &m_progress; }
+    [[nodiscard]] int cycleIndex() const { return m_cycleIndex; }       // 1-based session in the cycle
+    QBindable<int> bindableCycleIndex() { return &m_cycleIndex; }
+    [[nodiscard]] QString formattedTime() const { return m_formattedTime; }
+    QBindable<QString> bindableFormattedTime() { return &m_formattedTime; }
+    [[nodiscard]] QString windowTitle() const { return m_windowTitle; }
+    QBindable<QString> bindableWindowTitle() { return &m_windowTitle; }
+    [[nodiscard]] QString trayToolTip() const { return m_trayToolTip; }
+    QBindable<QString> bindableTrayToolTip() { return &m_trayToolTip; }
+    [[nodiscard]] bool isStartEnabled() const { return m_startEnabled; }
+    QBindable<bool> bindableStartEnabled() { return &m_startEnabled; }
+    [[nodiscard]] bool isResetVisible() const { return m_resetVisible; }
+    QBindable<bool> bindableResetVisible() { return &m_resetVisible; }
+
+    [[nodiscard]] int sessionsPerCycle() const { return m_sessionsPerCycle; }
+
+    static QString formatTime(int seconds);
+
+    // Groups several input writes so bindings see them as one change
+    class UpdateGroup
+    {
+    public:
+        UpdateGroup() { Qt::beginPropertyUpdateGroup(); }
+        ~UpdateGroup() { Qt::endPropertyUpdateGroup(); }
+        UpdateGroup(const UpdateGroup&) = delete;
+        UpdateGroup& operator=(const UpdateGroup&) = delete;
+    };
+
+signals:
+    void remainingSecondsChanged();
+    void totalSecondsChanged();
+    void stateChanged();
+    void runningChanged();
+    void completedSessionsChanged();
+
+private:
+    const int m_sessionsPerCycle;
+
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, int, m_remainingSeconds, &TimerModel::remainingSecondsChanged)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, int, m_totalSeconds, &TimerModel::totalSecondsChanged)
+    Q_OBJECT_BINDABLE_PROPERTY_WITH_ARGS(TimerModel, TimerState, m_state, TimerState::Work,
+                                         &TimerModel::stateChanged)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, bool, m_running, &TimerModel::runningChanged)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, int, m_completedSessions, &TimerModel::completedSessionsChanged)
+
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, int, m_progress)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, int, m_cycleIndex)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, QString, m_formattedTime)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, QString, m_windowTitle)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, QString, m_trayToolTip)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, bool, m_startEnabled)
+    Q_OBJECT_BINDABLE_PROPERTY(TimerModel, bool, m_resetVisible)
+};
+
+#endif // TIMERMODEL_H
@@ -45,6 +45,19 @@ public:
         return text;
     }
 
+    // Stable identifiers used by history import/export
+    static QString getStateKey(TimerState state) noexcept {
+        switch (state) {
+            case TimerState::Work:
+                return "work";
+            case TimerState::ShortBreak:
+                return "shortBreak";
+            case TimerState::LongBreak:
+                return "longBreak";
+        }
+        return "work";
+    }
+
     static int getDurationForState(TimerState state, int workDuration, int shortBreak, int longBreak) noexcept {
         switch (state) {
             case TimerState::Work:
@@ -0,0 +1,143 @@
+#include "TeamRoom.h"
+#include "PomodoroConfig.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+
+namespace {
+    QString sessionName(SessionType type)
+    {
+        switch (type) {
+            case SessionType::Work:
+                return QStringLiteral("work");
+            case SessionType::ShortBreak:
+                return QStringLiteral("shortBreak");
+            case SessionType::LongBreak:
+                return QStringLiteral("longBreak");
+        }
+        return QStringLiteral("work");
+    }
+
+    QString statusName(TimerStatus status)
+    {
+        switch (status) {
+            case TimerStatus::Stopped:
+                return QStringLiteral("stopped");
+            case TimerStatus::Running:
+                return QStringLiteral("running");
+            case TimerStatus::Paused:
+                return QStringLiteral("paused");
+        }
+        return QStringLiteral("stopped");
+    }
+}
+
+TeamRoom::TeamRoom(const QString &name, QObject *parent)
+    : QObject(parent)
+    , m_name(name)
+    , m_controller(std::make_unique<TimerController>())
+{
+    const PomodoroConfig &config = PomodoroConfig::instance();
+    m_controller->setWorkDuration(config.workDuration());
+    m_controller->setShortBreakDuration(config.shortBreakDuration());
+    m_controller->setLongBreakDuration(config.longBreakDuration());
+    m_controller->reset();
+
+    // Ticks that only move the remaining time are not forwarded; clients count down locally
+    connect(m_controller.get(), &TimerController::stateUpdated, this,
+            [this](const TimerSnapshot &, TimerController::ChangeMask changes) {
+                if (changes != TimerController::ChangeMask(TimerController::RemainingChanged)) {
+                    scheduleBroadcast();
+                }
+            });
+    connect(m_controller.get(), &TimerController::timerFinished, this, &TeamRoom::onTimerFinished);
+}
+
+TeamRoom::~TeamRoom() = default;
+
+void TeamRoom::addClient(QTcpSocket *socket)
+{
+    if (!socket || m_clients.contains(socket)) return;
+
+    m_clients.insert(socket);
+    socket->write(stateMessage());
+}
+
+void TeamRoom::removeClient(QTcpSocket *socket)
+{
+    if (m_clients.remove(socket) && m_clients.isEmpty()) {
+        emit empty();
+    }
+}
+
+void TeamRoom::start()
+{
+    if (m_controller->state() != TimerStatus::Running) {
+        m_controller->start();
+    }
+}
+
+void TeamRoom::pause()
+{
+    m_controller->pause();
+}
+
+void TeamRoom::reset()
+{
+    m_controller->reset();
+}
+
+void TeamRoom::skip()
+{
+    m_controller->skip();
+}
+
+QByteArray TeamRoom::stateMessage() const
+{
+    QJsonObject message;
+    message.insert(QStringLiteral("ev"), QStringLiteral("state"));
+    message.insert(QStringLiteral("room"), m_name);
+    message.insert(QStringLiteral("session"), sessionName(m_controller->currentSessionType()));
+    message.insert(QStringLiteral("status"), statusName(m_controller->state()));
+    message.insert(QStringLiteral("deadline"), m_deadlineMs);
+    message.insert(QStringLiteral("remaining"), m_controller->remainingSeconds());
+    message.insert(QStringLiteral("total"), m_controller->totalSeconds());
+    message.insert(QStringLiteral("completed"), m_controller->completedSessions());
+    message.insert(QStringLiteral("serverTime"), QDateTime::currentMSecsSinceEpoch());
+
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    return line;
+}
+
+void TeamRoom::scheduleBroadcast()
+{
+    // Commands handled in the same event-loop pass (e.g. finish then auto-start) share one message
+    if (m_broadcastPending) return;
+    m_broadcastPending = true;
+    QMetaObject::invokeMethod(this, &TeamRoom::broadcast, Qt::QueuedConnection);
+}
+
+void TeamRoom::onTimerFinished()
+{
+    // startNextSession() runs right after this signal, so start the next session
+    // once control returns to the event loop to keep the whole room in lockstep
+    QMetaObject::invokeMethod(this, &TeamRoom::start, Qt::QueuedConnection);
+}
+
+void TeamRoom::broadcast()
+{
+    m_broadcastPending = false;
+
+    m_deadlineMs = m_controller->state() == TimerStatus::Running
+        ? QDateTime::currentMSecsSinceEpoch() + qint64(m_controller->remainingSeconds()) * 1000
+        : 0;
+
+    // Serialize once and share the implicitly shared buffer with every socket
+    const QByteArray line = stateMessage();
+    for (QTcpSocket *socket : std::as_const(m_clients)) {
+        socket->write(line);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef TEAMROOM_H
+#define TEAMROOM_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include <memory>
+#include "TimerController.h"
+
+class QTcpSocket;
+
+// A named room shares one authoritative TimerController between all of its
+// clients. Only transitions are broadcast: each message carries the absolute
+// deadline so clients can render the countdown locally without per-tick traffic.
+class TeamRoom : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TeamRoom(const QString &name, QObject *parent = nullptr);
+    ~TeamRoom() override;
+
+    [[nodiscard]] const QString& name() const { return m_name; }
+    [[nodiscard]] int clientCount() const { return static_cast<int>(m_clients.size()); }
+    [[nodiscard]] TimerController* controller() const { return m_controller.get(); }
+
+    void addClient(QTcpSocket *socket);
+    void removeClient(QTcpSocket *socket);
+
+    void start();
+    void pause();
+    void reset();
+    void skip();
+
+    // Current room state encoded as a single protocol line
+    [[nodiscard]] QByteArray stateMessage() const;
+
+signals:
+    void empty();
+
+private slots:
+    void scheduleBroadcast();
+    void onTimerFinished();
+
+private:
+    void broadcast();
+
+    QString m_name;
+    std::unique_ptr<TimerController> m_controller;
+    QSet<QTcpSocket*> m_clients;
+
+    // Absolute end of the running session in ms since epoch, 0 when not running
+    qint64 m_deadlineMs = 0;
+    bool m_broadcastPending = false;
+};
+
+#endif // TEAMROOM_H
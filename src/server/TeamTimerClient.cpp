@@ -0,0 +1,96 @@
+#include "TeamTimerClient.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QTcpSocket>
+
+TeamTimerClient::TeamTimerClient(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QTcpSocket(this))
+{
+    connect(m_socket, &QTcpSocket::connected, this, &TeamTimerClient::onConnected);
+    connect(m_socket, &QTcpSocket::disconnected, this, &TeamTimerClient::disconnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &TeamTimerClient::onReadyRead);
+}
+
+TeamTimerClient::~TeamTimerClient() = default;
+
+void TeamTimerClient::connectToServer(const QHostAddress &address, quint16 port, const QString &room)
+{
+    m_room = room;
+    m_lastState = QJsonObject();
+    m_socket->connectToHost(address, port);
+}
+
+void TeamTimerClient::disconnectFromServer()
+{
+    m_socket->disconnectFromHost();
+}
+
+void TeamTimerClient::start() { send(QStringLiteral("start")); }
+void TeamTimerClient::pause() { send(QStringLiteral("pause")); }
+void TeamTimerClient::reset() { send(QStringLiteral("reset")); }
+void TeamTimerClient::skip() { send(QStringLiteral("skip")); }
+
+bool TeamTimerClient::isConnected() const
+{
+    return m_socket->state() == QAbstractSocket::ConnectedState;
+}
+
+int TeamTimerClient::remainingSeconds() const
+{
+    const qint64 deadline = m_lastState.value(QStringLiteral("deadline")).toInteger();
+    if (deadline <= 0) {
+        return m_lastState.value(QStringLiteral("remaining")).toInt();
+    }
+
+    const qint64 serverNow = QDateTime::currentMSecsSinceEpoch() + m_clockOffsetMs;
+    return static_cast<int>(qMax<qint64>(0, (deadline - serverNow + 999) / 1000));
+}
+
+void TeamTimerClient::onConnected()
+{
+    QJsonObject join;
+    join.insert(QStringLiteral("op"), QStringLiteral("join"));
+    join.insert(QStringLiteral("room"), m_room);
+
+    QByteArray line = QJsonDocument(join).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    m_socket->write(line);
+
+    emit connected();
+}
+
+void TeamTimerClient::onReadyRead()
+{
+    while (m_socket->canReadLine()) {
+        const QJsonDocument document = QJsonDocument::fromJson(m_socket->readLine().trimmed());
+        if (!document.isObject()) continue;
+
+        const QJsonObject message = document.object();
+        const QString event = message.value(QStringLiteral("ev")).toString();
+
+        if (event == QLatin1String("state")) {
+            const qint64 serverTime = message.value(QStringLiteral("serverTime")).toInteger();
+            if (serverTime > 0) {
+                m_clockOffsetMs = serverTime - QDateTime::currentMSecsSinceEpoch();
+            }
+            m_lastState = message;
+            emit stateReceived(message);
+        } else if (event == QLatin1String("error")) {
+            emit errorReceived(message.value(QStringLiteral("message")).toString());
+        }
+    }
+}
+
+void TeamTimerClient::send(const QString &op)
+{
+    if (!isConnected()) return;
+
+    QJsonObject message;
+    message.insert(QStringLiteral("op"), op);
+
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    m_socket->write(line);
+}
@@ -0,0 +1,58 @@
+#ifndef TEAMTIMERCLIENT_H
+#define TEAMTIMERCLIENT_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QString>
+
+class QTcpSocket;
+
+// Minimal client for TeamTimerServer. It keeps the last authoritative room
+// state and derives the remaining time locally from the broadcast deadline.
+// Used by the --join command line mode and as a stand-in client when
+// exercising a server locally.
+class TeamTimerClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TeamTimerClient(QObject *parent = nullptr);
+    ~TeamTimerClient() override;
+
+    void connectToServer(const QHostAddress &address, quint16 port, const QString &room);
+    void disconnectFromServer();
+
+    void start();
+    void pause();
+    void reset();
+    void skip();
+
+    [[nodiscard]] bool isConnected() const;
+    [[nodiscard]] const QString& room() const { return m_room; }
+    [[nodiscard]] const QJsonObject& lastState() const { return m_lastState; }
+
+    // Remaining seconds computed from the deadline and the local clock,
+    // corrected by the server clock offset observed with the last message
+    [[nodiscard]] int remainingSeconds() const;
+
+signals:
+    void connected();
+    void disconnected();
+    void stateReceived(const QJsonObject &state);
+    void errorReceived(const QString &message);
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+
+private:
+    void send(const QString &op);
+
+    QTcpSocket *m_socket;
+    QString m_room;
+    QJsonObject m_lastState;
+    qint64 m_clockOffsetMs = 0;
+};
+
+#endif // TEAMTIMERCLIENT_H
@@ -0,0 +1,216 @@
+#include "TeamTimerServer.h"
+#include "TeamRoom.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+TeamTimerServer::TeamTimerServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+{
+    m_server->setMaxPendingConnections(PENDING_CONNECTIONS);
+    connect(m_server, &QTcpServer::newConnection, this, &TeamTimerServer::onNewConnection);
+}
+
+TeamTimerServer::~TeamTimerServer()
+{
+    close();
+}
+
+bool TeamTimerServer::listen(const QHostAddress &address, quint16 port)
+{
+    if (!m_server->listen(address, port)) {
+        qWarning() << "TeamTimerServer: cannot listen on" << address.toString() << port
+                   << "-" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void TeamTimerServer::close()
+{
+    m_server->close();
+
+    const auto sockets = m_clientRooms.keys();
+    for (QTcpSocket *socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_clientRooms.clear();
+    m_overlongLines.clear();
+
+    qDeleteAll(m_rooms);
+    m_rooms.clear();
+}
+
+bool TeamTimerServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+quint16 TeamTimerServer::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+QString TeamTimerServer::errorString() const
+{
+    return m_server->errorString();
+}
+
+void TeamTimerServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_clientRooms.insert(socket, nullptr);
+
+        connect(socket, &QTcpSocket::readyRead, this, &TeamTimerServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &TeamTimerServer::onDisconnected);
+    }
+}
+
+void TeamTimerServer::onReadyRead()
+{
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine(MAX_LINE_LENGTH + 1);
+        const bool complete = line.endsWith('\n');
+
+        // The rest of a line that was already rejected
+        if (m_overlongLines.contains(socket)) {
+            if (complete) {
+                m_overlongLines.remove(socket);
+            }
+            continue;
+        }
+        // readLine() stopped at the limit before the newline
+        if (!complete) {
+            rejectOverlongLine(socket);
+            continue;
+        }
+
+        line = line.trimmed();
+        if (!line.isEmpty()) {
+            handleMessage(socket, line);
+        }
+    }
+
+    // No newline buffered: a line already being discarded, or one that has
+    // outgrown the limit, must not grow the buffer without bound
+    if (m_overlongLines.contains(socket)) {
+        socket->skip(socket->bytesAvailable());
+    } else if (socket->bytesAvailable() > MAX_LINE_LENGTH) {
+        rejectOverlongLine(socket);
+        socket->skip(socket->bytesAvailable());
+    }
+}
+
+void TeamTimerServer::rejectOverlongLine(QTcpSocket *socket)
+{
+    sendError(socket, QStringLiteral("line too long"));
+    m_overlongLines.insert(socket);
+}
+
+void TeamTimerServer::onDisconnected()
+{
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    leaveRoom(socket);
+    m_clientRooms.remove(socket);
+    m_overlongLines.remove(socket);
+    socket->deleteLater();
+}
+
+void TeamTimerServer::handleMessage(QTcpSocket *socket, const QByteArray &line)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        sendError(socket, QStringLiteral("malformed message"));
+        return;
+    }
+
+    const QJsonObject message = document.object();
+    const QString op = message.value(QStringLiteral("op")).toString();
+
+    if (op == QLatin1String("join")) {
+        joinRoom(socket, message.value(QStringLiteral("room")).toString());
+        return;
+    }
+    if (op == QLatin1String("leave")) {
+        leaveRoom(socket);
+        return;
+    }
+
+    TeamRoom *room = m_clientRooms.value(socket, nullptr);
+    if (!room) {
+        sendError(socket, QStringLiteral("join a room first"));
+        return;
+    }
+
+    if (op == QLatin1String("start")) {
+        room->start();
+    } else if (op == QLatin1String("pause")) {
+        room->pause();
+    } else if (op == QLatin1String("reset")) {
+        room->reset();
+    } else if (op == QLatin1String("skip")) {
+        room->skip();
+    } else {
+        sendError(socket, QStringLiteral("unknown op: %1").arg(op));
+    }
+}
+
+void TeamTimerServer::joinRoom(QTcpSocket *socket, const QString &roomName)
+{
+    const QString name = roomName.trimmed();
+    if (name.isEmpty() || name.size() > MAX_ROOM_NAME_LENGTH) {
+        sendError(socket, QStringLiteral("invalid room name"));
+        return;
+    }
+
+    TeamRoom *current = m_clientRooms.value(socket, nullptr);
+    if (current && current->name() == name) return;
+    leaveRoom(socket);
+
+    TeamRoom *room = m_rooms.value(name, nullptr);
+    if (!room) {
+        room = new TeamRoom(name, this);
+        m_rooms.insert(name, room);
+        connect(room, &TeamRoom::empty, this, [this, room]() {
+            m_rooms.remove(room->name());
+            room->deleteLater();
+        });
+    }
+
+    m_clientRooms.insert(socket, room);
+    room->addClient(socket);
+}
+
+void TeamTimerServer::leaveRoom(QTcpSocket *socket)
+{
+    auto it = m_clientRooms.find(socket);
+    if (it == m_clientRooms.end() || !it.value()) return;
+
+    TeamRoom *room = it.value();
+    it.value() = nullptr;
+    room->removeClient(socket);
+}
+
+void TeamTimerServer::sendError(QTcpSocket *socket, const QString &message)
+{
+    QJsonObject error;
+    error.insert(QStringLiteral("ev"), QStringLiteral("error"));
+    error.insert(QStringLiteral("message"), message);
+
+    QByteArray line = QJsonDocument(error).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    socket->write(line);
+}
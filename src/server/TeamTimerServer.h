@@ -0,0 +1,68 @@
+#ifndef TEAMTIMERSERVER_H
+#define TEAMTIMERSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QSet>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+class TeamRoom;
+
+// Hosts named rooms over TCP using newline-delimited JSON.
+//
+// Client -> server: {"op":"join","room":"<name>"}, {"op":"start"}, {"op":"pause"},
+//                   {"op":"reset"}, {"op":"skip"}, {"op":"leave"}
+// Server -> client: {"ev":"state", ...} on join and on every room transition,
+//                   {"ev":"error","message":"..."} for rejected requests
+//
+// A line longer than MAX_LINE_LENGTH is rejected with "line too long" and
+// skipped up to its newline; the connection stays usable.
+//
+// Everything runs on the thread that owns the server; sockets are multiplexed
+// by the Qt event loop, so one thread serves thousands of connections.
+class TeamTimerServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TeamTimerServer(QObject *parent = nullptr);
+    ~TeamTimerServer() override;
+
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = DEFAULT_PORT);
+    void close();
+
+    [[nodiscard]] bool isListening() const;
+    [[nodiscard]] quint16 serverPort() const;
+    [[nodiscard]] QString errorString() const;
+    [[nodiscard]] int roomCount() const { return static_cast<int>(m_rooms.size()); }
+    [[nodiscard]] int clientCount() const { return static_cast<int>(m_clientRooms.size()); }
+
+    static constexpr quint16 DEFAULT_PORT = 4725;
+    static constexpr int MAX_LINE_LENGTH = 4096;
+    static constexpr int MAX_ROOM_NAME_LENGTH = 64;
+    static constexpr int PENDING_CONNECTIONS = 1024;
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    void handleMessage(QTcpSocket *socket, const QByteArray &line);
+    void joinRoom(QTcpSocket *socket, const QString &roomName);
+    void leaveRoom(QTcpSocket *socket);
+    void rejectOverlongLine(QTcpSocket *socket);
+    static void sendError(QTcpSocket *socket, const QString &message);
+
+    QTcpServer *m_server;
+    QHash<QString, TeamRoom*> m_rooms;
+    // Every connected client, mapped to its room (nullptr until it joins one)
+    QHash<QTcpSocket*, TeamRoom*> m_clientRooms;
+    // Clients whose current line exceeded MAX_LINE_LENGTH; read up to its newline and dropped
+    QSet<QTcpSocket*> m_overlongLines;
+};
+
+#endif // TEAMTIMERSERVER_H
@@ -0,0 +1,205 @@
+#include "AmbientNoiseGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr int FADE_FRAMES = AmbientNoiseGenerator::FADE_MS * AudioSource::SAMPLE_RATE / 1000;
+    constexpr float GAIN_PER_FRAME = 1.0f / FADE_FRAMES;
+    constexpr float TICK_FREQUENCY = 1800.0f;
+    constexpr float TICK_DECAY = 180.0f;          // per second
+    constexpr float TICK_AMPLITUDE = 0.6f;
+    constexpr float PINK_SCALE = 0.11f;
+    constexpr float BROWN_SCALE = 3.5f;
+    constexpr float PI = 3.14159265358979f;
+
+    float approach(float value, float target, float maxStep)
+    {
+        return value < target ? std::min(target, value + maxStep) : std::max(target, value - maxStep);
+    }
+}
+
+AmbientNoiseGenerator::AmbientNoiseGenerator()
+{
+    for (int lane = 0; lane < LANES; ++lane) {
+        m_rng[lane] = 0x9E3779B9u * static_cast<quint32>(lane + 1);
+    }
+
+    const int tickFrames = TICK_MS * SAMPLE_RATE / 1000;
+    m_tick.resize(tickFrames);
+    for (int i = 0; i < tickFrames; ++i) {
+        const float t = static_cast<float>(i) / SAMPLE_RATE;
+        m_tick[i] = TICK_AMPLITUDE * std::exp(-TICK_DECAY * t) * std::sin(2.0f * PI * TICK_FREQUENCY * t);
+    }
+}
+
+void AmbientNoiseGenerator::setLevel(float level)
+{
+    m_level.store(std::clamp(level, 0.0f, 1.0f), std::memory_order_relaxed);
+}
+
+bool AmbientNoiseGenerator::parseNoise(const QString &name, Noise &noise)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == QLatin1String("off") || key.isEmpty()) {
+        noise = Noise::Off;
+    } else if (key == QLatin1String("white")) {
+        noise = Noise::White;
+    } else if (key == QLatin1String("pink")) {
+        noise = Noise::Pink;
+    } else if (key == QLatin1String("brown")) {
+        noise = Noise::Brown;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString AmbientNoiseGenerator::noiseName(Noise noise)
+{
+    switch (noise) {
+    case Noise::White: return QStringLiteral("white");
+    case Noise::Pink: return QStringLiteral("pink");
+    case Noise::Brown: return QStringLiteral("brown");
+    case Noise::Off: break;
+    }
+    return QStringLiteral("off");
+}
+
+void AmbientNoiseGenerator::render(float *interleaved, int frames)
+{
+    for (int done = 0; done < frames;) {
+        const int count = std::min(BLOCK_FRAMES, frames - done);
+        renderBlock(interleaved + done * CHANNELS, count);
+        done += count;
+    }
+}
+
+bool AmbientNoiseGenerator::isIdle() const
+{
+    return m_gain == 0.0f && targetGain() == 0.0f;
+}
+
+float AmbientNoiseGenerator::targetGain() const
+{
+    const bool audible = m_active.load(std::memory_order_relaxed)
+        && (m_noise.load(std::memory_order_relaxed) != static_cast<int>(Noise::Off)
+            || m_ticking.load(std::memory_order_relaxed));
+    return audible ? m_level.load(std::memory_order_relaxed) : 0.0f;
+}
+
+void AmbientNoiseGenerator::renderBlock(float *interleaved, int frames)
+{
+    const Noise noise = static_cast<Noise>(m_noise.load(std::memory_order_relaxed));
+    const bool ticking = m_ticking.load(std::memory_order_relaxed);
+    const float target = targetGain();
+
+    // Silent and settled: cost is a few loads per block
+    if (target == 0.0f && m_gain == 0.0f) {
+        m_frame += frames;
+        m_tickPosition = -1;
+        return;
+    }
+
+    // Linear ramp across the block towards the target gain
+    const float endGain = approach(m_gain, target, GAIN_PER_FRAME * frames);
+    const float gainStep = (endGain - m_gain) / frames;
+
+    if (noise != Noise::Off) {
+        fillWhite(frames);
+        if (noise == Noise::Pink) {
+            applyPink(frames);
+        } else if (noise == Noise::Brown) {
+            applyBrown(frames);
+        }
+
+        const float startGain = m_gain;
+        for (int i = 0; i < frames; ++i) {
+            const float sample = m_block[i] * (startGain + gainStep * (i + 1));
+            interleaved[i * CHANNELS] += sample;
+            interleaved[i * CHANNELS + 1] += sample;
+        }
+    }
+
+    if (ticking) {
+        mixTicks(interleaved, frames, m_gain, gainStep);
+    } else {
+        m_tickPosition = -1;
+    }
+
+    m_gain = endGain;
+    m_frame += frames;
+}
+
+void AmbientNoiseGenerator::fillWhite(int frames)
+{
+    // Rounded up to whole lane groups; m_block holds BLOCK_FRAMES, a multiple of LANES
+    const int padded = (frames + LANES - 1) / LANES * LANES;
+    for (int i = 0; i < padded; i += LANES) {
+        for (int lane = 0; lane < LANES; ++lane) {
+            quint32 x = m_rng[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            m_rng[lane] = x;
+            m_block[i + lane] = static_cast<qint32>(x) * (1.0f / 2147483648.0f);
+        }
+    }
+}
+
+void AmbientNoiseGenerator::applyPink(int frames)
+{
+    // Paul Kellet's refined pink noise filter
+    auto &b = m_pink;
+    for (int i = 0; i < frames; ++i) {
+        const float white = m_block[i];
+        b[0] = 0.99886f * b[0] + white * 0.0555179f;
+        b[1] = 0.99332f * b[1] + white * 0.0750759f;
+        b[2] = 0.96900f * b[2] + white * 0.1538520f;
+        b[3] = 0.86650f * b[3] + white * 0.3104856f;
+        b[4] = 0.55000f * b[4] + white * 0.5329522f;
+        b[5] = -0.7616f * b[5] - white * 0.0168980f;
+        m_block[i] = (b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f) * PINK_SCALE;
+        b[6] = white * 0.115926f;
+    }
+}
+
+void AmbientNoiseGenerator::applyBrown(int frames)
+{
+    // Leaky integrator keeps the random walk bounded
+    float brown = m_brown;
+    for (int i = 0; i < frames; ++i) {
+        brown = (brown + 0.02f * m_block[i]) / 1.02f;
+        m_block[i] = brown * BROWN_SCALE;
+    }
+    m_brown = brown;
+}
+
+void AmbientNoiseGenerator::mixTicks(float *interleaved, int frames, float gain, float gainStep)
+{
+    const int tickFrames = static_cast<int>(m_tick.size());
+    for (int i = 0; i < frames;) {
+        if (m_tickPosition < 0) {
+            // Ticks start on whole seconds of the stream clock
+            const qint64 next = (m_frame + i + SAMPLE_RATE - 1) / SAMPLE_RATE * SAMPLE_RATE - m_frame;
+            if (next >= frames) {
+                return;
+            }
+            i = static_cast<int>(next);
+            m_tickPosition = 0;
+        }
+
+        const int count = std::min(frames - i, tickFrames - m_tickPosition);
+        const float *tick = m_tick.constData() + m_tickPosition;
+        for (int k = 0; k < count; ++k) {
+            const float sample = tick[k] * (gain + gainStep * (i + k + 1));
+            interleaved[(i + k) * CHANNELS] += sample;
+            interleaved[(i + k) * CHANNELS + 1] += sample;
+        }
+
+        i += count;
+        m_tickPosition += count;
+        if (m_tickPosition >= tickFrames) {
+            m_tickPosition = -1;
+        }
+    }
+}
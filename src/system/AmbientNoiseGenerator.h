@@ -0,0 +1,80 @@
+#ifndef AMBIENTNOISEGENERATOR_H
+#define AMBIENTNOISEGENERATOR_H
+
+#include <QString>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include "AudioSink.h"
+
+// Background noise for work sessions: white, pink or brown noise and an
+// optional clock tick once per second.
+//
+// All settings are atomics written from the GUI thread and read once per block
+// on the audio thread, so nothing locks. Synthesis runs in blocks of
+// BLOCK_FRAMES: white noise comes from LANES independent xorshift generators
+// laid out so the compiler vectorises them, and gain ramps and mixing are flat
+// loops over the block. Only the pink and brown filters are inherently serial.
+// setActive() fades the output in or out over FADE_MS instead of cutting it.
+// Once faded out the generator reports idle; the owner wakes the sink after
+// changing any setting.
+class AmbientNoiseGenerator : public AudioSource
+{
+public:
+    enum class Noise {
+        Off,
+        White,
+        Pink,
+        Brown
+    };
+
+    AmbientNoiseGenerator();
+
+    // Thread-safe; take effect on the next block
+    void setNoise(Noise noise) { m_noise.store(static_cast<int>(noise), std::memory_order_relaxed); }
+    void setLevel(float level);
+    void setTicking(bool enabled) { m_ticking.store(enabled, std::memory_order_relaxed); }
+    void setActive(bool active) { m_active.store(active, std::memory_order_relaxed); }
+
+    [[nodiscard]] Noise noise() const { return static_cast<Noise>(m_noise.load(std::memory_order_relaxed)); }
+    [[nodiscard]] bool isActive() const { return m_active.load(std::memory_order_relaxed); }
+
+    void render(float *interleaved, int frames) override;
+    // Faded out, or nothing to play
+    [[nodiscard]] bool isIdle() const override;
+
+    static bool parseNoise(const QString &name, Noise &noise);
+    static QString noiseName(Noise noise);
+
+    static constexpr int BLOCK_FRAMES = 256;
+    static constexpr int LANES = 8;
+    static constexpr int FADE_MS = 2000;
+    static constexpr int TICK_MS = 25;
+    static constexpr float DEFAULT_LEVEL = 0.3f;
+
+private:
+    [[nodiscard]] float targetGain() const;
+    void renderBlock(float *interleaved, int frames);
+    void fillWhite(int frames);
+    void applyPink(int frames);
+    void applyBrown(int frames);
+    void mixTicks(float *interleaved, int frames, float gain, float gainStep);
+
+    std::atomic<int> m_noise{static_cast<int>(Noise::Off)};
+    std::atomic<float> m_level{DEFAULT_LEVEL};
+    std::atomic_bool m_ticking{false};
+    std::atomic_bool m_active{false};
+
+    // Audio thread only
+    std::array<quint32, LANES> m_rng{};
+    std::array<float, BLOCK_FRAMES> m_block{};
+    std::array<float, 7> m_pink{};
+    float m_brown = 0.0f;
+    float m_gain = 0.0f;
+    qint64 m_frame = 0;
+    int m_tickPosition = -1;
+
+    QVector<float> m_tick;                  // one mono tick, built up front
+};
+
+#endif // AMBIENTNOISEGENERATOR_H
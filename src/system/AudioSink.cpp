@@ -0,0 +1,312 @@
+#include "AudioSink.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
+#include <functional>
+
+#ifdef POMODORO_HAVE_MULTIMEDIA
+#include <QAudioFormat>
+#include <QAudioSink>
+#include <QIODevice>
+#include <QMediaDevices>
+#endif
+
+namespace {
+    constexpr int BYTES_PER_FRAME = AudioSource::CHANNELS * static_cast<int>(sizeof(qint16));
+    constexpr int WAV_HEADER_SIZE = 44;
+
+#ifdef POMODORO_HAVE_MULTIMEDIA
+    // Output buffer kept small so a cue starts within a few milliseconds
+    constexpr int DEVICE_BUFFER_MS = 20;
+
+    // Pull-mode adapter: the audio backend reads, we render on demand
+    class MixDevice : public QIODevice
+    {
+    public:
+        using Render = std::function<void(float*, int)>;
+
+        explicit MixDevice(Render render) : m_render(std::move(render)) {}
+
+        qint64 bytesAvailable() const override { return BYTES_PER_FRAME * AudioSource::SAMPLE_RATE + QIODevice::bytesAvailable(); }
+        bool isSequential() const override { return true; }
+
+    protected:
+        qint64 readData(char *data, qint64 maxSize) override
+        {
+            const int frames = static_cast<int>(maxSize / BYTES_PER_FRAME);
+            if (frames <= 0) {
+                return 0;
+            }
+            if (m_mix.size() < frames * AudioSource::CHANNELS) {
+                m_mix.resize(frames * AudioSource::CHANNELS);
+            }
+            m_render(m_mix.data(), frames);
+
+            auto *out = reinterpret_cast<qint16*>(data);
+            for (int i = 0; i < frames * AudioSource::CHANNELS; ++i) {
+                out[i] = AudioSink::toInt16(m_mix[i]);
+            }
+            return static_cast<qint64>(frames) * BYTES_PER_FRAME;
+        }
+
+        qint64 writeData(const char *, qint64) override { return -1; }
+
+    private:
+        Render m_render;
+        QVector<float> m_mix;
+    };
+
+    class DeviceAudioSink : public AudioSink
+    {
+    public:
+        using AudioSink::AudioSink;
+        ~DeviceAudioSink() override { stop(); }
+
+        bool start() override
+        {
+            if (m_output) {
+                return true;
+            }
+
+            QAudioFormat format;
+            format.setSampleRate(AudioSource::SAMPLE_RATE);
+            format.setChannelCount(AudioSource::CHANNELS);
+            format.setSampleFormat(QAudioFormat::Int16);
+
+            const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+            if (device.isNull() || !device.isFormatSupported(format)) {
+                qWarning() << "AudioSink: no output device supports 48 kHz stereo";
+                return false;
+            }
+
+            m_device = std::make_unique<MixDevice>([this](float *out, int frames) { mix(out, frames); });
+            m_device->open(QIODevice::ReadOnly);
+            m_output = new QAudioSink(device, format, this);
+            m_output->setBufferSize(AudioSource::SAMPLE_RATE * DEVICE_BUFFER_MS / 1000 * BYTES_PER_FRAME);
+            m_output->start(m_device.get());
+            return true;
+        }
+
+        void stop() override
+        {
+            if (!m_output) {
+                return;
+            }
+            m_output->stop();
+            delete m_output;
+            m_output = nullptr;
+            m_device.reset();
+        }
+
+        [[nodiscard]] bool isActive() const override { return m_output != nullptr; }
+
+    private:
+        QAudioSink *m_output = nullptr;
+        std::unique_ptr<MixDevice> m_device;
+    };
+#endif
+}
+
+AudioSink::AudioSink(QObject *parent)
+    : QObject(parent)
+{
+}
+
+std::unique_ptr<AudioSink> AudioSink::create(const QString &spec)
+{
+    if (spec.compare(QStringLiteral("null"), Qt::CaseInsensitive) == 0) {
+        return std::make_unique<NullAudioSink>();
+    }
+    if (spec.endsWith(QStringLiteral(".wav"), Qt::CaseInsensitive)) {
+        return std::make_unique<WavFileSink>(spec);
+    }
+    if (!spec.isEmpty() && spec.compare(QStringLiteral("device"), Qt::CaseInsensitive) != 0) {
+        qWarning() << "AudioSink: unknown sink" << spec << "- using the default";
+    }
+#ifdef POMODORO_HAVE_MULTIMEDIA
+    return std::make_unique<DeviceAudioSink>();
+#else
+    qWarning() << "AudioSink: built without Qt Multimedia; sound is discarded";
+    return std::make_unique<NullAudioSink>();
+#endif
+}
+
+void AudioSink::addSource(AudioSource *source)
+{
+    if (source && !m_sources.contains(source)) {
+        m_sources.append(source);
+    }
+}
+
+void AudioSink::removeSource(AudioSource *source)
+{
+    m_sources.removeAll(source);
+}
+
+void AudioSink::wake()
+{
+    QMetaObject::invokeMethod(this, &AudioSink::resume, Qt::QueuedConnection);
+}
+
+bool AudioSink::sourcesIdle() const
+{
+    return std::all_of(m_sources.cbegin(), m_sources.cend(), [](const AudioSource *source) {
+        return source->isIdle();
+    });
+}
+
+void AudioSink::mix(float *interleaved, int frames) const
+{
+    std::fill_n(interleaved, frames * AudioSource::CHANNELS, 0.0f);
+    for (AudioSource *source : m_sources) {
+        source->render(interleaved, frames);
+    }
+}
+
+qint16 AudioSink::toInt16(float sample)
+{
+    return static_cast<qint16>(std::clamp(sample, -1.0f, 1.0f) * 32767.0f);
+}
+
+ClockedAudioSink::ClockedAudioSink(QObject *parent)
+    : AudioSink(parent)
+    , m_clock(new QTimer(this))
+{
+    m_clock->setInterval(TICK_MS);
+    m_clock->setTimerType(Qt::PreciseTimer);
+    connect(m_clock, &QTimer::timeout, this, &ClockedAudioSink::tick);
+}
+
+bool ClockedAudioSink::start()
+{
+    if (m_started) {
+        return true;
+    }
+    if (!open()) {
+        return false;
+    }
+    m_started = true;
+    resume();
+    return true;
+}
+
+void ClockedAudioSink::stop()
+{
+    if (!m_started) {
+        return;
+    }
+    if (m_clock->isActive()) {
+        m_clock->stop();
+        tick();
+    }
+    m_started = false;
+    close();
+}
+
+bool ClockedAudioSink::isActive() const
+{
+    return m_started;
+}
+
+void ClockedAudioSink::resume()
+{
+    if (!m_started || m_clock->isActive()) {
+        return;
+    }
+    m_framesRendered = 0;
+    m_elapsed.start();
+    m_clock->start();
+}
+
+void ClockedAudioSink::advance(int frames)
+{
+    if (frames <= 0) {
+        return;
+    }
+    if (m_buffer.size() < frames * AudioSource::CHANNELS) {
+        m_buffer.resize(frames * AudioSource::CHANNELS);
+    }
+    mix(m_buffer.data(), frames);
+    consume(m_buffer.constData(), frames);
+    m_framesRendered += frames;
+}
+
+void ClockedAudioSink::tick()
+{
+    const qint64 due = m_elapsed.elapsed() * AudioSource::SAMPLE_RATE / 1000;
+    advance(static_cast<int>(due - m_framesRendered));
+    if (!keepsTime() && sourcesIdle()) {
+        m_clock->stop();
+    }
+}
+
+WavFileSink::WavFileSink(const QString &path, QObject *parent)
+    : ClockedAudioSink(parent)
+    , m_file(path)
+{
+}
+
+WavFileSink::~WavFileSink()
+{
+    stop();
+}
+
+bool WavFileSink::open()
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "WavFileSink: cannot open" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    m_dataBytes = 0;
+    writeHeader(0);
+    return true;
+}
+
+void WavFileSink::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    m_file.seek(0);
+    writeHeader(m_dataBytes);
+    m_file.close();
+}
+
+void WavFileSink::consume(const float *interleaved, int frames)
+{
+    const int count = frames * AudioSource::CHANNELS;
+    if (m_samples.size() < count) {
+        m_samples.resize(count);
+    }
+    for (int i = 0; i < count; ++i) {
+        m_samples[i] = qToLittleEndian(toInt16(interleaved[i]));
+    }
+
+    const qint64 bytes = static_cast<qint64>(frames) * BYTES_PER_FRAME;
+    if (m_file.write(reinterpret_cast<const char*>(m_samples.constData()), bytes) != bytes) {
+        qWarning() << "WavFileSink: write failed" << m_file.errorString();
+        return;
+    }
+    m_dataBytes += static_cast<quint32>(bytes);
+}
+
+void WavFileSink::writeHeader(quint32 dataBytes)
+{
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream.writeRawData("RIFF", 4);
+    stream << quint32(WAV_HEADER_SIZE - 8 + dataBytes);
+    stream.writeRawData("WAVEfmt ", 8);
+    stream << quint32(16)                                   // fmt chunk size
+           << quint16(1)                                    // PCM
+           << quint16(AudioSource::CHANNELS)
+           << quint32(AudioSource::SAMPLE_RATE)
+           << quint32(AudioSource::SAMPLE_RATE * BYTES_PER_FRAME)
+           << quint16(BYTES_PER_FRAME)
+           << quint16(16);                                  // bits per sample
+    stream.writeRawData("data", 4);
+    stream << dataBytes;
+}
@@ -0,0 +1,139 @@
+#ifndef AUDIOSINK_H
+#define AUDIOSINK_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class QTimer;
+
+// Something that produces interleaved stereo float frames at SAMPLE_RATE.
+// render() is called from whatever thread drives the sink, so implementations
+// must not block or allocate; they add into the buffer rather than overwrite it.
+class AudioSource
+{
+public:
+    virtual ~AudioSource() = default;
+    virtual void render(float *interleaved, int frames) = 0;
+    // Render thread; true while render() would add nothing but silence
+    [[nodiscard]] virtual bool isIdle() const { return false; }
+
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int CHANNELS = 2;
+};
+
+// Pulls frames from its sources and sends the mix somewhere. Sources are added
+// before start() and must outlive the sink. The sink may be moved to its own
+// thread before start(); start(), stop() and the rendering then run there.
+class AudioSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioSink(QObject *parent = nullptr);
+    ~AudioSink() override = default;
+
+    // "device" (the default output), "null", or a path ending in .wav
+    static std::unique_ptr<AudioSink> create(const QString &spec);
+
+    void addSource(AudioSource *source);
+    void removeSource(AudioSource *source);
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    [[nodiscard]] virtual bool isActive() const = 0;
+
+    // Thread-safe: a source has something to play again after going idle
+    void wake();
+
+    // Clamps to [-1, 1] and scales to 16-bit PCM
+    static qint16 toInt16(float sample);
+
+protected:
+    // Clears the buffer and sums every source into it
+    void mix(float *interleaved, int frames) const;
+    [[nodiscard]] bool sourcesIdle() const;
+    // Sink thread, after wake()
+    virtual void resume() {}
+
+private:
+    QVector<AudioSource*> m_sources;
+};
+
+// Renders in real time from a timer on the owning thread. advance() renders a
+// fixed number of frames immediately, which makes output deterministic headless.
+// Unless the sink keeps time, the timer stops once every source is idle and
+// restarts on wake(), so a silent sink costs nothing.
+class ClockedAudioSink : public AudioSink
+{
+    Q_OBJECT
+
+public:
+    explicit ClockedAudioSink(QObject *parent = nullptr);
+
+    bool start() override;
+    void stop() override;
+    [[nodiscard]] bool isActive() const override;
+
+    void advance(int frames);
+
+    static constexpr int TICK_MS = 10;
+
+protected:
+    virtual bool open() { return true; }
+    virtual void close() {}
+    virtual void consume(const float *interleaved, int frames) = 0;
+    // True if silence must be consumed like any other output
+    [[nodiscard]] virtual bool keepsTime() const { return false; }
+    void resume() override;
+
+private:
+    void tick();
+
+    QTimer *m_clock;
+    QElapsedTimer m_elapsed;
+    qint64 m_framesRendered = 0;
+    QVector<float> m_buffer;
+    bool m_started = false;
+};
+
+// Discards the mix; keeps sources advancing as if a device were attached
+class NullAudioSink : public ClockedAudioSink
+{
+    Q_OBJECT
+
+public:
+    using ClockedAudioSink::ClockedAudioSink;
+
+protected:
+    void consume(const float *, int) override {}
+};
+
+// Writes the mix as 16-bit stereo PCM; the RIFF sizes are patched on stop()
+class WavFileSink : public ClockedAudioSink
+{
+    Q_OBJECT
+
+public:
+    explicit WavFileSink(const QString &path, QObject *parent = nullptr);
+    ~WavFileSink() override;
+
+protected:
+    bool open() override;
+    void close() override;
+    void consume(const float *interleaved, int frames) override;
+    // The file is a timeline; gaps are written as silence
+    [[nodiscard]] bool keepsTime() const override { return true; }
+
+private:
+    void writeHeader(quint32 dataBytes);
+
+    QFile m_file;
+    quint32 m_dataBytes = 0;
+    QVector<qint16> m_samples;
+};
+
+#endif // AUDIOSINK_H
@@ -0,0 +1,276 @@
+#include "HookRunner.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include "PomodoroConfig.h"
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <unistd.h>
+#endif
+
+namespace {
+    const QString LOG_FILE = QStringLiteral("hooks.log");
+    constexpr std::array<const char*, HookRunner::HOOK_COUNT> HOOK_KEYS = {
+        "workStart", "workEnd", "breakStart", "breakEnd", "skip", "reset"
+    };
+
+    QString sessionTypeName(uint32_t type)
+    {
+        switch (type) {
+        case POMODORO_SESSION_WORK: return QStringLiteral("work");
+        case POMODORO_SESSION_SHORT_BREAK: return QStringLiteral("short_break");
+        case POMODORO_SESSION_LONG_BREAK: return QStringLiteral("long_break");
+        }
+        return QString();
+    }
+}
+
+HookRunner::HookRunner(QObject *parent)
+    : QObject(parent)
+    , m_baseEnvironment(QProcessEnvironment::systemEnvironment())
+    , m_maxConcurrent(PomodoroConfig::DEFAULT_HOOK_CONCURRENCY)
+    , m_timeoutMs(PomodoroConfig::DEFAULT_HOOK_TIMEOUT_SECONDS * 1000)
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(directory);
+    m_logPath = directory + "/" + LOG_FILE;
+
+    m_logThread = std::make_unique<QThread>();
+    m_logThread->setObjectName(QStringLiteral("HookLog"));
+    m_logContext = new QObject();
+    m_logContext->moveToThread(m_logThread.get());
+    connect(m_logThread.get(), &QThread::finished, m_logContext, &QObject::deleteLater);
+    m_logThread->start(QThread::LowestPriority);
+}
+
+HookRunner::~HookRunner()
+{
+    // Commands still running are killed with their process groups; nothing reports back
+    for (auto it = m_running.cbegin(); it != m_running.cend(); ++it) {
+        it.key()->disconnect(this);
+        kill(it.key());
+    }
+
+    // Queued behind the pending writes, so every entry reaches the log
+    QThread *logThread = m_logThread.get();
+    QMetaObject::invokeMethod(m_logContext, [logThread]() { logThread->quit(); }, Qt::QueuedConnection);
+    m_logThread->wait();
+}
+
+QString HookRunner::hookKey(Hook hook)
+{
+    return QString::fromLatin1(HOOK_KEYS[static_cast<size_t>(hook)]);
+}
+
+bool HookRunner::parseHook(const QString &key, Hook &hook)
+{
+    for (size_t i = 0; i < HOOK_KEYS.size(); ++i) {
+        if (key == QLatin1String(HOOK_KEYS[i])) {
+            hook = static_cast<Hook>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HookRunner::setCommands(const QHash<QString, QString> &commands)
+{
+    m_commands.fill(QString());
+    for (auto it = commands.cbegin(); it != commands.cend(); ++it) {
+        Hook hook;
+        if (!parseHook(it.key(), hook)) {
+            qWarning() << "HookRunner: ignoring unknown hook" << it.key();
+            continue;
+        }
+        m_commands[static_cast<size_t>(hook)] = it.value();
+    }
+}
+
+bool HookRunner::hasCommands() const
+{
+    return std::any_of(m_commands.cbegin(), m_commands.cend(), [](const QString &command) {
+        return !command.isEmpty();
+    });
+}
+
+void HookRunner::handle(const pomodoro_event &event)
+{
+    const bool work = event.session_type == POMODORO_SESSION_WORK;
+    Hook hook;
+    switch (event.type) {
+    case POMODORO_EVENT_SESSION_STARTED:
+        hook = work ? Hook::WorkStart : Hook::BreakStart;
+        break;
+    case POMODORO_EVENT_SESSION_FINISHED:
+        hook = work ? Hook::WorkEnd : Hook::BreakEnd;
+        break;
+    case POMODORO_EVENT_SESSION_SKIPPED:
+        hook = Hook::Skip;
+        break;
+    case POMODORO_EVENT_SESSION_RESET:
+        hook = Hook::Reset;
+        break;
+    default:
+        return;
+    }
+
+    const QString &command = m_commands[static_cast<size_t>(hook)];
+    if (command.isEmpty()) return;
+
+    Job job{hook, command, m_baseEnvironment};
+    job.environment.insert(QStringLiteral("POMODORO_EVENT"), hookKey(hook));
+    job.environment.insert(QStringLiteral("POMODORO_SESSION_TYPE"), sessionTypeName(event.session_type));
+    job.environment.insert(QStringLiteral("POMODORO_SESSION_ID"), QString::number(event.session_id));
+    job.environment.insert(QStringLiteral("POMODORO_PLANNED_SECONDS"), QString::number(event.planned_seconds));
+    job.environment.insert(QStringLiteral("POMODORO_ELAPSED_SECONDS"), QString::number(event.elapsed_seconds));
+    job.environment.insert(QStringLiteral("POMODORO_COMPLETED_SESSIONS"), QString::number(event.completed_sessions));
+    job.environment.insert(QStringLiteral("POMODORO_TAG"), QString::fromUtf8(event.tag));
+    job.environment.insert(QStringLiteral("POMODORO_TIME"),
+                           QDateTime::fromMSecsSinceEpoch(event.wall_time_ms).toString(Qt::ISODate));
+
+    if (m_running.size() < m_maxConcurrent) {
+        start(job);
+    } else if (m_pending.size() < MAX_PENDING) {
+        m_pending.enqueue(job);
+    } else {
+        qWarning() << "HookRunner: too many hooks waiting, dropping" << hookKey(hook);
+        appendLog(job, QStringLiteral("dropped, queue full"), QByteArray());
+    }
+}
+
+void HookRunner::start(const Job &job)
+{
+    auto *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    process->setProcessEnvironment(job.environment);
+#ifdef Q_OS_WIN
+    process->setProgram(QStringLiteral("cmd.exe"));
+    process->setArguments({QStringLiteral("/c"), job.command});
+#else
+    process->setProgram(QStringLiteral("/bin/sh"));
+    process->setArguments({QStringLiteral("-c"), job.command});
+    // The shell leads a new session and process group, so a timeout can kill
+    // whatever it started as well
+    process->setChildProcessModifier([]() { ::setsid(); });
+#endif
+
+    Run &run = m_running[process];
+    run.job = job;
+    run.elapsed.start();
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, process]() { readOutput(process); });
+    connect(process, &QProcess::finished, this, [this, process](int exitCode, QProcess::ExitStatus status) {
+        const auto it = m_running.constFind(process);
+        if (it == m_running.cend()) return;
+        QString outcome;
+        if (it->timedOut) {
+            outcome = QStringLiteral("killed after %1 ms timeout").arg(m_timeoutMs);
+        } else if (status == QProcess::CrashExit) {
+            outcome = QStringLiteral("crashed");
+        } else {
+            outcome = QStringLiteral("exit %1").arg(exitCode);
+        }
+        finish(process, outcome);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        // Every other error is followed by finished()
+        if (error == QProcess::FailedToStart) {
+            finish(process, QStringLiteral("failed to start: %1").arg(process->errorString()));
+        }
+    });
+    QTimer::singleShot(m_timeoutMs, process, [this, process]() {
+        const auto it = m_running.find(process);
+        if (it != m_running.end()) {
+            it->timedOut = true;
+            kill(process);
+        }
+    });
+
+    process->start();
+}
+
+void HookRunner::startPending()
+{
+    while (m_running.size() < m_maxConcurrent && !m_pending.isEmpty()) {
+        start(m_pending.dequeue());
+    }
+}
+
+void HookRunner::readOutput(QProcess *process)
+{
+    const auto it = m_running.find(process);
+    if (it == m_running.end()) return;
+
+    // Always drained so a chatty command never blocks on a full pipe; only the start is kept
+    const QByteArray data = process->readAll();
+    const qsizetype room = MAX_CAPTURED_OUTPUT - it->output.size();
+    if (room > 0) {
+        it->output.append(data.left(room));
+    }
+}
+
+void HookRunner::finish(QProcess *process, const QString &outcome)
+{
+    readOutput(process);
+    const auto it = m_running.find(process);
+    if (it == m_running.end()) return;
+
+    const Run run = it.value();
+    m_running.erase(it);
+    process->deleteLater();
+
+    appendLog(run.job, QStringLiteral("%1 in %2 ms").arg(outcome, QString::number(run.elapsed.elapsed())), run.output);
+    startPending();
+}
+
+void HookRunner::kill(QProcess *process)
+{
+#ifdef Q_OS_UNIX
+    // Still running, so not yet reaped: the group ID cannot have been reused
+    const qint64 pid = process->processId();
+    if (pid > 0) {
+        ::kill(-static_cast<pid_t>(pid), SIGKILL);
+        return;
+    }
+#endif
+    process->kill();
+}
+
+void HookRunner::appendLog(const Job &job, const QString &outcome, const QByteArray &output) const
+{
+    QByteArray entry = QStringLiteral("[%1] %2: %3 (%4)\n")
+                           .arg(QDateTime::currentDateTime().toString(Qt::ISODate), hookKey(job.hook),
+                                job.command, outcome)
+                           .toUtf8();
+    const QList<QByteArray> lines = output.split('\n');
+    for (const QByteArray &line : lines) {
+        if (!line.isEmpty()) {
+            entry += "    " + line + '\n';
+        }
+    }
+
+    const QString path = m_logPath;
+    QMetaObject::invokeMethod(m_logContext, [path, entry]() { writeLog(path, entry); }, Qt::QueuedConnection);
+}
+
+void HookRunner::writeLog(const QString &path, const QByteArray &entry)
+{
+    QFile file(path);
+    if (file.size() > MAX_LOG_SIZE) {
+        const QString previous = path + ".1";
+        QFile::remove(previous);
+        QFile::rename(path, previous);
+    }
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "HookRunner: cannot write" << path;
+        return;
+    }
+    file.write(entry);
+}
@@ -0,0 +1,98 @@
+#ifndef HOOKRUNNER_H
+#define HOOKRUNNER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QProcessEnvironment>
+#include <QQueue>
+#include <QString>
+#include <array>
+#include <memory>
+#include "PomodoroPlugin.h"
+
+class QProcess;
+class QThread;
+
+// Runs the user's shell commands on timer events ("hooks").
+//
+// Commands start through QProcess without waiting for them: at most
+// maxConcurrent run at once, further ones queue up to MAX_PENDING and are
+// dropped beyond that, and a command still running after the timeout is
+// killed together with everything it started. Each one gets POMODORO_*
+// variables describing the session, and its merged output, exit status and
+// duration go to hooks.log in the app data directory, written on a
+// low-priority thread.
+class HookRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Hook {
+        WorkStart,
+        WorkEnd,
+        BreakStart,
+        BreakEnd,
+        Skip,
+        Reset
+    };
+
+    explicit HookRunner(QObject *parent = nullptr);
+    ~HookRunner() override;
+
+    // key is a hookKey(); unknown keys are reported and ignored
+    void setCommands(const QHash<QString, QString> &commands);
+    void setMaxConcurrent(int count) { m_maxConcurrent = qMax(1, count); }
+    void setTimeoutMs(int ms) { m_timeoutMs = qMax(1, ms); }
+
+    [[nodiscard]] bool hasCommands() const;
+
+    // Maps a timer event to its hook and queues the command, if one is set
+    void handle(const pomodoro_event &event);
+
+    [[nodiscard]] int runningCount() const { return static_cast<int>(m_running.size()); }
+    [[nodiscard]] int pendingCount() const { return static_cast<int>(m_pending.size()); }
+
+    static QString hookKey(Hook hook);
+    static bool parseHook(const QString &key, Hook &hook);
+
+    static constexpr int HOOK_COUNT = 6;
+    static constexpr int MAX_PENDING = 32;
+    static constexpr int MAX_CAPTURED_OUTPUT = 16 * 1024;     // bytes logged per run
+    static constexpr qint64 MAX_LOG_SIZE = 1024 * 1024;        // rotated to hooks.log.1 beyond this
+
+private:
+    struct Job {
+        Hook hook = Hook::WorkStart;
+        QString command;
+        QProcessEnvironment environment;
+    };
+
+    struct Run {
+        Job job;
+        QByteArray output;
+        QElapsedTimer elapsed;
+        bool timedOut = false;
+    };
+
+    void start(const Job &job);
+    void startPending();
+    void readOutput(QProcess *process);
+    void finish(QProcess *process, const QString &outcome);
+    void appendLog(const Job &job, const QString &outcome, const QByteArray &output) const;
+    static void writeLog(const QString &path, const QByteArray &entry);
+    static void kill(QProcess *process);
+
+    std::array<QString, HOOK_COUNT> m_commands;
+    QQueue<Job> m_pending;
+    QHash<QProcess*, Run> m_running;
+    QProcessEnvironment m_baseEnvironment;
+    int m_maxConcurrent;
+    int m_timeoutMs;
+    QString m_logPath;
+
+    std::unique_ptr<QThread> m_logThread;
+    QObject *m_logContext = nullptr;        // lives on m_logThread; runs the queued log writes
+};
+
+#endif // HOOKRUNNER_H
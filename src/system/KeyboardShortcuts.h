@@ -17,6 +17,7 @@ signals:
     void resetRequested();
     void settingsRequested();
     void skipRequested();
+    void hudToggleRequested();
 
 private:
     void setupShortcuts(QWidget *parent);
@@ -26,6 +27,7 @@ private:
     QShortcut *m_resetShortcut{};
     QShortcut *m_settingsShortcut{};
     QShortcut *m_skipShortcut{};
+    QShortcut *m_hudShortcut{};
 };
 
 #endif // KEYBOARDSHORTCUTS_H
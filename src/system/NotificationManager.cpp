@@ -1,14 +1,27 @@
 #include "NotificationManager.h"
 #include "SystemTrayManager.h"
+#include <QLabel>
+#include <QTimer>
 #include <QWidget>
-#include <QMessageBox>
 
 NotificationManager::NotificationManager(QWidget *parent)
     : QObject(parent)
     , m_parent(parent)
     , m_trayManager(nullptr)
     , m_notificationsEnabled(true)
+    , m_dispatchTimer(new QTimer(this))
+    , m_toastTimer(new QTimer(this))
 {
+    m_dispatchTimer->setSingleShot(true);
+    connect(m_dispatchTimer, &QTimer::timeout, this, &NotificationManager::deliverNext);
+
+    m_toastTimer->setSingleShot(true);
+    m_toastTimer->setInterval(TOAST_DURATION_MS);
+    connect(m_toastTimer, &QTimer::timeout, this, [this]() {
+        if (m_toast) {
+            m_toast->hide();
+        }
+    });
 }
 
 NotificationManager::~NotificationManager() = default;
@@ -25,17 +38,79 @@ void NotificationManager::setSystemTrayManager(SystemTrayManager *trayManager)
 void NotificationManager::setNotificationsEnabled(bool enabled)
 {
     m_notificationsEnabled = enabled;
+    if (!enabled) {
+        m_queue.clear();
+        m_dispatchTimer->stop();
+    }
 }
 
-void NotificationManager::showNotification(const QString &message) const
+void NotificationManager::showNotification(const QString &message, Kind kind)
 {
     if (!m_notificationsEnabled || message.isEmpty()) {
         return;
     }
 
+    // Only the latest notification of each kind is worth showing
+    for (Pending &pending : m_queue) {
+        if (pending.kind == kind) {
+            pending.message = message;
+            return;
+        }
+    }
+    m_queue.append({kind, message});
+    scheduleDelivery();
+}
+
+void NotificationManager::scheduleDelivery()
+{
+    if (m_queue.isEmpty() || m_dispatchTimer->isActive()) {
+        return;
+    }
+
+    int delay = 0;
+    if (m_lastDelivery.isValid()) {
+        delay = qMax<qint64>(0, MIN_DELIVERY_INTERVAL_MS - m_lastDelivery.elapsed());
+    }
+    m_dispatchTimer->start(delay);
+}
+
+void NotificationManager::deliverNext()
+{
+    if (m_queue.isEmpty()) {
+        return;
+    }
+
+    const Pending pending = m_queue.takeFirst();
     if (m_trayManager && m_trayManager->isVisible()) {
-        m_trayManager->showMessage(QStringLiteral("Pomodoro Timer"), message);
+        m_trayManager->showMessage(QStringLiteral("Pomodoro Timer"), pending.message);
     } else if (m_parent) {
-        QMessageBox::information(m_parent, QStringLiteral("Pomodoro Timer"), message);
+        showToast(pending.message);
     }
+    m_lastDelivery.start();
+    emit notificationDelivered(pending.kind, pending.message);
+
+    scheduleDelivery();
+}
+
+void NotificationManager::showToast(const QString &message)
+{
+    if (!m_toast) {
+        m_toast = new QLabel(m_parent);
+        m_toast->setObjectName(QStringLiteral("notificationToast"));
+        m_toast->setWordWrap(true);
+        m_toast->setAlignment(Qt::AlignCenter);
+        m_toast->setAttribute(Qt::WA_TransparentForMouseEvents);
+        m_toast->setStyleSheet(QStringLiteral(
+            "QLabel#notificationToast { background-color: rgba(44, 62, 80, 230); color: white;"
+            " border-radius: 8px; padding: 8px 12px; font-size: 12px; }"));
+    }
+
+    const int width = m_parent->width() - 2 * TOAST_MARGIN;
+    m_toast->setText(message);
+    m_toast->setFixedWidth(width);
+    m_toast->adjustSize();
+    m_toast->move(TOAST_MARGIN, m_parent->height() - m_toast->height() - TOAST_MARGIN);
+    m_toast->raise();
+    m_toast->show();
+    m_toastTimer->start();
 }
@@ -1,29 +1,71 @@
 #ifndef NOTIFICATIONMANAGER_H
 #define NOTIFICATIONMANAGER_H
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QPointer>
 #include <QString>
+#include <QVector>
 
+class QLabel;
+class QTimer;
 class QWidget;
 class SystemTrayManager;
 
+// Notifications are queued and delivered from the event loop, so callers such
+// as the timer transition never wait on them. A newer notification of the same
+// kind replaces one that is still queued, and deliveries are spaced at least
+// MIN_DELIVERY_INTERVAL_MS apart. Without a visible tray icon they appear as a
+// non-modal toast inside the parent window instead of a message box.
 class NotificationManager : public QObject
 {
     Q_OBJECT
 
 public:
+    enum class Kind {
+        SessionFinished,
+        Info
+    };
+    Q_ENUM(Kind)
+
     explicit NotificationManager(QWidget *parent = nullptr);
     ~NotificationManager() override;
 
     void setSystemTrayManager(SystemTrayManager *trayManager);
     void setNotificationsEnabled(bool enabled);
-    void showNotification(const QString &message) const;
+    void showNotification(const QString &message, Kind kind = Kind::Info);
+
+    [[nodiscard]] int pendingCount() const { return m_queue.size(); }
+
+    static constexpr int MIN_DELIVERY_INTERVAL_MS = 2000;
+    static constexpr int TOAST_DURATION_MS = 4000;
+    static constexpr int TOAST_MARGIN = 12;
+
+signals:
+    void notificationDelivered(NotificationManager::Kind kind, const QString &message);
+
+private slots:
+    void deliverNext();
 
 private:
+    struct Pending {
+        Kind kind;
+        QString message;
+    };
+
+    void scheduleDelivery();
+    void showToast(const QString &message);
+
     QWidget *m_parent;
     SystemTrayManager *m_trayManager;
     bool m_notificationsEnabled;
+
+    QVector<Pending> m_queue;
+    QTimer *m_dispatchTimer;
+    QElapsedTimer m_lastDelivery;
+
+    QPointer<QLabel> m_toast;
+    QTimer *m_toastTimer;
 };
 
 #endif // NOTIFICATIONMANAGER_H
-
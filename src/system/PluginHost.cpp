@@ -0,0 +1,297 @@
+#include "PluginHost.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+Q_LOGGING_CATEGORY(lcPlugins, "pomodoro.plugins", QtInfoMsg)
+
+namespace {
+    const QString PLUGIN_DIRECTORY = QStringLiteral("plugins");
+
+    qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void storeMax(std::atomic<qint64> &target, qint64 value)
+    {
+        qint64 current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+struct PluginHost::Plugin {
+    struct Entry {
+        pomodoro_event event;
+        qint64 enqueuedNs = 0;
+    };
+
+    QString path;
+    QString name;
+    std::unique_ptr<QLibrary> library;
+    pomodoro_plugin_create_fn create = nullptr;
+    pomodoro_plugin_on_event_fn onEvent = nullptr;
+    pomodoro_plugin_destroy_fn destroy = nullptr;
+
+    // Ring written by publish() and drained by the plugin thread
+    std::array<Entry, QUEUE_SIZE> queue{};
+    std::atomic<quint32> head{0};
+    std::atomic<quint32> tail{0};
+
+    // The plugin thread only sleeps on an empty ring; the mutex is never held across a plugin call
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic_bool sleeping{false};
+    std::atomic_bool stopping{false};
+    std::atomic_bool exited{false};
+    std::thread thread;
+
+    std::atomic<quint64> delivered{0};
+    std::atomic<quint64> dropped{0};
+    std::atomic<qint64> queueNs{0};
+    std::atomic<qint64> maxQueueNs{0};
+    std::atomic<qint64> handlerNs{0};
+    std::atomic<qint64> maxHandlerNs{0};
+    std::atomic<qint64> callStartedNs{0};
+
+    void push(const pomodoro_event &event);
+    bool pop(Entry &entry);
+    void run();
+    void exit();
+    void notify();
+};
+
+void PluginHost::Plugin::push(const pomodoro_event &event)
+{
+    const quint32 at = tail.load(std::memory_order_relaxed);
+    if (exited.load(std::memory_order_relaxed) || at - head.load(std::memory_order_acquire) >= QUEUE_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue[at % QUEUE_SIZE] = Entry{event, nowNs()};
+
+    // Sequentially consistent with the sleeper's check, so one of the two sees the other
+    tail.store(at + 1);
+    if (sleeping.load()) {
+        notify();
+    }
+}
+
+bool PluginHost::Plugin::pop(Entry &entry)
+{
+    const quint32 at = head.load(std::memory_order_relaxed);
+    if (at == tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    entry = queue[at % QUEUE_SIZE];
+    head.store(at + 1, std::memory_order_release);
+    return true;
+}
+
+void PluginHost::Plugin::notify()
+{
+    // Taking the lock makes sure a sleeper is either still before its check or already waiting
+    { const std::lock_guard<std::mutex> lock(mutex); }
+    wake.notify_all();
+}
+
+void PluginHost::Plugin::run()
+{
+    void *state = create();
+    if (!state) {
+        qCWarning(lcPlugins) << "plugin" << name << "failed to initialise";
+        exit();
+        return;
+    }
+
+    Entry entry;
+    for (;;) {
+        if (pop(entry)) {
+            const qint64 started = nowNs();
+            callStartedNs.store(started, std::memory_order_relaxed);
+            onEvent(state, &entry.event);
+            const qint64 finished = nowNs();
+            callStartedNs.store(0, std::memory_order_relaxed);
+
+            delivered.fetch_add(1, std::memory_order_relaxed);
+            queueNs.fetch_add(started - entry.enqueuedNs, std::memory_order_relaxed);
+            handlerNs.fetch_add(finished - started, std::memory_order_relaxed);
+            storeMax(maxQueueNs, started - entry.enqueuedNs);
+            storeMax(maxHandlerNs, finished - started);
+            continue;
+        }
+        // Events published before stopping are still delivered
+        if (stopping.load()) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true);
+        wake.wait(lock, [this]() { return stopping.load() || head.load(std::memory_order_relaxed) != tail.load(); });
+        sleeping.store(false);
+    }
+
+    destroy(state);
+    exit();
+}
+
+void PluginHost::Plugin::exit()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        exited.store(true);
+    }
+    wake.notify_all();
+}
+
+PluginHost::PluginHost() = default;
+
+PluginHost::~PluginHost()
+{
+    unloadAll();
+}
+
+QString PluginHost::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/" + PLUGIN_DIRECTORY;
+}
+
+int PluginHost::loadDirectory(const QString &directory)
+{
+    const QDir dir(directory);
+    if (!dir.exists()) {
+        return 0;
+    }
+
+    int loaded = 0;
+    const QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Name);
+    for (const QFileInfo &file : files) {
+        if (QLibrary::isLibrary(file.fileName()) && load(file.absoluteFilePath())) {
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
+bool PluginHost::load(const QString &path)
+{
+    auto plugin = std::make_unique<Plugin>();
+    plugin->path = path;
+    plugin->library = std::make_unique<QLibrary>(path);
+    if (!plugin->library->load()) {
+        qCWarning(lcPlugins) << "cannot load plugin" << path << plugin->library->errorString();
+        return false;
+    }
+
+    QLibrary &library = *plugin->library;
+    const auto version = reinterpret_cast<pomodoro_plugin_api_version_fn>(
+        library.resolve(POMODORO_PLUGIN_API_VERSION_SYMBOL));
+    const auto name = reinterpret_cast<pomodoro_plugin_name_fn>(library.resolve(POMODORO_PLUGIN_NAME_SYMBOL));
+    plugin->create = reinterpret_cast<pomodoro_plugin_create_fn>(library.resolve(POMODORO_PLUGIN_CREATE_SYMBOL));
+    plugin->onEvent = reinterpret_cast<pomodoro_plugin_on_event_fn>(library.resolve(POMODORO_PLUGIN_ON_EVENT_SYMBOL));
+    plugin->destroy = reinterpret_cast<pomodoro_plugin_destroy_fn>(library.resolve(POMODORO_PLUGIN_DESTROY_SYMBOL));
+
+    if (!version || !plugin->create || !plugin->onEvent || !plugin->destroy) {
+        qCWarning(lcPlugins) << "not a plugin, entry points missing:" << path;
+        library.unload();
+        return false;
+    }
+    if (version() != POMODORO_PLUGIN_API_VERSION) {
+        qCWarning(lcPlugins) << "plugin" << path << "uses API version" << version()
+                             << "but" << POMODORO_PLUGIN_API_VERSION << "is required";
+        library.unload();
+        return false;
+    }
+
+    const char *displayName = name ? name() : nullptr;
+    plugin->name = displayName ? QString::fromUtf8(displayName) : QFileInfo(path).baseName();
+    plugin->thread = std::thread(&Plugin::run, plugin.get());
+
+    qCInfo(lcPlugins) << "loaded plugin" << plugin->name << "from" << path;
+    m_plugins.push_back(std::move(plugin));
+    return true;
+}
+
+void PluginHost::unloadAll()
+{
+    if (m_plugins.empty()) return;
+
+    for (const auto &plugin : m_plugins) {
+        plugin->stopping.store(true);
+        plugin->notify();
+    }
+
+    // One shared deadline, so several hung plugins do not add up
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SHUTDOWN_TIMEOUT_MS);
+    std::vector<bool> stopped;
+    stopped.reserve(m_plugins.size());
+    for (const auto &plugin : m_plugins) {
+        std::unique_lock<std::mutex> lock(plugin->mutex);
+        stopped.push_back(plugin->wake.wait_until(lock, deadline, [&plugin]() { return plugin->exited.load(); }));
+    }
+
+    const QVector<Stats> finalStats = stats();
+    for (size_t i = 0; i < m_plugins.size(); ++i) {
+        const Stats &stats = finalStats.at(static_cast<int>(i));
+        qCInfo(lcPlugins).nospace() << "plugin " << stats.name << ": " << stats.delivered << " delivered, "
+                                    << stats.dropped << " dropped, queue avg/max " << stats.averageQueueUs
+                                    << "/" << stats.maxQueueUs << " us, handler avg/max " << stats.averageHandlerUs
+                                    << "/" << stats.maxHandlerUs << " us";
+
+        std::unique_ptr<Plugin> &plugin = m_plugins[i];
+        if (stopped[i]) {
+            plugin->thread.join();
+            plugin->library->unload();
+        } else {
+            // Its code may still be running: keep the library mapped and the state alive
+            qCWarning(lcPlugins) << "plugin" << plugin->name << "did not stop within"
+                                 << SHUTDOWN_TIMEOUT_MS << "ms; leaving it loaded";
+            plugin->thread.detach();
+            static_cast<void>(plugin.release());
+        }
+    }
+    m_plugins.clear();
+}
+
+void PluginHost::publish(const pomodoro_event &event)
+{
+    for (const auto &plugin : m_plugins) {
+        plugin->push(event);
+    }
+}
+
+QVector<PluginHost::Stats> PluginHost::stats() const
+{
+    const qint64 now = nowNs();
+    QVector<Stats> result;
+    result.reserve(static_cast<int>(m_plugins.size()));
+    for (const auto &plugin : m_plugins) {
+        Stats stats;
+        stats.name = plugin->name;
+        stats.path = plugin->path;
+        stats.delivered = plugin->delivered.load(std::memory_order_relaxed);
+        stats.dropped = plugin->dropped.load(std::memory_order_relaxed);
+        if (stats.delivered > 0) {
+            const auto delivered = static_cast<qint64>(stats.delivered);
+            stats.averageQueueUs = plugin->queueNs.load(std::memory_order_relaxed) / delivered / 1000;
+            stats.averageHandlerUs = plugin->handlerNs.load(std::memory_order_relaxed) / delivered / 1000;
+        }
+        stats.maxQueueUs = plugin->maxQueueNs.load(std::memory_order_relaxed) / 1000;
+        stats.maxHandlerUs = plugin->maxHandlerNs.load(std::memory_order_relaxed) / 1000;
+        const qint64 callStarted = plugin->callStartedNs.load(std::memory_order_relaxed);
+        stats.busyMs = callStarted > 0 ? (now - callStarted) / 1000000 : 0;
+        result.append(stats);
+    }
+    return result;
+}
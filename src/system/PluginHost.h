@@ -0,0 +1,65 @@
+#ifndef PLUGINHOST_H
+#define PLUGINHOST_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "PomodoroPlugin.h"
+
+// Loads the shared-library plugins described in PomodoroPlugin.h and feeds
+// them timer events.
+//
+// Every plugin gets a thread and a bounded single-producer/single-consumer
+// ring of QUEUE_SIZE events. publish() copies the event into each ring with
+// two atomic operations and returns; a plugin that is slow or hung only fills
+// its own ring, after which its events are dropped and counted. The plugin
+// thread creates, feeds and destroys the plugin, so none of its code runs on
+// the GUI thread. Plugins still share the process: a crash in one is a crash
+// of the app.
+class PluginHost
+{
+public:
+    struct Stats {
+        QString name;
+        QString path;
+        quint64 delivered = 0;
+        quint64 dropped = 0;                // ring was full
+        qint64 averageQueueUs = 0;          // publish() to the start of the call
+        qint64 maxQueueUs = 0;
+        qint64 averageHandlerUs = 0;        // time spent in pomodoro_plugin_on_event
+        qint64 maxHandlerUs = 0;
+        qint64 busyMs = 0;                  // length of the call in progress, 0 when idle
+    };
+
+    PluginHost();
+    ~PluginHost();
+
+    PluginHost(const PluginHost&) = delete;
+    PluginHost& operator=(const PluginHost&) = delete;
+
+    // Loads every library in directory; returns how many loaded
+    int loadDirectory(const QString &directory);
+    bool load(const QString &path);
+    // Stops the plugin threads, waiting up to SHUTDOWN_TIMEOUT_MS for each
+    void unloadAll();
+
+    // GUI thread only; never waits for a plugin
+    void publish(const pomodoro_event &event);
+
+    [[nodiscard]] QVector<Stats> stats() const;
+    [[nodiscard]] int pluginCount() const { return static_cast<int>(m_plugins.size()); }
+
+    // <app data>/plugins
+    static QString defaultDirectory();
+
+    static constexpr quint32 QUEUE_SIZE = 64;
+    static constexpr int SHUTDOWN_TIMEOUT_MS = 2000;
+
+private:
+    struct Plugin;
+
+    std::vector<std::unique_ptr<Plugin>> m_plugins;
+};
+
+#endif // PLUGINHOST_H
@@ -0,0 +1,80 @@
+#ifndef POMODOROPLUGIN_H
+#define POMODOROPLUGIN_H
+
+/*
+ * C interface for Pomodoro Timer plugins.
+ *
+ * A plugin is a shared library exporting the functions declared below with C
+ * linkage. Apart from pomodoro_plugin_api_version() and pomodoro_plugin_name(),
+ * which are read once while loading, the host calls them on a thread of the
+ * plugin's own, one call at a time, so a plugin needs no locking of its own
+ * and may block; events that arrive while it is busy wait in a bounded queue
+ * and are dropped, not delayed, once it is full.
+ *
+ * Structs only ever grow at the end; check struct_size before reading fields
+ * added after version 1.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POMODORO_PLUGIN_API_VERSION 1
+#define POMODORO_PLUGIN_TAG_SIZE 64
+
+#if defined(_WIN32)
+#define POMODORO_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define POMODORO_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef enum pomodoro_event_type {
+    POMODORO_EVENT_SESSION_STARTED = 1,
+    POMODORO_EVENT_SESSION_PAUSED = 2,
+    POMODORO_EVENT_SESSION_RESUMED = 3,
+    POMODORO_EVENT_SESSION_FINISHED = 4,
+    POMODORO_EVENT_SESSION_SKIPPED = 5,
+    POMODORO_EVENT_SESSION_RESET = 6
+} pomodoro_event_type;
+
+typedef enum pomodoro_session_type {
+    POMODORO_SESSION_WORK = 0,
+    POMODORO_SESSION_SHORT_BREAK = 1,
+    POMODORO_SESSION_LONG_BREAK = 2
+} pomodoro_session_type;
+
+typedef struct pomodoro_event {
+    uint32_t struct_size;           /* sizeof(pomodoro_event) as built by the host */
+    uint32_t type;                  /* pomodoro_event_type */
+    uint32_t session_type;          /* pomodoro_session_type */
+    uint32_t session_id;            /* history ID once finished or skipped, else 0 */
+    int64_t wall_time_ms;           /* when the event happened, ms since the Unix epoch */
+    int32_t planned_seconds;        /* full length of the session */
+    int32_t elapsed_seconds;        /* active time so far, pauses excluded */
+    int32_t completed_sessions;     /* work sessions completed; drives the long-break cycle */
+    uint32_t reserved;
+    char tag[POMODORO_PLUGIN_TAG_SIZE]; /* UTF-8, NUL-terminated, empty when untagged */
+} pomodoro_event;
+
+/* Returns POMODORO_PLUGIN_API_VERSION as the plugin was built against */
+typedef uint32_t (*pomodoro_plugin_api_version_fn)(void);
+/* Short display name; the string must stay valid while the library is loaded */
+typedef const char *(*pomodoro_plugin_name_fn)(void);
+/* Returns the plugin's state, passed back to every later call; NULL fails the load */
+typedef void *(*pomodoro_plugin_create_fn)(void);
+typedef void (*pomodoro_plugin_on_event_fn)(void *state, const pomodoro_event *event);
+typedef void (*pomodoro_plugin_destroy_fn)(void *state);
+
+#define POMODORO_PLUGIN_API_VERSION_SYMBOL "pomodoro_plugin_api_version"
+#define POMODORO_PLUGIN_NAME_SYMBOL "pomodoro_plugin_name"
+#define POMODORO_PLUGIN_CREATE_SYMBOL "pomodoro_plugin_create"
+#define POMODORO_PLUGIN_ON_EVENT_SYMBOL "pomodoro_plugin_on_event"
+#define POMODORO_PLUGIN_DESTROY_SYMBOL "pomodoro_plugin_destroy"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POMODOROPLUGIN_H */
@@ -0,0 +1,236 @@
+#include "SoundCueEngine.h"
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr quint16 WAVE_FORMAT_PCM = 1;
+    constexpr quint16 WAVE_FORMAT_IEEE_FLOAT = 3;
+    constexpr quint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    float decodeSample(const uchar *p, int bits, bool isFloat)
+    {
+        if (isFloat) {
+            const quint32 raw = qFromLittleEndian<quint32>(p);
+            float value;
+            std::memcpy(&value, &raw, sizeof(value));
+            return value;
+        }
+        switch (bits) {
+        case 8:
+            return (static_cast<int>(p[0]) - 128) / 128.0f;
+        case 16:
+            return qFromLittleEndian<qint16>(p) / 32768.0f;
+        case 24: {
+            qint32 value = p[0] | (p[1] << 8) | (p[2] << 16);
+            if (value & 0x800000) {
+                value -= 0x1000000;
+            }
+            return value / 8388608.0f;
+        }
+        default:
+            return qFromLittleEndian<qint32>(p) / 2147483648.0f;
+        }
+    }
+}
+
+SoundCueEngine::SoundCueEngine(QObject *parent)
+    : QObject(parent)
+{
+    for (std::atomic<float> &volume : m_volumes) {
+        volume.store(1.0f, std::memory_order_relaxed);
+    }
+}
+
+SoundCueEngine::~SoundCueEngine()
+{
+    if (m_loader) {
+        m_loader->wait();
+    }
+}
+
+void SoundCueEngine::preload(const QString &workEndFile, const QString &breakEndFile)
+{
+    if (m_loader) {
+        m_loader->wait();
+    }
+
+    const std::array<QString, CUE_COUNT> files{workEndFile, breakEndFile};
+    m_loader.reset(QThread::create([this, files]() {
+        std::array<Pcm, CUE_COUNT> decoded;
+        for (int i = 0; i < CUE_COUNT; ++i) {
+            if (files[i].isEmpty()) {
+                continue;
+            }
+            QVector<float> pcm = decodeWav(files[i]);
+            if (!pcm.isEmpty()) {
+                decoded[i] = std::make_shared<const QVector<float>>(std::move(pcm));
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, decoded]() {
+            m_cues = decoded;
+            emit preloaded();
+        }, Qt::QueuedConnection);
+    }));
+    m_loader->start(QThread::LowPriority);
+}
+
+bool SoundCueEngine::isLoaded(Cue cue) const
+{
+    return m_cues[static_cast<int>(cue)] != nullptr;
+}
+
+void SoundCueEngine::setVolume(Cue cue, float volume)
+{
+    m_volumes[static_cast<int>(cue)].store(qBound(0.0f, volume, 1.0f), std::memory_order_relaxed);
+}
+
+float SoundCueEngine::volume(Cue cue) const
+{
+    return m_volumes[static_cast<int>(cue)].load(std::memory_order_relaxed);
+}
+
+void SoundCueEngine::play(Cue cue)
+{
+    const int index = static_cast<int>(cue);
+    if (!m_cues[index]) {
+        return;
+    }
+
+    const quint32 tail = m_queueTail.load(std::memory_order_relaxed);
+    if (tail - m_queueHead.load(std::memory_order_acquire) >= QUEUE_SIZE) {
+        return; // the audio thread is not draining; dropping beats blocking
+    }
+    m_queue[tail % QUEUE_SIZE] = Command{m_cues[index], index};
+    m_queueTail.store(tail + 1, std::memory_order_release);
+}
+
+bool SoundCueEngine::isIdle() const
+{
+    if (m_queueHead.load(std::memory_order_relaxed) != m_queueTail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return std::none_of(m_voices.cbegin(), m_voices.cend(), [](const Voice &voice) { return voice.pcm != nullptr; });
+}
+
+void SoundCueEngine::render(float *interleaved, int frames)
+{
+    // Start the cues triggered since the last buffer
+    quint32 head = m_queueHead.load(std::memory_order_relaxed);
+    const quint32 tail = m_queueTail.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+        Command &command = m_queue[head % QUEUE_SIZE];
+
+        // A free voice, or else the one that has played the longest
+        Voice *target = &m_voices[0];
+        for (Voice &voice : m_voices) {
+            if (!voice.pcm) {
+                target = &voice;
+                break;
+            }
+            if (voice.frame > target->frame) {
+                target = &voice;
+            }
+        }
+        target->pcm = std::move(command.pcm);
+        target->cue = command.cue;
+        target->frame = 0;
+    }
+    m_queueHead.store(head, std::memory_order_release);
+
+    for (Voice &voice : m_voices) {
+        if (!voice.pcm) {
+            continue;
+        }
+
+        const float gain = m_volumes[voice.cue].load(std::memory_order_relaxed);
+        const int total = static_cast<int>(voice.pcm->size() / CHANNELS);
+        const int count = qMin(frames, total - voice.frame);
+        const float *source = voice.pcm->constData() + static_cast<qsizetype>(voice.frame) * CHANNELS;
+        for (int i = 0; i < count * CHANNELS; ++i) {
+            interleaved[i] += source[i] * gain;
+        }
+
+        voice.frame += count;
+        if (voice.frame >= total) {
+            voice.pcm.reset();
+        }
+    }
+}
+
+QVector<float> SoundCueEngine::decodeWav(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SoundCueEngine: cannot open" << path << file.errorString();
+        return {};
+    }
+
+    const qint64 size = file.size();
+    const uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data || size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+        qWarning() << "SoundCueEngine: not a WAV file" << path;
+        return {};
+    }
+
+    quint16 format = 0;
+    quint16 channels = 0;
+    quint16 bits = 0;
+    quint32 rate = 0;
+    const uchar *samples = nullptr;
+    qint64 sampleBytes = 0;
+
+    for (qint64 offset = 12; offset + 8 <= size;) {
+        const quint32 chunkSize = qFromLittleEndian<quint32>(data + offset + 4);
+        const uchar *chunk = data + offset + 8;
+        const qint64 available = qMin<qint64>(chunkSize, size - offset - 8);
+
+        if (std::memcmp(data + offset, "fmt ", 4) == 0 && available >= 16) {
+            format = qFromLittleEndian<quint16>(chunk);
+            channels = qFromLittleEndian<quint16>(chunk + 2);
+            rate = qFromLittleEndian<quint32>(chunk + 4);
+            bits = qFromLittleEndian<quint16>(chunk + 14);
+            if (format == WAVE_FORMAT_EXTENSIBLE && available >= 26) {
+                format = qFromLittleEndian<quint16>(chunk + 24);
+            }
+        } else if (std::memcmp(data + offset, "data", 4) == 0) {
+            samples = chunk;
+            sampleBytes = available;
+        }
+        offset += 8 + static_cast<qint64>(chunkSize) + (chunkSize & 1);
+    }
+
+    const bool isFloat = format == WAVE_FORMAT_IEEE_FLOAT && bits == 32;
+    const bool isPcm = format == WAVE_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+    if (!samples || channels == 0 || rate == 0 || (!isFloat && !isPcm)) {
+        qWarning() << "SoundCueEngine: unsupported WAV encoding in" << path;
+        return {};
+    }
+
+    const int bytesPerSample = bits / 8;
+    const qint64 frames = sampleBytes / (bytesPerSample * channels);
+    const auto sampleAt = [&](qint64 frame, int channel) {
+        return decodeSample(samples + (frame * channels + channel) * bytesPerSample, bits, isFloat);
+    };
+
+    // Linear resampling to the mix rate; mono is duplicated, extra channels are dropped
+    const double step = static_cast<double>(rate) / SAMPLE_RATE;
+    const qint64 outFrames = frames > 0 ? static_cast<qint64>(frames / step) : 0;
+    const int right = channels > 1 ? 1 : 0;
+
+    QVector<float> pcm(outFrames * CHANNELS);
+    for (qint64 i = 0; i < outFrames; ++i) {
+        const double position = i * step;
+        const qint64 index = static_cast<qint64>(position);
+        const qint64 next = qMin(index + 1, frames - 1);
+        const float t = static_cast<float>(position - index);
+
+        const float left0 = sampleAt(index, 0);
+        const float right0 = sampleAt(index, right);
+        pcm[i * CHANNELS] = left0 + (sampleAt(next, 0) - left0) * t;
+        pcm[i * CHANNELS + 1] = right0 + (sampleAt(next, right) - right0) * t;
+    }
+    return pcm;
+}
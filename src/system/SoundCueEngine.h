@@ -0,0 +1,84 @@
+#ifndef SOUNDCUEENGINE_H
+#define SOUNDCUEENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "AudioSink.h"
+
+// Plays the end-of-session sounds from memory.
+//
+// preload() decodes the configured WAV files on a worker thread into the mix
+// format (48 kHz stereo float), so play() never touches the disk or a decoder.
+// play() hands the cue to the audio thread through a lock-free single-producer
+// queue; render() mixes up to MAX_VOICES overlapping cues, each scaled by the
+// live volume of its cue. The owner adds the engine to an AudioSink, wakes the
+// sink after play(), and must stop that sink before destroying the engine.
+class SoundCueEngine : public QObject, public AudioSource
+{
+    Q_OBJECT
+
+public:
+    enum class Cue {
+        WorkEnd,
+        BreakEnd
+    };
+
+    explicit SoundCueEngine(QObject *parent = nullptr);
+    ~SoundCueEngine() override;
+
+    // Empty paths leave the cue silent
+    void preload(const QString &workEndFile, const QString &breakEndFile);
+    [[nodiscard]] bool isLoaded(Cue cue) const;
+
+    void setVolume(Cue cue, float volume);
+    [[nodiscard]] float volume(Cue cue) const;
+
+    // GUI thread only; returns immediately. Cues are dropped while no sink drains the queue
+    void play(Cue cue);
+
+    void render(float *interleaved, int frames) override;
+    [[nodiscard]] bool isIdle() const override;
+
+    static constexpr int CUE_COUNT = 2;
+    static constexpr int MAX_VOICES = 8;
+    static constexpr int QUEUE_SIZE = 16;
+
+    // Decodes a PCM or float WAV file into 48 kHz interleaved stereo floats
+    static QVector<float> decodeWav(const QString &path);
+
+signals:
+    void preloaded();
+
+private:
+    using Pcm = std::shared_ptr<const QVector<float>>;
+
+    struct Voice {
+        Pcm pcm;
+        int cue = 0;
+        int frame = 0;
+    };
+
+    struct Command {
+        Pcm pcm;
+        int cue = 0;
+    };
+
+    std::array<Pcm, CUE_COUNT> m_cues;
+    std::array<std::atomic<float>, CUE_COUNT> m_volumes;
+    std::unique_ptr<QThread> m_loader;
+
+    // Lock-free hand-off from play() to render()
+    std::array<Command, QUEUE_SIZE> m_queue;
+    std::atomic<quint32> m_queueHead{0};
+    std::atomic<quint32> m_queueTail{0};
+
+    // Audio thread only
+    std::array<Voice, MAX_VOICES> m_voices;
+};
+
+#endif // SOUNDCUEENGINE_H
@@ -59,36 +59,14 @@ bool SystemTrayManager::isVisible() const
     return m_trayIcon && m_trayIcon->isVisible();
 }
 
-void SystemTrayManager::updateTooltip(TimerState state, bool isRunning, const QString &timeRemaining, int currentSession, int totalSessions)
+void SystemTrayManager::setToolTip(const QString &tooltip)
 {
     if (!m_trayIcon) return;
 
-    // Build tooltip more efficiently
-    QString tooltip;
-    tooltip.reserve(100); // Reserve space to avoid reallocations
-
-    QString emoji = TimerStateHelper::getStateEmoji(state);
-    QString stateText = TimerStateHelper::getStateText(state);
-
-    if (isRunning) {
-        tooltip = QStringLiteral("%1 %2 - %3 remaining").arg(
-            emoji,
-            stateText,
-            timeRemaining);
-    } else {
-        stateText += " (Paused)";
-        tooltip = QStringLiteral("%1 %2 Ready (%3)").arg(
-            emoji,
-            stateText,
-            timeRemaining);
-    }
-
-    tooltip += QStringLiteral("\nSession %1 of %2").arg(currentSession).arg(totalSessions);
-
     // Only update if tooltip changed
     if (tooltip != m_lastTooltip) {
         m_trayIcon->setToolTip(tooltip);
-        m_lastTooltip = std::move(tooltip);
+        m_lastTooltip = tooltip;
     }
 }
 
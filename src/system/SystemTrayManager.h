@@ -16,7 +16,7 @@ public:
     void show();
     void hide();
     bool isVisible() const;
-    void updateTooltip(TimerState state, bool isRunning, const QString &timeRemaining, int currentSession, int totalSessions);
+    void setToolTip(const QString &tooltip);
     void showMessage(const QString &title, const QString &message);
 
 signals:
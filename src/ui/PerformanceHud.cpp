@@ -0,0 +1,239 @@
+#include "PerformanceHud.h"
+#include "AllocationCounter.h"
+
+#include <QEvent>
+#include <QFontDatabase>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+    constexpr int HUD_WIDTH = 420;
+    constexpr int HUD_MARGIN = 6;
+    constexpr int TEXT_HEIGHT = 14;
+    constexpr int HISTOGRAM_HEIGHT = 12;
+    constexpr int ROW_SPACING = 4;
+    constexpr int ROW_HEIGHT = TEXT_HEIGHT + HISTOGRAM_HEIGHT + ROW_SPACING;
+
+    const QString TICK_METRIC = QStringLiteral("tick work");
+    const QString ALLOCATION_METRIC = QStringLiteral("allocs/tick");
+    const QString LATENCY_METRIC = QStringLiteral("loop latency");
+    const QString US = QStringLiteral("us");
+}
+
+// RollingSamples implementation
+RollingSamples::RollingSamples(int capacity)
+    : m_samples(qMax(1, capacity), 0)
+{
+}
+
+void RollingSamples::add(qint64 value)
+{
+    m_samples[m_next] = value;
+    m_next = (m_next + 1) % m_samples.size();
+    m_count = qMin(m_count + 1, static_cast<int>(m_samples.size()));
+}
+
+qint64 RollingSamples::last() const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    return m_samples.at((m_next + m_samples.size() - 1) % m_samples.size());
+}
+
+qint64 RollingSamples::percentile(double fraction) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    QVector<qint64> sorted(m_samples.cbegin(), m_samples.cbegin() + m_count);
+    const int index = qMin(static_cast<int>(m_count * fraction), m_count - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted.at(index);
+}
+
+QVector<int> RollingSamples::histogram(int buckets) const
+{
+    QVector<int> counts(buckets, 0);
+    for (int i = 0; i < m_count; ++i) {
+        qint64 value = m_samples.at(i);
+        int bucket = 0;
+        while (value > 1 && bucket < buckets - 1) {
+            value = (value + 1) / 2;
+            ++bucket;
+        }
+        ++counts[bucket];
+    }
+    return counts;
+}
+
+// PerformanceHud implementation
+PerformanceHud::PerformanceHud(QWidget *parent)
+    : QWidget(parent)
+    , m_probeTimer(new QTimer(this))
+    , m_refreshTimer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    metric(TICK_METRIC, US);
+    if (AllocationCounter::isAvailable()) {
+        metric(ALLOCATION_METRIC, QString());
+        AllocationCounter::setEnabled(true);
+    }
+    metric(LATENCY_METRIC, US);
+
+    // The probe measures how late a timer fires, which is how long any other
+    // event had to wait for the loop
+    m_probeTimer->setTimerType(Qt::PreciseTimer);
+    m_probeTimer->setInterval(PROBE_INTERVAL_MS);
+    connect(m_probeTimer, &QTimer::timeout, this, &PerformanceHud::onProbe);
+    m_probeClock.start();
+    m_probeTimer->start();
+
+    m_refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this]() { update(); });
+    m_refreshTimer->start();
+
+    resizeToContents();
+    move(HUD_MARGIN, HUD_MARGIN);
+    raise();
+}
+
+PerformanceHud::~PerformanceHud()
+{
+    AllocationCounter::setEnabled(false);
+    for (auto it = m_watched.cbegin(); it != m_watched.cend(); ++it) {
+        it.key()->removeEventFilter(this);
+    }
+}
+
+void PerformanceHud::watch(QWidget *widget, const QString &name)
+{
+    if (!widget || m_watched.contains(widget)) return;
+
+    m_watched.insert(widget, name);
+    connect(widget, &QObject::destroyed, this, [this](QObject *object) { m_watched.remove(object); });
+    widget->installEventFilter(this);
+    metric(QStringLiteral("paint ") + name, US);
+    resizeToContents();
+}
+
+bool PerformanceHud::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::Paint) {
+        return QWidget::eventFilter(watched, event);
+    }
+    const auto found = m_watched.constFind(watched);
+    if (found == m_watched.cend()) {
+        return QWidget::eventFilter(watched, event);
+    }
+
+    // The HUD is translucent, so each refresh repaints whatever lies under it;
+    // a paint confined to that area is the HUD's cost, not the widget's
+    auto *widget = static_cast<QWidget*>(watched);
+    const QRect hudArea(widget->mapFromGlobal(mapToGlobal(QPoint(0, 0))), size());
+    if (hudArea.contains(static_cast<QPaintEvent*>(event)->region().boundingRect())) {
+        return QWidget::eventFilter(watched, event);
+    }
+
+    // Deliver the paint here so it can be timed; filters do not see the
+    // direct call, and the event is consumed so it is not painted twice
+    QElapsedTimer elapsed;
+    elapsed.start();
+    watched->event(event);
+    metric(QStringLiteral("paint ") + found.value(), US).samples.add(elapsed.nsecsElapsed() / 1000);
+    return true;
+}
+
+void PerformanceHud::onProbe()
+{
+    // Both ends from the same clock in ns, so the lateness is not skewed by ms truncation
+    const qint64 nowNs = m_probeClock.nsecsElapsed();
+    if (m_lastProbeNs > 0) {
+        const qint64 lateNs = nowNs - m_lastProbeNs - qint64(PROBE_INTERVAL_MS) * 1000000;
+        metric(LATENCY_METRIC, US).samples.add(qMax<qint64>(0, lateNs / 1000));
+    }
+    m_lastProbeNs = nowNs;
+}
+
+PerformanceHud::Metric& PerformanceHud::metric(const QString &name, const QString &unit)
+{
+    for (Metric &existing : m_metrics) {
+        if (existing.name == name) {
+            return existing;
+        }
+    }
+    m_metrics.append({name, unit, RollingSamples()});
+    return m_metrics.last();
+}
+
+void PerformanceHud::resizeToContents()
+{
+    setFixedSize(HUD_WIDTH, 2 * HUD_MARGIN + m_metrics.size() * ROW_HEIGHT);
+}
+
+void PerformanceHud::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 190));
+    painter.drawRoundedRect(rect(), 6, 6);
+
+    const int contentWidth = width() - 2 * HUD_MARGIN;
+    const int barWidth = contentWidth / HISTOGRAM_BUCKETS;
+    int y = HUD_MARGIN;
+
+    for (const Metric &metric : m_metrics) {
+        const RollingSamples &samples = metric.samples;
+        painter.setPen(Qt::white);
+        const QString line = samples.isEmpty()
+            ? QStringLiteral("%1  -").arg(metric.name, -16)
+            : QStringLiteral("%1 last %2  p50 %3  p99 %4 %5")
+                  .arg(metric.name, -16)
+                  .arg(samples.last(), 6)
+                  .arg(samples.percentile(0.5), 6)
+                  .arg(samples.percentile(0.99), 6)
+                  .arg(metric.unit);
+        painter.drawText(QRect(HUD_MARGIN, y, contentWidth, TEXT_HEIGHT), Qt::AlignLeft | Qt::AlignVCenter, line);
+        y += TEXT_HEIGHT;
+
+        // Log2 buckets, so one bar per doubling of the value
+        const QVector<int> counts = samples.histogram(HISTOGRAM_BUCKETS);
+        const int maxCount = qMax(1, *std::max_element(counts.cbegin(), counts.cend()));
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(120, 200, 120));
+        for (int bucket = 0; bucket < counts.size(); ++bucket) {
+            const int barHeight = counts.at(bucket) * HISTOGRAM_HEIGHT / maxCount;
+            painter.drawRect(HUD_MARGIN + bucket * barWidth + 1, y + HISTOGRAM_HEIGHT - barHeight,
+                             barWidth - 2, barHeight);
+        }
+        y += HISTOGRAM_HEIGHT + ROW_SPACING;
+    }
+}
+
+// TickScope implementation
+PerformanceHud::TickScope::TickScope(PerformanceHud *hud)
+    : m_hud(hud)
+{
+    if (m_hud) {
+        m_allocationsBefore = AllocationCounter::currentThread();
+        m_elapsed.start();
+    }
+}
+
+PerformanceHud::TickScope::~TickScope()
+{
+    if (!m_hud) return;
+
+    m_hud->metric(TICK_METRIC, US).samples.add(m_elapsed.nsecsElapsed() / 1000);
+    if (AllocationCounter::isAvailable()) {
+        m_hud->metric(ALLOCATION_METRIC, QString())
+            .samples.add(static_cast<qint64>(AllocationCounter::currentThread() - m_allocationsBefore));
+    }
+}
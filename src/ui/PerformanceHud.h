@@ -0,0 +1,90 @@
+#ifndef PERFORMANCEHUD_H
+#define PERFORMANCEHUD_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+#include <QWidget>
+
+class QTimer;
+
+// Fixed window of recent samples, for the HUD's readouts and histograms
+class RollingSamples
+{
+public:
+    explicit RollingSamples(int capacity = 240);
+
+    void add(qint64 value);
+    [[nodiscard]] bool isEmpty() const { return m_count == 0; }
+    [[nodiscard]] qint64 last() const;
+    [[nodiscard]] qint64 percentile(double fraction) const;
+    // Counts per power-of-two bucket: [0,1], (1,2], (2,4], ...
+    [[nodiscard]] QVector<int> histogram(int buckets) const;
+
+private:
+    QVector<qint64> m_samples;
+    int m_next = 0;
+    int m_count = 0;
+};
+
+// Debug overlay showing where the GUI thread's time goes: paint time of the
+// watched widgets, event-loop latency, timer tick work and allocations per
+// tick, each as last/median/p99 plus a histogram of the recent window.
+//
+// Nothing is measured unless a HUD exists: the owner creates it when the user
+// turns it on and deletes it when they turn it off, which removes the event
+// filters, the probe timer and allocation counting with it.
+class PerformanceHud : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerformanceHud(QWidget *parent);
+    ~PerformanceHud() override;
+
+    // Times every paint of widget under the given label
+    void watch(QWidget *widget, const QString &name);
+
+    // Measures one timer tick; hud may be null, which costs a pointer check
+    class TickScope
+    {
+    public:
+        explicit TickScope(PerformanceHud *hud);
+        ~TickScope();
+        TickScope(const TickScope&) = delete;
+        TickScope& operator=(const TickScope&) = delete;
+
+    private:
+        PerformanceHud *m_hud;
+        QElapsedTimer m_elapsed;
+        quint64 m_allocationsBefore = 0;
+    };
+
+    static constexpr int PROBE_INTERVAL_MS = 50;
+    static constexpr int REFRESH_INTERVAL_MS = 250;
+    static constexpr int HISTOGRAM_BUCKETS = 14;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    struct Metric {
+        QString name;
+        QString unit;
+        RollingSamples samples;
+    };
+
+    void onProbe();
+    Metric& metric(const QString &name, const QString &unit);
+    void resizeToContents();
+
+    QVector<Metric> m_metrics;              // in display order
+    QHash<QObject*, QString> m_watched;
+    QTimer *m_probeTimer;
+    QTimer *m_refreshTimer;
+    QElapsedTimer m_probeClock;
+    qint64 m_lastProbeNs = 0;               // m_probeClock time of the previous probe
+};
+
+#endif // PERFORMANCEHUD_H
@@ -5,24 +5,47 @@
 #include "SystemTrayManager.h"
 #include "KeyboardShortcuts.h"
 #include "NotificationManager.h"
+#include "PerformanceHud.h"
+#include "PluginHost.h"
+#include "HookRunner.h"
+#include "PomodoroConfig.h"
+#include "SoundCueEngine.h"
+#include "AmbientNoiseGenerator.h"
+#include "BackgroundWriter.h"
+#include "SessionHistory.h"
+#include "SessionMetrics.h"
+#include "HistoryCompactor.h"
+#include "ForecastFitter.h"
+#include "SessionNotes.h"
+#include "SqliteHistoryStore.h"
+#include "StartupSequence.h"
+#include "TimerCheckpoint.h"
 #include "TimerState.h"
 
 #include <QApplication>
+#include <QComboBox>
+#include <QDebug>
 #include <QDateTime>
 #include <QFont>
 #include <QKeyEvent>
+#include <QLineEdit>
+#include <QPaintEvent>
 #include <QSettings>
+#include <QThread>
 #include <QVBoxLayout>
+#include <limits>
 
 namespace {
     // UI Layout constants
     constexpr int WINDOW_WIDTH = 440;
-    constexpr int WINDOW_HEIGHT = 550;
+    constexpr int WINDOW_HEIGHT = 630;
     constexpr int PROGRESS_BAR_SIZE = 220;
     constexpr int MAIN_BUTTON_WIDTH = 100;
     constexpr int MAIN_BUTTON_HEIGHT = 40;
     constexpr int SMALL_BUTTON_WIDTH = 90;
     constexpr int SMALL_BUTTON_HEIGHT = 35;
+    constexpr int TAG_PICKER_WIDTH = 220;
+    constexpr int NOTE_EDIT_WIDTH = 320;
     constexpr int LAYOUT_SPACING = 10;
     constexpr int LAYOUT_MARGIN = 25;
 
@@ -34,30 +57,305 @@ namespace {
 
     // Progress bar positioning
     constexpr int TIME_LABEL_Y_OFFSET = 90;
+
+    // Deferred startup still runs if the window is never painted (e.g. hidden)
+    constexpr int STARTUP_FALLBACK_MS = 1000;
 }
 
 PomodoroTimer::PomodoroTimer(QWidget *parent)
     : QWidget(parent)
     , m_timer(new QTimer(this))
-    , m_trayManager(std::make_unique<SystemTrayManager>(this))
-    , m_keyboardShortcuts(std::make_unique<KeyboardShortcuts>(this))
-    , m_notificationManager(std::make_unique<NotificationManager>(this))
+    , m_soundCues(std::make_unique<SoundCueEngine>())
+    , m_ambient(std::make_unique<AmbientNoiseGenerator>())
+    , m_startup(new StartupSequence(this))
+    , m_model(SESSIONS_BEFORE_LONG_BREAK)
 {
+    // Only what the first frame needs is done here; the rest runs from the
+    // event loop once the window has been painted
     loadSettings();
     setupUI();
     setupConnections();
     resetTimerState();
-    updateDisplay();
+    // Resume an interrupted session before the window is first painted
+    restoreCheckpoint();
+    bindViews();
+
+    // Stages in priority order: controls the user can reach first come first
+    m_startup->addStage(QStringLiteral("tray"), [this]() { initTray(); });
+    m_startup->addStage(QStringLiteral("shortcuts"), [this]() { initShortcuts(); });
+    m_startup->addStage(QStringLiteral("notifications"), [this]() { initNotifications(); });
+    m_startup->addStage(QStringLiteral("history"), [this]() { initHistory(); });
+    m_startup->addStage(QStringLiteral("statistics index"), [this]() { initStatisticsIndex(); });
+    m_startup->addStage(QStringLiteral("audio"), [this]() { initAudio(); });
+    m_startup->addStage(QStringLiteral("plugins"), [this]() { initPlugins(); });
+    m_startup->addStage(QStringLiteral("hooks"), [this]() { initHooks(); });
+    QTimer::singleShot(STARTUP_FALLBACK_MS, m_startup, &StartupSequence::start);
+}
+
+PomodoroTimer::~PomodoroTimer()
+{
+    saveSettings();
+    // The time until the next launch is then known to be downtime, not work
+    saveCheckpoint();
+    stopCompaction();
+    releaseAudioSink();
+    if (m_audioThread) {
+        m_audioThread->quit();
+        m_audioThread->wait();
+    }
+    if (m_forecastThread) {
+        m_forecastThread->quit();
+        m_forecastThread->wait();
+    }
+    SqliteHistoryStore::instance().close();
+    BackgroundWriter::instance().flush();
+}
+
+void PomodoroTimer::paintEvent(QPaintEvent *event)
+{
+    QWidget::paintEvent(event);
+    if (m_startup->firstFrameMs() < 0) {
+        m_startup->recordFirstFrame();
+        m_startup->start();
+    }
+}
+
+void PomodoroTimer::initTray()
+{
+    m_trayManager = std::make_unique<SystemTrayManager>(this);
+
+    connect(m_trayManager.get(), &SystemTrayManager::showMainWindow, this, &PomodoroTimer::onToggleVisibility);
+    connect(m_trayManager.get(), &SystemTrayManager::startPauseRequested, this, [this]() {
+        m_model.isRunning() ? onPauseTimer() : onStartTimer();
+    });
+    connect(m_trayManager.get(), &SystemTrayManager::resetRequested, this, &PomodoroTimer::onResetRequested);
+    connect(m_trayManager.get(), &SystemTrayManager::skipRequested, this, &PomodoroTimer::onSkipSession);
+    connect(m_trayManager.get(), &SystemTrayManager::settingsRequested, this, &PomodoroTimer::onShowSettings);
+    connect(m_trayManager.get(), &SystemTrayManager::statisticsRequested, this, &PomodoroTimer::onShowStatistics);
+    connect(m_trayManager.get(), &SystemTrayManager::quitRequested, qApp, &QCoreApplication::quit);
 
-    // Setup manager connections
+    m_trayManager->show();
+    bindView(m_model.bindableTrayToolTip(), [this](const QString &tooltip) {
+        m_trayManager->setToolTip(tooltip);
+    });
+}
+
+void PomodoroTimer::initShortcuts()
+{
+    m_keyboardShortcuts = std::make_unique<KeyboardShortcuts>(this);
+
+    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::startPauseRequested, this, [this]() {
+        m_model.isRunning() ? onPauseTimer() : onStartTimer();
+    });
+    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::pauseRequested, this, &PomodoroTimer::onPauseTimer);
+    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::resetRequested, this, &PomodoroTimer::onResetRequested);
+    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::settingsRequested, this, &PomodoroTimer::onShowSettings);
+    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::skipRequested, this, &PomodoroTimer::onSkipSession);
+    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::hudToggleRequested, this, [this]() {
+        setHudVisible(!isHudVisible());
+    });
+}
+
+void PomodoroTimer::initNotifications()
+{
+    m_notificationManager = std::make_unique<NotificationManager>(this);
     m_notificationManager->setSystemTrayManager(m_trayManager.get());
     m_notificationManager->setNotificationsEnabled(m_showNotifications);
-    m_trayManager->show();
 }
 
-PomodoroTimer::~PomodoroTimer()
+void PomodoroTimer::initHistory()
 {
-    saveSettings();
+    // First use of SessionHistory loads the whole file
+    SessionHistory& history = SessionHistory::instance();
+
+    // Sessions older than the retention window move to the compressed archive
+    if (m_archiveAfterMonths > 0) {
+        history.archiveBefore(QDate::currentDate().addMonths(-m_archiveAfterMonths).startOfDay());
+    }
+    applyHistoryStore();
+
+    // Metrics are kept up to date session by session; a full pass only when their file is missing
+    SessionMetrics& metrics = SessionMetrics::instance();
+    if (metrics.needsRebuild()) {
+        metrics.rebuild(history);
+    }
+
+    // Old archived sessions are folded into rollups off the GUI thread
+    m_compactionTimer = new QTimer(this);
+    m_compactionTimer->setInterval(COMPACTION_INTERVAL_MS);
+    connect(m_compactionTimer, &QTimer::timeout, this, &PomodoroTimer::onStartCompaction);
+    m_compactionTimer->start();
+    QTimer::singleShot(COMPACTION_DELAY_MS, this, &PomodoroTimer::onStartCompaction);
+}
+
+void PomodoroTimer::initStatisticsIndex()
+{
+    // Tag list and the session the note field refers to come from the loaded index
+    m_historyReady = true;
+    updateTagPicker();
+
+    const QVector<SessionRecord>& records = SessionHistory::instance().records();
+    for (auto it = records.crbegin(); it != records.crend(); ++it) {
+        if (it->type == TimerState::Work) {
+            m_lastWorkSessionId = it->id;
+            break;
+        }
+    }
+    m_noteEdit->setEnabled(m_lastWorkSessionId != 0);
+
+    // Catch the forecast up with the days that ended while the app was closed
+    onRefreshForecast();
+}
+
+void PomodoroTimer::initAudio()
+{
+    // Decode the cue sounds in the background so a session end plays from memory
+    const PomodoroConfig &config = PomodoroConfig::instance();
+    m_soundCues->setVolume(SoundCueEngine::Cue::WorkEnd, config.workEndVolume() / 100.0f);
+    m_soundCues->setVolume(SoundCueEngine::Cue::BreakEnd, config.breakEndVolume() / 100.0f);
+    if (!config.workEndSound().isEmpty() || !config.breakEndSound().isEmpty()) {
+        m_soundCues->preload(config.workEndSound(), config.breakEndSound());
+    }
+    applyAmbientSettings();
+}
+
+void PomodoroTimer::initPlugins()
+{
+    // Each plugin runs on its own thread; a missing directory simply loads nothing
+    m_plugins = std::make_unique<PluginHost>();
+    m_plugins->loadDirectory(m_pluginDirectory.isEmpty() ? PluginHost::defaultDirectory() : m_pluginDirectory);
+}
+
+void PomodoroTimer::initHooks()
+{
+    // Commands come from the [Hooks] group of config.ini
+    const PomodoroConfig &config = PomodoroConfig::instance();
+    m_hooks = new HookRunner(this);
+    m_hooks->setCommands(config.hookCommands());
+    m_hooks->setMaxConcurrent(config.hookConcurrency());
+    m_hooks->setTimeoutMs(config.hookTimeoutSeconds() * 1000);
+}
+
+void PomodoroTimer::publishEvent(pomodoro_event_type type, quint32 sessionId) const
+{
+    const bool toPlugins = m_plugins && m_plugins->pluginCount() > 0;
+    const bool toHooks = m_hooks && m_hooks->hasCommands();
+    if (!toPlugins && !toHooks) return;
+
+    pomodoro_event event{};
+    event.struct_size = sizeof(event);
+    event.type = type;
+    event.session_type = static_cast<uint32_t>(m_model.state());
+    event.session_id = sessionId;
+    event.wall_time_ms = QDateTime::currentMSecsSinceEpoch();
+    event.planned_seconds = m_model.totalSeconds();
+    event.elapsed_seconds = static_cast<int32_t>(m_clock.activeMs() / 1000);
+    event.completed_sessions = m_model.completedSessions();
+
+    // Cut at a character boundary so the tag stays valid UTF-8
+    QByteArray tag = m_model.state() == TimerState::Work ? m_currentTag.toUtf8() : QByteArray();
+    if (tag.size() >= POMODORO_PLUGIN_TAG_SIZE) {
+        int length = POMODORO_PLUGIN_TAG_SIZE - 1;
+        while (length > 0 && (static_cast<uchar>(tag.at(length)) & 0xC0) == 0x80) {
+            --length;
+        }
+        tag.truncate(length);
+    }
+    qstrncpy(event.tag, tag.constData(), sizeof(event.tag));
+
+    if (toPlugins) {
+        m_plugins->publish(event);
+    }
+    if (toHooks) {
+        m_hooks->handle(event);
+    }
+}
+
+void PomodoroTimer::showNotification(const QString &message, NotificationManager::Kind kind) const
+{
+    if (m_notificationManager) {
+        m_notificationManager->showNotification(message, kind);
+    }
+}
+
+void PomodoroTimer::setHudVisible(bool visible)
+{
+    if (visible == isHudVisible()) return;
+
+    if (!visible) {
+        delete m_hud;
+        m_hud = nullptr;
+        return;
+    }
+
+    m_hud = new PerformanceHud(this);
+    m_hud->watch(m_circularProgress, QStringLiteral("ring"));
+    m_hud->watch(m_timeLabel, QStringLiteral("time"));
+    m_hud->watch(m_mainFrame, QStringLiteral("frame"));
+    m_hud->show();
+}
+
+void PomodoroTimer::setAudioSink(const QString &spec)
+{
+    releaseAudioSink();
+    if (!m_audioThread) {
+        // Mixing and the device's pull callbacks stay off the GUI thread
+        m_audioThread = std::make_unique<QThread>();
+        m_audioThread->setObjectName(QStringLiteral("audio"));
+        m_audioThread->start(QThread::TimeCriticalPriority);
+    }
+
+    m_audioSink = AudioSink::create(spec);
+    m_audioSink->addSource(m_soundCues.get());
+    m_audioSink->addSource(m_ambient.get());
+    m_audioSink->moveToThread(m_audioThread.get());
+
+    AudioSink *sink = m_audioSink.get();
+    QMetaObject::invokeMethod(sink, [sink]() {
+        if (!sink->start()) {
+            qWarning() << "Sound disabled: the audio output could not be started";
+        }
+    }, Qt::QueuedConnection);
+}
+
+void PomodoroTimer::releaseAudioSink()
+{
+    if (!m_audioSink) {
+        return;
+    }
+    // Stopped on the audio thread, then handed back so it can be destroyed here
+    AudioSink *sink = m_audioSink.get();
+    QThread *owner = thread();
+    QMetaObject::invokeMethod(sink, [sink, owner]() {
+        sink->stop();
+        sink->moveToThread(owner);
+    }, Qt::BlockingQueuedConnection);
+    m_audioSink.reset();
+}
+
+void PomodoroTimer::applyAmbientSettings()
+{
+    m_ambient->setNoise(static_cast<AmbientNoiseGenerator::Noise>(m_ambientNoise));
+    m_ambient->setLevel(m_ambientLevel / 100.0f);
+    m_ambient->setTicking(m_ambientTicking);
+
+    // The output stays closed until something can actually be heard
+    const PomodoroConfig &config = PomodoroConfig::instance();
+    const bool needsOutput = m_ambientNoise != 0 || m_ambientTicking
+                             || !config.workEndSound().isEmpty() || !config.breakEndSound().isEmpty();
+    if (needsOutput && !m_audioSink) {
+        setAudioSink(QString());
+    } else if (m_audioSink) {
+        m_audioSink->wake();
+    }
+}
+
+void PomodoroTimer::updateAmbient() const
+{
+    m_ambient->setActive(m_model.isRunning() && m_model.state() == TimerState::Work);
+    if (m_audioSink) {
+        m_audioSink->wake();
+    }
 }
 
 void PomodoroTimer::setupUI()
@@ -70,9 +368,10 @@ void PomodoroTimer::setupUI()
 
     createLabels();
     createButtons();
+    createTagPicker();
+    createNoteEdit();
     createLayouts();
     applyStyles();
-    updateButtonStates();
 }
 
 void PomodoroTimer::createLabels()
@@ -113,6 +412,28 @@ void PomodoroTimer::createButtons()
     m_statsButton->setFixedSize(smallButtonSize);
 }
 
+void PomodoroTimer::createTagPicker()
+{
+    m_tagCombo = new QComboBox(m_mainFrame);
+    m_tagCombo->setEditable(true);
+    m_tagCombo->setInsertPolicy(QComboBox::NoInsert);
+    m_tagCombo->setFixedWidth(TAG_PICKER_WIDTH);
+    m_tagCombo->lineEdit()->setPlaceholderText("No project");
+    m_tagCombo->setToolTip("Task or project recorded with work sessions");
+    m_tagCombo->setEditText(m_currentTag);
+}
+
+void PomodoroTimer::createNoteEdit()
+{
+    m_noteEdit = new QLineEdit(m_mainFrame);
+    m_noteEdit->setFixedWidth(NOTE_EDIT_WIDTH);
+    m_noteEdit->setMaxLength(SessionNotes::MAX_NOTE_LENGTH);
+    m_noteEdit->setPlaceholderText("What did you get done? (Enter to save)");
+    m_noteEdit->setToolTip("Note attached to the last finished work session");
+    // Enabled once the history has loaded
+    m_noteEdit->setEnabled(false);
+}
+
 void PomodoroTimer::createLayouts()
 {
     // Progress bar layout
@@ -148,7 +469,11 @@ void PomodoroTimer::createLayouts()
     mainLayout->addLayout(progressLayout);
     mainLayout->addSpacing(15);
     mainLayout->addWidget(m_sessionLabel);
-    mainLayout->addSpacing(20);
+    mainLayout->addSpacing(10);
+    mainLayout->addWidget(m_tagCombo, 0, Qt::AlignCenter);
+    mainLayout->addSpacing(5);
+    mainLayout->addWidget(m_noteEdit, 0, Qt::AlignCenter);
+    mainLayout->addSpacing(10);
     mainLayout->addLayout(buttonLayout);
     mainLayout->addSpacing(15);
     mainLayout->addLayout(extraButtonLayout);
@@ -187,6 +512,23 @@ void PomodoroTimer::applyStyles() const {
     }
 }
 
+void PomodoroTimer::bindViews()
+{
+    bindView(m_model.bindableFormattedTime(), [this](const QString &time) { m_timeLabel->setText(time); });
+    bindView(m_model.bindableProgress(), [this](int progress) { m_circularProgress->setValue(progress); });
+    bindView(m_model.bindableCycleIndex(), [this](int index) {
+        m_sessionLabel->setText(QString("Session %1 of %2").arg(index).arg(SESSIONS_BEFORE_LONG_BREAK));
+    });
+    bindView(m_model.bindableWindowTitle(), [this](const QString &title) { setWindowTitle(title); });
+    bindView(m_model.bindableStartEnabled(), [this](bool enabled) { m_startButton->setEnabled(enabled); });
+    bindView(m_model.bindableResetVisible(), [this](bool visible) { m_resetButton->setVisible(visible); });
+    bindView(m_model.bindableRunning(), [this](bool running) {
+        m_pauseButton->setEnabled(running);
+        m_skipButton->setEnabled(running);
+        m_skipButton->setVisible(running);
+    });
+}
+
 void PomodoroTimer::setupConnections()
 {
     // Timer connections
@@ -195,99 +537,140 @@ void PomodoroTimer::setupConnections()
     // Button connections
     connect(m_startButton, &QPushButton::clicked, this, &PomodoroTimer::onStartTimer);
     connect(m_pauseButton, &QPushButton::clicked, this, &PomodoroTimer::onPauseTimer);
-    connect(m_resetButton, &QPushButton::clicked, this, &PomodoroTimer::onResetTimer);
+    connect(m_resetButton, &QPushButton::clicked, this, &PomodoroTimer::onResetRequested);
     connect(m_settingsButton, &QPushButton::clicked, this, &PomodoroTimer::onShowSettings);
     connect(m_skipButton, &QPushButton::clicked, this, &PomodoroTimer::onSkipSession);
     connect(m_statsButton, &QPushButton::clicked, this, &PomodoroTimer::onShowStatistics);
-
-    // System tray connections
-    connect(m_trayManager.get(), &SystemTrayManager::showMainWindow, this, &PomodoroTimer::onToggleVisibility);
-    connect(m_trayManager.get(), &SystemTrayManager::startPauseRequested, this, [this]() {
-        m_isRunning ? onPauseTimer() : onStartTimer();
-    });
-    connect(m_trayManager.get(), &SystemTrayManager::resetRequested, this, &PomodoroTimer::onResetTimer);
-    connect(m_trayManager.get(), &SystemTrayManager::skipRequested, this, &PomodoroTimer::onSkipSession);
-    connect(m_trayManager.get(), &SystemTrayManager::settingsRequested, this, &PomodoroTimer::onShowSettings);
-    connect(m_trayManager.get(), &SystemTrayManager::statisticsRequested, this, &PomodoroTimer::onShowStatistics);
-    connect(m_trayManager.get(), &SystemTrayManager::quitRequested, qApp, &QCoreApplication::quit);
-
-    // Keyboard shortcuts connections
-    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::startPauseRequested, this, [this]() {
-        m_isRunning ? onPauseTimer() : onStartTimer();
-    });
-    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::pauseRequested, this, &PomodoroTimer::onPauseTimer);
-    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::resetRequested, this, &PomodoroTimer::onResetTimer);
-    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::settingsRequested, this, &PomodoroTimer::onShowSettings);
-    connect(m_keyboardShortcuts.get(), &KeyboardShortcuts::skipRequested, this, &PomodoroTimer::onSkipSession);
+    connect(m_tagCombo, QOverload<int>::of(&QComboBox::activated), this, &PomodoroTimer::onTagSelected);
+    connect(m_tagCombo->lineEdit(), &QLineEdit::editingFinished, this, &PomodoroTimer::onTagSelected);
+    connect(m_noteEdit, &QLineEdit::returnPressed, this, &PomodoroTimer::onNoteEntered);
 }
 
 // Timer control methods
 void PomodoroTimer::onStartTimer()
 {
-    if (m_isRunning) return;
+    if (m_model.isRunning()) return;
 
-    m_isRunning = true;
-    m_sessionStartTime = QDateTime::currentDateTime();
+    const TimerModel::UpdateGroup group;
+    const bool resuming = m_clock.activeMs() > 0;
+    m_model.setRunning(true);
+    m_clock.start();
+    publishEvent(resuming ? POMODORO_EVENT_SESSION_RESUMED : POMODORO_EVENT_SESSION_STARTED);
     m_timer->start(TIMER_INTERVAL_MS);
 
-    m_statusLabel->setText(TimerStateHelper::getStatusMessage(m_currentState, true));
-    updateButtonStates();
-    updateDisplay();
+    m_statusLabel->setText(TimerStateHelper::getStatusMessage(m_model.state(), true));
+    updateAmbient();
+    saveCheckpoint();
 }
 
 void PomodoroTimer::onPauseTimer()
 {
-    if (!m_isRunning) return;
+    if (!m_model.isRunning()) return;
 
+    const TimerModel::UpdateGroup group;
     m_timer->stop();
-    m_isRunning = false;
+    m_clock.stop();
+    m_model.setRunning(false);
+    ++m_interruptions;
+    publishEvent(POMODORO_EVENT_SESSION_PAUSED);
     m_statusLabel->setText("⏸ Paused");
-    updateButtonStates();
-    updateDisplay();
+    updateAmbient();
+    saveCheckpoint();
 }
 
 void PomodoroTimer::onResetTimer()
 {
+    const TimerModel::UpdateGroup group;
     m_timer->stop();
-    m_isRunning = false;
+    m_model.setRunning(false);
+    m_clock.reset();
+    m_interruptions = 0;
     resetTimerState();
-    updateDisplay();
-    updateButtonStates();
+    updateAmbient();
+    saveCheckpoint();
+}
+
+void PomodoroTimer::onResetRequested()
+{
+    // Only an abandoned session is worth reporting
+    if (m_model.isRunning() || m_clock.activeMs() > 0) {
+        publishEvent(POMODORO_EVENT_SESSION_RESET);
+    }
+    onResetTimer();
 }
 
 void PomodoroTimer::onUpdateTimer()
 {
-    --m_currentTime;
-    updateDisplay();
+    const PerformanceHud::TickScope tickScope(m_hud);
+    const SessionClock::Event event = m_clock.poll();
+    if (event.gapMs > 0 && !m_clock.isRunning()) {
+        // Pause policy: the gap is already left out; wait for the user to resume
+        onPauseTimer();
+        showNotification(
+            QString("Paused after %1 away from the timer.").arg(TimerModel::formatTime(static_cast<int>(event.gapMs / 1000))));
+        return;
+    }
+    if (event.gapMs > 0) {
+        ++m_interruptions;     // counted or left out, the session was still broken up
+    }
 
-    if (m_currentTime <= 0) {
+    m_model.setRemainingSeconds(qMax(0, m_model.totalSeconds() - static_cast<int>(m_clock.activeMs() / 1000)));
+
+    if (m_model.remainingSeconds() <= 0) {
         onTimerFinished();
     }
 }
 
 void PomodoroTimer::onTimerFinished()
 {
+    // The views see the finished session and the next one as a single change
+    const TimerModel::UpdateGroup group;
     m_timer->stop();
-    m_isRunning = false;
+    m_model.setRunning(false);
+    m_soundCues->play(m_model.state() == TimerState::Work ? SoundCueEngine::Cue::WorkEnd
+                                                         : SoundCueEngine::Cue::BreakEnd);
+    if (m_audioSink) {
+        m_audioSink->wake();
+    }
 
-    // Update statistics
-    const QDateTime now = QDateTime::currentDateTime();
-    const int sessionDuration = static_cast<int>(m_sessionStartTime.secsTo(now));
+    // Update statistics from the reconciled clock, not the wall-clock difference
+    m_clock.stop();
+    const int sessionDuration = static_cast<int>(m_clock.activeMs() / 1000);
 
-    if (m_currentState == TimerState::Work) {
+    if (m_model.state() == TimerState::Work) {
         m_totalWorkTime += sessionDuration;
         m_totalSessions++;
-        m_completedSessions++;
+        m_model.setCompletedSessions(m_model.completedSessions() + 1);
     } else {
         m_totalBreakTime += sessionDuration;
     }
 
+    SessionHistory& history = SessionHistory::instance();
+    SessionRecord record;
+    record.startTime = m_clock.startWallMs() / 1000;
+    record.duration = static_cast<quint32>(qMax(0, sessionDuration));
+    record.type = m_model.state();
+    record.flags = static_cast<quint8>((m_skipRequested ? SessionSkipped : 0) | m_clock.flags());
+    record.tagId = m_model.state() == TimerState::Work ? history.internTag(m_currentTag) : 0;
+    const SessionRecord& stored = history.append(record);
+    SessionMetrics::instance().add(stored, m_interruptions);
+    publishEvent(m_skipRequested ? POMODORO_EVENT_SESSION_SKIPPED : POMODORO_EVENT_SESSION_FINISHED, stored.id);
+    if (stored.type == TimerState::Work) {
+        m_lastWorkSessionId = stored.id;
+        m_noteEdit->clear();
+        m_noteEdit->setEnabled(true);
+    }
+    emit sessionRecorded(stored);
+    onRefreshForecast();
+    m_skipRequested = false;
+    updateTagPicker();
+
     // Determine next state and show notifications
     QString message, nextAction;
-    if (m_currentState == TimerState::Work) {
+    if (m_model.state() == TimerState::Work) {
         message = "🎉 Focus session completed!";
 
-        const bool isLongBreakTime = (m_completedSessions % SESSIONS_BEFORE_LONG_BREAK == 0);
+        const bool isLongBreakTime = (m_model.completedSessions() % SESSIONS_BEFORE_LONG_BREAK == 0);
         updateTimerState(isLongBreakTime ? TimerState::LongBreak : TimerState::ShortBreak);
         nextAction = isLongBreakTime ? "Time for a long break! 🧘‍♀️" : "Take a short break! ☕";
     } else {
@@ -296,12 +679,12 @@ void PomodoroTimer::onTimerFinished()
         updateTimerState(TimerState::Work);
     }
 
-    m_notificationManager->showNotification(message + " " + nextAction);
+    showNotification(message + " " + nextAction, NotificationManager::Kind::SessionFinished);
     onResetTimer();
 
     // Auto-start if enabled
-    const bool shouldAutoStart = (m_currentState != TimerState::Work && m_autoStartBreaks) ||
-                                (m_currentState == TimerState::Work && m_autoStartWork);
+    const bool shouldAutoStart = (m_model.state() != TimerState::Work && m_autoStartBreaks) ||
+                                (m_model.state() == TimerState::Work && m_autoStartWork);
     if (shouldAutoStart) {
         QTimer::singleShot(AUTO_START_DELAY_MS, this, &PomodoroTimer::onStartTimer);
     }
@@ -312,122 +695,187 @@ void PomodoroTimer::onTimerFinished()
 // Helper methods
 void PomodoroTimer::resetTimerState()
 {
-    m_currentTime = TimerStateHelper::getDurationForState(m_currentState, m_workDuration, m_shortBreakDuration, m_longBreakDuration);
-    m_totalDuration = m_currentTime;
-    m_statusLabel->setText(TimerStateHelper::getStatusMessage(m_currentState, false));
+    const TimerModel::UpdateGroup group;
+    const int duration = TimerStateHelper::getDurationForState(m_model.state(), m_workDuration,
+                                                               m_shortBreakDuration, m_longBreakDuration);
+    m_model.setTotalSeconds(duration);
+    m_model.setRemainingSeconds(duration);
+    m_statusLabel->setText(TimerStateHelper::getStatusMessage(m_model.state(), false));
 }
 
-void PomodoroTimer::updateTimerState(TimerState newState)
+void PomodoroTimer::saveCheckpoint() const
 {
-    m_currentState = newState;
+    TimerCheckpoint checkpoint;
+    checkpoint.state = m_model.state();
+    checkpoint.running = m_model.isRunning();
+    checkpoint.completedSessions = m_model.completedSessions();
+    checkpoint.totalDuration = m_model.totalSeconds();
+    checkpoint.activeMs = m_clock.activeMs();
+    checkpoint.startWallMs = m_clock.startWallMs();
+    checkpoint.clockFlags = m_clock.flags();
+    checkpoint.writtenAtMs = QDateTime::currentMSecsSinceEpoch();
+    const QString path = TimerCheckpoint::defaultPath();
+    BackgroundWriter::instance().post([checkpoint, path]() { checkpoint.save(path); });
 }
 
-QString PomodoroTimer::formatTime(int seconds) {
-  const int minutes = seconds / 60;
-  const int secs = seconds % 60;
-  return QString("%1:%2")
-      .arg(minutes, 2, 10, QChar('0'))
-      .arg(secs, 2, 10, QChar('0'));
-}
-void PomodoroTimer::needsDisplayUpdate() {}
-
-void PomodoroTimer::updateDisplay()
+bool PomodoroTimer::restoreCheckpoint()
 {
-    m_timeLabel->setText(formatTime(m_currentTime));
+    TimerCheckpoint checkpoint;
+    if (!TimerCheckpoint::load(TimerCheckpoint::defaultPath(), checkpoint)) {
+        return false;
+    }
 
-    const int progress = m_totalDuration > 0 ?
-        ((m_totalDuration - m_currentTime) * 100) / m_totalDuration : 0;
-    m_circularProgress->setValue(progress);
+    const TimerModel::UpdateGroup group;
+    m_model.setState(checkpoint.state);
+    m_model.setCompletedSessions(checkpoint.completedSessions);
+    resetTimerState();
 
-    updateSessionCounter();
-    updateWindowTitle();
+    if (checkpoint.startWallMs == 0) {
+        return true;
+    }
+
+    // Time the app was closed is a gap like a suspend: only the policy decides
+    // whether it counts, and Pause leaves the session paused
+    const qint64 downtimeMs = checkpoint.downtimeMsAt(QDateTime::currentMSecsSinceEpoch());
+    const SessionClock::Event event = m_clock.restore(checkpoint.activeMs, checkpoint.startWallMs,
+                                                      checkpoint.clockFlags, downtimeMs);
+    const qint64 activeMs = qMin(m_clock.activeMs(), static_cast<qint64>(checkpoint.totalDuration) * 1000);
+    m_model.setTotalSeconds(checkpoint.totalDuration);
+    m_model.setRemainingSeconds(qMax(0, checkpoint.totalDuration - static_cast<int>(activeMs / 1000)));
+    if (event.gapMs > 0) {
+        ++m_interruptions;
+    }
 
-    // Update system tray
-    const int currentSession = (m_completedSessions % SESSIONS_BEFORE_LONG_BREAK) + 1;
-    m_trayManager->updateTooltip(m_currentState, m_isRunning, formatTime(m_currentTime),
-                                currentSession, SESSIONS_BEFORE_LONG_BREAK);
+    if (checkpoint.running && (event.gapMs == 0 || m_gapPolicy != SessionClock::GapPolicy::Pause)) {
+        onStartTimer();
+    } else if (event.gapMs > 0) {
+        const int awaySeconds = static_cast<int>(qMin<qint64>(event.gapMs / 1000, std::numeric_limits<int>::max()));
+        m_statusLabel->setText(QString("⏸ Paused after %1 away").arg(TimerModel::formatTime(awaySeconds)));
+    } else {
+        m_statusLabel->setText("⏸ Paused");
+    }
+    return true;
 }
 
-void PomodoroTimer::updateSessionCounter() const {
-    const int currentSession = (m_completedSessions % SESSIONS_BEFORE_LONG_BREAK) + 1;
-    m_sessionLabel->setText(QString("Session %1 of %2")
-                           .arg(currentSession)
-                           .arg(SESSIONS_BEFORE_LONG_BREAK));
+void PomodoroTimer::updateTimerState(TimerState newState)
+{
+    m_model.setState(newState);
 }
 
-void PomodoroTimer::updateButtonStates() const {
-    m_startButton->setEnabled(!m_isRunning);
-    m_pauseButton->setEnabled(m_isRunning);
+void PomodoroTimer::onShowSettings()
+{
+    // Built once and kept; reopening only refreshes the field values
+    if (!m_settingsDialog) {
+        m_settingsDialog = new SettingsDialog(this);
+        connect(m_settingsDialog, &QDialog::accepted, this, &PomodoroTimer::onSettingsAccepted);
+    }
+    if (m_settingsDialog->isVisible()) {
+        m_settingsDialog->raise();
+        m_settingsDialog->activateWindow();
+        return;
+    }
 
-    const bool shouldShowReset = m_isRunning || m_currentTime < m_totalDuration;
-    m_resetButton->setVisible(shouldShowReset);
-    m_resetButton->setEnabled(true);
+    SettingsDialog *dialog = m_settingsDialog;
+    dialog->setWorkDuration(m_workDuration / 60);
+    dialog->setShortBreakDuration(m_shortBreakDuration / 60);
+    dialog->setLongBreakDuration(m_longBreakDuration / 60);
+    dialog->setAutoStartBreaks(m_autoStartBreaks);
+    dialog->setAutoStartWork(m_autoStartWork);
+    dialog->setMinimizeToTray(m_minimizeToTray);
+    dialog->setShowNotifications(m_showNotifications);
+    dialog->setSqliteHistory(m_sqliteHistory);
+    dialog->setAmbientNoise(m_ambientNoise);
+    dialog->setAmbientTicking(m_ambientTicking);
+    dialog->setSuspendPolicy(static_cast<int>(m_gapPolicy));
+
+    // Window-modal without a nested event loop, so the countdown keeps ticking
+    dialog->open();
+}
 
-    m_skipButton->setEnabled(m_isRunning);
-    m_skipButton->setVisible(m_isRunning);
+void PomodoroTimer::onSettingsAccepted()
+{
+    const SettingsDialog *dialog = m_settingsDialog;
+    m_workDuration = dialog->workDuration() * 60;
+    m_shortBreakDuration = dialog->shortBreakDuration() * 60;
+    m_longBreakDuration = dialog->longBreakDuration() * 60;
+    m_autoStartBreaks = dialog->autoStartBreaks();
+    m_autoStartWork = dialog->autoStartWork();
+    m_minimizeToTray = dialog->minimizeToTray();
+    m_showNotifications = dialog->showNotifications();
+    m_sqliteHistory = dialog->sqliteHistory();
+    m_ambientNoise = dialog->ambientNoise();
+    m_ambientTicking = dialog->ambientTicking();
+    m_gapPolicy = static_cast<SessionClock::GapPolicy>(dialog->suspendPolicy());
+    m_clock.setPolicy(m_gapPolicy);
 
-    // Force layout update
-    if (m_mainFrame && m_mainFrame->layout()) {
-        m_mainFrame->layout()->update();
-        m_mainFrame->updateGeometry();
-    }
+    saveSettings();
+    applyHistoryStore();
+    applyAmbientSettings();
+    onResetTimer();
 }
 
-void PomodoroTimer::updateWindowTitle() {
-  const QString timeRemaining = formatTime(m_currentTime);
-  const QString emoji = TimerStateHelper::getStateEmoji(m_currentState);
+void PomodoroTimer::onSkipSession()
+{
+    if (m_model.isRunning()) {
+        m_skipRequested = true;
+        onTimerFinished();
+    }
+}
 
-  QString title;
-  if (m_isRunning) {
-    const QString stateText =
-        (m_currentState == TimerState::Work) ? "Focus" : "Break";
-    title = QString("%1 %2: %3").arg(emoji, stateText, timeRemaining);
-  } else {
-    title = "🍅 Pomodoro Timer";
-  }
+void PomodoroTimer::onShowStatistics()
+{
+    // Built and loaded once; afterwards it follows sessionRecorded() while open
+    onRefreshForecast();
+    if (!m_statisticsDialog) {
+        m_statisticsDialog = new StatisticsDialog(this);
+        m_statisticsDialog->setStatistics(m_totalSessions, m_totalWorkTime, m_totalBreakTime);
+        connect(this, &PomodoroTimer::sessionRecorded, m_statisticsDialog, &StatisticsDialog::addSession);
+        connect(this, &PomodoroTimer::forecastUpdated, m_statisticsDialog, &StatisticsDialog::refreshForecast);
+        connect(m_statisticsDialog, &StatisticsDialog::historyImported, this, &PomodoroTimer::onRefreshForecast);
+    }
+    m_statisticsDialog->show();
+    m_statisticsDialog->raise();
+    m_statisticsDialog->activateWindow();
+}
 
-  setWindowTitle(title);
+void PomodoroTimer::onTagSelected()
+{
+    setCurrentTag(m_tagCombo->currentText());
 }
-void PomodoroTimer::updateTrayTooltip() {}
 
-void PomodoroTimer::onShowSettings()
+void PomodoroTimer::onNoteEntered()
 {
-    SettingsDialog dialog(this);
-
-    dialog.setWorkDuration(m_workDuration / 60);
-    dialog.setShortBreakDuration(m_shortBreakDuration / 60);
-    dialog.setLongBreakDuration(m_longBreakDuration / 60);
-    dialog.setAutoStartBreaks(m_autoStartBreaks);
-    dialog.setAutoStartWork(m_autoStartWork);
-    dialog.setMinimizeToTray(m_minimizeToTray);
-    dialog.setShowNotifications(m_showNotifications);
-
-    if (dialog.exec() == QDialog::Accepted) {
-        m_workDuration = dialog.workDuration() * 60;
-        m_shortBreakDuration = dialog.shortBreakDuration() * 60;
-        m_longBreakDuration = dialog.longBreakDuration() * 60;
-        m_autoStartBreaks = dialog.autoStartBreaks();
-        m_autoStartWork = dialog.autoStartWork();
-        m_minimizeToTray = dialog.minimizeToTray();
-        m_showNotifications = dialog.showNotifications();
+    if (m_lastWorkSessionId == 0) return;
 
-        saveSettings();
-        onResetTimer();
-    }
+    SessionNotes::instance().setNote(m_lastWorkSessionId, m_noteEdit->text());
+    m_noteEdit->clearFocus();
 }
 
-void PomodoroTimer::onSkipSession()
+void PomodoroTimer::setCurrentTag(const QString &tag)
 {
-    if (m_isRunning) {
-        onTimerFinished();
-    }
+    const QString trimmed = tag.trimmed();
+    if (trimmed == m_currentTag) return;
+
+    m_currentTag = trimmed;
+    updateTagPicker();
+    saveSettings();
 }
 
-void PomodoroTimer::onShowStatistics()
+void PomodoroTimer::updateTagPicker()
 {
-    StatisticsDialog dialog(this);
-    dialog.setStatistics(m_totalSessions, m_totalWorkTime, m_totalBreakTime);
-    dialog.exec();
+    if (!m_tagCombo) return;
+
+    const QSignalBlocker blocker(m_tagCombo);
+    if (!m_historyReady) {
+        m_tagCombo->setEditText(m_currentTag);
+        return;
+    }
+    const QStringList& tags = SessionHistory::instance().tagNames();
+    if (m_tagCombo->count() != tags.size()) {
+        m_tagCombo->clear();
+        m_tagCombo->addItems(tags);
+    }
+    m_tagCombo->setEditText(m_currentTag);
 }
 
 void PomodoroTimer::onToggleVisibility()
@@ -451,9 +899,22 @@ void PomodoroTimer::loadSettings()
     m_autoStartWork = settings.value("autoStartWork", false).toBool();
     m_minimizeToTray = settings.value("minimizeToTray", true).toBool();
     m_showNotifications = settings.value("showNotifications", true).toBool();
+    m_sqliteHistory = settings.value("sqliteHistory", false).toBool();
+    m_archiveAfterMonths = settings.value("archiveAfterMonths", DEFAULT_ARCHIVE_AFTER_MONTHS).toInt();
+    m_dailyRollupAfterMonths = settings.value("dailyRollupAfterMonths", DEFAULT_DAILY_ROLLUP_AFTER_MONTHS).toInt();
+    m_monthlyRollupAfterMonths = settings.value("monthlyRollupAfterMonths", DEFAULT_MONTHLY_ROLLUP_AFTER_MONTHS).toInt();
+    AmbientNoiseGenerator::Noise noise = AmbientNoiseGenerator::Noise::Off;
+    AmbientNoiseGenerator::parseNoise(settings.value("ambientNoise").toString(), noise);
+    m_ambientNoise = static_cast<int>(noise);
+    m_ambientLevel = qBound(0, settings.value("ambientLevel", DEFAULT_AMBIENT_LEVEL).toInt(), 100);
+    m_ambientTicking = settings.value("ambientTicking", false).toBool();
+    m_gapPolicy = SessionClock::GapPolicy::Pause;
+    SessionClock::parsePolicy(settings.value("suspendPolicy").toString(), m_gapPolicy);
+    m_clock.setPolicy(m_gapPolicy);
     m_totalSessions = settings.value("totalSessions", 0).toInt();
     m_totalWorkTime = settings.value("totalWorkTime", 0).toInt();
     m_totalBreakTime = settings.value("totalBreakTime", 0).toInt();
+    m_currentTag = settings.value("currentTag").toString();
 }
 
 void PomodoroTimer::saveSettings() const {
@@ -465,9 +926,138 @@ void PomodoroTimer::saveSettings() const {
     settings.setValue("autoStartWork", m_autoStartWork);
     settings.setValue("minimizeToTray", m_minimizeToTray);
     settings.setValue("showNotifications", m_showNotifications);
+    settings.setValue("sqliteHistory", m_sqliteHistory);
+    settings.setValue("archiveAfterMonths", m_archiveAfterMonths);
+    settings.setValue("dailyRollupAfterMonths", m_dailyRollupAfterMonths);
+    settings.setValue("monthlyRollupAfterMonths", m_monthlyRollupAfterMonths);
+    settings.setValue("ambientNoise", AmbientNoiseGenerator::noiseName(static_cast<AmbientNoiseGenerator::Noise>(m_ambientNoise)));
+    settings.setValue("ambientLevel", m_ambientLevel);
+    settings.setValue("ambientTicking", m_ambientTicking);
+    settings.setValue("suspendPolicy", SessionClock::policyName(m_gapPolicy));
     settings.setValue("totalSessions", m_totalSessions);
     settings.setValue("totalWorkTime", m_totalWorkTime);
     settings.setValue("totalBreakTime", m_totalBreakTime);
+    settings.setValue("currentTag", m_currentTag);
+}
+
+void PomodoroTimer::applyHistoryStore() const
+{
+    SqliteHistoryStore& store = SqliteHistoryStore::instance();
+    if (m_sqliteHistory) {
+        store.open();
+    } else {
+        store.close();
+    }
+}
+
+void PomodoroTimer::onStartCompaction()
+{
+    if (m_compactionThread) {
+        return; // the previous run is still going
+    }
+    if (m_dailyRollupAfterMonths <= 0 && m_monthlyRollupAfterMonths <= 0) {
+        return;
+    }
+    const HistoryArchive &archive = SessionHistory::instance().archive();
+    if (archive.blockCount() == 0 && archive.rollups().isEmpty()) {
+        return; // nothing archived yet
+    }
+
+    HistoryCompactor::RetentionPolicy policy;
+    policy.dailyAfterMonths = m_dailyRollupAfterMonths;
+    policy.monthlyAfterMonths = m_monthlyRollupAfterMonths;
+
+    auto *compactor = new HistoryCompactor(policy);
+    auto *thread = new QThread;
+    compactor->moveToThread(thread);
+
+    connect(thread, &QThread::started, compactor, &HistoryCompactor::run);
+    connect(compactor, &HistoryCompactor::finished, this, [](bool changed, const QString &error) {
+        if (!changed && !error.isEmpty()) {
+            qWarning() << "History compaction failed:" << error;
+        }
+        // The archive may have been released for the swap even if it then failed
+        if (changed || !error.isEmpty()) {
+            SessionHistory::instance().reloadArchive();
+        }
+    });
+    connect(compactor, &HistoryCompactor::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, compactor, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    m_compactor = compactor;
+    m_compactionThread = thread;
+    thread->start(QThread::LowestPriority);
+}
+
+void PomodoroTimer::onRefreshForecast()
+{
+    if (!m_historyReady || m_forecastThread) {
+        return;
+    }
+
+    // Only complete days feed the model, so there is nothing new until the date changes
+    SessionHistory &history = SessionHistory::instance();
+    const FocusForecast &forecast = history.forecast();
+    const QDate today = QDate::currentDate();
+    if (forecast.asOf() == today) {
+        return;
+    }
+
+    const QMap<QDate, DailyRollup> &rollups = history.dailyRollups();
+    QDate firstDay;
+    if (forecast.lastDay() > 0) {
+        firstDay = QDate::fromJulianDay(forecast.lastDay() + 1);
+    } else if (!rollups.isEmpty()) {
+        firstDay = qMax(rollups.firstKey(), today.addDays(-FocusForecast::FIT_HISTORY_DAYS));
+    }
+    if (!firstDay.isValid() || (forecast.lastDay() == 0 && firstDay >= today)) {
+        return; // no complete day to fit yet
+    }
+
+    QVector<double> minutes;
+    for (QDate day = firstDay; day < today; day = day.addDays(1)) {
+        minutes.append(rollups.value(day).workSeconds / 60.0);
+    }
+
+    auto *fitter = new ForecastFitter(forecast, firstDay, minutes, today);
+    auto *thread = new QThread;
+    fitter->moveToThread(thread);
+
+    connect(thread, &QThread::started, fitter, &ForecastFitter::run);
+    // Compared by generation: a from-scratch fit and a reset model both have no last day
+    const quint64 generation = history.forecastGeneration();
+    connect(fitter, &ForecastFitter::finished, this, [this, generation](const FocusForecast &fitted) {
+        SessionHistory &history = SessionHistory::instance();
+        if (history.forecastGeneration() != generation) {
+            return; // an import reset the model meanwhile
+        }
+        history.setForecast(fitted);
+        emit forecastUpdated();
+    });
+    connect(fitter, &ForecastFitter::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, fitter, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    // Picks up a day change or import that arrived while this fit ran
+    connect(thread, &QThread::finished, this, [this]() {
+        m_forecastThread = nullptr;
+        onRefreshForecast();
+    });
+
+    m_forecastThread = thread;
+    thread->start(QThread::LowPriority);
+}
+
+void PomodoroTimer::stopCompaction()
+{
+    if (!m_compactionThread) {
+        return;
+    }
+    if (m_compactor) {
+        m_compactor->cancel();
+    }
+    m_compactionThread->quit();
+    m_compactionThread->wait();
 }
 
 void PomodoroTimer::keyPressEvent(QKeyEvent *event)
@@ -486,7 +1076,7 @@ void PomodoroTimer::closeEvent(QCloseEvent *event)
 
         static bool firstHide = true;
         if (firstHide) {
-            m_notificationManager->showNotification("Application was minimized to tray. Click the tray icon to show again.");
+            showNotification("Application was minimized to tray. Click the tray icon to show again.");
             firstHide = false;
         }
     } else {
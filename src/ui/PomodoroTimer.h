@@ -6,7 +6,14 @@
 #include <QPushButton>
 #include <QFrame>
 #include <QDateTime>
+#include <QPointer>
 #include <memory>
+#include <vector>
+#include "SessionClock.h"
+#include "NotificationManager.h"
+#include "PomodoroPlugin.h"
+#include "SessionHistory.h"
+#include "TimerModel.h"
 #include "TimerState.h"
 
 // Forward declarations
@@ -15,7 +22,17 @@ class SettingsDialog;
 class StatisticsDialog;
 class SystemTrayManager;
 class KeyboardShortcuts;
-class NotificationManager;
+class SoundCueEngine;
+class AmbientNoiseGenerator;
+class AudioSink;
+class QComboBox;
+class QLineEdit;
+class QThread;
+class HistoryCompactor;
+class StartupSequence;
+class PerformanceHud;
+class PluginHost;
+class HookRunner;
 
 class PomodoroTimer : public QWidget
 {
@@ -32,54 +49,107 @@ public:
     static constexpr int SESSIONS_BEFORE_LONG_BREAK = 4;
     static constexpr int TIMER_INTERVAL_MS = 1000;
     static constexpr int AUTO_START_DELAY_MS = 3000;
+    static constexpr int DEFAULT_ARCHIVE_AFTER_MONTHS = 6;
+    static constexpr int DEFAULT_DAILY_ROLLUP_AFTER_MONTHS = 24;
+    static constexpr int DEFAULT_MONTHLY_ROLLUP_AFTER_MONTHS = 60;
+    static constexpr int COMPACTION_DELAY_MS = 60 * 1000;
+    static constexpr int COMPACTION_INTERVAL_MS = 24 * 60 * 60 * 1000;
+    static constexpr int DEFAULT_AMBIENT_LEVEL = 30;        // percent
+
+    // Task/project tag recorded with the following work sessions (empty = untagged)
+    void setCurrentTag(const QString &tag);
+    [[nodiscard]] const QString& currentTag() const { return m_currentTag; }
+
+    // Where cues and focus noise are played: "device", "null" or a .wav path
+    void setAudioSink(const QString &spec);
+
+    // Where timer event plugins are loaded from; PluginHost::defaultDirectory() unless set
+    void setPluginDirectory(const QString &directory) { m_pluginDirectory = directory; }
+
+    // Debug overlay with paint times, event-loop latency and tick cost
+    void setHudVisible(bool visible);
+    [[nodiscard]] bool isHudVisible() const { return m_hud != nullptr; }
+
+signals:
+    // Emitted after a finished session has been appended to the history
+    void sessionRecorded(const SessionRecord &record);
+    // A refitted forecast was stored in SessionHistory
+    void forecastUpdated();
 
 protected:
     void keyPressEvent(QKeyEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private slots:
     // Timer control slots
     void onStartTimer();
     void onPauseTimer();
     void onResetTimer();
+    void onResetRequested();
     void onUpdateTimer();
     void onTimerFinished();
 
     // UI interaction slots
     void onShowSettings();
+    void onSettingsAccepted();
     void onSkipSession();
     void onShowStatistics();
     void onToggleVisibility();
+    void onTagSelected();
+    void onNoteEntered();
+    void onStartCompaction();
+    void onRefreshForecast();
 
 private:
     // Setup methods
     void setupUI();
     void setupConnections();
+    // Widgets follow the model's derived properties from here on
+    void bindViews();
+    template <typename T, typename Apply>
+    void bindView(QBindable<T> property, Apply apply);
+
+    // Deferred startup stages, run after the first frame
+    void initTray();
+    void initShortcuts();
+    void initNotifications();
+    void initHistory();
+    void initStatisticsIndex();
+    void initAudio();
+    void initPlugins();
+    void initHooks();
 
     // UI creation helpers
     void createLabels();
     void createButtons();
+    void createTagPicker();
+    void createNoteEdit();
     void createLayouts();
     void applyStyles() const;
 
     // Settings management
     void loadSettings();
     void saveSettings() const;
+    void applyHistoryStore() const;
+    void stopCompaction();
+    void applyAmbientSettings();
+    void releaseAudioSink();
+    void updateAmbient() const;
 
     // Timer state management
     void resetTimerState();
+    void saveCheckpoint() const;
+    bool restoreCheckpoint();
     void updateTimerState(TimerState newState);
-
-    // Display update methods - optimized to avoid unnecessary updates
-    void updateDisplay();
-    void updateSessionCounter() const;
-    void updateButtonStates() const;
-    void updateWindowTitle();
-    static void updateTrayTooltip();
+    void updateTagPicker();
+    // Hands a session transition to the plugins and the user's hooks
+    void publishEvent(pomodoro_event_type type, quint32 sessionId = 0) const;
 
     // Utility methods
-    static QString formatTime(int seconds);
-    static void needsDisplayUpdate();
+    // Dropped while the notification stage has not run yet
+    void showNotification(const QString &message,
+                          NotificationManager::Kind kind = NotificationManager::Kind::Info) const;
 
     // UI elements - use raw pointers for Qt objects with parent ownership
     QTimer *m_timer;
@@ -92,24 +162,43 @@ private:
     QPushButton *m_settingsButton{nullptr};
     QPushButton *m_skipButton{nullptr};
     QPushButton *m_statsButton{nullptr};
+    QComboBox *m_tagCombo{nullptr};
+    QLineEdit *m_noteEdit{nullptr};
     CircularProgressBar *m_circularProgress{nullptr};
+    // Created on first use and kept hidden between uses
+    SettingsDialog *m_settingsDialog{nullptr};
+    StatisticsDialog *m_statisticsDialog{nullptr};
     QFrame *m_mainFrame{nullptr};
 
-    // Managers - keep as unique_ptr for complex objects
+    // Managers - keep as unique_ptr for complex objects; the first three are
+    // created by the deferred startup stages and are null until then
     std::unique_ptr<SystemTrayManager> m_trayManager;
     std::unique_ptr<KeyboardShortcuts> m_keyboardShortcuts;
     std::unique_ptr<NotificationManager> m_notificationManager;
+    std::unique_ptr<SoundCueEngine> m_soundCues;
+    std::unique_ptr<AmbientNoiseGenerator> m_ambient;
+    std::unique_ptr<AudioSink> m_audioSink;             // declared after its sources so it stops first
+    std::unique_ptr<QThread> m_audioThread;             // renders the sink's mix, started with the first sink
+    std::unique_ptr<PluginHost> m_plugins;              // null until the plugin stage
+    QString m_pluginDirectory;
+    HookRunner *m_hooks{nullptr};                       // null until the hook stage
+
+    // Background history compaction
+    QTimer *m_compactionTimer{nullptr};
+    QPointer<QThread> m_compactionThread;
+    QPointer<HistoryCompactor> m_compactor;
+
+    // Forecast refits, started when a day has completed since the last one
+    QPointer<QThread> m_forecastThread;
+
+    StartupSequence *m_startup{nullptr};
+    bool m_historyReady{false};             // tag list may be read from SessionHistory
+    PerformanceHud *m_hud{nullptr};         // only exists while shown
 
     // Timer state
-    int m_currentTime{0};
-    int m_totalDuration{0};
-    TimerState m_currentState{TimerState::Work};
-    int m_completedSessions{0};
-    bool m_isRunning{false};
-
-    // Cache for reducing string operations
-    mutable QString m_cachedTimeString;
-    mutable int m_lastFormattedTime{-1};
+    TimerModel m_model;
+    std::vector<QPropertyNotifier> m_viewNotifiers;
+    SessionClock m_clock;                   // active time of the current session
 
     // Settings
     int m_workDuration{DEFAULT_WORK_DURATION};
@@ -119,17 +208,31 @@ private:
     bool m_autoStartWork{false};
     bool m_minimizeToTray{true};
     bool m_showNotifications{true};
+    bool m_sqliteHistory{false};
+    int m_archiveAfterMonths{DEFAULT_ARCHIVE_AFTER_MONTHS};
+    int m_dailyRollupAfterMonths{DEFAULT_DAILY_ROLLUP_AFTER_MONTHS};
+    int m_monthlyRollupAfterMonths{DEFAULT_MONTHLY_ROLLUP_AFTER_MONTHS};
+    int m_ambientNoise{0};                  // AmbientNoiseGenerator::Noise
+    int m_ambientLevel{DEFAULT_AMBIENT_LEVEL};
+    bool m_ambientTicking{false};
+    SessionClock::GapPolicy m_gapPolicy{SessionClock::GapPolicy::Pause};
 
     // Statistics
     int m_totalSessions{0};
     int m_totalWorkTime{0};
     int m_totalBreakTime{0};
-    QDateTime m_sessionStartTime;
-
-    // Update tracking to prevent unnecessary redraws
-    bool m_needsButtonUpdate{true};
-    bool m_needsSessionUpdate{true};
-    QString m_lastWindowTitle;
+    QString m_currentTag;
+    quint32 m_lastWorkSessionId{0};
+    bool m_skipRequested{false};
+    int m_interruptions{0};                 // pauses and away gaps in the current session
 };
 
+// Applies the current value now and again whenever it changes
+template <typename T, typename Apply>
+void PomodoroTimer::bindView(QBindable<T> property, Apply apply)
+{
+    apply(property.value());
+    m_viewNotifiers.push_back(property.addNotifier([property, apply]() { apply(property.value()); }));
+}
+
 #endif // POMODOROTIMER_H
@@ -1,6 +1,7 @@
 #include "SettingsDialog.h"
 #include <QApplication>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QDialogButtonBox>
 #include <QFormLayout>
 #include <QGroupBox>
@@ -12,7 +13,6 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     : QDialog(parent)
 {
     setWindowTitle("Pomodoro Settings");
-    setFixedSize(350, 300);  // Reduced from 400 since we removed sound settings
     // Remove all custom styling
     setStyleSheet("");
     setupUI();
@@ -41,6 +41,12 @@ void SettingsDialog::setupUI()
     m_longBreakSpin->setSuffix(" minutes");
     timerLayout->addRow("Long Break:", m_longBreakSpin);
 
+    // Item order matches SessionClock::GapPolicy
+    m_suspendPolicyCombo = new QComboBox();
+    m_suspendPolicyCombo->addItems({"Pause the timer", "Count the time away", "Skip the time away"});
+    m_suspendPolicyCombo->setToolTip("What happens when the computer sleeps during a running session");
+    timerLayout->addRow("After Sleep:", m_suspendPolicyCombo);
+
     // Behavior Settings Group
     QGroupBox *behaviorGroup = new QGroupBox("Behavior");
     QVBoxLayout *behaviorLayout = new QVBoxLayout(behaviorGroup);
@@ -49,11 +55,26 @@ void SettingsDialog::setupUI()
     m_autoStartWorkCheck = new QCheckBox("Auto-start work sessions");
     m_minimizeToTrayCheck = new QCheckBox("Minimize to system tray");
     m_showNotificationsCheck = new QCheckBox("Show notifications");
+    m_sqliteHistoryCheck = new QCheckBox("Keep a SQLite copy of the history");
+    m_sqliteHistoryCheck->setToolTip("Mirrors sessions to history.sqlite for ad-hoc queries");
 
     behaviorLayout->addWidget(m_autoStartBreaksCheck);
     behaviorLayout->addWidget(m_autoStartWorkCheck);
     behaviorLayout->addWidget(m_minimizeToTrayCheck);
     behaviorLayout->addWidget(m_showNotificationsCheck);
+    behaviorLayout->addWidget(m_sqliteHistoryCheck);
+
+    // Focus Sound Group
+    QGroupBox *soundGroup = new QGroupBox("Focus Sound");
+    QFormLayout *soundLayout = new QFormLayout(soundGroup);
+
+    // Item order matches AmbientNoiseGenerator::Noise
+    m_ambientNoiseCombo = new QComboBox();
+    m_ambientNoiseCombo->addItems({"Off", "White noise", "Pink noise", "Brown noise"});
+    soundLayout->addRow("Background:", m_ambientNoiseCombo);
+
+    m_ambientTickingCheck = new QCheckBox("Ticking clock");
+    soundLayout->addRow(m_ambientTickingCheck);
 
     // Dialog Buttons
     m_buttonBox = new QDialogButtonBox(
@@ -62,8 +83,11 @@ void SettingsDialog::setupUI()
     // Layout
     mainLayout->addWidget(timerGroup);
     mainLayout->addWidget(behaviorGroup);
+    mainLayout->addWidget(soundGroup);
     mainLayout->addStretch();
     mainLayout->addWidget(m_buttonBox);
+    // Fixed at whatever the groups need, so adding a setting never clips the dialog
+    mainLayout->setSizeConstraint(QLayout::SetFixedSize);
 
     // Connections
     connect(m_buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
@@ -80,6 +104,10 @@ bool SettingsDialog::autoStartBreaks() const { return m_autoStartBreaksCheck->is
 bool SettingsDialog::autoStartWork() const { return m_autoStartWorkCheck->isChecked(); }
 bool SettingsDialog::minimizeToTray() const { return m_minimizeToTrayCheck->isChecked(); }
 bool SettingsDialog::showNotifications() const { return m_showNotificationsCheck->isChecked(); }
+bool SettingsDialog::sqliteHistory() const { return m_sqliteHistoryCheck->isChecked(); }
+int SettingsDialog::suspendPolicy() const { return m_suspendPolicyCombo->currentIndex(); }
+int SettingsDialog::ambientNoise() const { return m_ambientNoiseCombo->currentIndex(); }
+bool SettingsDialog::ambientTicking() const { return m_ambientTickingCheck->isChecked(); }
 
 // Setters
 void SettingsDialog::setWorkDuration(int minutes) const { m_workDurationSpin->setValue(minutes); }
@@ -89,6 +117,10 @@ void SettingsDialog::setAutoStartBreaks(bool enabled) const { m_autoStartBreaksC
 void SettingsDialog::setAutoStartWork(bool enabled) const { m_autoStartWorkCheck->setChecked(enabled); }
 void SettingsDialog::setMinimizeToTray(bool enabled) const { m_minimizeToTrayCheck->setChecked(enabled); }
 void SettingsDialog::setShowNotifications(bool enabled) const { m_showNotificationsCheck->setChecked(enabled); }
+void SettingsDialog::setSqliteHistory(bool enabled) const { m_sqliteHistoryCheck->setChecked(enabled); }
+void SettingsDialog::setSuspendPolicy(int policy) const { m_suspendPolicyCombo->setCurrentIndex(policy); }
+void SettingsDialog::setAmbientNoise(int noise) const { m_ambientNoiseCombo->setCurrentIndex(noise); }
+void SettingsDialog::setAmbientTicking(bool enabled) const { m_ambientTickingCheck->setChecked(enabled); }
 
 void SettingsDialog::resetToDefaults() const {
     setWorkDuration(25);
@@ -98,4 +130,8 @@ void SettingsDialog::resetToDefaults() const {
     setAutoStartWork(false);
     setMinimizeToTray(true);
     setShowNotifications(true);
+    setSqliteHistory(false);
+    setSuspendPolicy(0);
+    setAmbientNoise(0);
+    setAmbientTicking(false);
 }
@@ -6,6 +6,7 @@
 // Forward declarations
 class QSpinBox;
 class QCheckBox;
+class QComboBox;
 class QPushButton;
 class QDialogButtonBox;
 
@@ -24,6 +25,10 @@ public:
     bool autoStartWork() const;
     bool minimizeToTray() const;
     bool showNotifications() const;
+    bool sqliteHistory() const;
+    int ambientNoise() const;
+    int suspendPolicy() const;
+    bool ambientTicking() const;
 
     // Setters
     void setWorkDuration(int minutes) const;
@@ -33,6 +38,10 @@ public:
     void setAutoStartWork(bool enabled) const;
     void setMinimizeToTray(bool enabled) const;
     void setShowNotifications(bool enabled) const;
+    void setSqliteHistory(bool enabled) const;
+    void setAmbientNoise(int noise) const;
+    void setSuspendPolicy(int policy) const;
+    void setAmbientTicking(bool enabled) const;
 
 signals:
     void settingsChanged();
@@ -47,10 +56,14 @@ private:
     QSpinBox *m_workDurationSpin;
     QSpinBox *m_shortBreakSpin;
     QSpinBox *m_longBreakSpin;
+    QComboBox *m_suspendPolicyCombo;
     QCheckBox *m_autoStartBreaksCheck;
     QCheckBox *m_autoStartWorkCheck;
     QCheckBox *m_minimizeToTrayCheck;
     QCheckBox *m_showNotificationsCheck;
+    QCheckBox *m_sqliteHistoryCheck;
+    QComboBox *m_ambientNoiseCombo;
+    QCheckBox *m_ambientTickingCheck;
     QDialogButtonBox *m_buttonBox;
 };
 
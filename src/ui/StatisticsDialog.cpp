@@ -4,22 +4,52 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QPushButton>
+#include <QSpinBox>
 #include <QTextEdit>
 #include <QPainter>
-#include <QSettings>
 #include <QDate>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QApplication>
-
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QLocale>
+#include <QMouseEvent>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QThread>
+#include <QToolTip>
+#include <QTreeWidget>
+#include <algorithm>
+#include <cmath>
+
+#include "HistoryExporter.h"
+#include "HistoryImporter.h"
+#include "PomodoroConfig.h"
+#include "SessionHistory.h"
+#include "SessionMetrics.h"
+#include "SessionNotes.h"
+#include "SqliteHistoryStore.h"
 #include "TimerState.h"
 
 // StatisticsChart implementation
+namespace {
+    constexpr int CHART_MARGIN = 40;
+    constexpr int LABEL_SKIP_INTERVAL = 3;
+    constexpr int MIN_LABEL_SPACING = 40;       // px between date labels
+    const QColor BAR_COLOR(70, 130, 180);
+    const QColor HOVER_COLOR(100, 170, 225);
+    const QColor SELECTION_COLOR(230, 150, 60);
+}
+
 StatisticsChart::StatisticsChart(QWidget *parent)
     : QWidget(parent), m_maxValue(0)
 {
     setMinimumSize(400, 200);
     setStyleSheet("background-color: white; border: 1px solid #ccc;");
+    setMouseTracking(true);
 }
 
 void StatisticsChart::setData(const QMap<QDate, int> &workTimeData)
@@ -33,13 +63,172 @@ void StatisticsChart::setData(const QMap<QDate, int> &workTimeData)
         }
     }
 
+    m_hovered = -1;
+    m_selectionAnchor = m_selectionEnd = -1;
+    m_selecting = false;
+    rebuildLayout();
     update();
 }
 
-void StatisticsChart::paintEvent(QPaintEvent *event)
+void StatisticsChart::resizeEvent(QResizeEvent *event)
 {
-    Q_UNUSED(event)
+    QWidget::resizeEvent(event);
+    rebuildLayout();
+}
+
+void StatisticsChart::rebuildLayout()
+{
+    m_bars.clear();
+    m_bars.reserve(m_workTimeData.size());
+
+    // Fractional widths keep a year of days inside the chart at any size
+    const double chartWidth = width() - 2 * CHART_MARGIN;
+    const double barWidth = chartWidth / qMax(1, static_cast<int>(m_workTimeData.size()));
+    double x = CHART_MARGIN;
+    for (auto it = m_workTimeData.cbegin(); it != m_workTimeData.cend(); ++it) {
+        m_bars.append({x, x + barWidth, it.key(), it.value()});
+        x += barWidth;
+    }
+
+    m_labelStep = qMax(LABEL_SKIP_INTERVAL, static_cast<int>(std::ceil(MIN_LABEL_SPACING / qMax(barWidth, 1.0))));
+}
+
+int StatisticsChart::barAt(const QPoint &pos) const
+{
+    if (m_bars.isEmpty() || pos.y() < CHART_MARGIN || pos.y() > height() - CHART_MARGIN) {
+        return -1;
+    }
+    const auto it = std::upper_bound(m_bars.cbegin(), m_bars.cend(), static_cast<double>(pos.x()),
+                                     [](double x, const Bar &bar) { return x < bar.right; });
+    if (it == m_bars.cend() || pos.x() < it->left) {
+        return -1;
+    }
+    return static_cast<int>(it - m_bars.cbegin());
+}
+
+QRect StatisticsChart::columnsRect(int first, int last) const
+{
+    if (first < 0 || last < 0) {
+        return {};
+    }
+    if (first > last) {
+        std::swap(first, last);
+    }
+    const int left = static_cast<int>(std::floor(m_bars.at(first).left));
+    const int right = static_cast<int>(std::ceil(m_bars.at(last).right));
+    return {left, CHART_MARGIN, right - left + 1, height() - 2 * CHART_MARGIN + 1};
+}
+
+bool StatisticsChart::isSelected(int index) const
+{
+    if (m_selectionAnchor < 0) {
+        return false;
+    }
+    return index >= qMin(m_selectionAnchor, m_selectionEnd) && index <= qMax(m_selectionAnchor, m_selectionEnd);
+}
+
+void StatisticsChart::mouseMoveEvent(QMouseEvent *event)
+{
+    const int index = barAt(event->position().toPoint());
+    if (m_selecting && index >= 0) {
+        setSelectionEnd(index);
+        showRangeToolTip(event->globalPosition().toPoint());
+    }
+    setHovered(index, event->globalPosition().toPoint());
+}
+
+void StatisticsChart::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    const QRect previous = columnsRect(m_selectionAnchor, m_selectionEnd);
+    const int index = barAt(event->position().toPoint());
+    m_selectionAnchor = m_selectionEnd = index;
+    m_selecting = index >= 0;
+    update(previous);
+    update(columnsRect(index, index));
+}
+
+void StatisticsChart::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !m_selecting) {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+    m_selecting = false;
+
+    // A plain click inspects one bar; a drag keeps the range highlighted
+    if (m_selectionAnchor == m_selectionEnd) {
+        const QRect previous = columnsRect(m_selectionAnchor, m_selectionEnd);
+        m_selectionAnchor = m_selectionEnd = -1;
+        update(previous);
+        return;
+    }
+    showRangeToolTip(event->globalPosition().toPoint());
+}
+
+void StatisticsChart::leaveEvent(QEvent *event)
+{
+    QWidget::leaveEvent(event);
+    setHovered(-1, QPoint());
+}
+
+void StatisticsChart::setHovered(int index, const QPoint &globalPos)
+{
+    if (index != m_hovered) {
+        update(columnsRect(m_hovered, m_hovered));
+        update(columnsRect(index, index));
+        m_hovered = index;
+    }
+
+    if (m_selecting) return;
+    if (index < 0) {
+        QToolTip::hideText();
+        return;
+    }
+    const Bar &bar = m_bars.at(index);
+    QToolTip::showText(globalPos,
+                       QString("%1\n%2 of focus").arg(QLocale().toString(bar.date, QLocale::ShortFormat),
+                                                      TimerStateHelper::formatDuration(bar.value * 60)),
+                       this, columnsRect(index, index));
+}
+
+void StatisticsChart::setSelectionEnd(int index)
+{
+    if (index == m_selectionEnd) return;
 
+    // Only the columns entering or leaving the range change
+    const int previous = m_selectionEnd;
+    m_selectionEnd = index;
+    update(columnsRect(previous, index));
+}
+
+void StatisticsChart::showRangeToolTip(const QPoint &globalPos)
+{
+    if (m_selectionAnchor < 0) return;
+
+    const int first = qMin(m_selectionAnchor, m_selectionEnd);
+    const int last = qMax(m_selectionAnchor, m_selectionEnd);
+    int total = 0;
+    for (int i = first; i <= last; ++i) {
+        total += m_bars.at(i).value;
+    }
+    const int days = last - first + 1;
+    QToolTip::showText(globalPos,
+                       QString("%1 – %2\n%3 over %4 days (avg %5)")
+                           .arg(QLocale().toString(m_bars.at(first).date, QLocale::ShortFormat),
+                                QLocale().toString(m_bars.at(last).date, QLocale::ShortFormat),
+                                TimerStateHelper::formatDuration(total * 60))
+                           .arg(days)
+                           .arg(TimerStateHelper::formatDuration(total * 60 / days)),
+                       this, columnsRect(first, last));
+}
+
+void StatisticsChart::paintEvent(QPaintEvent *event)
+{
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
@@ -48,54 +237,171 @@ void StatisticsChart::paintEvent(QPaintEvent *event)
         return;
     }
 
-    constexpr int LABEL_SKIP_INTERVAL = 3;
-    constexpr int margin = 40;
-    const int chartWidth = width() - 2 * margin;
-    const int chartHeight = height() - 2 * margin;
+    const int chartHeight = height() - 2 * CHART_MARGIN;
 
     // Draw axes
     painter.setPen(QPen(Qt::black, 2));
-    painter.drawLine(margin, height() - margin, width() - margin, height() - margin); // X-axis
-    painter.drawLine(margin, margin, margin, height() - margin); // Y-axis
+    painter.drawLine(CHART_MARGIN, height() - CHART_MARGIN, width() - CHART_MARGIN, height() - CHART_MARGIN); // X-axis
+    painter.drawLine(CHART_MARGIN, CHART_MARGIN, CHART_MARGIN, height() - CHART_MARGIN); // Y-axis
 
     if (m_maxValue == 0) return;
 
-    // Draw bars
-    const int barWidth = chartWidth / qMax(1, m_workTimeData.size());
-    int x = margin;
-
-    painter.setPen(Qt::NoPen);
-    painter.setBrush(QColor(70, 130, 180));
-
-    auto sortedData = m_workTimeData;
-
-    for (auto it = sortedData.begin(); it != sortedData.end(); ++it) {
-        const int barHeight = (it.value() * chartHeight) / m_maxValue;
-        const int barY = height() - margin - barHeight;
-
-        QRect barRect(x + 2, barY, barWidth - 4, barHeight);
-        painter.drawRect(barRect);
-
-        // Draw date labels (every 3rd day to avoid crowding)
-        if ((x - margin) % (barWidth * LABEL_SKIP_INTERVAL) == 0) {
+    // Only bars inside the dirty region are drawn; a hover repaints one column
+    const QRect dirty = event->rect();
+    auto it = std::upper_bound(m_bars.cbegin(), m_bars.cend(), static_cast<double>(dirty.left()),
+                               [](double x, const Bar &bar) { return x < bar.right; });
+    for (; it != m_bars.cend() && it->left <= dirty.right() + 1; ++it) {
+        const int index = static_cast<int>(it - m_bars.cbegin());
+        const int barHeight = (it->value * chartHeight) / m_maxValue;
+        const int barY = height() - CHART_MARGIN - barHeight;
+        const double inset = qMin(2.0, (it->right - it->left) / 4);
+
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(isSelected(index) ? SELECTION_COLOR : index == m_hovered ? HOVER_COLOR : BAR_COLOR);
+        painter.drawRect(QRectF(it->left + inset, barY, it->right - it->left - 2 * inset, barHeight));
+
+        // Date labels spaced so they do not overlap at any period
+        if (index % m_labelStep == 0) {
             painter.setPen(Qt::black);
-            QString dateStr = it.key().toString("dd/MM");
-            painter.drawText(x, height() - 10, dateStr);
-            painter.setPen(Qt::NoPen);
+            painter.drawText(QPointF(it->left, height() - 10), it->date.toString("dd/MM"));
         }
-
-        x += barWidth;
     }
 
     // Draw Y-axis labels
     painter.setPen(Qt::black);
     for (int i = 0; i <= 5; ++i) {
-        int y = height() - margin - (i * chartHeight / 5);
+        int y = height() - CHART_MARGIN - (i * chartHeight / 5);
         int minutes = (i * m_maxValue) / 5;
         painter.drawText(5, y + 5, QString::number(minutes) + "m");
     }
 }
 
+// ProductivityHeatmap implementation
+namespace {
+    constexpr int HEATMAP_LEFT = 40;        // weekday labels
+    constexpr int HEATMAP_TOP = 20;         // hour labels
+    constexpr int HEATMAP_MARGIN = 8;
+    constexpr int HEATMAP_HOUR_LABEL_STEP = 3;
+}
+
+ProductivityHeatmap::ProductivityHeatmap(QWidget *parent)
+    : QWidget(parent)
+    , m_cells(AnalyticsCube::HOURS * AnalyticsCube::WEEKDAYS)
+{
+    setMinimumSize(400, 200);
+    setMouseTracking(true);
+}
+
+void ProductivityHeatmap::setCells(const QVector<AnalyticsCube::Cell> &cells)
+{
+    m_cells = cells;
+    m_cells.resize(AnalyticsCube::HOURS * AnalyticsCube::WEEKDAYS);
+    m_maxSeconds = 0;
+    for (const AnalyticsCube::Cell &cell : std::as_const(m_cells)) {
+        m_maxSeconds = qMax(m_maxSeconds, cell.seconds);
+    }
+    update();
+}
+
+QRectF ProductivityHeatmap::gridRect() const
+{
+    return QRectF(HEATMAP_LEFT, HEATMAP_TOP,
+                  width() - HEATMAP_LEFT - HEATMAP_MARGIN, height() - HEATMAP_TOP - HEATMAP_MARGIN);
+}
+
+int ProductivityHeatmap::cellAt(const QPoint &pos) const
+{
+    const QRectF grid = gridRect();
+    if (!grid.contains(pos)) {
+        return -1;
+    }
+    const int hour = qBound(0, static_cast<int>((pos.x() - grid.left()) * AnalyticsCube::HOURS / grid.width()),
+                            AnalyticsCube::HOURS - 1);
+    const int day = qBound(0, static_cast<int>((pos.y() - grid.top()) * AnalyticsCube::WEEKDAYS / grid.height()),
+                           AnalyticsCube::WEEKDAYS - 1);
+    return day * AnalyticsCube::HOURS + hour;
+}
+
+QRect ProductivityHeatmap::cellRect(int index) const
+{
+    if (index < 0) {
+        return {};
+    }
+    const QRectF grid = gridRect();
+    const double cellWidth = grid.width() / AnalyticsCube::HOURS;
+    const double cellHeight = grid.height() / AnalyticsCube::WEEKDAYS;
+    return QRectF(grid.left() + (index % AnalyticsCube::HOURS) * cellWidth,
+                  grid.top() + (index / AnalyticsCube::HOURS) * cellHeight,
+                  cellWidth, cellHeight).toAlignedRect().adjusted(-1, -1, 1, 1);
+}
+
+void ProductivityHeatmap::mouseMoveEvent(QMouseEvent *event)
+{
+    const int index = cellAt(event->position().toPoint());
+    if (index != m_hovered) {
+        update(cellRect(m_hovered));
+        update(cellRect(index));
+        m_hovered = index;
+    }
+    if (index < 0) {
+        QToolTip::hideText();
+        return;
+    }
+
+    const AnalyticsCube::Cell &cell = m_cells.at(index);
+    const int hour = index % AnalyticsCube::HOURS;
+    QToolTip::showText(event->globalPosition().toPoint(),
+                       QString("%1 %2:00–%3:00\n%4 in %5 sessions")
+                           .arg(QLocale().dayName(index / AnalyticsCube::HOURS + 1, QLocale::ShortFormat))
+                           .arg(hour, 2, 10, QChar('0'))
+                           .arg(hour + 1, 2, 10, QChar('0'))
+                           .arg(TimerStateHelper::formatDuration(static_cast<int>(cell.seconds)))
+                           .arg(cell.sessions),
+                       this, cellRect(index));
+}
+
+void ProductivityHeatmap::leaveEvent(QEvent *event)
+{
+    QWidget::leaveEvent(event);
+    update(cellRect(m_hovered));
+    m_hovered = -1;
+}
+
+void ProductivityHeatmap::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    const QRectF grid = gridRect();
+    const double cellWidth = grid.width() / AnalyticsCube::HOURS;
+    const double cellHeight = grid.height() / AnalyticsCube::WEEKDAYS;
+
+    painter.setPen(Qt::black);
+    for (int day = 0; day < AnalyticsCube::WEEKDAYS; ++day) {
+        painter.drawText(QRectF(0, grid.top() + day * cellHeight, HEATMAP_LEFT - 4, cellHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, QLocale().dayName(day + 1, QLocale::ShortFormat));
+    }
+    for (int hour = 0; hour < AnalyticsCube::HOURS; hour += HEATMAP_HOUR_LABEL_STEP) {
+        painter.drawText(QRectF(grid.left() + hour * cellWidth, 0, cellWidth * HEATMAP_HOUR_LABEL_STEP, HEATMAP_TOP),
+                         Qt::AlignLeft | Qt::AlignVCenter, QString::number(hour));
+    }
+
+    // Cell shade is the share of the busiest cell
+    for (int index = 0; index < m_cells.size(); ++index) {
+        const double share = m_maxSeconds > 0 ? static_cast<double>(m_cells.at(index).seconds) / m_maxSeconds : 0.0;
+        QColor color(70, 130, 180);
+        color.setAlphaF(0.08 + 0.92 * share);
+
+        const QRectF rect(grid.left() + (index % AnalyticsCube::HOURS) * cellWidth,
+                          grid.top() + (index / AnalyticsCube::HOURS) * cellHeight, cellWidth, cellHeight);
+        painter.fillRect(rect.adjusted(1, 1, -1, -1), color);
+        if (index == m_hovered) {
+            painter.setPen(QPen(QColor(230, 150, 60), 2));
+            painter.drawRect(rect.adjusted(1, 1, -1, -1));
+        }
+    }
+}
+
 // StatisticsDialog implementation
 StatisticsDialog::StatisticsDialog(QWidget *parent)
     : QDialog(parent)
@@ -103,6 +409,7 @@ StatisticsDialog::StatisticsDialog(QWidget *parent)
     , m_totalWorkTime(0)
     , m_totalBreakTime(0)
     , m_chartPeriod("week")
+    , m_viewsStale(false)
 {
     setWindowTitle("📊 Pomodoro Statistics");
     setMinimumSize(600, 500);
@@ -119,14 +426,30 @@ void StatisticsDialog::setupUI()
 
     setupOverviewTab();
     setupChartTab();
+    setupProjectsTab();
+    setupHeatmapTab();
+    setupNotesTab();
     setupDetailsTab();
 
     m_tabWidget->addTab(m_overviewTab, "📈 Overview");
     m_tabWidget->addTab(m_chartTab, "📊 Chart");
+    m_tabWidget->addTab(m_projectsTab, "🏷️ Projects");
+    m_tabWidget->addTab(m_heatmapTab, "🔥 Heatmap");
+    m_tabWidget->addTab(m_notesTab, "📝 Notes");
     m_tabWidget->addTab(m_detailsTab, "📋 Details");
 
-    // No additional buttons - only native window close button
+    m_importButton = new QPushButton("📥 Import...");
+    m_exportButton = new QPushButton("💾 Export...");
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_importButton);
+    buttonLayout->addWidget(m_exportButton);
+
     mainLayout->addWidget(m_tabWidget);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_importButton, &QPushButton::clicked, this, &StatisticsDialog::onImport);
+    connect(m_exportButton, &QPushButton::clicked, this, &StatisticsDialog::onExport);
 
     // Connect chart period buttons
     connect(m_weekButton, &QPushButton::clicked, this, [this]() {
@@ -208,11 +531,40 @@ void StatisticsDialog::setupOverviewTab()
     periodGrid->addWidget(new QLabel("📅 This Month:"), 2, 0);
     periodGrid->addWidget(m_monthLabel, 2, 1);
 
+    // Forecast section, read from the model SessionHistory keeps fitted
+    QLabel *forecastTitle = new QLabel("🔮 Forecast");
+    forecastTitle->setFont(periodFont);
+
+    m_weekForecastLabel = new QLabel();
+    m_monthForecastLabel = new QLabel();
+    m_weeklyGoalSpin = new QSpinBox();
+    m_weeklyGoalSpin->setRange(1, PomodoroConfig::MAX_WEEKLY_GOAL_MINUTES / 60);
+    m_weeklyGoalSpin->setSuffix(" h");
+    m_weeklyGoalSpin->setValue(PomodoroConfig::instance().weeklyGoalMinutes() / 60);
+
+    QGridLayout *forecastGrid = new QGridLayout();
+    forecastGrid->addWidget(new QLabel("🎯 Weekly Goal:"), 0, 0);
+    forecastGrid->addWidget(m_weeklyGoalSpin, 0, 1);
+
+    forecastGrid->addWidget(new QLabel("📈 This Week:"), 1, 0);
+    forecastGrid->addWidget(m_weekForecastLabel, 1, 1);
+
+    forecastGrid->addWidget(new QLabel("📈 This Month:"), 2, 0);
+    forecastGrid->addWidget(m_monthForecastLabel, 2, 1);
+
+    connect(m_weeklyGoalSpin, &QSpinBox::valueChanged, this, [this](int hours) {
+        PomodoroConfig::instance().setWeeklyGoalMinutes(hours * 60);
+        updateForecast();
+    });
+
     layout->addWidget(titleLabel);
     layout->addLayout(statsGrid);
     layout->addSpacing(20);
     layout->addWidget(periodTitle);
     layout->addLayout(periodGrid);
+    layout->addSpacing(20);
+    layout->addWidget(forecastTitle);
+    layout->addLayout(forecastGrid);
     layout->addStretch();
 }
 
@@ -251,6 +603,79 @@ void StatisticsDialog::setupChartTab()
     layout->addWidget(m_chart);
 }
 
+void StatisticsDialog::setupProjectsTab()
+{
+    m_projectsTab = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(m_projectsTab);
+
+    QLabel *projectsTitle = new QLabel("🏷️ Time per Project");
+    QFont projectsFont = projectsTitle->font();
+    projectsFont.setPointSize(14);
+    projectsFont.setBold(true);
+    projectsTitle->setFont(projectsFont);
+
+    m_projectsTree = new QTreeWidget();
+    m_projectsTree->setRootIsDecorated(false);
+    m_projectsTree->setHeaderLabels({"Project", "Today", "Last 7 Days", "This Month", "Total", "Sessions"});
+    m_projectsTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    layout->addWidget(projectsTitle);
+    layout->addWidget(m_projectsTree);
+
+    updateProjects();
+}
+
+void StatisticsDialog::setupHeatmapTab()
+{
+    m_heatmapTab = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(m_heatmapTab);
+
+    QHBoxLayout *headerLayout = new QHBoxLayout();
+    QLabel *heatmapTitle = new QLabel("🔥 When Do You Focus?");
+    QFont heatmapFont = heatmapTitle->font();
+    heatmapFont.setPointSize(14);
+    heatmapFont.setBold(true);
+    heatmapTitle->setFont(heatmapFont);
+
+    m_heatmapTagCombo = new QComboBox();
+    headerLayout->addWidget(heatmapTitle);
+    headerLayout->addStretch();
+    headerLayout->addWidget(m_heatmapTagCombo);
+
+    m_heatmap = new ProductivityHeatmap();
+    m_peakLabel = new QLabel();
+
+    layout->addLayout(headerLayout);
+    layout->addWidget(m_heatmap);
+    layout->addWidget(m_peakLabel);
+
+    connect(m_heatmapTagCombo, QOverload<int>::of(&QComboBox::activated), this, [this]() { updateHeatmap(); });
+    updateHeatmap();
+}
+
+void StatisticsDialog::setupNotesTab()
+{
+    m_notesTab = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(m_notesTab);
+
+    m_noteSearchEdit = new QLineEdit();
+    m_noteSearchEdit->setPlaceholderText("🔍 Search session notes...");
+    m_noteSearchEdit->setClearButtonEnabled(true);
+
+    m_notesTree = new QTreeWidget();
+    m_notesTree->setRootIsDecorated(false);
+    m_notesTree->setHeaderLabels({"Date", "Project", "Duration", "Note"});
+    m_notesTree->header()->setSectionResizeMode(3, QHeaderView::Stretch);
+
+    m_notesStatusLabel = new QLabel();
+
+    layout->addWidget(m_noteSearchEdit);
+    layout->addWidget(m_notesTree);
+    layout->addWidget(m_notesStatusLabel);
+
+    connect(m_noteSearchEdit, &QLineEdit::textChanged, this, &StatisticsDialog::updateNoteResults);
+}
+
 void StatisticsDialog::setupDetailsTab()
 {
     m_detailsTab = new QWidget();
@@ -275,11 +700,69 @@ void StatisticsDialog::setStatistics(int totalSessions, int totalWorkTime, int t
     m_totalSessions = totalSessions;
     m_totalWorkTime = totalWorkTime;
     m_totalBreakTime = totalBreakTime;
+    refreshViews();
+}
+
+void StatisticsDialog::addSession(const SessionRecord &record)
+{
+    if (record.type == TimerState::Work) {
+        ++m_totalSessions;
+        m_totalWorkTime += static_cast<int>(record.duration);
+    } else {
+        m_totalBreakTime += static_cast<int>(record.duration);
+    }
+
+    // Only the session's day changes; take it from the rollup index instead of reloading
+    const QDate date = QDateTime::fromSecsSinceEpoch(record.startTime).date();
+    const DailyRollup rollup = SessionHistory::instance().dailyRollups().value(date);
+    m_dailyWorkTime[date] = rollup.workSeconds / 60;
+    m_dailySessions[date] = rollup.sessions;
+
+    refreshViews();
+}
+
+void StatisticsDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    if (m_viewsStale) {
+        refreshViews();
+    }
+}
+
+void StatisticsDialog::refreshViews()
+{
+    // Hidden between uses: catch up once when shown again
+    if (!isVisible()) {
+        m_viewsStale = true;
+        return;
+    }
+    m_viewsStale = false;
 
     updateOverview();
+    updateForecast();
     updateChart();
+    updateProjects();
+    updateHeatmap();
+    updateDetails();
+}
+
+void StatisticsDialog::updateDetails() const
+{
+    const SessionMetrics &metrics = SessionMetrics::instance();
+    const QDate today = QDate::currentDate();
+    const SessionMetrics::Average week = metrics.rollingAverage(7, today);
+    const SessionMetrics::Average month = metrics.rollingAverage(30, today);
+    const SessionMetrics::Average quarter = metrics.rollingAverage(90, today);
+
+    // Calendar weeks start on Monday
+    const QDate weekStart = today.addDays(1 - today.dayOfWeek());
+    int thisWeek = 0;
+    int lastWeek = 0;
+    for (int day = 0; day < 7; ++day) {
+        thisWeek += m_dailyWorkTime.value(weekStart.addDays(day), 0);
+        lastWeek += m_dailyWorkTime.value(weekStart.addDays(day - 7), 0);
+    }
 
-    // Update details tab
     QString details = QString(
         "DETAILED POMODORO STATISTICS\n"
         "=============================\n\n"
@@ -291,52 +774,176 @@ void StatisticsDialog::setStatistics(int totalSessions, int totalWorkTime, int t
         "Productivity Metrics:\n"
         "- Average Session Length: %8 minutes\n"
         "- Work/Break Ratio: %9\n"
-        "- Sessions per Day (avg): %10\n\n"
+        "- Current Streak: %10 days (best %11)\n"
+        "- Sessions per Day (7/30/90-day avg): %12 / %13 / %14\n"
+        "- Focus per Day (7/30/90-day avg): %15 / %16 / %17 minutes\n"
+        "- Completion Rate: %18% (%19 finished, %20 skipped)\n"
+        "- Interruptions per Session (avg): %21\n\n"
         "Recent Activity:\n"
-        "- Today: %11 minutes\n"
-        "- Yesterday: %12 minutes\n"
-        "- This Week: %13 minutes\n"
-        "- Last Week: %14 minutes\n"
+        "- Today: %22 minutes\n"
+        "- Yesterday: %23 minutes\n"
+        "- This Week: %24 minutes\n"
+        "- Last Week: %25 minutes\n"
     ).arg(m_totalSessions)
      .arg(m_totalWorkTime / 3600).arg((m_totalWorkTime % 3600) / 60)
      .arg(m_totalWorkTime / 3600).arg((m_totalWorkTime % 3600) / 60)
      .arg(m_totalBreakTime / 3600).arg((m_totalBreakTime % 3600) / 60)
      .arg(m_totalSessions > 0 ? m_totalWorkTime / (m_totalSessions * 60) : 0)
      .arg(m_totalBreakTime > 0 ? QString::number(static_cast<double>(m_totalWorkTime) / m_totalBreakTime, 'f', 2) : "N/A")
-     .arg(m_totalSessions > 0 ? QString::number(static_cast<double>(m_totalSessions) / 7, 'f', 1) : "0")
-     .arg(m_dailyWorkTime.value(QDate::currentDate(), 0))
-     .arg(m_dailyWorkTime.value(QDate::currentDate().addDays(-1), 0))
-     .arg(m_dailyWorkTime.value(QDate::currentDate(), 0)) // This week calculation can be improved
-     .arg(0); // Last week calculation can be improved
+     .arg(metrics.currentStreak(today)).arg(metrics.bestStreak())
+     .arg(week.sessions, 0, 'f', 1).arg(month.sessions, 0, 'f', 1).arg(quarter.sessions, 0, 'f', 1)
+     .arg(week.workMinutes, 0, 'f', 0).arg(month.workMinutes, 0, 'f', 0).arg(quarter.workMinutes, 0, 'f', 0)
+     .arg(metrics.completionRate() * 100, 0, 'f', 0)
+     .arg(metrics.finishedSessions()).arg(metrics.skippedSessions())
+     .arg(metrics.averageInterruptions(), 0, 'f', 1)
+     .arg(m_dailyWorkTime.value(today, 0))
+     .arg(m_dailyWorkTime.value(today.addDays(-1), 0))
+     .arg(thisWeek)
+     .arg(lastWeek);
 
     m_detailsText->setPlainText(details);
 }
 
-void StatisticsDialog::loadDailyStatistics()
+void StatisticsDialog::onExport()
 {
-    QSettings settings;
+    const QString sessionsCsv = "Sessions (CSV) (*.csv)";
+    const QString sessionsJson = "Sessions (NDJSON) (*.ndjson)";
+    const QString dailyCsv = "Daily totals (CSV) (*.csv)";
+    const QString dailyJson = "Daily totals (NDJSON) (*.ndjson)";
+
+    QString selectedFilter = sessionsCsv;
+    const QString path = QFileDialog::getSaveFileName(
+        this, "Export History", "pomodoro-history.csv",
+        QStringList({sessionsCsv, sessionsJson, dailyCsv, dailyJson}).join(";;"), &selectedFilter);
+    if (path.isEmpty()) return;
+
+    const auto format = (selectedFilter == sessionsJson || selectedFilter == dailyJson)
+        ? HistoryExporter::Format::NdJson : HistoryExporter::Format::Csv;
+    const auto dataset = (selectedFilter == dailyCsv || selectedFilter == dailyJson)
+        ? HistoryExporter::Dataset::DailyRollups : HistoryExporter::Dataset::Sessions;
+
+    // The exporter streams on its own thread; the dialog only follows its progress
+    auto *exporter = new HistoryExporter(path, format, dataset);
+    auto *thread = new QThread();
+    exporter->moveToThread(thread);
+
+    QPointer<QProgressDialog> progress = new QProgressDialog("Exporting history...", "Cancel", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    m_exportButton->setEnabled(false);
+
+    connect(thread, &QThread::started, exporter, &HistoryExporter::run);
+    connect(exporter, &HistoryExporter::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, exporter, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    connect(progress, &QProgressDialog::canceled, exporter, [exporter]() { exporter->cancel(); }, Qt::DirectConnection);
+    connect(exporter, &HistoryExporter::progress, progress, [progress](qint64 done, qint64 total) {
+        if (progress) progress->setValue(total > 0 ? static_cast<int>(done * 100 / total) : 100);
+    });
+    connect(exporter, &HistoryExporter::finished, this, [this, progress](bool success, const QString &error) {
+        if (progress) progress->close();
+        m_exportButton->setEnabled(true);
+        if (!success) {
+            QMessageBox::warning(this, "Export History", QString("Export failed: %1").arg(error));
+        }
+    });
 
-    // Load daily work time data for the last 30 days
-    QDate today = QDate::currentDate();
-    for (int i = 0; i < 30; ++i) {
-        QDate date = today.addDays(-i);
-        QSettings settings1;
-        auto dailyStats = settings1.value("dailyStats").toMap();
-
-        for (auto it = dailyStats.begin(); it != dailyStats.end(); ++it) {
-            QDate date1 = QDate::fromString(it.key(), "yyyy-MM-dd");
-            if (date1.isValid()) {
-                QVariantMap dayData = it.value().toMap();
-                m_dailyWorkTime[date1] = dayData["workTime"].toInt();
-                m_dailySessions[date1] = dayData["sessions"].toInt();
-            }
+    thread->start();
+}
+
+void StatisticsDialog::onImport()
+{
+    const QString path = QFileDialog::getOpenFileName(
+        this, "Import History", QString(),
+        "Session logs (*.csv *.ndjson *.jsonl *.json);;All files (*)");
+    if (path.isEmpty()) return;
+
+    // Parsing, writing and indexing run on a worker; the GUI thread only
+    // interns the tags and merges the finished batch into the history
+    auto *importer = new HistoryImporter(path);
+    auto *thread = new QThread();
+    importer->moveToThread(thread);
+
+    QPointer<QProgressDialog> progress = new QProgressDialog("Importing history...", "Cancel", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    m_importButton->setEnabled(false);
+
+    connect(thread, &QThread::started, importer, &HistoryImporter::run);
+    connect(thread, &QThread::finished, importer, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    connect(progress, &QProgressDialog::canceled, importer, [importer]() { importer->cancel(); }, Qt::DirectConnection);
+    connect(importer, &HistoryImporter::progress, progress, [progress](qint64 done, qint64 total) {
+        if (progress) progress->setValue(total > 0 ? static_cast<int>(done * 100 / total) : 100);
+    });
+
+    const auto fail = [this, progress, thread](const QString &error) {
+        thread->quit();
+        if (progress) progress->close();
+        m_importButton->setEnabled(true);
+        QMessageBox::warning(this, "Import History", QString("Import failed: %1").arg(error));
+    };
+
+    // The worker stays idle between these steps, so the importer is only ever
+    // touched by one thread at a time; it is released once the batch is merged
+    connect(importer, &HistoryImporter::finished, this, [importer, fail](bool success, const QString &error) {
+        if (!success) {
+            fail(error);
+            return;
+        }
+        importer->resolveTags();
+        QMetaObject::invokeMethod(importer, [importer]() { importer->write(); }, Qt::QueuedConnection);
+    });
+    connect(importer, &HistoryImporter::written, this, [this, progress, thread, importer, fail](bool success, const QString &error) {
+        if (!success) {
+            fail(error);
+            return;
         }
+        const HistoryImporter::Summary summary = importer->commit();
+        thread->quit();
+        if (progress) progress->close();
+        m_importButton->setEnabled(true);
+
+        // Imported sessions land anywhere in the past; the incremental metrics cannot place them
+        SessionMetrics::instance().rebuild(SessionHistory::instance());
+        loadDailyStatistics();
+        refreshViews();
+        emit historyImported();
+        QMessageBox::information(this, "Import History",
+                                 QString("Imported %1 sessions.\n%2 duplicates and %3 invalid rows were skipped.")
+                                     .arg(summary.imported).arg(summary.duplicates).arg(summary.invalid));
+    });
 
-        QString sessionKey = QString("dailyStats/sessions_%1").arg(date.toString("yyyy-MM-dd"));
-        int sessions = settings1.value(sessionKey, 0).toInt();
-        if (sessions > 0) {
-            m_dailySessions[date] = sessions;
+    thread->start();
+}
+
+void StatisticsDialog::loadDailyStatistics()
+{
+    // A year covers the longest chart period; both sources answer with a range scan
+    const QDate today = QDate::currentDate();
+    const QDate from = today.addDays(-364);
+
+    const auto addDay = [this](const QDate& date, const DailyRollup& rollup) {
+        m_dailyWorkTime[date] = rollup.workSeconds / 60;
+        m_dailySessions[date] = rollup.sessions;
+    };
+
+    const SqliteHistoryStore& store = SqliteHistoryStore::instance();
+    if (store.isReady()) {
+        const QMap<QDate, DailyRollup> rollups = store.dailyRollups(from, today);
+        for (auto it = rollups.cbegin(); it != rollups.cend(); ++it) {
+            addDay(it.key(), it.value());
         }
+        return;
+    }
+
+    const QMap<QDate, DailyRollup>& rollups = SessionHistory::instance().dailyRollups();
+    for (auto it = rollups.lowerBound(from); it != rollups.cend() && it.key() <= today; ++it) {
+        addDay(it.key(), it.value());
     }
 }
 
@@ -376,6 +983,47 @@ void StatisticsDialog::updateOverview() const {
     m_monthLabel->setText(TimerStateHelper::formatDuration(monthTotal * 60));
 }
 
+void StatisticsDialog::refreshForecast()
+{
+    if (isVisible()) {
+        updateForecast();
+    } else {
+        m_viewsStale = true;
+    }
+}
+
+void StatisticsDialog::updateForecast() const
+{
+    const FocusForecast &forecast = SessionHistory::instance().forecast();
+    const QDate today = QDate::currentDate();
+    if (!forecast.isValid() || forecast.asOf() != today) {
+        // Fitted in the background once a full day of history exists
+        const QString pending = forecast.isValid() ? "Updating…" : "Not enough history yet";
+        m_weekForecastLabel->setText(pending);
+        m_monthForecastLabel->setText(pending);
+        return;
+    }
+
+    const double todayMinutes = m_dailyWorkTime.value(today, 0);
+    const double weeklyGoal = PomodoroConfig::instance().weeklyGoalMinutes();
+
+    const auto show = [&](QLabel *label, const FocusForecast::Outlook &outlook, const QDate &start, double goal) {
+        double soFar = 0;
+        for (QDate day = start; day <= today; day = day.addDays(1)) {
+            soFar += m_dailyWorkTime.value(day, 0);
+        }
+        const FocusForecast::Estimate estimate = forecast.estimate(outlook, soFar, todayMinutes, goal);
+        label->setText(QString("≈ %1 of %2 goal (%3% likely)")
+                           .arg(TimerStateHelper::formatDuration(static_cast<int>(estimate.expectedMinutes * 60)),
+                                TimerStateHelper::formatDuration(static_cast<int>(goal * 60)))
+                           .arg(qRound(estimate.goalProbability * 100)));
+    };
+
+    show(m_weekForecastLabel, forecast.week(), today.addDays(1 - today.dayOfWeek()), weeklyGoal);
+    show(m_monthForecastLabel, forecast.month(), QDate(today.year(), today.month(), 1),
+         weeklyGoal * today.daysInMonth() / 7);
+}
+
 void StatisticsDialog::updateChart() const {
     QMap<QDate, int> chartData;
     QDate today = QDate::currentDate();
@@ -396,3 +1044,121 @@ void StatisticsDialog::updateChart() const {
     m_monthButton->setChecked(m_chartPeriod == "month");
     m_yearButton->setChecked(m_chartPeriod == "year");
 }
+
+void StatisticsDialog::updateProjects() const {
+    const SessionHistory& history = SessionHistory::instance();
+    const QDate today = QDate::currentDate();
+    const QDateTime todayStart = today.startOfDay();
+    const QDateTime weekStart = today.addDays(-6).startOfDay();
+    const QDateTime monthStart = QDate(today.year(), today.month(), 1).startOfDay();
+    const QDateTime end = today.addDays(1).startOfDay();
+
+    m_projectsTree->clear();
+
+    struct ProjectRow {
+        QString name;
+        qint64 today, week, month, total;
+        int sessions;
+    };
+    QVector<ProjectRow> rows;
+
+    // Each cell is a range lookup in the per-tag index, independent of history size
+    const QStringList& tags = history.tagNames();
+    for (int i = 0; i < tags.size(); ++i) {
+        const auto tagId = static_cast<quint16>(i + 1);
+        const int sessions = history.tagSessionCount(tagId, QDateTime(), QDateTime());
+        if (sessions == 0) continue;
+
+        rows.append({tags.at(i),
+                     history.tagWorkSeconds(tagId, todayStart, end),
+                     history.tagWorkSeconds(tagId, weekStart, end),
+                     history.tagWorkSeconds(tagId, monthStart, end),
+                     history.tagWorkSeconds(tagId, QDateTime(), QDateTime()),
+                     sessions});
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const ProjectRow& a, const ProjectRow& b) {
+        return a.total > b.total;
+    });
+
+    for (const ProjectRow& row : rows) {
+        auto *item = new QTreeWidgetItem(m_projectsTree);
+        item->setText(0, row.name);
+        item->setText(1, TimerStateHelper::formatDuration(static_cast<int>(row.today)));
+        item->setText(2, TimerStateHelper::formatDuration(static_cast<int>(row.week)));
+        item->setText(3, TimerStateHelper::formatDuration(static_cast<int>(row.month)));
+        item->setText(4, TimerStateHelper::formatDuration(static_cast<int>(row.total)));
+        item->setText(5, QString::number(row.sessions));
+    }
+}
+
+void StatisticsDialog::updateHeatmap() const
+{
+    const SessionHistory& history = SessionHistory::instance();
+
+    // Keep the selection while the tag list grows
+    const int selectedTag = m_heatmapTagCombo->count() > 0
+        ? m_heatmapTagCombo->currentData().toInt() : AnalyticsCube::ALL_TAGS;
+    const QStringList& tags = history.tagNames();
+    if (m_heatmapTagCombo->count() != tags.size() + 1) {
+        const QSignalBlocker blocker(m_heatmapTagCombo);
+        m_heatmapTagCombo->clear();
+        m_heatmapTagCombo->addItem("All projects", AnalyticsCube::ALL_TAGS);
+        for (int i = 0; i < tags.size(); ++i) {
+            m_heatmapTagCombo->addItem(tags.at(i), i + 1);
+        }
+        m_heatmapTagCombo->setCurrentIndex(qMax(0, m_heatmapTagCombo->findData(selectedTag)));
+    }
+
+    // Read out of the cube: 168 cells whatever the history length
+    const QVector<AnalyticsCube::Cell> cells =
+        history.analytics().heatmap(TimerState::Work, m_heatmapTagCombo->currentData().toInt());
+    m_heatmap->setCells(cells);
+
+    const auto peak = std::max_element(cells.cbegin(), cells.cend(),
+        [](const AnalyticsCube::Cell& a, const AnalyticsCube::Cell& b) { return a.seconds < b.seconds; });
+    if (peak == cells.cend() || peak->seconds == 0) {
+        m_peakLabel->setText("No focus sessions recorded yet.");
+        return;
+    }
+    const int index = static_cast<int>(peak - cells.cbegin());
+    const int hour = index % AnalyticsCube::HOURS;
+    m_peakLabel->setText(QString("Most productive: %1 %2:00–%3:00 (%4 in %5 sessions)")
+                             .arg(QLocale().dayName(index / AnalyticsCube::HOURS + 1))
+                             .arg(hour, 2, 10, QChar('0'))
+                             .arg(hour + 1, 2, 10, QChar('0'))
+                             .arg(TimerStateHelper::formatDuration(static_cast<int>(peak->seconds)))
+                             .arg(peak->sessions));
+}
+
+void StatisticsDialog::updateNoteResults(const QString &query) const {
+    m_notesTree->clear();
+    if (query.trimmed().isEmpty()) {
+        m_notesStatusLabel->clear();
+        return;
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    const SessionHistory& history = SessionHistory::instance();
+    const SessionNotes& notes = SessionNotes::instance();
+    bool truncated = false;
+    const QVector<quint32> sessionIds = notes.search(query, SessionNotes::DEFAULT_SEARCH_LIMIT, &truncated);
+
+    for (const quint32 sessionId : sessionIds) {
+        const std::optional<SessionRecord> record = history.record(sessionId);
+        if (!record) continue;
+
+        auto *item = new QTreeWidgetItem(m_notesTree);
+        item->setText(0, QDateTime::fromSecsSinceEpoch(record->startTime).toString("yyyy-MM-dd hh:mm"));
+        item->setText(1, history.tagName(record->tagId));
+        item->setText(2, TimerStateHelper::formatDuration(static_cast<int>(record->duration)));
+        item->setText(3, notes.note(sessionId));
+    }
+
+    m_notesStatusLabel->setText(QString("%1 sessions found in %2 ms%3")
+                                .arg(sessionIds.size())
+                                .arg(elapsed.elapsed())
+                                .arg(truncated ? QStringLiteral(" (more match; refine the search)") : QString()));
+}
@@ -4,6 +4,7 @@
 #include <QDialog>
 #include <QMap>
 #include <QDate>
+#include "SessionHistory.h"
 
 class QLabel;
 class QVBoxLayout;
@@ -12,7 +13,17 @@ class QPushButton;
 class QTabWidget;
 class QTextEdit;
 class QScrollArea;
+class QTreeWidget;
+class QLineEdit;
+class QComboBox;
+class QSpinBox;
 
+// Daily work-time bars. Hovering a bar shows its value, dragging across bars
+// selects a range and shows its total.
+//
+// Bar positions are laid out once per data or size change into an x-ordered
+// interval list, so hit testing a mouse position is a binary search and a
+// hover change repaints only the columns of the bars involved.
 class StatisticsChart : public QWidget
 {
     Q_OBJECT
@@ -23,10 +34,65 @@ public:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
 
 private:
+    struct Bar {
+        double left;            // x interval covered by the bar's column
+        double right;
+        QDate date;
+        int value;              // minutes
+    };
+
+    void rebuildLayout();
+    // Index of the bar whose column contains x, or -1
+    [[nodiscard]] int barAt(const QPoint &pos) const;
+    // Columns of bars first..last, for partial repaints
+    [[nodiscard]] QRect columnsRect(int first, int last) const;
+    [[nodiscard]] bool isSelected(int index) const;
+    void setHovered(int index, const QPoint &globalPos);
+    void setSelectionEnd(int index);
+    void showRangeToolTip(const QPoint &globalPos);
+
     QMap<QDate, int> m_workTimeData;
     int m_maxValue;
+
+    QVector<Bar> m_bars;                // ordered by x
+    int m_labelStep{1};
+    int m_hovered{-1};
+    int m_selectionAnchor{-1};          // -1 when nothing is selected
+    int m_selectionEnd{-1};
+    bool m_selecting{false};
+};
+
+// Weekday x hour-of-day grid of focus time from the analytics cube. The grid is
+// uniform, so hit testing is arithmetic and a hover repaints two cells.
+class ProductivityHeatmap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProductivityHeatmap(QWidget *parent = nullptr);
+    // AnalyticsCube::HOURS * WEEKDAYS cells, Monday first
+    void setCells(const QVector<AnalyticsCube::Cell> &cells);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
+private:
+    [[nodiscard]] QRectF gridRect() const;
+    [[nodiscard]] int cellAt(const QPoint &pos) const;
+    [[nodiscard]] QRect cellRect(int index) const;
+
+    QVector<AnalyticsCube::Cell> m_cells;
+    qint64 m_maxSeconds{0};
+    int m_hovered{-1};
 };
 
 class StatisticsDialog : public QDialog
@@ -37,14 +103,40 @@ public:
     explicit StatisticsDialog(QWidget *parent = nullptr);
     void setStatistics(int totalSessions, int totalWorkTime, int totalBreakTime);
 
+public slots:
+    // Folds one newly recorded session into the totals and its day
+    void addSession(const SessionRecord &record);
+    // Picks up a newly fitted forecast from SessionHistory
+    void refreshForecast();
+
+signals:
+    // Sessions were imported into the history
+    void historyImported();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void onExport();
+    void onImport();
+
 private:
     void setupUI();
     void setupOverviewTab();
     void setupChartTab();
     void setupDetailsTab();
+    void setupProjectsTab();
+    void setupNotesTab();
+    void setupHeatmapTab();
     void loadDailyStatistics();
+    void refreshViews();
     void updateOverview() const;
     void updateChart() const;
+    void updateProjects() const;
+    void updateHeatmap() const;
+    void updateNoteResults(const QString &query) const;
+    void updateDetails() const;
+    void updateForecast() const;
 
     // UI elements
     QTabWidget *m_tabWidget;
@@ -60,6 +152,9 @@ private:
     QLabel *m_todayLabel;
     QLabel *m_weekLabel;
     QLabel *m_monthLabel;
+    QLabel *m_weekForecastLabel;
+    QLabel *m_monthForecastLabel;
+    QSpinBox *m_weeklyGoalSpin;
 
     // Chart tab
     QWidget *m_chartTab;
@@ -69,10 +164,29 @@ private:
     QPushButton *m_monthButton;
     QPushButton *m_yearButton;
 
+    // Projects tab
+    QWidget *m_projectsTab;
+    QTreeWidget *m_projectsTree;
+
+    // Heatmap tab
+    QWidget *m_heatmapTab;
+    QComboBox *m_heatmapTagCombo;
+    ProductivityHeatmap *m_heatmap;
+    QLabel *m_peakLabel;
+
+    // Notes tab
+    QWidget *m_notesTab;
+    QLineEdit *m_noteSearchEdit;
+    QTreeWidget *m_notesTree;
+    QLabel *m_notesStatusLabel;
+
     // Details tab
     QWidget *m_detailsTab;
     QTextEdit *m_detailsText;
 
+    QPushButton *m_importButton;
+    QPushButton *m_exportButton;
+
     // Data
     int m_totalSessions;
     int m_totalWorkTime;
@@ -80,6 +194,7 @@ private:
     QMap<QDate, int> m_dailyWorkTime;
     QMap<QDate, int> m_dailySessions;
     QString m_chartPeriod;
+    bool m_viewsStale;                      // data changed while hidden
 };
 
 #endif // STATISTICSDIALOG_H
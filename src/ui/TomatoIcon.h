@@ -0,0 +1,9 @@
+#ifndef TOMATOICON_H
+#define TOMATOICON_H
+
+#include <QIcon>
+
+// The application and tray icon, painted at the requested pixel size
+QIcon createTomatoIcon(int size = 32);
+
+#endif // TOMATOICON_H
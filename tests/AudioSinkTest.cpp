@@ -0,0 +1,306 @@
+#include "AmbientNoiseGenerator.h"
+#include "AudioSink.h"
+#include "SoundCueEngine.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+// Renders sources into a WavFileSink with advance() and checks the samples,
+// so nothing depends on an audio device or on real time
+class AudioSinkTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void wavHeaderMatchesData();
+    void cueIsScaledByItsVolume();
+    void overlappingCuesAreMixed();
+    void mixIsClipped();
+
+    void ambientNoiseIsDeterministic();
+    void ambientNoiseFadesOut();
+    void ticksLandOnWholeSeconds();
+
+private:
+    // 16-bit stereo at the mix rate: frames of a constant left and right value
+    QString writeCue(const QString &name, qint16 left, qint16 right, int frames) const;
+    void preload(const QString &workEnd, const QString &breakEnd);
+    // Samples of a file written by WavFileSink, after checking its header
+    static QVector<qint16> readWav(const QString &path);
+    QString outputPath() const { return m_directory->filePath(QStringLiteral("out.wav")); }
+    // Renders frames of a generator configured by setup into a file of its own
+    QVector<qint16> renderAmbient(const QString &name, int frames,
+                                  const std::function<void(AmbientNoiseGenerator&)> &setup) const;
+
+    std::unique_ptr<QTemporaryDir> m_directory;
+    std::unique_ptr<SoundCueEngine> m_engine;
+};
+
+void AudioSinkTest::init()
+{
+    m_directory = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_directory->isValid());
+    m_engine = std::make_unique<SoundCueEngine>();
+}
+
+void AudioSinkTest::cleanup()
+{
+    m_engine.reset();
+    m_directory.reset();
+}
+
+QString AudioSinkTest::writeCue(const QString &name, qint16 left, qint16 right, int frames) const
+{
+    const QString path = m_directory->filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+
+    const quint32 dataBytes = static_cast<quint32>(frames) * AudioSource::CHANNELS * sizeof(qint16);
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("RIFF", 4);
+    stream << quint32(36 + dataBytes);
+    stream.writeRawData("WAVEfmt ", 8);
+    stream << quint32(16) << quint16(1) << quint16(AudioSource::CHANNELS) << quint32(AudioSource::SAMPLE_RATE)
+           << quint32(AudioSource::SAMPLE_RATE * 4) << quint16(4) << quint16(16);
+    stream.writeRawData("data", 4);
+    stream << dataBytes;
+    for (int i = 0; i < frames; ++i) {
+        stream << left << right;
+    }
+    return path;
+}
+
+void AudioSinkTest::preload(const QString &workEnd, const QString &breakEnd)
+{
+    QSignalSpy preloaded(m_engine.get(), &SoundCueEngine::preloaded);
+    m_engine->preload(workEnd, breakEnd);
+    QVERIFY(preloaded.wait(5000));
+}
+
+QVector<qint16> AudioSinkTest::readWav(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    const QByteArray bytes = file.readAll();
+    if (bytes.size() < 44 || !bytes.startsWith("RIFF") || bytes.mid(8, 8) != "WAVEfmt ") {
+        return {};
+    }
+
+    QDataStream stream(bytes);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    quint32 riffSize = 0;
+    quint32 dataSize = 0;
+    stream.skipRawData(4);
+    stream >> riffSize;
+    stream.skipRawData(32);
+    stream >> dataSize;
+    if (riffSize != static_cast<quint32>(bytes.size() - 8) || dataSize != static_cast<quint32>(bytes.size() - 44)) {
+        return {};
+    }
+
+    QVector<qint16> samples(static_cast<int>(dataSize / sizeof(qint16)));
+    for (qint16 &sample : samples) {
+        stream >> sample;
+    }
+    return samples;
+}
+
+void AudioSinkTest::wavHeaderMatchesData()
+{
+    {
+        WavFileSink sink(outputPath());
+        QVERIFY(sink.start());
+        sink.advance(1000);
+        sink.stop();
+    }
+
+    // Stopping may add the few frames of real time since start(); all silent
+    const QVector<qint16> samples = readWav(outputPath());
+    QVERIFY(samples.size() >= 1000 * AudioSource::CHANNELS);
+    QVERIFY(std::all_of(samples.cbegin(), samples.cend(), [](qint16 sample) { return sample == 0; }));
+}
+
+void AudioSinkTest::cueIsScaledByItsVolume()
+{
+    constexpr int CUE_FRAMES = 480;
+    preload(writeCue(QStringLiteral("work.wav"), 8192, -8192, CUE_FRAMES), QString());
+    QVERIFY(m_engine->isLoaded(SoundCueEngine::Cue::WorkEnd));
+    QVERIFY(!m_engine->isLoaded(SoundCueEngine::Cue::BreakEnd));
+
+    m_engine->setVolume(SoundCueEngine::Cue::WorkEnd, 0.5f);
+    {
+        WavFileSink sink(outputPath());
+        sink.addSource(m_engine.get());
+        QVERIFY(sink.start());
+        m_engine->play(SoundCueEngine::Cue::WorkEnd);
+        sink.advance(CUE_FRAMES * 2);
+        sink.stop();
+    }
+    QVERIFY(m_engine->isIdle());
+
+    const QVector<qint16> samples = readWav(outputPath());
+    QVERIFY(samples.size() >= CUE_FRAMES * 2 * AudioSource::CHANNELS);
+    for (int frame = 0; frame < CUE_FRAMES * 2; ++frame) {
+        const bool playing = frame < CUE_FRAMES;
+        QCOMPARE(samples.at(frame * 2), playing ? AudioSink::toInt16(0.125f) : qint16(0));
+        QCOMPARE(samples.at(frame * 2 + 1), playing ? AudioSink::toInt16(-0.125f) : qint16(0));
+    }
+}
+
+void AudioSinkTest::overlappingCuesAreMixed()
+{
+    preload(writeCue(QStringLiteral("work.wav"), 8192, 8192, 480),
+            writeCue(QStringLiteral("break.wav"), 4096, -4096, 960));
+    m_engine->setVolume(SoundCueEngine::Cue::BreakEnd, 0.5f);
+
+    {
+        WavFileSink sink(outputPath());
+        sink.addSource(m_engine.get());
+        QVERIFY(sink.start());
+        m_engine->play(SoundCueEngine::Cue::WorkEnd);
+        m_engine->play(SoundCueEngine::Cue::BreakEnd);
+        sink.advance(1200);
+        sink.stop();
+    }
+
+    // Both cues for the first 480 frames, the longer one alone after that
+    const QVector<qint16> samples = readWav(outputPath());
+    QVERIFY(samples.size() >= 1200 * AudioSource::CHANNELS);
+    QCOMPARE(samples.at(0), AudioSink::toInt16(0.25f + 0.0625f));
+    QCOMPARE(samples.at(1), AudioSink::toInt16(0.25f - 0.0625f));
+    QCOMPARE(samples.at(479 * 2), AudioSink::toInt16(0.3125f));
+    QCOMPARE(samples.at(480 * 2), AudioSink::toInt16(0.0625f));
+    QCOMPARE(samples.at(480 * 2 + 1), AudioSink::toInt16(-0.0625f));
+    QCOMPARE(samples.at(959 * 2), AudioSink::toInt16(0.0625f));
+    QCOMPARE(samples.at(960 * 2), qint16(0));
+}
+
+void AudioSinkTest::mixIsClipped()
+{
+    preload(writeCue(QStringLiteral("loud.wav"), 24576, -24576, 100), QString());
+
+    {
+        WavFileSink sink(outputPath());
+        sink.addSource(m_engine.get());
+        QVERIFY(sink.start());
+        m_engine->play(SoundCueEngine::Cue::WorkEnd);
+        m_engine->play(SoundCueEngine::Cue::WorkEnd);
+        sink.advance(100);
+        sink.stop();
+    }
+
+    const QVector<qint16> samples = readWav(outputPath());
+    QVERIFY(samples.size() >= 100 * AudioSource::CHANNELS);
+    QCOMPARE(samples.at(0), qint16(32767));
+    QCOMPARE(samples.at(1), qint16(-32767));
+}
+
+QVector<qint16> AudioSinkTest::renderAmbient(const QString &name, int frames,
+                                             const std::function<void(AmbientNoiseGenerator&)> &setup) const
+{
+    const QString path = m_directory->filePath(name);
+    AmbientNoiseGenerator generator;
+    setup(generator);
+    {
+        WavFileSink sink(path);
+        sink.addSource(&generator);
+        if (!sink.start()) {
+            return {};
+        }
+        sink.advance(frames);
+        sink.removeSource(&generator);
+        sink.stop();
+    }
+    return readWav(path).mid(0, frames * AudioSource::CHANNELS);
+}
+
+void AudioSinkTest::ambientNoiseIsDeterministic()
+{
+    const auto pink = [](AmbientNoiseGenerator &generator) {
+        generator.setNoise(AmbientNoiseGenerator::Noise::Pink);
+        generator.setLevel(0.5f);
+        generator.setActive(true);
+    };
+    // Not a multiple of the block size, so the last block is a partial one
+    constexpr int FRAMES = AudioSource::SAMPLE_RATE + 100;
+    const QVector<qint16> first = renderAmbient(QStringLiteral("pink-1.wav"), FRAMES, pink);
+    const QVector<qint16> second = renderAmbient(QStringLiteral("pink-2.wav"), FRAMES, pink);
+
+    QCOMPARE(first.size(), FRAMES * AudioSource::CHANNELS);
+    QCOMPARE(first, second);
+    QVERIFY(std::any_of(first.cbegin(), first.cend(), [](qint16 sample) { return sample != 0; }));
+    // Noise is mono in both channels
+    for (int i = 0; i < first.size(); i += 2) {
+        QCOMPARE(first.at(i), first.at(i + 1));
+    }
+    // It fades in rather than starting at full level
+    QCOMPARE(first.at(0), qint16(0));
+}
+
+void AudioSinkTest::ambientNoiseFadesOut()
+{
+    constexpr int FADE_FRAMES = AmbientNoiseGenerator::FADE_MS * AudioSource::SAMPLE_RATE / 1000;
+
+    AmbientNoiseGenerator generator;
+    generator.setNoise(AmbientNoiseGenerator::Noise::Brown);
+    generator.setActive(true);
+    QVERIFY(!generator.isIdle());
+    {
+        WavFileSink sink(outputPath());
+        sink.addSource(&generator);
+        QVERIFY(sink.start());
+        sink.advance(FADE_FRAMES);
+        generator.setActive(false);
+        sink.advance(FADE_FRAMES + AmbientNoiseGenerator::BLOCK_FRAMES);
+        QVERIFY(generator.isIdle());
+        sink.advance(AudioSource::SAMPLE_RATE / 10);
+        sink.removeSource(&generator);
+        sink.stop();
+    }
+
+    const QVector<qint16> samples = readWav(outputPath());
+    const int faded = (FADE_FRAMES * 2 + AmbientNoiseGenerator::BLOCK_FRAMES) * AudioSource::CHANNELS;
+    QVERIFY(samples.size() >= faded + AudioSource::SAMPLE_RATE / 10 * AudioSource::CHANNELS);
+    QVERIFY(std::any_of(samples.cbegin(), samples.cbegin() + faded, [](qint16 sample) { return sample != 0; }));
+    QVERIFY(std::all_of(samples.cbegin() + faded, samples.cend(), [](qint16 sample) { return sample == 0; }));
+}
+
+void AudioSinkTest::ticksLandOnWholeSeconds()
+{
+    constexpr int TICK_FRAMES = AmbientNoiseGenerator::TICK_MS * AudioSource::SAMPLE_RATE / 1000;
+    const QVector<qint16> samples = renderAmbient(QStringLiteral("ticks.wav"), AudioSource::SAMPLE_RATE * 3,
+        [](AmbientNoiseGenerator &generator) {
+            generator.setTicking(true);
+            generator.setLevel(1.0f);
+            generator.setActive(true);
+        });
+    QCOMPARE(samples.size(), AudioSource::SAMPLE_RATE * 3 * AudioSource::CHANNELS);
+
+    const auto audible = [&samples](int from, int to) {
+        return std::any_of(samples.cbegin() + from * AudioSource::CHANNELS, samples.cbegin() + to * AudioSource::CHANNELS,
+                           [](qint16 sample) { return sample != 0; });
+    };
+    // Silence between ticks; each tick starts on a second of the stream clock
+    for (int second = 1; second < 3; ++second) {
+        const int start = second * AudioSource::SAMPLE_RATE;
+        QVERIFY(!audible(start - AudioSource::SAMPLE_RATE + TICK_FRAMES, start));
+        QVERIFY(audible(start, start + TICK_FRAMES));
+    }
+}
+
+QTEST_GUILESS_MAIN(AudioSinkTest)
+#include "AudioSinkTest.moc"
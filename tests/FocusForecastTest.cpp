@@ -0,0 +1,154 @@
+#include "FocusForecast.h"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+class FocusForecastTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyModelPredictsNothing();
+    void constantHistoryIsLearned();
+    void weekdaySeasonIsLearned();
+    void outlookCoversRestOfPeriod();
+    void estimateAgainstGoal();
+    void saveLoadRoundTrip();
+
+private:
+    // A model fed count days of minutes(date), ending the day before today
+    template <typename Minutes>
+    static FocusForecast fit(const QDate &today, int count, Minutes minutes);
+    static bool nearly(double actual, double expected) { return qAbs(actual - expected) < 1e-6; }
+
+    // A Wednesday, so the week still has four days after it
+    const QDate m_today{2022, 6, 1};
+};
+
+template <typename Minutes>
+FocusForecast FocusForecastTest::fit(const QDate &today, int count, Minutes minutes)
+{
+    FocusForecast forecast;
+    for (QDate day = today.addDays(-count); day < today; day = day.addDays(1)) {
+        forecast.addDay(day.toJulianDay(), minutes(day));
+    }
+    forecast.updateOutlook(today);
+    return forecast;
+}
+
+void FocusForecastTest::emptyModelPredictsNothing()
+{
+    FocusForecast forecast;
+    QVERIFY(!forecast.isValid());
+    QCOMPARE(forecast.predict(m_today.toJulianDay()), 0.0);
+
+    forecast.updateOutlook(m_today);
+    QVERIFY(!forecast.isValid());
+    QCOMPARE(forecast.week().restMinutes, 0.0);
+}
+
+void FocusForecastTest::constantHistoryIsLearned()
+{
+    FocusForecast forecast = fit(m_today, 56, [](const QDate &) { return 100.0; });
+    QVERIFY(forecast.isValid());
+    QCOMPARE(forecast.lastDay(), m_today.addDays(-1).toJulianDay());
+    QCOMPARE(forecast.asOf(), m_today);
+    QVERIFY(nearly(forecast.predict(m_today.toJulianDay()), 100));
+    QVERIFY(nearly(forecast.predict(m_today.addDays(30).toJulianDay()), 100));
+
+    // Days must arrive in order; a repeated or earlier day is ignored
+    forecast.addDay(m_today.addDays(-1).toJulianDay(), 0);
+    forecast.addDay(m_today.addDays(-10).toJulianDay(), 0);
+    QCOMPARE(forecast.lastDay(), m_today.addDays(-1).toJulianDay());
+    QVERIFY(nearly(forecast.predict(m_today.toJulianDay()), 100));
+}
+
+void FocusForecastTest::weekdaySeasonIsLearned()
+{
+    const FocusForecast forecast = fit(m_today, 20 * 7, [](const QDate &day) {
+        return day.dayOfWeek() <= 5 ? 120.0 : 0.0;
+    });
+
+    const double saturday = forecast.predict(m_today.addDays(3).toJulianDay());
+    const double monday = forecast.predict(m_today.addDays(5).toJulianDay());
+    QCOMPARE(QDate::fromJulianDay(m_today.addDays(3).toJulianDay()).dayOfWeek(), 6);
+    QVERIFY2(monday > 100, qPrintable(QString::number(monday)));
+    QVERIFY2(saturday < 20, qPrintable(QString::number(saturday)));
+}
+
+void FocusForecastTest::outlookCoversRestOfPeriod()
+{
+    const FocusForecast forecast = fit(m_today, 56, [](const QDate &) { return 100.0; });
+
+    // Thursday to Sunday, and the rest of June
+    const FocusForecast::Outlook &week = forecast.week();
+    QCOMPARE(week.end, QDate(2022, 6, 5));
+    QVERIFY(nearly(week.restMinutes, 4 * 100));
+    const FocusForecast::Outlook &month = forecast.month();
+    QCOMPARE(month.end, QDate(2022, 6, 30));
+    QVERIFY(nearly(month.restMinutes, 29 * 100));
+
+    // A perfect fit still keeps the minimum spread, for today and each day left
+    const double dayVariance = FocusForecast::MIN_STDDEV_MINUTES * FocusForecast::MIN_STDDEV_MINUTES;
+    QVERIFY(nearly(week.variance, 5 * dayVariance));
+    QVERIFY(nearly(month.variance, 30 * dayVariance));
+}
+
+void FocusForecastTest::estimateAgainstGoal()
+{
+    const FocusForecast forecast = fit(m_today, 56, [](const QDate &) { return 100.0; });
+    const FocusForecast::Outlook &week = forecast.week();
+
+    // 150 so far, 50 of it today: 50 more expected today and 400 after it
+    FocusForecast::Estimate estimate = forecast.estimate(week, 150, 50, 600);
+    QVERIFY(nearly(estimate.expectedMinutes, 600));
+    QVERIFY(nearly(estimate.goalProbability, 0.5));
+
+    // More done today than predicted adds nothing for the rest of it
+    estimate = forecast.estimate(week, 300, 200, 1000);
+    QVERIFY(nearly(estimate.expectedMinutes, 700));
+    QVERIFY(estimate.goalProbability < 0.01);
+    estimate = forecast.estimate(week, 300, 200, 500);
+    QVERIFY(estimate.goalProbability > 0.99);
+
+    QCOMPARE(forecast.estimate(week, 700, 0, 600).goalProbability, 1.0);    // already reached
+    QCOMPARE(forecast.estimate(week, 0, 0, 0).goalProbability, 1.0);        // no goal
+}
+
+void FocusForecastTest::saveLoadRoundTrip()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = directory.filePath(QStringLiteral("forecast.dat"));
+
+    const FocusForecast saved = fit(m_today, 10 * 7, [](const QDate &day) {
+        return day.dayOfWeek() <= 5 ? 90.0 + day.day() : 10.0;
+    });
+    QVERIFY(saved.save(path));
+
+    FocusForecast loaded;
+    QVERIFY(FocusForecast::load(path, loaded));
+    QCOMPARE(loaded.asOf(), saved.asOf());
+    QCOMPARE(loaded.lastDay(), saved.lastDay());
+    for (int offset = 0; offset < 14; ++offset) {
+        const qint64 day = m_today.addDays(offset).toJulianDay();
+        QCOMPARE(loaded.predict(day), saved.predict(day));
+    }
+    QCOMPARE(loaded.week().end, saved.week().end);
+    QCOMPARE(loaded.week().restMinutes, saved.week().restMinutes);
+    QCOMPARE(loaded.month().variance, saved.month().variance);
+
+    // A foreign file leaves the forecast alone
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a forecast");
+    file.close();
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^FocusForecast: ignoring unreadable")));
+    QVERIFY(!FocusForecast::load(path, loaded));
+    QCOMPARE(loaded.lastDay(), saved.lastDay());
+}
+
+QTEST_GUILESS_MAIN(FocusForecastTest)
+#include "FocusForecastTest.moc"
@@ -0,0 +1,253 @@
+#include "HistoryArchive.h"
+
+#include <QDateTime>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+// Encodes, appends and reads back archives in a temporary directory and
+// compares every answer with a brute-force pass over the same records
+class HistoryArchiveTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void recordsRoundTrip();
+    void totalsMatchRecords();
+    void indexSummarizesBlocks();
+    void appendKeepsEverything();
+    void rollupsRoundTrip();
+
+private:
+    // Three weeks of sessions every 20 minutes, spread over three tags and
+    // more than one block; every seventh work session is skipped
+    static QVector<SessionRecord> makeRecords(qint64 from, int count, quint32 firstId);
+    QString archivePath() const { return m_directory->filePath(QStringLiteral("history.archive")); }
+    // Loads with tag IDs resolved to 1-based indexes into m_tags, as the history does
+    bool load(HistoryArchive &archive) const;
+
+    std::unique_ptr<QTemporaryDir> m_directory;
+    const QStringList m_tags{QStringLiteral("alpha"), QStringLiteral("beta"), QStringLiteral("gamma")};
+};
+
+void HistoryArchiveTest::init()
+{
+    m_directory = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_directory->isValid());
+}
+
+QVector<SessionRecord> HistoryArchiveTest::makeRecords(qint64 from, int count, quint32 firstId)
+{
+    QVector<SessionRecord> records;
+    records.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        SessionRecord record;
+        record.id = firstId + static_cast<quint32>(i);
+        record.startTime = from + static_cast<qint64>(i) * 1200;
+        record.type = i % 4 == 3 ? TimerState::ShortBreak : TimerState::Work;
+        record.duration = record.type == TimerState::Work ? 1500 - (i % 11) * 7 : 300 + i % 5;
+        record.flags = record.type == TimerState::Work && i % 7 == 0 ? SessionSkipped : 0;
+        record.tagId = static_cast<quint16>(i % 4);     // 0 is untagged
+        records.append(record);
+    }
+    return records;
+}
+
+bool HistoryArchiveTest::load(HistoryArchive &archive) const
+{
+    const QStringList tags = m_tags;
+    return archive.load(archivePath(), [tags](const QString &name) {
+        return static_cast<quint16>(tags.indexOf(name) + 1);
+    });
+}
+
+void HistoryArchiveTest::recordsRoundTrip()
+{
+    QVector<SessionRecord> records = makeRecords(1700000000, 2500, 10);
+    std::reverse(records.begin(), records.end());   // any order is accepted
+    QVERIFY(HistoryArchive::write(archivePath(), records, {}, m_tags, 1800000000));
+
+    HistoryArchive archive;
+    QVERIFY(load(archive));
+    QCOMPARE(archive.recordCount(), 2500);
+    QCOMPARE(archive.blockCount(), (2500 + HistoryArchive::BLOCK_RECORDS - 1) / HistoryArchive::BLOCK_RECORDS);
+    QCOMPARE(archive.maxId(), 2509u);
+    QCOMPARE(archive.nextId(), 2510u);
+    QCOMPARE(archive.cutoff(), 1800000000);
+
+    const QVector<SessionRecord> decoded = archive.records();
+    std::reverse(records.begin(), records.end());
+    QCOMPARE(decoded.size(), records.size());
+    for (int i = 0; i < records.size(); ++i) {
+        QCOMPARE(decoded.at(i).id, records.at(i).id);
+        QCOMPARE(decoded.at(i).startTime, records.at(i).startTime);
+        QCOMPARE(decoded.at(i).duration, records.at(i).duration);
+        QCOMPARE(decoded.at(i).type, records.at(i).type);
+        QCOMPARE(decoded.at(i).flags, records.at(i).flags);
+        QCOMPARE(decoded.at(i).tagId, records.at(i).tagId);
+    }
+
+    const std::optional<SessionRecord> found = archive.find(1234);
+    QVERIFY(found.has_value());
+    QCOMPARE(found->startTime, records.at(1224).startTime);
+    QVERIFY(!archive.find(5000).has_value());
+}
+
+void HistoryArchiveTest::totalsMatchRecords()
+{
+    const QVector<SessionRecord> records = makeRecords(1700000000, 3000, 1);
+    QVERIFY(HistoryArchive::write(archivePath(), records, {}, m_tags, 1800000000));
+    HistoryArchive archive;
+    QVERIFY(load(archive));
+
+    // Whole blocks, partial blocks at both ends, and an empty range
+    const QVector<QPair<qint64, qint64>> ranges{
+        {0, std::numeric_limits<qint64>::max()},
+        {1700000000 + 500 * 1200 + 17, 1700000000 + 2700 * 1200 + 3},
+        {1700000000 + 10 * 1200, 1700000000 + 11 * 1200},
+        {1600000000, 1600000001},
+    };
+    for (const auto &[from, to] : ranges) {
+        DailyRollup expected;
+        for (const SessionRecord &record : records) {
+            if (record.startTime < from || record.startTime >= to) continue;
+            if (record.type == TimerState::Work) {
+                expected.workSeconds += static_cast<int>(record.duration);
+                expected.sessions++;
+                expected.skippedSessions += (record.flags & SessionSkipped) ? 1 : 0;
+            } else {
+                expected.breakSeconds += static_cast<int>(record.duration);
+            }
+        }
+        const DailyRollup totals = archive.totals(from, to);
+        QCOMPARE(totals.workSeconds, expected.workSeconds);
+        QCOMPARE(totals.breakSeconds, expected.breakSeconds);
+        QCOMPARE(totals.sessions, expected.sessions);
+        QCOMPARE(totals.skippedSessions, expected.skippedSessions);
+    }
+}
+
+void HistoryArchiveTest::indexSummarizesBlocks()
+{
+    const QVector<SessionRecord> records = makeRecords(1700000000, 1500, 1);
+    QVERIFY(HistoryArchive::write(archivePath(), records, {}, m_tags, 1800000000));
+    HistoryArchive archive;
+    QVERIFY(load(archive));
+
+    QMap<QPair<qint64, quint16>, HistoryArchive::Rollup> expected;
+    AnalyticsCube cube;
+    for (const SessionRecord &record : records) {
+        const qint64 day = QDateTime::fromSecsSinceEpoch(record.startTime).date().toJulianDay();
+        HistoryArchive::Rollup &rollup = expected[qMakePair(day, record.tagId)];
+        if (record.type == TimerState::Work) {
+            rollup.workSeconds += record.duration;
+            rollup.sessions++;
+            rollup.skippedSessions += (record.flags & SessionSkipped) ? 1 : 0;
+        } else {
+            rollup.breakSeconds += record.duration;
+        }
+        cube.add(record);
+    }
+
+    QCOMPARE(archive.blockDays().size(), expected.size());
+    for (const HistoryArchive::Rollup &day : archive.blockDays()) {
+        QCOMPARE(day.period, HistoryArchive::RollupPeriod::Day);
+        const auto it = expected.constFind(qMakePair(day.julianDay, day.tagId));
+        QVERIFY(it != expected.cend());
+        QCOMPARE(day.workSeconds, it->workSeconds);
+        QCOMPARE(day.breakSeconds, it->breakSeconds);
+        QCOMPARE(day.sessions, it->sessions);
+        QCOMPARE(day.skippedSessions, it->skippedSessions);
+    }
+
+    for (int tag : {AnalyticsCube::ALL_TAGS, 0, 1, 2, 3}) {
+        const QVector<AnalyticsCube::Cell> actual = archive.analytics().heatmap(TimerState::Work, tag);
+        const QVector<AnalyticsCube::Cell> wanted = cube.heatmap(TimerState::Work, tag);
+        QCOMPARE(actual.size(), wanted.size());
+        for (int i = 0; i < wanted.size(); ++i) {
+            QCOMPARE(actual.at(i).seconds, wanted.at(i).seconds);
+            QCOMPARE(actual.at(i).sessions, wanted.at(i).sessions);
+        }
+    }
+}
+
+void HistoryArchiveTest::appendKeepsEverything()
+{
+    const QVector<SessionRecord> records = makeRecords(1700000000, 2200, 1);
+    QVERIFY(HistoryArchive::write(archivePath(), records.mid(0, 1300), {}, m_tags, 1700000000 + 1300 * 1200));
+
+    HistoryArchive before;
+    QVERIFY(load(before));
+    const qint64 sizeBefore = before.fileSize();
+    before.close();
+
+    QVERIFY(HistoryArchive::append(archivePath(), records.mid(1300), m_tags, 1800000000));
+
+    HistoryArchive archive;
+    QVERIFY(load(archive));
+    QVERIFY(archive.fileSize() > sizeBefore);
+    QCOMPARE(archive.recordCount(), 2200);
+    QCOMPARE(archive.cutoff(), 1800000000);
+    QCOMPARE(archive.nextId(), 2201u);
+
+    const DailyRollup totals = archive.totals(0, std::numeric_limits<qint64>::max());
+    int work = 0;
+    int sessions = 0;
+    for (const SessionRecord &record : records) {
+        if (record.type != TimerState::Work) continue;
+        work += static_cast<int>(record.duration);
+        ++sessions;
+    }
+    QCOMPARE(totals.workSeconds, work);
+    QCOMPARE(totals.sessions, sessions);
+
+    // The summary carried over from the first write plus the appended days
+    int summarized = 0;
+    for (const HistoryArchive::Rollup &day : archive.blockDays()) {
+        summarized += static_cast<int>(day.workSeconds);
+    }
+    QCOMPARE(summarized, work);
+}
+
+void HistoryArchiveTest::rollupsRoundTrip()
+{
+    HistoryArchive::Rollup daily;
+    daily.julianDay = QDate(2020, 3, 14).toJulianDay();
+    daily.tagId = 2;
+    daily.workSeconds = 4500;
+    daily.breakSeconds = 600;
+    daily.sessions = 3;
+    daily.skippedSessions = 1;
+
+    HistoryArchive::Rollup monthly;
+    monthly.julianDay = QDate(2018, 7, 1).toJulianDay();
+    monthly.period = HistoryArchive::RollupPeriod::Month;
+    monthly.workSeconds = 90000;
+    monthly.sessions = 60;
+
+    QVERIFY(HistoryArchive::write(archivePath(), {}, {daily, monthly}, m_tags, 1600000000, 777));
+    HistoryArchive archive;
+    QVERIFY(load(archive));
+    QCOMPARE(archive.recordCount(), 0);
+    QCOMPARE(archive.nextId(), 777u);       // IDs of folded sessions are never reused
+    QVERIFY(archive.blockDays().isEmpty());
+
+    const QVector<HistoryArchive::Rollup> &rollups = archive.rollups();
+    QCOMPARE(rollups.size(), 2);
+    const auto day = std::find_if(rollups.cbegin(), rollups.cend(), [](const HistoryArchive::Rollup &rollup) {
+        return rollup.period == HistoryArchive::RollupPeriod::Day;
+    });
+    QVERIFY(day != rollups.cend());
+    QCOMPARE(day->julianDay, daily.julianDay);
+    QCOMPARE(day->tagId, quint16(2));
+    QCOMPARE(day->workSeconds, 4500u);
+    QCOMPARE(day->skippedSessions, 1u);
+}
+
+QTEST_GUILESS_MAIN(HistoryArchiveTest)
+#include "HistoryArchiveTest.moc"
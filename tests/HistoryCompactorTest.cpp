@@ -0,0 +1,213 @@
+#include "HistoryCompactor.h"
+#include "SessionNotes.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTest>
+#include <QThread>
+#include <limits>
+
+// Compacts an archive written into the history's test-mode directory. The
+// compactor runs on a worker as in the app: it waits for the main thread to
+// release the archive before the swap, so the test keeps the event loop going
+class HistoryCompactorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void oldSessionsAreFolded();
+    void nothingLeftToFold();
+
+private:
+    // Runs a compactor with the default policy to completion on its own thread
+    void compact(bool &changed, QString &error);
+    static SessionRecord session(quint32 id, const QDate &date, int hour, TimerState type, quint32 duration,
+                                 quint16 tagId = 0, quint8 flags = 0);
+    static const HistoryArchive::Rollup* findRollup(const QVector<HistoryArchive::Rollup> &rollups,
+                                                    const QDate &date, HistoryArchive::RollupPeriod period,
+                                                    quint16 tagId);
+
+    const QStringList m_tags{QStringLiteral("alpha"), QStringLiteral("beta")};
+    const QDate m_today = QDate::currentDate();
+    QVector<SessionRecord> m_records;
+    QVector<HistoryArchive::Rollup> m_rollups;
+};
+
+SessionRecord HistoryCompactorTest::session(quint32 id, const QDate &date, int hour, TimerState type,
+                                            quint32 duration, quint16 tagId, quint8 flags)
+{
+    SessionRecord record;
+    record.id = id;
+    record.startTime = QDateTime(date, QTime(hour, 0)).toSecsSinceEpoch();
+    record.type = type;
+    record.duration = duration;
+    record.tagId = tagId;
+    record.flags = flags;
+    return record;
+}
+
+const HistoryArchive::Rollup* HistoryCompactorTest::findRollup(const QVector<HistoryArchive::Rollup> &rollups,
+                                                               const QDate &date,
+                                                               HistoryArchive::RollupPeriod period, quint16 tagId)
+{
+    for (const HistoryArchive::Rollup &rollup : rollups) {
+        if (rollup.julianDay == date.toJulianDay() && rollup.period == period && rollup.tagId == tagId) {
+            return &rollup;
+        }
+    }
+    return nullptr;
+}
+
+void HistoryCompactorTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).removeRecursively();
+
+    // With the default policy: raw after 24 months, daily after 60
+    const QDate recent = m_today.addMonths(-2);
+    const QDate old = m_today.addMonths(-30);
+    const QDate ancient = m_today.addMonths(-80);
+    const QDate ancientMonth(ancient.year(), ancient.month(), 1);
+    m_records = {
+        session(1, recent, 9, TimerState::Work, 1500, 1),
+        session(2, recent, 10, TimerState::ShortBreak, 300),
+        session(3, recent.addDays(1), 9, TimerState::Work, 1500, 2),
+        session(4, old, 9, TimerState::Work, 1500, 1),
+        session(5, old, 10, TimerState::Work, 1200, 1),
+        session(6, old, 11, TimerState::ShortBreak, 300),
+        session(7, old.addDays(1), 9, TimerState::Work, 600, 2, SessionSkipped),
+        session(8, old.addDays(2), 9, TimerState::Work, 1500, 1),       // has a note
+        session(9, ancientMonth.addDays(4), 9, TimerState::Work, 1500, 1),
+        session(10, ancientMonth.addDays(19), 9, TimerState::Work, 1000, 1),
+    };
+    // A daily rollup already past the monthly horizon
+    HistoryArchive::Rollup daily;
+    daily.julianDay = m_today.addMonths(-70).toJulianDay();
+    daily.tagId = 2;
+    daily.workSeconds = 3000;
+    daily.sessions = 2;
+    m_rollups = {daily};
+
+    SessionHistory &history = SessionHistory::instance();
+    history.releaseArchive();
+    QVERIFY(HistoryArchive::write(history.archiveFilePath(), m_records, m_rollups, m_tags,
+                                  QDateTime(recent.addDays(2), QTime(0, 0)).toSecsSinceEpoch(), 50));
+    history.reloadArchive();
+    QCOMPARE(history.archive().recordCount(), static_cast<int>(m_records.size()));
+
+    SessionNotes::instance().setNote(8, QStringLiteral("kept for its note"));
+    QVERIFY(SessionNotes::instance().hasNote(8));
+}
+
+void HistoryCompactorTest::compact(bool &changed, QString &error)
+{
+    QThread thread;
+    auto *compactor = new HistoryCompactor(HistoryCompactor::RetentionPolicy());
+    compactor->moveToThread(&thread);
+    connect(&thread, &QThread::started, compactor, &HistoryCompactor::run);
+    connect(&thread, &QThread::finished, compactor, &QObject::deleteLater);
+
+    bool done = false;
+    connect(compactor, &HistoryCompactor::finished, &thread, [&](bool success, const QString &message) {
+        changed = success;
+        error = message;
+        done = true;
+        thread.quit();
+    });
+    thread.start();
+    QTRY_VERIFY_WITH_TIMEOUT(done, 10000);
+    thread.wait();
+
+    // The app maps the archive again once the compactor is done
+    SessionHistory::instance().reloadArchive();
+}
+
+void HistoryCompactorTest::oldSessionsAreFolded()
+{
+    bool changed = false;
+    QString error;
+    compact(changed, error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QVERIFY(changed);
+
+    const QStringList tags = m_tags;
+    HistoryArchive archive;
+    QVERIFY(archive.load(SessionHistory::instance().archiveFilePath(), [tags](const QString &name) {
+        return static_cast<quint16>(tags.indexOf(name) + 1);
+    }));
+
+    // Recent sessions and the noted one stay raw; folded IDs are never reused
+    QCOMPARE(archive.recordCount(), 4);
+    for (quint32 id : {1u, 2u, 3u, 8u}) {
+        QVERIFY(archive.find(id).has_value());
+    }
+    QCOMPARE(archive.nextId(), 50u);
+
+    const QVector<HistoryArchive::Rollup> &rollups = archive.rollups();
+    const QDate old = m_today.addMonths(-30);
+    const HistoryArchive::Rollup *work = findRollup(rollups, old, HistoryArchive::RollupPeriod::Day, 1);
+    QVERIFY(work);
+    QCOMPARE(work->workSeconds, 2700u);
+    QCOMPARE(work->sessions, 2u);
+    const HistoryArchive::Rollup *pause = findRollup(rollups, old, HistoryArchive::RollupPeriod::Day, 0);
+    QVERIFY(pause);
+    QCOMPARE(pause->breakSeconds, 300u);
+    QCOMPARE(pause->sessions, 0u);
+    const HistoryArchive::Rollup *skipped = findRollup(rollups, old.addDays(1), HistoryArchive::RollupPeriod::Day, 2);
+    QVERIFY(skipped);
+    QCOMPARE(skipped->sessions, 1u);
+    QCOMPARE(skipped->skippedSessions, 1u);
+
+    // Past the monthly horizon, sessions and daily rollups alike end up per month
+    const QDate ancient = m_today.addMonths(-80);
+    const HistoryArchive::Rollup *month = findRollup(rollups, QDate(ancient.year(), ancient.month(), 1),
+                                                     HistoryArchive::RollupPeriod::Month, 1);
+    QVERIFY(month);
+    QCOMPARE(month->workSeconds, 2500u);
+    QCOMPARE(month->sessions, 2u);
+    const QDate promoted = m_today.addMonths(-70);
+    const HistoryArchive::Rollup *daily = findRollup(rollups, QDate(promoted.year(), promoted.month(), 1),
+                                                     HistoryArchive::RollupPeriod::Month, 2);
+    QVERIFY(daily);
+    QCOMPARE(daily->workSeconds, 3000u);
+    QCOMPARE(rollups.size(), 5);
+
+    // Nothing was lost on the way
+    quint32 before = 0;
+    for (const SessionRecord &record : std::as_const(m_records)) {
+        before += record.type == TimerState::Work ? record.duration : 0;
+    }
+    quint32 after = static_cast<quint32>(archive.totals(0, std::numeric_limits<qint64>::max()).workSeconds);
+    for (const HistoryArchive::Rollup &rollup : rollups) {
+        after += rollup.workSeconds;
+    }
+    QCOMPARE(after, before + 3000);
+
+    // The reloaded history sees the months as monthly rollups
+    const SessionHistory &history = SessionHistory::instance();
+    QCOMPARE(history.archive().recordCount(), 4);
+    QCOMPARE(history.monthlyRollups().value(QDate(ancient.year(), ancient.month(), 1)).sessions, 2);
+}
+
+void HistoryCompactorTest::nothingLeftToFold()
+{
+    QFile file(SessionHistory::instance().archiveFilePath());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray before = file.readAll();
+    file.close();
+
+    bool changed = true;
+    QString error;
+    compact(changed, error);
+    QVERIFY(!changed);
+    QVERIFY(error.isEmpty());
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), before);
+}
+
+QTEST_GUILESS_MAIN(HistoryCompactorTest)
+#include "HistoryCompactorTest.moc"
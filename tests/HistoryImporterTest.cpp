@@ -0,0 +1,170 @@
+#include "HistoryArchive.h"
+#include "HistoryImporter.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <optional>
+
+// Imports into the history singleton, which test mode keeps away from the
+// user's data. The slots share it and run in order, each on its own dates
+class HistoryImporterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void csvRowsAreValidated();
+    void ndjsonIsCheckedAgainstHistory();
+    void rolledUpPeriodsAreDuplicates();
+
+private:
+    // Writes contents to a file with the given suffix and runs every import step on it
+    bool importFile(const QByteArray &contents, const QString &suffix, HistoryImporter::Summary &summary);
+    static std::optional<SessionRecord> findSession(qint64 startTime, TimerState type);
+    static qint64 utc(const char *text) { return QDateTime::fromString(QLatin1String(text), Qt::ISODate).toSecsSinceEpoch(); }
+
+    QTemporaryDir m_inputs;
+};
+
+void HistoryImporterTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).removeRecursively();
+    QVERIFY(m_inputs.isValid());
+    QVERIFY(SessionHistory::instance().records().isEmpty());
+}
+
+bool HistoryImporterTest::importFile(const QByteArray &contents, const QString &suffix,
+                                     HistoryImporter::Summary &summary)
+{
+    static int count = 0;
+    QFile file(m_inputs.filePath(QStringLiteral("import%1.%2").arg(++count).arg(suffix)));
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size()) return false;
+    file.close();
+
+    HistoryImporter importer(file.fileName());
+    if (!importer.run()) return false;
+    importer.resolveTags();
+    if (!importer.write()) return false;
+    summary = importer.commit();
+    return true;
+}
+
+std::optional<SessionRecord> HistoryImporterTest::findSession(qint64 startTime, TimerState type)
+{
+    for (const SessionRecord &record : SessionHistory::instance().records()) {
+        if (record.startTime == startTime && record.type == type) return record;
+    }
+    return std::nullopt;
+}
+
+void HistoryImporterTest::csvRowsAreValidated()
+{
+    const QByteArray csv =
+        "start,duration,type,tag,skipped\r\n"
+        "2021-03-01T09:00:00Z,1500,work,\"Write, \"\"draft\"\"\",0\r\n"
+        "2021-03-01T09:25:00Z,300,shortBreak,,\r\n"
+        "2021-03-01T09:00:00Z,1400,work,other,0\r\n"        // same start and type: duplicate
+        "2021-03-01T09:00:00Z,300,shortBreak,,\r\n"         // same start, other type: kept
+        "2021-02-31T10:00:00Z,1500,work,,\r\n"              // no such day
+        "2021-03-02T10:00:00+01:00,1200,work,Write,1\r\n"
+        "2021-03-02T12:00:00Z,0,work,,\r\n"                 // empty session
+        "2999-01-01T00:00:00Z,1500,work,,\r\n";             // in the future
+
+    HistoryImporter::Summary summary;
+    QVERIFY(importFile(csv, QStringLiteral("csv"), summary));
+    QCOMPARE(summary.imported, 4);
+    QCOMPARE(summary.duplicates, 1);
+    QCOMPARE(summary.invalid, 3);
+
+    const SessionHistory &history = SessionHistory::instance();
+    const std::optional<SessionRecord> drafted = findSession(utc("2021-03-01T09:00:00Z"), TimerState::Work);
+    QVERIFY(drafted.has_value());
+    QCOMPARE(drafted->duration, 1500u);
+    QCOMPARE(drafted->flags, quint8(0));
+    QCOMPARE(history.tagName(drafted->tagId), QStringLiteral("Write, \"draft\""));
+
+    const std::optional<SessionRecord> skipped = findSession(utc("2021-03-02T09:00:00Z"), TimerState::Work);
+    QVERIFY(skipped.has_value());
+    QCOMPARE(skipped->duration, 1200u);
+    QCOMPARE(skipped->flags, quint8(SessionSkipped));
+    QCOMPARE(history.tagName(skipped->tagId), QStringLiteral("Write"));
+
+    const std::optional<SessionRecord> pause = findSession(utc("2021-03-01T09:25:00Z"), TimerState::ShortBreak);
+    QVERIFY(pause.has_value());
+    QCOMPARE(pause->tagId, quint16(0));
+    QVERIFY(findSession(utc("2021-03-01T09:00:00Z"), TimerState::ShortBreak).has_value());
+}
+
+void HistoryImporterTest::ndjsonIsCheckedAgainstHistory()
+{
+    const qsizetype before = SessionHistory::instance().records().size();
+    const QByteArray ndjson =
+        "{\"start\": 1614589200, \"duration\": 1500, \"type\": \"work\"}\n"     // imported above
+        "{\"start\": \"2021-03-03T08:00:00Z\", \"end\": \"2021-03-03T08:25:00Z\", "
+        "\"tag\": \"Read \\\"spec\\\"\", \"skipped\": true}\n"
+        "{\"start_time\": 1614762000000, \"seconds\": 600, \"kind\": \"long_break\", \"task\": null}\n"
+        "not a record\n"
+        "\n";
+
+    HistoryImporter::Summary summary;
+    QVERIFY(importFile(ndjson, QStringLiteral("ndjson"), summary));
+    QCOMPARE(summary.imported, 2);
+    QCOMPARE(summary.duplicates, 1);
+    QCOMPARE(summary.invalid, 1);
+    QCOMPARE(SessionHistory::instance().records().size(), before + 2);
+
+    const std::optional<SessionRecord> reading = findSession(utc("2021-03-03T08:00:00Z"), TimerState::Work);
+    QVERIFY(reading.has_value());
+    QCOMPARE(reading->duration, 1500u);
+    QCOMPARE(reading->flags, quint8(SessionSkipped));
+    QCOMPARE(SessionHistory::instance().tagName(reading->tagId), QStringLiteral("Read \"spec\""));
+
+    // Millisecond epochs are scaled down
+    const std::optional<SessionRecord> rest = findSession(utc("2021-03-03T09:00:00Z"), TimerState::LongBreak);
+    QVERIFY(rest.has_value());
+    QCOMPARE(rest->duration, 600u);
+}
+
+void HistoryImporterTest::rolledUpPeriodsAreDuplicates()
+{
+    SessionHistory &history = SessionHistory::instance();
+
+    // Rollups are kept per local day, or per month on its first day
+    HistoryArchive::Rollup day;
+    day.julianDay = QDate(2019, 5, 10).toJulianDay();
+    day.workSeconds = 3000;
+    day.sessions = 2;
+    HistoryArchive::Rollup month;
+    month.julianDay = QDate(2018, 3, 1).toJulianDay();
+    month.period = HistoryArchive::RollupPeriod::Month;
+    month.workSeconds = 60000;
+    month.sessions = 40;
+
+    history.releaseArchive();
+    const qint64 cutoff = QDateTime(QDate(2020, 1, 1), QTime(0, 0)).toSecsSinceEpoch();
+    QVERIFY(HistoryArchive::write(history.archiveFilePath(), {}, {day, month}, history.tagNames(), cutoff));
+    history.reloadArchive();
+
+    const auto localNoon = [](const QDate &date) {
+        return QByteArray::number(QDateTime(date, QTime(12, 0)).toSecsSinceEpoch());
+    };
+    const QByteArray csv = "start,duration\n"
+        + localNoon(QDate(2019, 5, 10)) + ",1500\n"
+        + localNoon(QDate(2018, 3, 20)) + ",1500\n"
+        + localNoon(QDate(2019, 5, 11)) + ",1500\n";
+
+    HistoryImporter::Summary summary;
+    QVERIFY(importFile(csv, QStringLiteral("csv"), summary));
+    QCOMPARE(summary.imported, 1);
+    QCOMPARE(summary.duplicates, 2);
+    QCOMPARE(summary.invalid, 0);
+    QVERIFY(findSession(QDateTime(QDate(2019, 5, 11), QTime(12, 0)).toSecsSinceEpoch(), TimerState::Work).has_value());
+}
+
+QTEST_GUILESS_MAIN(HistoryImporterTest)
+#include "HistoryImporterTest.moc"
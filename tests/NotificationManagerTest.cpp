@@ -0,0 +1,109 @@
+#include "NotificationManager.h"
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QSignalSpy>
+#include <QTest>
+#include <QWidget>
+
+// Queueing, coalescing and the in-window toast; run with QT_QPA_PLATFORM=offscreen
+class NotificationManagerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void sameKindIsCoalesced();
+    void deliveriesAreSpaced();
+    void disablingDropsTheQueue();
+    void toastWithoutTray();
+
+private:
+    QWidget *m_window = nullptr;
+    NotificationManager *m_manager = nullptr;
+};
+
+void NotificationManagerTest::init()
+{
+    m_window = new QWidget;
+    m_window->resize(320, 240);
+    m_manager = new NotificationManager(m_window);
+}
+
+void NotificationManagerTest::cleanup()
+{
+    delete m_window;
+    m_window = nullptr;
+    m_manager = nullptr;
+}
+
+void NotificationManagerTest::sameKindIsCoalesced()
+{
+    QSignalSpy delivered(m_manager, &NotificationManager::notificationDelivered);
+
+    m_manager->showNotification(QStringLiteral("first"), NotificationManager::Kind::SessionFinished);
+    m_manager->showNotification(QStringLiteral("info"), NotificationManager::Kind::Info);
+    m_manager->showNotification(QStringLiteral("second"), NotificationManager::Kind::SessionFinished);
+    QCOMPARE(m_manager->pendingCount(), 2);
+    QCOMPARE(delivered.count(), 0);     // never from inside the call
+
+    // The newer message took the older one's place in the queue
+    QVERIFY(delivered.wait(1000));
+    QCOMPARE(delivered.at(0).at(0).value<NotificationManager::Kind>(), NotificationManager::Kind::SessionFinished);
+    QCOMPARE(delivered.at(0).at(1).toString(), QStringLiteral("second"));
+
+    QTRY_COMPARE_WITH_TIMEOUT(delivered.count(), 2, NotificationManager::MIN_DELIVERY_INTERVAL_MS * 3);
+    QCOMPARE(delivered.at(1).at(1).toString(), QStringLiteral("info"));
+    QCOMPARE(m_manager->pendingCount(), 0);
+}
+
+void NotificationManagerTest::deliveriesAreSpaced()
+{
+    QSignalSpy delivered(m_manager, &NotificationManager::notificationDelivered);
+    QElapsedTimer elapsed;
+
+    m_manager->showNotification(QStringLiteral("one"), NotificationManager::Kind::SessionFinished);
+    QVERIFY(delivered.wait(1000));
+    elapsed.start();
+
+    m_manager->showNotification(QStringLiteral("two"), NotificationManager::Kind::SessionFinished);
+    QTRY_COMPARE_WITH_TIMEOUT(delivered.count(), 2, NotificationManager::MIN_DELIVERY_INTERVAL_MS * 3);
+    // Timers may fire a little early on some platforms
+    QVERIFY(elapsed.elapsed() >= NotificationManager::MIN_DELIVERY_INTERVAL_MS - 50);
+}
+
+void NotificationManagerTest::disablingDropsTheQueue()
+{
+    QSignalSpy delivered(m_manager, &NotificationManager::notificationDelivered);
+
+    m_manager->showNotification(QStringLiteral("dropped"), NotificationManager::Kind::Info);
+    m_manager->setNotificationsEnabled(false);
+    QCOMPARE(m_manager->pendingCount(), 0);
+
+    m_manager->showNotification(QStringLiteral("ignored"), NotificationManager::Kind::Info);
+    QCOMPARE(m_manager->pendingCount(), 0);
+    QVERIFY(!delivered.wait(200));
+}
+
+void NotificationManagerTest::toastWithoutTray()
+{
+    m_window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_window));
+
+    QSignalSpy delivered(m_manager, &NotificationManager::notificationDelivered);
+    m_manager->showNotification(QStringLiteral("Work session finished"));
+    QVERIFY(delivered.wait(1000));
+
+    auto *toast = m_window->findChild<QLabel*>(QStringLiteral("notificationToast"));
+    QVERIFY(toast);
+    QVERIFY(toast->isVisible());
+    QCOMPARE(toast->text(), QStringLiteral("Work session finished"));
+    QVERIFY(m_window->rect().contains(toast->geometry()));
+
+    QTRY_VERIFY_WITH_TIMEOUT(!toast->isVisible(), NotificationManager::TOAST_DURATION_MS * 2);
+}
+
+QTEST_MAIN(NotificationManagerTest)
+#include "NotificationManagerTest.moc"
@@ -0,0 +1,283 @@
+#include "CircularProgressBar.h"
+#include "StatisticsDialog.h"
+#include "TomatoIcon.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QSaveFile>
+#include <QTest>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+// Renders the custom-painted widgets offscreen at several sizes and device
+// pixel ratios, compares each image with a golden PNG and times the painting.
+//
+// Every variant is set up once and painted ITERATIONS times into the same
+// QImage; only the painting is timed. Paint times are recorded relative to a
+// fixed calibration scene painted in the same run, so the baseline carries over
+// between machines as long as their relative costs do. Set
+// POMODORO_UPDATE_GOLDEN=1 to record the goldens and the baseline instead.
+class RenderCheckTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void render_data();
+    void render();
+
+private:
+    // Paints one frame into an image that is already sized and cleared
+    using Painter = std::function<void(QImage &image)>;
+
+    static Painter painterFor(const QString &name, const QSize &size, qreal dpr);
+    static Painter widgetPainter(const std::shared_ptr<QWidget> &widget, const QSize &size);
+    static void paintCalibration(QImage &image);
+    // Paints ITERATIONS frames and returns the time of each in microseconds
+    static QVector<qint64> measure(const Painter &paint, QImage &image);
+    static qint64 percentile(QVector<qint64> samples, double fraction);
+    // Fraction of pixels differing beyond the tolerance, or -1 when the sizes differ
+    static double differingPixels(const QImage &actual, const QImage &golden);
+
+    QString baselinePath() const;
+
+    static constexpr int ITERATIONS = 50;
+    static constexpr int CHANNEL_TOLERANCE = 16;            // per 8-bit channel
+    static constexpr double MAX_DIFFERING_PIXELS = 0.005;   // fraction of pixels
+    static constexpr double TIME_REGRESSION_FACTOR = 2.0;
+    static constexpr double TIME_SLACK = 0.05;              // of the calibration paint; noise on tiny paints
+
+    QString m_directory;
+    bool m_update = false;
+    qint64 m_calibrationUs = 1;
+    QJsonObject m_baseline;
+    QJsonObject m_measured;
+};
+
+namespace {
+    const QString BASELINE_FILE_NAME = QStringLiteral("paint-times.json");
+    constexpr qreal DEVICE_PIXEL_RATIOS[] = {1.0, 1.5, 2.0};
+    const QSize CALIBRATION_SIZE(256, 256);
+
+    // Fixed sample data so the chart looks the same on every run
+    constexpr int CHART_DAYS = 14;
+    const QDate CHART_FIRST_DAY(2024, 1, 1);
+
+    struct Case {
+        const char *name;
+        QVector<QSize> sizes;
+    };
+
+    const QVector<Case> &cases()
+    {
+        static const QVector<Case> all = {
+            {"progress-ring", {QSize(110, 110), QSize(220, 220), QSize(440, 440)}},
+            {"progress-ring-empty", {QSize(220, 220)}},
+            {"statistics-chart", {QSize(400, 200), QSize(800, 300)}},
+            {"tomato-icon", {QSize(16, 16), QSize(32, 32), QSize(64, 64)}},
+        };
+        return all;
+    }
+}
+
+void RenderCheckTest::initTestCase()
+{
+    m_directory = QStringLiteral(POMODORO_GOLDEN_DIRECTORY);
+    m_update = qEnvironmentVariableIntValue("POMODORO_UPDATE_GOLDEN") != 0;
+    QVERIFY2(QDir().mkpath(m_directory), qPrintable(m_directory));
+
+    QFile baselineFile(baselinePath());
+    if (!m_update && baselineFile.open(QIODevice::ReadOnly)) {
+        m_baseline = QJsonDocument::fromJson(baselineFile.readAll()).object();
+    }
+
+    QImage image(CALIBRATION_SIZE, QImage::Format_ARGB32_Premultiplied);
+    m_calibrationUs = qMax<qint64>(1, percentile(measure(&RenderCheckTest::paintCalibration, image), 0.5));
+    qInfo().noquote() << QStringLiteral("calibration paint: median %1 us").arg(m_calibrationUs);
+}
+
+void RenderCheckTest::cleanupTestCase()
+{
+    if (!m_update) {
+        return;
+    }
+    QSaveFile file(baselinePath());
+    QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(file.errorString()));
+    QVERIFY(file.write(QJsonDocument(m_measured).toJson()) >= 0);
+    QVERIFY2(file.commit(), qPrintable(file.errorString()));
+    qInfo().noquote() << "Golden images and paint-time baseline written to" << m_directory;
+}
+
+void RenderCheckTest::render_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<qreal>("dpr");
+
+    for (const Case &renderCase : cases()) {
+        for (const QSize &size : renderCase.sizes) {
+            for (const qreal dpr : DEVICE_PIXEL_RATIOS) {
+                const QString key = QStringLiteral("%1_%2x%3@%4x").arg(QLatin1String(renderCase.name))
+                                        .arg(size.width()).arg(size.height()).arg(dpr);
+                QTest::newRow(qPrintable(key)) << QString::fromLatin1(renderCase.name) << size << dpr;
+            }
+        }
+    }
+}
+
+void RenderCheckTest::render()
+{
+    QFETCH(QString, name);
+    QFETCH(QSize, size);
+    QFETCH(qreal, dpr);
+    const QString key = QString::fromLatin1(QTest::currentDataTag());
+
+    const Painter paint = painterFor(name, size, dpr);
+    QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+
+    const QVector<qint64> samples = measure(paint, image);
+    const qint64 medianUs = percentile(samples, 0.5);
+    const double relative = static_cast<double>(medianUs) / m_calibrationUs;
+    qInfo().noquote() << QStringLiteral("%1  median %2 us  p99 %3 us  (%4x calibration)")
+                             .arg(key, -36).arg(medianUs, 6).arg(percentile(samples, 0.99), 6)
+                             .arg(relative, 0, 'f', 3);
+
+    const QString goldenPath = m_directory + "/" + key + ".png";
+    if (m_update) {
+        m_measured.insert(key, relative);
+        QVERIFY2(image.save(goldenPath), qPrintable(goldenPath));
+        return;
+    }
+
+    const QImage golden(goldenPath);
+    QVERIFY2(!golden.isNull(), qPrintable(QStringLiteral("no golden image %1").arg(goldenPath)));
+    const double differing = differingPixels(image, golden);
+    QVERIFY2(differing >= 0.0, "size differs from golden");
+    if (differing > MAX_DIFFERING_PIXELS) {
+        image.save(m_directory + "/" + key + ".actual.png");
+        QFAIL(qPrintable(QStringLiteral("%1% of pixels differ").arg(differing * 100, 0, 'f', 2)));
+    }
+
+    if (m_baseline.contains(key)) {
+        const double budget = m_baseline.value(key).toDouble() * TIME_REGRESSION_FACTOR + TIME_SLACK;
+        QVERIFY2(relative <= budget, qPrintable(QStringLiteral("paint costs %1x calibration, budget %2x")
+                                                    .arg(relative, 0, 'f', 3).arg(budget, 0, 'f', 3)));
+    }
+}
+
+RenderCheckTest::Painter RenderCheckTest::painterFor(const QString &name, const QSize &size, qreal dpr)
+{
+    if (name == QLatin1String("progress-ring")) {
+        auto bar = std::make_shared<CircularProgressBar>();
+        bar->setValue(65);
+        return widgetPainter(bar, size);
+    }
+    if (name == QLatin1String("progress-ring-empty")) {
+        return widgetPainter(std::make_shared<CircularProgressBar>(), size);
+    }
+    if (name == QLatin1String("statistics-chart")) {
+        QMap<QDate, int> data;
+        for (int day = 0; day < CHART_DAYS; ++day) {
+            data.insert(CHART_FIRST_DAY.addDays(day), (day * 37) % 150 + 10);
+        }
+        auto chart = std::make_shared<StatisticsChart>();
+        chart->setData(data);
+        return widgetPainter(chart, size);
+    }
+    // tomato-icon
+    const int pixels = qRound(size.width() * dpr);
+    return [size, pixels](QImage &image) {
+        QPainter painter(&image);
+        painter.drawPixmap(QRect(QPoint(0, 0), size), createTomatoIcon(pixels).pixmap(pixels, pixels));
+    };
+}
+
+RenderCheckTest::Painter RenderCheckTest::widgetPainter(const std::shared_ptr<QWidget> &widget, const QSize &size)
+{
+    // Some widgets fix their own size; the test decides it here
+    widget->setFixedSize(size);
+    return [widget](QImage &image) { widget->render(&image); };
+}
+
+void RenderCheckTest::paintCalibration(QImage &image)
+{
+    // Antialiased strokes, fills and a gradient: the same kind of work the widgets do
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QLinearGradient gradient(0, 0, CALIBRATION_SIZE.width(), CALIBRATION_SIZE.height());
+    gradient.setColorAt(0.0, QColor(255, 100, 100));
+    gradient.setColorAt(1.0, QColor(40, 40, 160));
+    painter.fillRect(QRect(QPoint(0, 0), CALIBRATION_SIZE), gradient);
+    for (int i = 0; i < 16; ++i) {
+        painter.setPen(QPen(QColor(20 * (i % 8), 120, 200), 3 + i % 5));
+        painter.setBrush(QColor(255, 255, 255, 40));
+        painter.drawEllipse(QRectF(8 * i, 4 * i, 240 - 12 * i, 248 - 10 * i));
+        painter.drawArc(QRectF(16, 16, 224, 224), 90 * 16, -360 * i);
+    }
+}
+
+QVector<qint64> RenderCheckTest::measure(const Painter &paint, QImage &image)
+{
+    QVector<qint64> samples;
+    samples.reserve(ITERATIONS);
+    QElapsedTimer timer;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        image.fill(Qt::white);
+        timer.start();
+        paint(image);
+        samples.append(timer.nsecsElapsed() / 1000);
+    }
+    return samples;
+}
+
+qint64 RenderCheckTest::percentile(QVector<qint64> samples, double fraction)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    const int index = qMin(static_cast<int>(samples.size() * fraction), static_cast<int>(samples.size()) - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples.at(index);
+}
+
+double RenderCheckTest::differingPixels(const QImage &actual, const QImage &golden)
+{
+    const QImage a = actual.convertToFormat(QImage::Format_ARGB32);
+    const QImage b = golden.convertToFormat(QImage::Format_ARGB32);
+    if (a.size() != b.size()) {
+        return -1.0;
+    }
+
+    qint64 differing = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        const auto *rowA = reinterpret_cast<const QRgb *>(a.constScanLine(y));
+        const auto *rowB = reinterpret_cast<const QRgb *>(b.constScanLine(y));
+        for (int x = 0; x < a.width(); ++x) {
+            const QRgb pa = rowA[x];
+            const QRgb pb = rowB[x];
+            if (qAbs(qRed(pa) - qRed(pb)) > CHANNEL_TOLERANCE
+                || qAbs(qGreen(pa) - qGreen(pb)) > CHANNEL_TOLERANCE
+                || qAbs(qBlue(pa) - qBlue(pb)) > CHANNEL_TOLERANCE
+                || qAbs(qAlpha(pa) - qAlpha(pb)) > CHANNEL_TOLERANCE) {
+                ++differing;
+            }
+        }
+    }
+    return static_cast<double>(differing) / (static_cast<qint64>(a.width()) * a.height());
+}
+
+QString RenderCheckTest::baselinePath() const
+{
+    return m_directory + "/" + BASELINE_FILE_NAME;
+}
+
+QTEST_MAIN(RenderCheckTest)
+#include "RenderCheckTest.moc"
@@ -0,0 +1,137 @@
+#include "SessionClock.h"
+#include "SessionHistory.h"
+
+#include <QDateTime>
+#include <QTest>
+
+namespace {
+    constexpr qint64 START_WALL_MS = Q_INT64_C(1600000000000);
+}
+
+// Real suspends and clock steps cannot be staged in a test; the gap
+// handling is exercised through restore(), which shares the policy rules
+class SessionClockTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void policyNamesRoundTrip();
+    void runningTimeAccumulates();
+    void stopKeepsActiveTime();
+    void shortDowntimeKeepsRunning();
+    void longDowntimeFollowsPolicy_data();
+    void longDowntimeFollowsPolicy();
+    void resetForgetsSession();
+};
+
+void SessionClockTest::policyNamesRoundTrip()
+{
+    for (SessionClock::GapPolicy policy : {SessionClock::GapPolicy::Pause, SessionClock::GapPolicy::Count,
+                                           SessionClock::GapPolicy::Discard}) {
+        SessionClock::GapPolicy parsed = SessionClock::GapPolicy::Pause;
+        QVERIFY(SessionClock::parsePolicy(SessionClock::policyName(policy), parsed));
+        QVERIFY(parsed == policy);
+    }
+
+    SessionClock::GapPolicy policy = SessionClock::GapPolicy::Count;
+    QVERIFY(SessionClock::parsePolicy(QStringLiteral(" Discard "), policy));
+    QVERIFY(policy == SessionClock::GapPolicy::Discard);
+    QVERIFY(!SessionClock::parsePolicy(QStringLiteral("sleep"), policy));
+    QVERIFY(policy == SessionClock::GapPolicy::Discard);
+}
+
+void SessionClockTest::runningTimeAccumulates()
+{
+    SessionClock clock;
+    const qint64 before = QDateTime::currentMSecsSinceEpoch();
+    clock.start();
+    QVERIFY(clock.isRunning());
+    QVERIFY(clock.startWallMs() >= before);
+
+    QTest::qSleep(100);
+    const SessionClock::Event event = clock.poll();
+    QCOMPARE(event.gapMs, qint64(0));
+    QVERIFY(!event.wallStepped);
+    QVERIFY(clock.activeMs() >= 100);
+    QVERIFY(clock.activeMs() < SessionClock::GAP_THRESHOLD_MS);
+    QCOMPARE(clock.flags(), quint8(0));
+    QVERIFY(clock.isRunning());
+}
+
+void SessionClockTest::stopKeepsActiveTime()
+{
+    SessionClock clock;
+    clock.start();
+    const qint64 startWall = clock.startWallMs();
+    QTest::qSleep(50);
+    clock.stop();
+    QVERIFY(!clock.isRunning());
+
+    const qint64 active = clock.activeMs();
+    QVERIFY(active >= 50);
+    QTest::qSleep(50);
+    QCOMPARE(clock.activeMs(), active);     // paused time is not counted
+
+    // Resuming continues the same session
+    clock.start();
+    QCOMPARE(clock.startWallMs(), startWall);
+    QVERIFY(clock.activeMs() >= active);
+}
+
+void SessionClockTest::shortDowntimeKeepsRunning()
+{
+    SessionClock clock(SessionClock::GapPolicy::Pause);
+    const SessionClock::Event event = clock.restore(60000, START_WALL_MS, SessionClockStepped,
+                                                    SessionClock::GAP_THRESHOLD_MS);
+    QCOMPARE(event.gapMs, qint64(0));
+    QVERIFY(!clock.isRunning());
+    QCOMPARE(clock.activeMs(), 60000 + SessionClock::GAP_THRESHOLD_MS);
+    QCOMPARE(clock.startWallMs(), START_WALL_MS);
+    QCOMPARE(clock.flags(), quint8(SessionClockStepped));
+}
+
+void SessionClockTest::longDowntimeFollowsPolicy_data()
+{
+    QTest::addColumn<int>("policy");
+    QTest::addColumn<qint64>("activeMs");
+    QTest::addColumn<int>("flag");
+
+    QTest::newRow("pause") << int(SessionClock::GapPolicy::Pause) << qint64(60000) << int(SessionGapExcluded);
+    QTest::newRow("count") << int(SessionClock::GapPolicy::Count) << qint64(60000 + 600000) << int(SessionGapCounted);
+    QTest::newRow("discard") << int(SessionClock::GapPolicy::Discard) << qint64(60000) << int(SessionGapExcluded);
+}
+
+void SessionClockTest::longDowntimeFollowsPolicy()
+{
+    QFETCH(int, policy);
+    QFETCH(qint64, activeMs);
+    QFETCH(int, flag);
+
+    SessionClock clock(static_cast<SessionClock::GapPolicy>(policy));
+    const SessionClock::Event event = clock.restore(60000, START_WALL_MS, 0, 600000);
+    QCOMPARE(event.gapMs, qint64(600000));
+    QVERIFY(!clock.isRunning());
+    QCOMPARE(clock.activeMs(), activeMs);
+    QCOMPARE(clock.flags(), quint8(flag));
+
+    // The restored session carries on from where it was
+    clock.start();
+    QCOMPARE(clock.startWallMs(), START_WALL_MS);
+    QVERIFY(clock.activeMs() >= activeMs);
+}
+
+void SessionClockTest::resetForgetsSession()
+{
+    SessionClock clock;
+    clock.restore(60000, START_WALL_MS, SessionGapCounted);
+    clock.reset();
+    QCOMPARE(clock.activeMs(), qint64(0));
+    QCOMPARE(clock.startWallMs(), qint64(0));
+    QCOMPARE(clock.flags(), quint8(0));
+
+    clock.start();
+    QVERIFY(clock.startWallMs() > START_WALL_MS);
+}
+
+QTEST_GUILESS_MAIN(SessionClockTest)
+#include "SessionClockTest.moc"
@@ -0,0 +1,142 @@
+#include "BackgroundWriter.h"
+#include "SessionHistory.h"
+#include "SessionMetrics.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>
+#include <QtEndian>
+
+// The metrics and the history are singletons kept in the test-mode data
+// directory; the slots build on each other and run in order
+class SessionMetricsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void incrementalFigures();
+    void rebuildFromHistory();
+    void stateIsSaved();
+
+private:
+    static SessionRecord session(const QDate &date, TimerState type, quint32 duration, quint8 flags = 0);
+    static bool fuzzyEqual(double actual, double expected) { return qAbs(actual - expected) < 1e-9; }
+
+    // The sessions of incrementalFigures(), as (session, interruptions)
+    QVector<QPair<SessionRecord, int>> m_sessions;
+    const QDate m_today{2022, 6, 1};
+};
+
+SessionRecord SessionMetricsTest::session(const QDate &date, TimerState type, quint32 duration, quint8 flags)
+{
+    SessionRecord record;
+    record.startTime = QDateTime(date, QTime(12, 0)).toSecsSinceEpoch();
+    record.type = type;
+    record.duration = duration;
+    record.flags = flags;
+    return record;
+}
+
+void SessionMetricsTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).removeRecursively();
+
+    const SessionMetrics &metrics = SessionMetrics::instance();
+    QVERIFY(metrics.needsRebuild());        // no state file yet
+    QCOMPARE(metrics.finishedSessions(), 0u);
+    QCOMPARE(metrics.currentStreak(m_today), 0);
+}
+
+void SessionMetricsTest::incrementalFigures()
+{
+    m_sessions = {
+        {session(m_today.addDays(-5), TimerState::Work, 1500), 2},
+        {session(m_today.addDays(-3), TimerState::Work, 1500), 0},
+        {session(m_today.addDays(-2), TimerState::Work, 1200), 1},
+        {session(m_today.addDays(-2), TimerState::Work, 300, SessionSkipped), 0},
+        {session(m_today.addDays(-1), TimerState::Work, 1500), 0},
+        {session(m_today.addDays(-1), TimerState::ShortBreak, 300), 4},     // breaks are ignored
+    };
+    SessionMetrics &metrics = SessionMetrics::instance();
+    for (const auto &[record, interruptions] : std::as_const(m_sessions)) {
+        metrics.add(record, interruptions);
+    }
+
+    QCOMPARE(metrics.finishedSessions(), 4u);
+    QCOMPARE(metrics.skippedSessions(), 1u);
+    QVERIFY(fuzzyEqual(metrics.completionRate(), 0.8));
+    QVERIFY(fuzzyEqual(metrics.averageInterruptions(), 3.0 / 5));
+
+    // -3, -2 and -1 in a row; the streak survives today and ends tomorrow
+    QCOMPARE(metrics.bestStreak(), 3);
+    QCOMPARE(metrics.currentStreak(m_today.addDays(-1)), 3);
+    QCOMPARE(metrics.currentStreak(m_today), 3);
+    QCOMPARE(metrics.currentStreak(m_today.addDays(1)), 0);
+
+    // Skipped sessions count towards the time spent, idle days towards the average
+    SessionMetrics::Average week = metrics.rollingAverage(7, m_today);
+    QVERIFY(fuzzyEqual(week.workMinutes, 6000.0 / 60 / 7));
+    QVERIFY(fuzzyEqual(week.sessions, 5.0 / 7));
+    week = metrics.rollingAverage(7, m_today.addDays(3));
+    QVERIFY(fuzzyEqual(week.workMinutes, 4500.0 / 60 / 7));
+    QVERIFY(fuzzyEqual(week.sessions, 4.0 / 7));
+    const SessionMetrics::Average month = metrics.rollingAverage(30, m_today.addDays(40));
+    QCOMPARE(month.sessions, 0.0);
+
+    QTest::ignoreMessage(QtWarningMsg, "SessionMetrics: no rolling window of 14 days");
+    QCOMPARE(metrics.rollingAverage(14, m_today).sessions, 0.0);
+
+    // A session recorded late for an earlier day cannot extend the streak after it
+    const SessionRecord late = session(m_today.addDays(-4), TimerState::Work, 1500);
+    metrics.add(late);
+    m_sessions.append({late, 0});
+    QCOMPARE(metrics.bestStreak(), 3);
+    QCOMPARE(metrics.finishedSessions(), 5u);
+}
+
+void SessionMetricsTest::rebuildFromHistory()
+{
+    SessionHistory &history = SessionHistory::instance();
+    for (const auto &[record, interruptions] : std::as_const(m_sessions)) {
+        Q_UNUSED(interruptions)
+        history.append(record);
+    }
+
+    SessionMetrics &metrics = SessionMetrics::instance();
+    metrics.rebuild(history);
+    QVERIFY(!metrics.needsRebuild());
+    QCOMPARE(metrics.finishedSessions(), 5u);
+    QCOMPARE(metrics.skippedSessions(), 1u);
+
+    // Rebuilt in day order, the late session joins -5 to -1 into one streak
+    QCOMPARE(metrics.bestStreak(), 5);
+    QCOMPARE(metrics.currentStreak(m_today), 5);
+
+    const SessionMetrics::Average week = metrics.rollingAverage(7, m_today);
+    QVERIFY(fuzzyEqual(week.workMinutes, 7500.0 / 60 / 7));
+    QVERIFY(fuzzyEqual(week.sessions, 6.0 / 7));
+
+    // The history does not keep interruptions, so rebuild() leaves their totals alone
+    QVERIFY(fuzzyEqual(metrics.averageInterruptions(), 3.0 / 6));
+}
+
+void SessionMetricsTest::stateIsSaved()
+{
+    BackgroundWriter::instance().flush();
+
+    QFile file(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+               + QStringLiteral("/metrics.dat"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray header = file.read(6);
+    QCOMPARE(header.size(), qsizetype(6));
+    QCOMPARE(qFromLittleEndian<quint32>(header.constData()), SessionMetrics::FILE_MAGIC);
+    QCOMPARE(qFromLittleEndian<quint16>(header.constData() + 4), SessionMetrics::FILE_VERSION);
+}
+
+QTEST_GUILESS_MAIN(SessionMetricsTest)
+#include "SessionMetricsTest.moc"
@@ -0,0 +1,162 @@
+#include "TeamTimerServer.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTcpSocket>
+#include <QTest>
+
+// Drives a TeamTimerServer on a loopback port with plain QTcpSocket clients
+class TeamTimerServerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void joinSendsState();
+    void transitionsReachEveryClient();
+    void malformedMessageIsRejected();
+    void overlongLineIsRejectedOnce();
+    void unterminatedOverlongLineIsDiscarded();
+
+private:
+    QTcpSocket *connectClient();
+    static QJsonObject nextMessage(QTcpSocket *socket);
+    static void send(QTcpSocket *socket, const QByteArray &line);
+
+    TeamTimerServer *m_server = nullptr;
+    QList<QTcpSocket*> m_clients;
+};
+
+void TeamTimerServerTest::initTestCase()
+{
+    // Rooms read PomodoroConfig; keep it away from the user's settings
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TeamTimerServerTest::init()
+{
+    m_server = new TeamTimerServer(this);
+    QVERIFY(m_server->listen(QHostAddress::LocalHost, 0));
+}
+
+void TeamTimerServerTest::cleanup()
+{
+    qDeleteAll(m_clients);
+    m_clients.clear();
+    delete m_server;
+    m_server = nullptr;
+}
+
+QTcpSocket *TeamTimerServerTest::connectClient()
+{
+    auto *socket = new QTcpSocket;
+    m_clients.append(socket);
+    socket->connectToHost(QHostAddress::LocalHost, m_server->serverPort());
+    if (!socket->waitForConnected(5000)) {
+        return nullptr;
+    }
+    return socket;
+}
+
+QJsonObject TeamTimerServerTest::nextMessage(QTcpSocket *socket)
+{
+    // The server lives on this thread, so keep its event loop turning while waiting
+    if (!QTest::qWaitFor([socket]() { return socket->canReadLine(); }, 5000)) {
+        return {};
+    }
+    return QJsonDocument::fromJson(socket->readLine()).object();
+}
+
+void TeamTimerServerTest::send(QTcpSocket *socket, const QByteArray &line)
+{
+    socket->write(line);
+    socket->flush();
+}
+
+void TeamTimerServerTest::joinSendsState()
+{
+    QTcpSocket *client = connectClient();
+    QVERIFY(client);
+
+    send(client, R"({"op":"join","room":"alpha"})" "\n");
+    const QJsonObject state = nextMessage(client);
+    QCOMPARE(state.value("ev").toString(), QStringLiteral("state"));
+    QCOMPARE(state.value("room").toString(), QStringLiteral("alpha"));
+    QCOMPARE(state.value("status").toString(), QStringLiteral("stopped"));
+    QCOMPARE(m_server->roomCount(), 1);
+}
+
+void TeamTimerServerTest::transitionsReachEveryClient()
+{
+    QTcpSocket *first = connectClient();
+    QTcpSocket *second = connectClient();
+    QVERIFY(first && second);
+
+    send(first, R"({"op":"join","room":"shared"})" "\n");
+    send(second, R"({"op":"join","room":"shared"})" "\n");
+    QCOMPARE(nextMessage(first).value("status").toString(), QStringLiteral("stopped"));
+    QCOMPARE(nextMessage(second).value("status").toString(), QStringLiteral("stopped"));
+
+    send(first, R"({"op":"start"})" "\n");
+    for (QTcpSocket *client : {first, second}) {
+        const QJsonObject state = nextMessage(client);
+        QCOMPARE(state.value("status").toString(), QStringLiteral("running"));
+        QVERIFY(state.value("deadline").toDouble() > 0);
+    }
+}
+
+void TeamTimerServerTest::malformedMessageIsRejected()
+{
+    QTcpSocket *client = connectClient();
+    QVERIFY(client);
+
+    send(client, "not json\n");
+    const QJsonObject error = nextMessage(client);
+    QCOMPARE(error.value("ev").toString(), QStringLiteral("error"));
+    QCOMPARE(error.value("message").toString(), QStringLiteral("malformed message"));
+}
+
+void TeamTimerServerTest::overlongLineIsRejectedOnce()
+{
+    QTcpSocket *client = connectClient();
+    QVERIFY(client);
+
+    // Arrives together with its newline and the next message; only one error
+    // may come back, and the message after it must still be handled
+    const QByteArray overlong(TeamTimerServer::MAX_LINE_LENGTH * 3, 'x');
+    send(client, overlong + "\n" R"({"op":"join","room":"after"})" "\n");
+
+    const QJsonObject error = nextMessage(client);
+    QCOMPARE(error.value("ev").toString(), QStringLiteral("error"));
+    QCOMPARE(error.value("message").toString(), QStringLiteral("line too long"));
+
+    const QJsonObject state = nextMessage(client);
+    QCOMPARE(state.value("ev").toString(), QStringLiteral("state"));
+    QCOMPARE(state.value("room").toString(), QStringLiteral("after"));
+    QCOMPARE(client->state(), QAbstractSocket::ConnectedState);
+}
+
+void TeamTimerServerTest::unterminatedOverlongLineIsDiscarded()
+{
+    QTcpSocket *client = connectClient();
+    QVERIFY(client);
+
+    const QByteArray overlong(TeamTimerServer::MAX_LINE_LENGTH + 512, 'y');
+    send(client, overlong);
+    const QJsonObject error = nextMessage(client);
+    QCOMPARE(error.value("message").toString(), QStringLiteral("line too long"));
+
+    // The tail of the same line, then a real message
+    send(client, overlong + "\n" R"({"op":"join","room":"later"})" "\n");
+    const QJsonObject state = nextMessage(client);
+    QCOMPARE(state.value("ev").toString(), QStringLiteral("state"));
+    QCOMPARE(state.value("room").toString(), QStringLiteral("later"));
+}
+
+QTEST_GUILESS_MAIN(TeamTimerServerTest)
+#include "TeamTimerServerTest.moc"
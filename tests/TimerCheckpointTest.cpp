@@ -0,0 +1,131 @@
+#include "TimerCheckpoint.h"
+#include "SessionHistory.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <memory>
+
+class TimerCheckpointTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void roundTrip();
+    void missingFileIsNotLoaded();
+    void damagedFilesAreRejected_data();
+    void damagedFilesAreRejected();
+    void downtimeOnlyWhileRunning();
+
+private:
+    QString checkpointPath() const { return m_directory->filePath(QStringLiteral("timer.checkpoint")); }
+    // The on-disk layout of save(), with every field under the test's control
+    static QByteArray encode(quint32 magic, quint16 version, quint8 state, qint32 totalDuration);
+
+    std::unique_ptr<QTemporaryDir> m_directory;
+};
+
+void TimerCheckpointTest::init()
+{
+    m_directory = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_directory->isValid());
+}
+
+QByteArray TimerCheckpointTest::encode(quint32 magic, quint16 version, quint8 state, qint32 totalDuration)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << magic << version << state << quint8(1) << quint8(0) << qint32(2) << totalDuration
+           << qint64(1000) << qint64(1600000000000) << qint64(1600000001000);
+    return data;
+}
+
+void TimerCheckpointTest::roundTrip()
+{
+    TimerCheckpoint saved;
+    saved.state = TimerState::LongBreak;
+    saved.running = true;
+    saved.completedSessions = 4;
+    saved.totalDuration = 900;
+    saved.activeMs = 123456;
+    saved.startWallMs = Q_INT64_C(1600000000000);
+    saved.clockFlags = SessionGapExcluded;
+    saved.writtenAtMs = Q_INT64_C(1600000123456);
+    QVERIFY(saved.save(checkpointPath()));
+
+    TimerCheckpoint loaded;
+    QVERIFY(TimerCheckpoint::load(checkpointPath(), loaded));
+    QVERIFY(loaded.state == TimerState::LongBreak);
+    QCOMPARE(loaded.running, true);
+    QCOMPARE(loaded.completedSessions, 4);
+    QCOMPARE(loaded.totalDuration, 900);
+    QCOMPARE(loaded.activeMs, qint64(123456));
+    QCOMPARE(loaded.startWallMs, saved.startWallMs);
+    QCOMPARE(loaded.clockFlags, saved.clockFlags);
+    QCOMPARE(loaded.writtenAtMs, saved.writtenAtMs);
+
+    // The file is replaced, not appended to
+    saved.running = false;
+    QVERIFY(saved.save(checkpointPath()));
+    QVERIFY(TimerCheckpoint::load(checkpointPath(), loaded));
+    QCOMPARE(loaded.running, false);
+}
+
+void TimerCheckpointTest::missingFileIsNotLoaded()
+{
+    TimerCheckpoint checkpoint;
+    checkpoint.totalDuration = 1500;
+    QVERIFY(!TimerCheckpoint::load(checkpointPath(), checkpoint));
+    QCOMPARE(checkpoint.totalDuration, 1500);
+}
+
+void TimerCheckpointTest::damagedFilesAreRejected_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("valid") << encode(TimerCheckpoint::MAGIC, TimerCheckpoint::VERSION, 0, 1500);
+    QTest::newRow("magic") << encode(0x12345678, TimerCheckpoint::VERSION, 0, 1500);
+    QTest::newRow("version") << encode(TimerCheckpoint::MAGIC, TimerCheckpoint::VERSION + 1, 0, 1500);
+    QTest::newRow("state") << encode(TimerCheckpoint::MAGIC, TimerCheckpoint::VERSION, 7, 1500);
+    QTest::newRow("duration") << encode(TimerCheckpoint::MAGIC, TimerCheckpoint::VERSION, 0, 0);
+    QTest::newRow("truncated") << encode(TimerCheckpoint::MAGIC, TimerCheckpoint::VERSION, 0, 1500).left(20);
+    QTest::newRow("empty") << QByteArray();
+}
+
+void TimerCheckpointTest::damagedFilesAreRejected()
+{
+    QFETCH(QByteArray, data);
+
+    QFile file(checkpointPath());
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(data) == data.size());
+    file.close();
+
+    // Only the untouched encoding is accepted, and a rejected file changes nothing
+    TimerCheckpoint checkpoint;
+    checkpoint.completedSessions = 9;
+    const bool valid = qstrcmp(QTest::currentDataTag(), "valid") == 0;
+    QCOMPARE(TimerCheckpoint::load(checkpointPath(), checkpoint), valid);
+    QCOMPARE(checkpoint.completedSessions, valid ? 2 : 9);
+}
+
+void TimerCheckpointTest::downtimeOnlyWhileRunning()
+{
+    TimerCheckpoint checkpoint;
+    checkpoint.writtenAtMs = 10000;
+
+    checkpoint.running = true;
+    QCOMPARE(checkpoint.downtimeMsAt(70000), qint64(60000));
+    // A wall clock set back since the write is no downtime at all
+    QCOMPARE(checkpoint.downtimeMsAt(5000), qint64(0));
+
+    checkpoint.running = false;
+    QCOMPARE(checkpoint.downtimeMsAt(70000), qint64(0));
+}
+
+QTEST_GUILESS_MAIN(TimerCheckpointTest)
+#include "TimerCheckpointTest.moc"